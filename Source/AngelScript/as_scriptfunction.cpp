@@ -1095,6 +1095,10 @@ asDWORD asCScriptFunction::GetAccessMask() const
 // internal
 void asCScriptFunction::JITCompile()
 {
+	// Virtual methods in the module have no bytecode of their own
+	if( funcType != asFUNC_SCRIPT )
+		return;
+
 	asIJITCompiler *jit = engine->GetJITCompiler();
 	if( !jit )
 		return;
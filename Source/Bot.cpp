@@ -0,0 +1,609 @@
+#include "Core.h"
+
+#ifndef FO_WINDOWS
+# include <errno.h>
+# include <fcntl.h>
+# include <netinet/tcp.h>
+#endif
+
+#include "Bot.h"
+#include "Crypt.h"
+#include "GameOptions.h"
+#include "Log.h"
+#include "NetProtocol.h"
+#include "Text.h"
+#include "Timer.h"
+
+// Hashes of texts and item prototypes sent by server, next logins skip that data
+// Shared by all bots, race between threads only causes extra transfer
+static uint TextMsgHashes[TEXTMSG_MAX];
+static uint ItemProtoHashes[ITEM_TYPE_MAX];
+
+static bool IsWouldBlock()
+{
+    #ifdef FO_WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+    #else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+    #endif
+}
+
+Bot::Bot( const BotOptions& options, uint index ) : State( BOT_STATE_DISCONNECTED ),
+    BytesSend( 0 ), BytesReceive( 0 ), Logins( 0 ), Disconnects( 0 ), Moves( 0 ), Texts( 0 ), Attacks( 0 ),
+    Options( options ), Registered( !options.Register ), Rnd( index + 1 ), Sock( INVALID_SOCKET ), BoutPos( 0 ), ZStreamOk( false ),
+    ChosenId( 0 ), MapPid( 0 ), HexX( 0 ), HexY( 0 ), ReconnectTick( 0 ), WalkTick( 0 ), ChatTick( 0 ), CombatTick( 0 )
+{
+    memzero( Name, sizeof(Name) );
+    Str::Format( Name, "%s%u", options.NamePrefix.c_str(), index + 1 );
+
+    // Server rejects logins with same set of uids, so each bot have own
+    // Check bits are same as in client
+    for( int i = 0; i < 5; i++ )
+        UID[i] = (index + 1) * 2654435761U + i * 0x9E3779B9U;
+    SETFLAG( UID[0], 0x00800000 );
+    UNSETFLAG( UID[0], 0x00000400 );
+    SETFLAG( UID[1], 0x04000000 );
+    UNSETFLAG( UID[1], 0x00200000 );
+    SETFLAG( UID[2], 0x00000020 );
+    UNSETFLAG( UID[2], 0x00000800 );
+    SETFLAG( UID[3], 0x80000000 );
+    UNSETFLAG( UID[3], 0x40000000 );
+    SETFLAG( UID[4], 0x00000800 );
+    UNSETFLAG( UID[4], 0x00004000 );
+
+    ComBuf.resize( 0x10000 );
+    memzero( &ZStream, sizeof(ZStream) );
+}
+
+Bot::~Bot()
+{
+    Stop();
+    if( ZStreamOk )
+        inflateEnd( &ZStream );
+}
+
+bool Bot::Connect()
+{
+    Bin.Reset();
+    Bout.Reset();
+    Bin.SetEncryptKey( 0 );
+    Bout.SetEncryptKey( 0 );
+    BoutPos = 0;
+
+    if( ZStreamOk )
+        inflateEnd( &ZStream );
+    memzero( &ZStream, sizeof(ZStream) );
+    ZStreamOk = (inflateInit( &ZStream ) == Z_OK);
+    if( !ZStreamOk )
+    {
+        WriteLogF( _FUNC_, " - ZStream InflateInit error, bot<%s>.\n", Name );
+        return false;
+    }
+
+    if( (Sock = socket( AF_INET, SOCK_STREAM, 0 ) ) == INVALID_SOCKET )
+    {
+        WriteLogF( _FUNC_, " - Create socket error<%s>, bot<%s>.\n", GetLastSocketError(), Name );
+        return false;
+    }
+
+    int optval = 1;
+    setsockopt( Sock, IPPROTO_TCP, TCP_NODELAY, (char*)&optval, sizeof(optval) );
+
+    // Connect is fast on loopback, so only data exchange is nonblocking
+    if( connect( Sock, (sockaddr*)&Options.Addr, sizeof(sockaddr_in) ) )
+    {
+        WriteLogF( _FUNC_, " - Can't connect to server, error<%s>, bot<%s>.\n", GetLastSocketError(), Name );
+        closesocket( Sock );
+        Sock = INVALID_SOCKET;
+        return false;
+    }
+
+    #ifdef FO_WINDOWS
+    u_long nonblocking = 1;
+    ioctlsocket( Sock, FIONBIO, &nonblocking );
+    #else
+    fcntl( Sock, F_SETFL, fcntl( Sock, F_GETFL, 0 ) | O_NONBLOCK );
+    #endif
+
+    ChosenId = 0;
+    MapPid = 0;
+    Critters.clear();
+    return true;
+}
+
+void Bot::Stop()
+{
+    if( Sock != INVALID_SOCKET )
+    {
+        shutdown( Sock, SD_BOTH );
+        closesocket( Sock );
+        Sock = INVALID_SOCKET;
+    }
+    State = BOT_STATE_DISCONNECTED;
+}
+
+void Bot::Disconnect()
+{
+    if( State == BOT_STATE_DISCONNECTED )
+        return;
+
+    if( State != BOT_STATE_REGISTER )
+        Disconnects++;
+    Stop();
+    ReconnectTick = Timer::FastTick() + Options.ReconnectTime;
+}
+
+void Bot::Process( uint tick, uint actions )
+{
+    if( State == BOT_STATE_DISCONNECTED )
+    {
+        if( tick < ReconnectTick )
+            return;
+        ReconnectTick = tick + Options.ReconnectTime;
+
+        if( !Connect() )
+            return;
+
+        // Any answer of registration (success, name is taken) is followed by login attempts
+        if( !Registered )
+        {
+            Net_SendCreatePlayer();
+            Registered = true;
+            State = BOT_STATE_REGISTER;
+        }
+        else
+        {
+            Net_SendLogIn();
+            State = BOT_STATE_LOGIN;
+        }
+    }
+
+    if( !NetInput() )
+    {
+        Disconnect();
+        return;
+    }
+
+    NetProcess();
+    if( State == BOT_STATE_DISCONNECTED )
+        return;
+    if( Bin.IsError() )
+    {
+        WriteLogF( _FUNC_, " - Input buffer error, bot<%s>.\n", Name );
+        Disconnect();
+        return;
+    }
+
+    if( State == BOT_STATE_PLAYING )
+    {
+        if( FLAG( actions, BOT_ACTION_WALK ) && tick >= WalkTick )
+        {
+            Net_SendMove();
+            WalkTick = tick + Options.WalkTime;
+        }
+        if( FLAG( actions, BOT_ACTION_CHAT ) && tick >= ChatTick )
+        {
+            Net_SendText();
+            ChatTick = tick + Options.ChatTime;
+        }
+        if( FLAG( actions, BOT_ACTION_COMBAT ) && tick >= CombatTick )
+        {
+            Net_SendAttack();
+            CombatTick = tick + Options.CombatTime;
+        }
+    }
+
+    if( !NetOutput() )
+        Disconnect();
+}
+
+bool Bot::NetInput()
+{
+    while( true )
+    {
+        int len = recv( Sock, &ComBuf[0], (int)ComBuf.size(), 0 );
+        if( len == 0 )
+            return false;
+        if( len < 0 )
+            return IsWouldBlock();
+
+        BytesReceive += len;
+        Bin.Refresh();
+
+        if( Options.DisableZlib )
+        {
+            Bin.Push( &ComBuf[0], len, true );
+            continue;
+        }
+
+        ZStream.next_in = (uchar*)&ComBuf[0];
+        ZStream.avail_in = len;
+        do
+        {
+            Bin.GrowBuf( 2048 );
+
+            ZStream.next_out = (uchar*)Bin.GetData() + Bin.GetEndPos();
+            ZStream.avail_out = Bin.GetLen() - Bin.GetEndPos();
+
+            int result = inflate( &ZStream, Z_SYNC_FLUSH );
+            if( result != Z_OK && result != Z_BUF_ERROR )
+            {
+                WriteLogF( _FUNC_, " - ZStream Inflate error<%d>, bot<%s>.\n", result, Name );
+                return false;
+            }
+
+            Bin.SetEndPos( (uint)( (size_t)ZStream.next_out - (size_t)Bin.GetData() ) );
+        }
+        while( ZStream.avail_in || !ZStream.avail_out );
+    }
+}
+
+bool Bot::NetOutput()
+{
+    while( BoutPos < Bout.GetEndPos() )
+    {
+        int len = send( Sock, Bout.GetData() + BoutPos, Bout.GetEndPos() - BoutPos, 0 );
+        if( len <= 0 )
+            return len < 0 && IsWouldBlock();
+
+        BoutPos += len;
+        BytesSend += len;
+    }
+
+    Bout.Reset();
+    BoutPos = 0;
+    return true;
+}
+
+void Bot::NetProcess()
+{
+    if( Bin.NeedProcessRaw() )
+    {
+        Bin.SetEncryptKey( 0 );
+        Bout.SetEncryptKey( 0 );
+        Bin.MoveReadPos( 4 );
+
+        uint data = 0;
+        Bin >> data;
+
+        if( data == NETRAW_INVALID_VERSION )
+            WriteLog( "Invalid version, bot<%s>.\n", Name );
+        Disconnect();
+        return;
+    }
+
+    while( Bin.NeedProcess() )
+    {
+        uint msg = 0;
+        Bin >> msg;
+
+        switch( msg )
+        {
+            case NETMSG_LOGIN_SUCCESS:
+                Net_OnLoginSuccess();
+                break;
+            case NETMSG_REGISTER_SUCCESS:
+                break;
+            case NETMSG_PING:
+                Net_OnPing();
+                break;
+            case NETMSG_LOADMAP:
+                Net_OnLoadMap();
+                break;
+            case NETMSG_ADD_PLAYER:
+            case NETMSG_ADD_NPC:
+                Net_OnAddCritter();
+                break;
+            case NETMSG_REMOVE_CRITTER:
+                Net_OnRemoveCritter();
+                break;
+            case NETMSG_CRITTER_XY:
+                Net_OnCritterXY();
+                break;
+            case NETMSG_MSG_DATA:
+                Net_OnMsgData();
+                break;
+            case NETMSG_ITEM_PROTOS:
+                Net_OnProtoItemData();
+                break;
+            default:
+                Bin.SkipMsg( msg );
+                break;
+        }
+
+        if( State == BOT_STATE_DISCONNECTED || Bin.IsError() )
+            return;
+    }
+}
+
+void Bot::SkipMsgRest( uint msg_begin, uint msg_len )
+{
+    uint msg_end = msg_begin + msg_len;
+    if( msg_end > Bin.GetCurPos() )
+        Bin.MoveReadPos( msg_end - Bin.GetCurPos() );
+}
+
+void Bot::Net_SendCreatePlayer()
+{
+    ushort count = (ushort)(Options.RegParams.size() / 2);
+    uint   msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(ushort) * 2 + UTF8_BUF_SIZE( MAX_NAME ) + PASS_HASH_SIZE + sizeof(count) + (sizeof(ushort) + sizeof(int) ) * count;
+
+    Bout << NETMSG_REGISTER;
+    Bout << msg_len;
+
+    Bout << (ushort)FOCLASSIC_STAGE;
+    Bout << (ushort)FOCLASSIC_VERSION;
+
+    Bout.SetEncryptKey( 892018 + NETSALT_REGISTER );
+    Bin.SetEncryptKey( 892018 - NETSALT_REGISTER );
+
+    Bout.Push( Name, UTF8_BUF_SIZE( MAX_NAME ) );
+    char pass_hash[PASS_HASH_SIZE];
+    Crypt.ClientPassHash( Name, Options.Password.c_str(), pass_hash );
+    Bout.Push( pass_hash, PASS_HASH_SIZE );
+
+    Bout << count;
+    for( ushort i = 0; i < count; i++ )
+    {
+        Bout << (ushort)Options.RegParams[i * 2];
+        Bout << Options.RegParams[i * 2 + 1];
+    }
+}
+
+void Bot::Net_SendLogIn()
+{
+    Bout << NETMSG_LOGIN;
+    Bout << (ushort)FOCLASSIC_STAGE;
+    Bout << (ushort)FOCLASSIC_VERSION;
+    Bout << UID[4];
+
+    Bout.SetEncryptKey( UID[4] + NETSALT_LOGIN );
+    Bin.SetEncryptKey( UID[4] - NETSALT_LOGIN );
+
+    uint uidxor = 0xF145668A, uidor = 0, uidcalc = 0x45012345;
+    for( int i = 0; i < 5; i++ )
+    {
+        uidxor ^= UID[i];
+        uidor |= UID[i];
+        uidcalc += UID[i];
+    }
+
+    Bout.Push( Name, sizeof(Name) );
+    Bout << UID[1];
+    char pass_hash[PASS_HASH_SIZE];
+    Crypt.ClientPassHash( Name, Options.Password.c_str(), pass_hash );
+    Bout.Push( pass_hash, PASS_HASH_SIZE );
+    Bout << Options.Language;
+    for( int i = 0; i < TEXTMSG_MAX; i++ )
+        Bout << TextMsgHashes[i];
+    Bout << uidxor;
+    Bout << UID[3];
+    Bout << UID[2];
+    Bout << uidor;
+    for( int i = 0; i < ITEM_TYPE_MAX; i++ )
+        Bout << ItemProtoHashes[i];
+    Bout << uidcalc;
+    Bout << (uchar)COMBAT_MODE_ANY;
+    Bout << UID[0];
+
+    char dummy[100];
+    memzero( dummy, sizeof(dummy) );
+    Bout.Push( dummy, 100 );
+}
+
+void Bot::Net_SendMove()
+{
+    if( !ChosenId || !MapPid )
+        return;
+
+    int   hx = HexX;
+    int   hy = HexY;
+    uchar dir = (uchar)Rnd.Random( 0, DIRS_COUNT - 1 );
+    MoveHexByDirUnsafe( hx, hy, dir );
+    if( hx < 0 || hy < 0 || hx > MAXHEX_MAX || hy > MAXHEX_MAX )
+        return;
+
+    // Server answers with position correction if hex is blocked
+    HexX = hx;
+    HexY = hy;
+
+    Bout << NETMSG_SEND_MOVE_WALK;
+    Bout << (uint)0;
+    Bout << HexX;
+    Bout << HexY;
+    Moves++;
+}
+
+void Bot::Net_SendText()
+{
+    char   str[MAX_FOTEXT];
+    Str::Format( str, "%s load test message %u", Name, Texts + 1 );
+
+    uchar  how_say = SAY_NORM;
+    ushort len = Str::Length( str );
+    uint   msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(how_say) + sizeof(len) + len;
+
+    Bout << NETMSG_SEND_TEXT;
+    Bout << msg_len;
+    Bout << how_say;
+    Bout << len;
+    Bout.Push( str, len );
+    Texts++;
+}
+
+void Bot::Net_SendAttack()
+{
+    if( !ChosenId || !MapPid || Critters.size() < 2 )
+        return;
+
+    uint target_id = Critters[Rnd.Random( 0, (int)Critters.size() - 1 )];
+    if( target_id == ChosenId )
+        return;
+
+    Bout << NETMSG_SEND_USE_ITEM;
+    Bout << Options.CombatAp;
+    Bout << (uint)0;
+    Bout << (ushort)UNARMED_PUNCH;
+    Bout << (uchar)USE_PRIMARY;
+    Bout << (uchar)TARGET_CRITTER;
+    Bout << target_id;
+    Bout << (ushort)0;
+    Bout << (uint)0;
+    Attacks++;
+}
+
+void Bot::Net_OnLoginSuccess()
+{
+    // Server bin/bout == client bout/bin
+    uint bin_seed, bout_seed;
+    Bin >> bin_seed;
+    Bin >> bout_seed;
+    Bout.SetEncryptKey( bin_seed + NETSALT_BIN );
+    Bin.SetEncryptKey( bout_seed + NETSALT_BOUT );
+
+    State = BOT_STATE_TRANSFER;
+    Logins++;
+}
+
+void Bot::Net_OnPing()
+{
+    uchar ping;
+    Bin >> ping;
+
+    if( ping == PING_CLIENT )
+    {
+        Bout << NETMSG_PING;
+        Bout << (uchar)PING_CLIENT;
+    }
+}
+
+void Bot::Net_OnLoadMap()
+{
+    ushort map_pid;
+    int    map_time;
+    uchar  map_rain;
+    uint   hash_tiles;
+    uint   hash_walls;
+    uint   hash_scen;
+    Bin >> map_pid;
+    Bin >> map_time;
+    Bin >> map_rain;
+    Bin >> hash_tiles;
+    Bin >> hash_walls;
+    Bin >> hash_scen;
+
+    // Map data is not needed, server only waits for confirmation
+    MapPid = map_pid;
+    ChosenId = 0;
+    Critters.clear();
+    Bout << NETMSG_SEND_LOAD_MAP_OK;
+
+    if( State == BOT_STATE_TRANSFER )
+    {
+        uint tick = Timer::FastTick();
+        WalkTick = tick + Rnd.Random( 0, Options.WalkTime );
+        ChatTick = tick + Rnd.Random( 0, Options.ChatTime );
+        CombatTick = tick + Rnd.Random( 0, Options.CombatTime );
+    }
+    State = BOT_STATE_PLAYING;
+}
+
+void Bot::Net_OnAddCritter()
+{
+    uint msg_begin = Bin.GetCurPos() - sizeof(uint);
+    uint msg_len;
+    Bin >> msg_len;
+
+    uint   crid;
+    uint   base_type;
+    ushort hx, hy;
+    uchar  dir;
+    uchar  cond;
+    uint   anims[6];
+    uint   flags;
+    Bin >> crid;
+    Bin >> base_type;
+    Bin >> hx;
+    Bin >> hy;
+    Bin >> dir;
+    Bin >> cond;
+    for( int i = 0; i < 6; i++ )
+        Bin >> anims[i];
+    Bin >> flags;
+    SkipMsgRest( msg_begin, msg_len );
+
+    if( !crid )
+        return;
+
+    if( FLAG( flags, CRITTER_FLAG_CHOSEN ) )
+    {
+        ChosenId = crid;
+        HexX = hx;
+        HexY = hy;
+    }
+    if( std::find( Critters.begin(), Critters.end(), crid ) == Critters.end() )
+        Critters.push_back( crid );
+}
+
+void Bot::Net_OnRemoveCritter()
+{
+    uint crid;
+    Bin >> crid;
+
+    auto it = std::find( Critters.begin(), Critters.end(), crid );
+    if( it != Critters.end() )
+    {
+        *it = Critters.back();
+        Critters.pop_back();
+    }
+}
+
+void Bot::Net_OnCritterXY()
+{
+    uint   crid;
+    ushort hx;
+    ushort hy;
+    uchar  dir;
+    Bin >> crid;
+    Bin >> hx;
+    Bin >> hy;
+    Bin >> dir;
+
+    if( crid == ChosenId )
+    {
+        HexX = hx;
+        HexY = hy;
+    }
+}
+
+void Bot::Net_OnMsgData()
+{
+    uint   msg_begin = Bin.GetCurPos() - sizeof(uint);
+    uint   msg_len;
+    uint   lang;
+    ushort num_msg;
+    uint   data_hash;
+    Bin >> msg_len;
+    Bin >> lang;
+    Bin >> num_msg;
+    Bin >> data_hash;
+    SkipMsgRest( msg_begin, msg_len );
+
+    if( num_msg < TEXTMSG_MAX )
+        TextMsgHashes[num_msg] = data_hash;
+}
+
+void Bot::Net_OnProtoItemData()
+{
+    uint  msg_begin = Bin.GetCurPos() - sizeof(uint);
+    uint  msg_len;
+    uchar type;
+    uint  data_hash;
+    Bin >> msg_len;
+    Bin >> type;
+    Bin >> data_hash;
+    SkipMsgRest( msg_begin, msg_len );
+
+    if( type < ITEM_TYPE_MAX )
+        ItemProtoHashes[type] = data_hash;
+}
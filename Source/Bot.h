@@ -0,0 +1,112 @@
+#ifndef __BOT__
+#define __BOT__
+
+#include "zlib.h"
+
+#include "BufferManager.h"
+#include "Network.h"
+#include "Random.h"
+#include "Types.h"
+
+// Session states
+#define BOT_STATE_DISCONNECTED    (0)
+#define BOT_STATE_REGISTER        (1) // Waiting for registration answer, server disconnects after it
+#define BOT_STATE_LOGIN           (2)
+#define BOT_STATE_TRANSFER        (3) // Logged in, waiting for map
+#define BOT_STATE_PLAYING         (4)
+
+// Scenario actions, combined by flags
+#define BOT_ACTION_WALK           (0x01)
+#define BOT_ACTION_CHAT           (0x02)
+#define BOT_ACTION_COMBAT         (0x04)
+
+struct BotOptions
+{
+    sockaddr_in Addr;
+    string      NamePrefix;
+    string      Password;
+    uint        Language;
+    bool        Register;
+    bool        DisableZlib;   // Must match server option
+    IntVec      RegParams;     // Pairs of parameter index and value
+    uint        ReconnectTime;
+    uint        WalkTime;
+    uint        ChatTime;
+    uint        CombatTime;
+    uchar       CombatAp;
+};
+
+// Headless client session, reuses client protocol without resources, map and interface
+// Only own position and critters around are tracked, other messages are skipped
+// Bot is processed by one thread, counters are read by other threads without locks
+class Bot
+{
+public:
+    Bot( const BotOptions& options, uint index );
+    ~Bot();
+
+    void Process( uint tick, uint actions );
+    void Stop();
+
+    const char* GetName() { return Name; }
+
+    volatile int State;
+    uint64       BytesSend;
+    uint64       BytesReceive;
+    uint         Logins;
+    uint         Disconnects;
+    uint         Moves;
+    uint         Texts;
+    uint         Attacks;
+
+private:
+    const BotOptions& Options;
+    char              Name[UTF8_BUF_SIZE( MAX_NAME )];
+    uint              UID[5];
+    bool              Registered;
+    Randomizer        Rnd;
+
+    SOCKET            Sock;
+    BufferManager     Bin;
+    BufferManager     Bout;
+    uint              BoutPos;
+    z_stream          ZStream;
+    bool              ZStreamOk;
+    CharVec           ComBuf;
+
+    uint              ChosenId;
+    ushort            MapPid;
+    ushort            HexX;
+    ushort            HexY;
+    UIntVec           Critters;
+
+    uint              ReconnectTick;
+    uint              WalkTick;
+    uint              ChatTick;
+    uint              CombatTick;
+
+    bool Connect();
+    void Disconnect(); // Unexpected, counted and delayed reconnect
+    bool NetInput();
+    bool NetOutput();
+    void NetProcess();
+    void SkipMsgRest( uint msg_begin, uint msg_len );
+
+    void Net_SendCreatePlayer();
+    void Net_SendLogIn();
+    void Net_SendMove();
+    void Net_SendText();
+    void Net_SendAttack();
+
+    void Net_OnLoginSuccess();
+    void Net_OnPing();
+    void Net_OnLoadMap();
+    void Net_OnAddCritter(); // Players and npc
+    void Net_OnRemoveCritter();
+    void Net_OnCritterXY();
+    void Net_OnMsgData();
+    void Net_OnProtoItemData();
+};
+typedef vector<Bot*> BotVec;
+
+#endif // __BOT__
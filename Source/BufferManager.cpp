@@ -90,8 +90,7 @@ void BufferManager::Refresh()
     }
     if( bufReadPos )
     {
-        for( uint i = bufReadPos; i < bufEndPos; i++ )
-            bufData[i - bufReadPos] = bufData[i];
+        memmove( bufData, bufData + bufReadPos, bufEndPos - bufReadPos );
         bufEndPos -= bufReadPos;
         bufReadPos = 0;
     }
@@ -122,14 +121,29 @@ void BufferManager::GrowBuf( uint len )
 {
     if( bufEndPos + len < bufLen )
         return;
+
+    // Space before read position is freed by Pop/Cut, reuse it if at least half of buffer is free
+    // Moving is amortized by skipped data, so Cut and Push sequences stay linear
+    uint data_len = bufEndPos - bufReadPos;
+    if( bufReadPos && data_len + len < bufLen / 2 )
+    {
+        memmove( bufData, bufData + bufReadPos, data_len );
+        bufReadPos = 0;
+        bufEndPos = data_len;
+        return;
+    }
+
+    // Copy only not processed data
     MEMORY_PROCESS( MEMORY_NET_BUFFER, -(int)bufLen );
-    while( bufEndPos + len >= bufLen )
+    while( data_len + len >= bufLen )
         bufLen <<= 1;
     MEMORY_PROCESS( MEMORY_NET_BUFFER, bufLen );
     char* new_buf = new char[bufLen];
-    memcpy( new_buf, bufData, bufEndPos );
+    memcpy( new_buf, bufData + bufReadPos, data_len );
     SAFEDELA( bufData );
     bufData = new_buf;
+    bufReadPos = 0;
+    bufEndPos = data_len;
 }
 
 void BufferManager::Push( const char* buf, uint len, bool no_crypt /* = false */ )
@@ -152,6 +166,42 @@ void BufferManager::Push( const char* buf, const char* mask, uint len )
     bufEndPos += len;
 }
 
+void BufferManager::Push( const BroadcastBuffer& msg )
+{
+    uint len = msg.GetLen();
+    if( isError || !len )
+        return;
+    if( bufEndPos + len >= bufLen )
+        GrowBuf( len );
+
+    const char* from = (const char*)msg.GetData();
+    char*       to = bufData + bufEndPos;
+    if( !encryptActive )
+    {
+        memcpy( to, from, len );
+    }
+    else
+    {
+        // Same keys sequence as for pushing field by field
+        const UIntVec& fields = msg.GetFields();
+        for( auto it = fields.begin(), end = fields.end(); it != end; ++it )
+        {
+            uint size = (*it & ~BROADCAST_FIELD_BLOCK);
+            if( *it & BROADCAST_FIELD_BLOCK )
+                CopyBuf( from, to, NULL, EncryptKey( size ), size );
+            else if( size == 4 )
+                *(uint*)to = *(uint*)from ^ EncryptKey( 4 );
+            else if( size == 2 )
+                *(ushort*)to = *(ushort*)from ^ EncryptKey( 2 );
+            else
+                *(uchar*)to = *(uchar*)from ^ EncryptKey( 1 );
+            from += size;
+            to += size;
+        }
+    }
+    bufEndPos += len;
+}
+
 void BufferManager::Pop( char* buf, uint len )
 {
     if( isError || !len )
@@ -176,10 +226,12 @@ void BufferManager::Cut( uint len )
         WriteLogF( _FUNC_, " - Error!\n" );
         return;
     }
-    char* buf = bufData + bufReadPos;
-    for( uint i = 0; i + bufReadPos + len < bufEndPos; i++ )
-        buf[i] = buf[i + len];
-    bufEndPos -= len;
+    bufReadPos += len;
+    if( bufReadPos == bufEndPos )
+    {
+        bufReadPos = 0;
+        bufEndPos = 0;
+    }
 }
 
 void BufferManager::CopyBuf( const char* from, char* to, const char* mask, uint crypt_key, uint len )
@@ -387,7 +439,84 @@ BufferManager& BufferManager::operator>>( bool& i )
 }
 
 
-#if defined (FOCLASSIC_CLIENT)
+BroadcastBuffer::BroadcastBuffer()
+{
+    data.reserve( 64 );
+    fields.reserve( 16 );
+}
+
+void BroadcastBuffer::Clear()
+{
+    data.clear();
+    fields.clear();
+}
+
+void BroadcastBuffer::AddField( const void* ptr, uint size, bool block )
+{
+    data.insert( data.end(), (const uchar*)ptr, (const uchar*)ptr + size );
+    fields.push_back( block ? (size | BROADCAST_FIELD_BLOCK) : size );
+}
+
+void BroadcastBuffer::Push( const char* buf, uint len )
+{
+    if( len )
+        AddField( buf, len, true );
+}
+
+void BroadcastBuffer::Push( const char* buf, const char* mask, uint len )
+{
+    if( !len || !mask )
+        return;
+    size_t pos = data.size();
+    AddField( buf, len, true );
+    for( uint i = 0; i < len; i++ )
+        data[pos + i] &= (uchar)mask[i];
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( uint i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( int i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( ushort i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( short i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( uchar i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( char i )
+{
+    AddField( &i, sizeof(i), false );
+    return *this;
+}
+
+BroadcastBuffer& BroadcastBuffer::operator<<( bool i )
+{
+    uchar b = (i ? 1 : 0);
+    AddField( &b, sizeof(b), false );
+    return *this;
+}
+
+#if defined (FOCLASSIC_CLIENT) || defined (FOCLASSIC_BOT)
 bool BufferManager::NeedProcessRaw()
 {
     if( bufReadPos + sizeof(uint) > bufEndPos )
@@ -398,7 +527,7 @@ bool BufferManager::NeedProcessRaw()
 }
 #endif
 
-#if (defined (FOCLASSIC_SERVER) ) || (defined (FOCLASSIC_CLIENT) )
+#if (defined (FOCLASSIC_SERVER) ) || (defined (FOCLASSIC_CLIENT) ) || (defined (FOCLASSIC_BOT) )
 bool BufferManager::NeedProcess()
 {
     if( bufReadPos + sizeof(uint) > bufEndPos )
@@ -594,7 +723,7 @@ bool BufferManager::NeedProcess()
             return msg_len + bufReadPos <= bufEndPos;
         default:
             // Unknown message
-            # ifdef FOCLASSIC_CLIENT
+            # if defined (FOCLASSIC_CLIENT) || defined (FOCLASSIC_BOT)
             WriteLogF( _FUNC_, " - Unknown message<%u> in buffer, try find valid.\n", (msg >> 8) & 0xFF );
             SeekValidMsg();
             return NeedProcess();
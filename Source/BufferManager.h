@@ -4,7 +4,39 @@
 #include "Mutex.h"
 #include "Types.h"
 
-#define CRYPT_KEYS_COUNT    (50)
+#define CRYPT_KEYS_COUNT         (50)
+#define BROADCAST_FIELD_BLOCK    (0x80000000)
+
+// Message serialized once and pushed to many buffers
+// Data stored without encryption, each buffer applies own keys field by field during pushing
+class BroadcastBuffer
+{
+private:
+    UCharVec data;
+    UIntVec  fields; // Size of each field, BROADCAST_FIELD_BLOCK flag for data pushed by Push
+
+    void AddField( const void* ptr, uint size, bool block );
+
+public:
+    BroadcastBuffer();
+    void Clear();
+
+    bool           IsEmpty() const   { return data.empty(); }
+    uint           GetLen() const    { return (uint)data.size(); }
+    const uchar*   GetData() const   { return &data[0]; }
+    const UIntVec& GetFields() const { return fields; }
+
+    void Push( const char* buf, uint len );
+    void Push( const char* buf, const char* mask, uint len );
+
+    BroadcastBuffer& operator<<( uint i );
+    BroadcastBuffer& operator<<( int i );
+    BroadcastBuffer& operator<<( ushort i );
+    BroadcastBuffer& operator<<( short i );
+    BroadcastBuffer& operator<<( uchar i );
+    BroadcastBuffer& operator<<( char i );
+    BroadcastBuffer& operator<<( bool i );
+};
 
 class BufferManager
 {
@@ -36,14 +68,16 @@ public:
     void LockReset();
     void Push( const char* buf, uint len, bool no_crypt = false );
     void Push( const char* buf, const char* mask, uint len );
+    void Push( const BroadcastBuffer& msg );
     void Pop( char* buf, uint len );
-    void Cut( uint len );
+    void Cut( uint len ); // Skip data at read position, encryption keys not moved
     void GrowBuf( uint len );
 
     char* GetData()             { return bufData; }
     char* GetCurData()          { return bufData + bufReadPos; }
     uint  GetLen()              { return bufLen; }
     uint  GetCurPos()           { return bufReadPos; }
+    uint  GetDataLen() const    { return bufEndPos - bufReadPos; }
     void  SetEndPos( uint pos ) { bufEndPos = pos; }
     uint  GetEndPos() const     { return bufEndPos; }
     void  MoveReadPos( int val )
@@ -55,10 +89,10 @@ public:
     bool IsEmpty() const               { return bufReadPos >= bufEndPos; }
     bool IsHaveSize( uint size ) const { return bufReadPos + size <= bufEndPos; }
 
-    #if defined (FOCLASSIC_CLIENT)
+    #if defined (FOCLASSIC_CLIENT) || defined (FOCLASSIC_BOT)
     bool NeedProcessRaw();
     #endif
-    #if (defined (FOCLASSIC_SERVER) ) || (defined (FOCLASSIC_CLIENT) )
+    #if (defined (FOCLASSIC_SERVER) ) || (defined (FOCLASSIC_CLIENT) ) || (defined (FOCLASSIC_BOT) )
     bool NeedProcess();
     void SkipMsg( uint msg );
     void SeekValidMsg();
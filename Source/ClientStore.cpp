@@ -0,0 +1,586 @@
+#include "Core.h"
+
+#include <unordered_map>
+
+#include "ClientStore.h"
+#include "Crypt.h"
+#include "FileSystem.h"
+#include "Log.h"
+#include "Mutex.h"
+#include "Text.h"
+#include "Timer.h"
+
+#define CLIENT_STORE_RECORD_MAGIC    (0x52414F46) // FOAR
+
+BINARY_SIGNATURE( ClientStoreSignature, BINARY_TYPE_CLIENTSTORE, CLIENT_STORE_LAST );
+
+// Record header, followed by Size bytes of data
+struct StoreRecord
+{
+    uint Magic;
+    uint Type;
+    uint Id;
+    uint Size;
+    uint Crc;
+    char Name[UTF8_BUF_SIZE( MAX_NAME )];
+    char PassHash[PASS_HASH_SIZE];
+};
+
+struct StoreSegment
+{
+    void* Read;
+    uint  Size;
+    uint  Waste; // Size of replaced records and tombstones
+};
+typedef map<uint, StoreSegment> StoreSegmentMap;
+
+struct StoreRef
+{
+    ClientStoreEntry Entry;
+    uint             Segment;
+    uint             Offset; // Record header offset
+    uint             Size;
+};
+typedef std::unordered_map<string, StoreRef> StoreNameIndex;
+typedef std::unordered_map<uint, string>     StoreIdIndex;
+typedef std::unordered_map<string, uint>     StoreTombstones; // Segment of last delete record
+
+static Mutex                 StoreLocker;
+static bool                  Opened = false;
+static string                StorePath;
+static StoreSegmentMap       Segments;
+static void*                 AppendFile = NULL;
+static StoreNameIndex        NameIndex;
+static StoreIdIndex          IdIndex;
+static StoreTombstones       Tombstones;
+static UCharVec              RecordBuf;
+static ClientStoreStatistics Stats;
+
+static string MakeKey( const char* name )
+{
+    char key[UTF8_BUF_SIZE( MAX_NAME )];
+    Str::Copy( key, name );
+    Str::LowerUTF8( key );
+    return string( key );
+}
+
+static const char* SegmentName( char* fname, uint number )
+{
+    return Str::Format( fname, "%saccounts%04u.foa", StorePath.c_str(), number );
+}
+
+static void WasteRecord( uint segment, uint size )
+{
+    auto it = Segments.find( segment );
+    if( it != Segments.end() )
+        it->second.Waste += sizeof(StoreRecord) + size;
+}
+
+static void IndexSave( const StoreRecord& rec, uint segment, uint offset )
+{
+    string key = MakeKey( rec.Name );
+    auto   it = NameIndex.find( key );
+    if( it != NameIndex.end() )
+    {
+        WasteRecord( it->second.Segment, it->second.Size );
+        IdIndex.erase( it->second.Entry.Id );
+    }
+    Tombstones.erase( key );
+
+    StoreRef& ref = NameIndex[key];
+    Str::Copy( ref.Entry.Name, rec.Name );
+    memcpy( ref.Entry.PassHash, rec.PassHash, PASS_HASH_SIZE );
+    ref.Entry.Id = rec.Id;
+    ref.Segment = segment;
+    ref.Offset = offset;
+    ref.Size = rec.Size;
+    IdIndex[rec.Id] = key;
+}
+
+static void IndexDelete( const string& key, uint segment )
+{
+    auto it = NameIndex.find( key );
+    if( it != NameIndex.end() )
+    {
+        WasteRecord( it->second.Segment, it->second.Size );
+        IdIndex.erase( it->second.Entry.Id );
+        NameIndex.erase( it );
+    }
+    WasteRecord( segment, 0 );
+    Tombstones[key] = segment;
+}
+
+static bool OpenSegment( uint number )
+{
+    char  fname[MAX_FOPATH];
+    SegmentName( fname, number );
+
+    void* f = FileOpen( fname, true );
+    if( !f )
+    {
+        WriteLogF( _FUNC_, " - Can't create client store file<%s>.\n", fname );
+        return false;
+    }
+    bool ok = FileWrite( f, ClientStoreSignature, sizeof(ClientStoreSignature) );
+    FileClose( f );
+
+    StoreSegment seg;
+    seg.Read = (ok ? FileOpenForSharedRead( fname ) : NULL);
+    seg.Size = sizeof(ClientStoreSignature);
+    seg.Waste = 0;
+    FileClose( AppendFile );
+    AppendFile = (seg.Read ? FileOpenForAppend( fname, true ) : NULL);
+    if( !AppendFile )
+    {
+        WriteLogF( _FUNC_, " - Can't open client store file<%s>.\n", fname );
+        FileClose( seg.Read );
+        return false;
+    }
+    Segments[number] = seg;
+    return true;
+}
+
+static bool AppendRecord( uint type, const char* name, uint id, const char* pass_hash, const uchar* data, uint size, StoreRef* ref )
+{
+    // Roll to new segment, also after failed write
+    if( !AppendFile || Segments.rbegin()->second.Size >= CLIENT_STORE_SEGMENT_SIZE )
+    {
+        uint number = (Segments.empty() ? 0 : Segments.rbegin()->first + 1);
+        if( !OpenSegment( number ) )
+            return false;
+    }
+
+    StoreRecord rec;
+    memzero( &rec, sizeof(rec) );
+    rec.Magic = CLIENT_STORE_RECORD_MAGIC;
+    rec.Type = type;
+    rec.Id = id;
+    rec.Size = size;
+    rec.Crc = (size ? Crypt.Crc32( (uchar*)data, size ) : 0);
+    Str::Copy( rec.Name, name );
+    if( pass_hash )
+        memcpy( rec.PassHash, pass_hash, PASS_HASH_SIZE );
+
+    // Single write for header and data
+    RecordBuf.resize( sizeof(rec) + size );
+    memcpy( &RecordBuf[0], &rec, sizeof(rec) );
+    if( size )
+        memcpy( &RecordBuf[sizeof(rec)], data, size );
+
+    StoreSegment& seg = Segments.rbegin()->second;
+    if( !FileWrite( AppendFile, &RecordBuf[0], (uint)RecordBuf.size() ) )
+    {
+        WriteLogF( _FUNC_, " - Can't write client store record, client<%s>.\n", name );
+        FileClose( AppendFile );
+        AppendFile = NULL;
+        return false;
+    }
+
+    if( ref )
+    {
+        Str::Copy( ref->Entry.Name, name );
+        memcpy( ref->Entry.PassHash, rec.PassHash, PASS_HASH_SIZE );
+        ref->Entry.Id = id;
+        ref->Segment = Segments.rbegin()->first;
+        ref->Offset = seg.Size;
+        ref->Size = size;
+    }
+    seg.Size += (uint)RecordBuf.size();
+    return true;
+}
+
+static bool ReadRecord( const StoreRef& ref, UCharVec& data )
+{
+    auto it = Segments.find( ref.Segment );
+    if( it == Segments.end() )
+        return false;
+
+    StoreRecord rec;
+    void*       f = it->second.Read;
+    if( !FileSetPointer( f, ref.Offset, SEEK_SET ) || !FileRead( f, &rec, sizeof(rec) ) ||
+        rec.Magic != CLIENT_STORE_RECORD_MAGIC || rec.Size != ref.Size )
+        return false;
+
+    data.resize( rec.Size );
+    if( rec.Size && !FileRead( f, &data[0], rec.Size ) )
+        return false;
+    return rec.Crc == (rec.Size ? Crypt.Crc32( &data[0], rec.Size ) : 0);
+}
+
+// Reads record headers only, data is checked on load
+static bool ScanSegment( uint number, bool& clean )
+{
+    char  fname[MAX_FOPATH];
+    SegmentName( fname, number );
+    void* f = FileOpenForSharedRead( fname );
+    if( !f )
+    {
+        WriteLogF( _FUNC_, " - Can't open client store file<%s>.\n", fname );
+        return false;
+    }
+
+    uchar signature[sizeof(ClientStoreSignature)];
+    if( !FileRead( f, signature, sizeof(signature) ) || !BINARY_SIGNATURE_VALID( signature, ClientStoreSignature ) ||
+        BINARY_SIGNATURE_VERSION( signature ) > CLIENT_STORE_LAST )
+    {
+        WriteLogF( _FUNC_, " - Invalid signature of client store file<%s>.\n", fname );
+        FileClose( f );
+        return false;
+    }
+
+    StoreSegment& seg = Segments[number];
+    seg.Read = f;
+    seg.Size = sizeof(signature);
+    seg.Waste = 0;
+
+    uint file_size = FileGetSize( f );
+    clean = true;
+    while( seg.Size < file_size )
+    {
+        StoreRecord rec;
+        if( file_size - seg.Size < sizeof(rec) || !FileRead( f, &rec, sizeof(rec) ) || rec.Magic != CLIENT_STORE_RECORD_MAGIC ||
+            rec.Size > file_size - seg.Size - sizeof(rec) || (rec.Type != CLIENT_STORE_SAVE && rec.Type != CLIENT_STORE_DELETE) )
+        {
+            // Torn write, segment is not used for appending anymore
+            WriteLogF( _FUNC_, " - Client store file<%s> truncated at offset<%u>, size<%u>.\n", fname, seg.Size, file_size );
+            clean = false;
+            break;
+        }
+        rec.Name[sizeof(rec.Name) - 1] = 0;
+
+        if( rec.Type == CLIENT_STORE_SAVE )
+            IndexSave( rec, number, seg.Size );
+        else
+            IndexDelete( MakeKey( rec.Name ), number );
+
+        seg.Size += sizeof(rec) + rec.Size;
+        if( rec.Size && !FileSetPointer( f, seg.Size, SEEK_SET ) )
+        {
+            clean = false;
+            break;
+        }
+    }
+    return true;
+}
+
+// Moves live records of segments with many stale ones to the tail
+static void CompactSegments()
+{
+    if( Segments.empty() )
+        return;
+
+    // Last segment is still appended
+    UIntVec numbers;
+    uint    last = Segments.rbegin()->first;
+    for( auto it = Segments.begin(), end = Segments.end(); it != end; ++it )
+        if( it->first != last && it->second.Waste * 2 >= it->second.Size - sizeof(ClientStoreSignature) )
+            numbers.push_back( it->first );
+
+    UCharVec data;
+    for( auto it = numbers.begin(), end = numbers.end(); it != end; ++it )
+    {
+        uint number = *it;
+        bool ok = true;
+
+        for( auto it_ref = NameIndex.begin(), end_ref = NameIndex.end(); it_ref != end_ref && ok; ++it_ref )
+        {
+            StoreRef& ref = it_ref->second;
+            if( ref.Segment != number )
+                continue;
+
+            StoreRef new_ref;
+            ok = ReadRecord( ref, data ) &&
+                 AppendRecord( CLIENT_STORE_SAVE, ref.Entry.Name, ref.Entry.Id, ref.Entry.PassHash, data.empty() ? NULL : &data[0], (uint)data.size(), &new_ref );
+            if( ok )
+            {
+                WasteRecord( ref.Segment, ref.Size );
+                ref = new_ref;
+                Stats.Compacted++;
+            }
+        }
+
+        // Deletes must outlive older saves of same name
+        bool first = (Segments.begin()->first == number);
+        for( auto it_del = Tombstones.begin(); it_del != Tombstones.end() && ok;)
+        {
+            if( it_del->second != number )
+            {
+                ++it_del;
+                continue;
+            }
+            if( first )
+            {
+                it_del = Tombstones.erase( it_del );
+                continue;
+            }
+            ok = AppendRecord( CLIENT_STORE_DELETE, it_del->first.c_str(), 0, NULL, NULL, 0, NULL );
+            if( ok )
+            {
+                it_del->second = Segments.rbegin()->first;
+                WasteRecord( it_del->second, 0 );
+                Stats.Compacted++;
+            }
+            ++it_del;
+        }
+
+        if( !ok )
+        {
+            WriteLogF( _FUNC_, " - Compaction of client store segment<%u> failed.\n", number );
+            break;
+        }
+
+        char fname[MAX_FOPATH];
+        FileClose( Segments[number].Read );
+        Segments.erase( number );
+        FileDelete( SegmentName( fname, number ) );
+    }
+}
+
+static void CloseStore()
+{
+    for( auto it = Segments.begin(), end = Segments.end(); it != end; ++it )
+        FileClose( it->second.Read );
+    Segments.clear();
+    FileClose( AppendFile );
+    AppendFile = NULL;
+    NameIndex.clear();
+    IdIndex.clear();
+    Tombstones.clear();
+    Opened = false;
+}
+
+static void FindSegments( const char* path, UIntVec& numbers )
+{
+    FIND_DATA fd;
+    void*     h = FileFindFirst( path, "foa", fd );
+    if( !h )
+        return;
+
+    do
+    {
+        uint number;
+        if( sscanf( fd.FileName, "accounts%u.foa", &number ) == 1 )
+            numbers.push_back( number );
+    }
+    while( FileFindNext( h, fd ) );
+    FileFindClose( h );
+
+    std::sort( numbers.begin(), numbers.end() );
+}
+
+bool ClientStore::Exists( const char* path )
+{
+    UIntVec numbers;
+    FindSegments( path, numbers );
+    return !numbers.empty();
+}
+
+bool ClientStore::Open( const char* path )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    double tick = Timer::AccurateTick();
+
+    CloseStore();
+    StorePath = path;
+    Stats.Compacted = 0;
+
+    UIntVec numbers;
+    FindSegments( path, numbers );
+
+    bool clean = true;
+    for( auto it = numbers.begin(), end = numbers.end(); it != end; ++it )
+    {
+        if( !ScanSegment( *it, clean ) )
+        {
+            CloseStore();
+            return false;
+        }
+    }
+
+    // Continue last segment
+    if( !Segments.empty() && clean && Segments.rbegin()->second.Size < CLIENT_STORE_SEGMENT_SIZE )
+    {
+        char fname[MAX_FOPATH];
+        AppendFile = FileOpenForAppend( SegmentName( fname, Segments.rbegin()->first ), true );
+    }
+
+    CompactSegments();
+
+    if( !AppendFile && !OpenSegment( Segments.empty() ? 0 : Segments.rbegin()->first + 1 ) )
+    {
+        CloseStore();
+        return false;
+    }
+
+    Opened = true;
+    Stats.OpenTime = (uint)(Timer::AccurateTick() - tick);
+    return true;
+}
+
+void ClientStore::Close()
+{
+    SCOPE_LOCK( StoreLocker );
+
+    CloseStore();
+}
+
+bool ClientStore::IsOpened()
+{
+    return Opened;
+}
+
+void ClientStore::Retire( const char* path )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    CloseStore();
+    StorePath = path;
+
+    UIntVec numbers;
+    FindSegments( path, numbers );
+
+    for( auto it = numbers.begin(), end = numbers.end(); it != end; ++it )
+    {
+        char fname[MAX_FOPATH];
+        char new_fname[MAX_FOPATH];
+        SegmentName( fname, *it );
+        Str::Format( new_fname, "%s_exported", fname );
+        if( !FileRename( fname, new_fname ) )
+            WriteLogF( _FUNC_, " - Fail to rename from<%s> to<%s>.\n", fname, new_fname );
+    }
+}
+
+bool ClientStore::Save( const char* name, uint id, const char* pass_hash, const UCharVec& data )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    if( !Opened )
+        return false;
+
+    string key = MakeKey( name );
+    auto   it_id = IdIndex.find( id );
+    if( it_id != IdIndex.end() && it_id->second != key )
+    {
+        WriteLogF( _FUNC_, " - Id<%u> of client<%s> already used by client<%s>.\n", id, name, it_id->second.c_str() );
+        return false;
+    }
+
+    StoreRef ref;
+    if( !AppendRecord( CLIENT_STORE_SAVE, name, id, pass_hash, data.empty() ? NULL : &data[0], (uint)data.size(), &ref ) )
+        return false;
+
+    auto it = NameIndex.find( key );
+    if( it != NameIndex.end() )
+    {
+        WasteRecord( it->second.Segment, it->second.Size );
+        IdIndex.erase( it->second.Entry.Id );
+    }
+    Tombstones.erase( key );
+    NameIndex[key] = ref;
+    IdIndex[id] = key;
+    Stats.Saves++;
+    return true;
+}
+
+bool ClientStore::Load( const char* name, UCharVec& data )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    auto it = NameIndex.find( MakeKey( name ) );
+    if( it == NameIndex.end() )
+        return false;
+
+    if( !ReadRecord( it->second, data ) )
+    {
+        WriteLogF( _FUNC_, " - Client<%s> record in segment<%u> at offset<%u> is corrupted.\n", name, it->second.Segment, it->second.Offset );
+        return false;
+    }
+    Stats.Loads++;
+    return true;
+}
+
+bool ClientStore::Delete( const char* name )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    string key = MakeKey( name );
+    if( !NameIndex.count( key ) )
+        return false;
+
+    if( !AppendRecord( CLIENT_STORE_DELETE, key.c_str(), 0, NULL, NULL, 0, NULL ) )
+        return false;
+
+    IndexDelete( key, Segments.rbegin()->first );
+    Stats.Deletes++;
+    return true;
+}
+
+void ClientStore::GetEntries( ClientStoreEntryVec& entries )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    entries.reserve( entries.size() + NameIndex.size() );
+    for( auto it = NameIndex.begin(), end = NameIndex.end(); it != end; ++it )
+        entries.push_back( it->second.Entry );
+}
+
+uint ClientStore::Export( const char* path )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    uint     count = 0;
+    UCharVec data;
+    for( auto it = NameIndex.begin(), end = NameIndex.end(); it != end; ++it )
+    {
+        StoreRef& ref = it->second;
+        char      fname[MAX_FOPATH];
+        Str::Format( fname, "%s%s.client", path, ref.Entry.Name );
+
+        if( !ReadRecord( ref, data ) )
+        {
+            WriteLogF( _FUNC_, " - Client<%s> record is corrupted, not exported.\n", ref.Entry.Name );
+            continue;
+        }
+
+        void* f = FileOpen( fname, true );
+        if( !f )
+        {
+            WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
+            continue;
+        }
+        if( data.empty() || FileWrite( f, &data[0], (uint)data.size() ) )
+            count++;
+        FileClose( f );
+    }
+    return count;
+}
+
+void ClientStore::GetStatistics( ClientStoreStatistics& stats )
+{
+    SCOPE_LOCK( StoreLocker );
+
+    Stats.Clients = (uint)NameIndex.size();
+    Stats.Segments = (uint)Segments.size();
+    Stats.FileSize = 0;
+    Stats.WasteSize = 0;
+    for( auto it = Segments.begin(), end = Segments.end(); it != end; ++it )
+    {
+        Stats.FileSize += it->second.Size;
+        Stats.WasteSize += it->second.Waste;
+    }
+    stats = Stats;
+}
+
+string ClientStore::GetStatisticsString()
+{
+    if( !IsOpened() )
+        return "Client store: disabled\n";
+
+    ClientStoreStatistics stats;
+    GetStatistics( stats );
+
+    char str[MAX_FOTEXT];
+    return Str::Format( str, "Client store: clients %u, segments %u, size %llu, waste %llu; saves %u, loads %u, deletes %u; open %u ms, compacted records %u\n",
+                        stats.Clients, stats.Segments, stats.FileSize, stats.WasteSize, stats.Saves, stats.Loads, stats.Deletes, stats.OpenTime, stats.Compacted );
+}
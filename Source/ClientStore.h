@@ -0,0 +1,57 @@
+#ifndef __CLIENT_STORE__
+#define __CLIENT_STORE__
+
+#include "Defines.h"
+#include "Types.h"
+
+// Store records
+#define CLIENT_STORE_SAVE            (1)
+#define CLIENT_STORE_DELETE          (2)
+
+// Segment file is closed for appending after reaching this size, offsets must fit into signed 32 bit
+#define CLIENT_STORE_SEGMENT_SIZE    (0x10000000) // 256mb
+
+struct ClientStoreEntry
+{
+    char Name[UTF8_BUF_SIZE( MAX_NAME )];
+    char PassHash[PASS_HASH_SIZE];
+    uint Id;
+};
+typedef vector<ClientStoreEntry> ClientStoreEntryVec;
+
+struct ClientStoreStatistics
+{
+    uint   Clients;
+    uint   Segments;
+    uint64 FileSize;
+    uint64 WasteSize;
+    uint   Saves;
+    uint   Loads;
+    uint   Deletes;
+    uint   Compacted;    // Records moved by compaction
+    uint   OpenTime;
+};
+
+// Accounts of all clients in append-only segment files, clients/accountsXXXX.foa
+// Record data is client save in .client file layout, store itself don't parse it
+// Index by name and id is rebuilt from record headers on open, segments with many stale records are compacted on open
+class ClientStore
+{
+public:
+    static bool Exists( const char* path );
+    static bool Open( const char* path );
+    static void Close();
+    static bool IsOpened();
+    static void Retire( const char* path ); // Renames segments to accountsXXXX.foa_exported
+
+    static bool Save( const char* name, uint id, const char* pass_hash, const UCharVec& data );
+    static bool Load( const char* name, UCharVec& data );
+    static bool Delete( const char* name );
+    static void GetEntries( ClientStoreEntryVec& entries );
+    static uint Export( const char* path );
+
+    static void   GetStatistics( ClientStoreStatistics& stats );
+    static string GetStatisticsString();
+};
+
+#endif // __CLIENT_STORE__
@@ -228,6 +228,7 @@ void GetClientOptions()
     GameOpt.CombatMessagesType = GetInt( SECTION_CLIENT, "CombatMessagesType", 0, 1, 0 );
     GameOpt.Animation3dFPS = GetInt( SECTION_CLIENT, "Animation3dFPS", 0, 1000, 10 );
     GameOpt.Animation3dSmoothTime = GetInt( SECTION_CLIENT, "Animation3dSmoothTime", 0, 10000, 250 );
+    DataFile::SetCacheSize( GetInt( SECTION_CLIENT, "DataFileCacheSize", 0, 1024, 0 ) * 0x100000 ); // Megabytes
 
     GameOpt.HelpInfo = CommandLine->IsOption( "HelpInfo" );
     GameOpt.DebugInfo = CommandLine->IsOption( "DebugInfo" );
@@ -272,6 +273,13 @@ int  ServerGameSleep = 10;
 uint VarsGarbageTime = 3600000;
 bool WorldSaveManager = true;
 bool LogicMT = false;
+bool DeadlineScheduler = false;
+bool WorldSaveFork = false;
+bool VisibilityGrid = false;
+int  PathFinder = 0;
+uint PathCacheTime = 0;
+bool ClientStoreEnabled = false;
+bool LatencyProfiler = false;
 #endif
 
 #if defined (FOCLASSIC_SERVER) || defined (FOCLASSIC_MAPPER)
@@ -288,7 +296,18 @@ void GetServerOptions()
     # if defined (FOCLASSIC_SERVER)
     ServerGameSleep = ConfigFile->GetInt( SECTION_SERVER, "GameSleep", 10 );
     Script::SetConcurrentExecution( ConfigFile->GetBool( SECTION_SERVER, "ScriptConcurrentExecution", false ) );
+    Script::SetThreadSafeModules( ConfigFile->GetStr( SECTION_SERVER, "ScriptThreadSafeModules", "" ).c_str() );
+    Script::SetJitCompiler( ConfigFile->GetStr( SECTION_SERVER, "ScriptJit", "" ).c_str() );
+    Script::SetAotCompiler( ConfigFile->GetBool( SECTION_SERVER, "ScriptAot", false ) );
     WorldSaveManager = ConfigFile->GetInt( SECTION_SERVER, "WorldSaveManager", 1 ) == 1;
+    DeadlineScheduler = ConfigFile->GetBool( SECTION_SERVER, "DeadlineScheduler", false );
+    WorldSaveFork = ConfigFile->GetBool( SECTION_SERVER, "WorldSaveFork", false );
+    VisibilityGrid = ConfigFile->GetBool( SECTION_SERVER, "VisibilityGrid", false );
+    PathFinder = ConfigFile->GetInt( SECTION_SERVER, "PathFinder", 0 );
+    PathCacheTime = ConfigFile->GetInt( SECTION_SERVER, "PathCacheTime", 0 );
+    ClientStoreEnabled = ConfigFile->GetBool( SECTION_SERVER, "ClientStore", false );
+    LatencyProfiler = ConfigFile->GetBool( SECTION_SERVER, "LatencyProfiler", false );
+    DataFile::SetCacheSize( CLAMP( ConfigFile->GetInt( SECTION_SERVER, "DataFileCacheSize", 0 ), 0, 1024 ) * 0x100000 ); // Megabytes
     # endif
 }
 #endif
@@ -60,6 +60,13 @@ extern int  ServerGameSleep;
 extern uint VarsGarbageTime;
 extern bool WorldSaveManager;
 extern bool LogicMT;
+extern bool DeadlineScheduler;
+extern bool WorldSaveFork;
+extern bool VisibilityGrid;
+extern int  PathFinder;
+extern uint PathCacheTime;
+extern bool ClientStoreEnabled;
+extern bool LatencyProfiler;
 #endif
 
 #if defined (FOCLASSIC_SERVER) || defined (FOCLASSIC_MAPPER)
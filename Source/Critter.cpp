@@ -6,6 +6,7 @@
 #include "CritterType.h"
 #include "Exception.h"
 #include "ItemManager.h"
+#include "Jobs.h"
 #include "Log.h"
 #include "MapManager.h"
 #include "MsgStr.h"
@@ -16,6 +17,7 @@
 #include "ThreadSync.h"
 #include "Text.h"
 #include "Timer.h"
+#include "Tracer.h"
 #include "Utils.h"
 #include "Vars.h"
 
@@ -79,6 +81,10 @@ bool      Critter::ParamsSendEnabled[MAX_PARAMS] = { 0 };
 int       Critter::ParamsSendScript[MAX_PARAMS] = { 0 };
 int       Critter::ParamsChangeScript[MAX_PARAMS] = { 0 };
 int       Critter::ParamsGetScript[MAX_PARAMS] = { 0 };
+UIntVec   Critter::ParamsGetDepends[MAX_PARAMS];
+int       Critter::ParamsGetCacheOffset[MAX_PARAMS] = { 0 }; // Set to -1 in ResetParamsGetCache
+uint      Critter::ParamsGetCacheSize = 0;
+uint      Critter::ParamsGetCacheGeneration = 1;
 int       Critter::ParamsDialogGetScript[MAX_PARAMS] = { 0 };
 bool      Critter::SlotDataSendEnabled[0x100] = { 0 };
 int       Critter::SlotDataSendScript[0x100] = { 0 };
@@ -94,13 +100,14 @@ Critter::Critter() : CritterIsNpc( false ), RefCounter( 1 ), IsNotValid( false )
     GroupMove( NULL ), PrevHexTick( 0 ), PrevHexX( 0 ), PrevHexY( 0 ),
     startBreakTime( 0 ), breakTime( 0 ), waitEndTick( 0 ), KnockoutAp( 0 ), CacheValuesNextTick( 0 ), IntellectCacheValue( 0 ),
     Flags( 0 ), AccessContainerId( 0 ), ItemTransferCount( 0 ),
-    TryingGoHomeTick( 0 ), ApRegenerationTick( 0 ), GlobalIdleNextTick( 0 ), LockMapTransfers( 0 ),
-    ViewMapId( 0 ), ViewMapPid( 0 ), ViewMapLook( 0 ), ViewMapHx( 0 ), ViewMapHy( 0 ), ViewMapDir( 0 ),
-    DisableSend( 0 ), CanBeRemoved( false )
+    TryingGoHomeTick( 0 ), ApRegenerationTick( 0 ), GlobalIdleNextTick( 0 ), LockMapTransfers( 0 ), ParamsGetCacheGen( 0 ), ParamsSlot( uint( -1 ) ), JournalGen( 0 ),
+    MapGridId( 0 ), MapGridCell( -1 ), ViewMapId( 0 ), ViewMapPid( 0 ), ViewMapLook( 0 ), ViewMapHx( 0 ), ViewMapHy( 0 ), ViewMapDir( 0 ),
+    DisableSend( 0 ), JobDelayTick( 0 ), CanBeRemoved( false )
 {
     memzero( &Data, sizeof(Data) );
     DataExt = NULL;
     memzero( FuncId, sizeof(FuncId) );
+    Sync.SetType( SYNC_OBJECT_CRITTER );
     GroupSelf = new GlobalMapGroup();
     GroupSelf->CurX = (float)Data.WorldX;
     GroupSelf->CurY = (float)Data.WorldY;
@@ -161,6 +168,7 @@ void Critter::SetBreakTime( uint ms )
     breakTime = ms;
     startBreakTime = Timer::GameTick();
     ApRegenerationTick = 0;
+    WakeUp();
 }
 
 void Critter::SetBreakTimeDelta( uint ms )
@@ -178,6 +186,7 @@ void Critter::SetBreakTimeDelta( uint ms )
 void Critter::SetWait( uint ms )
 {
     waitEndTick = Timer::GameTick() + ms;
+    WakeUp();
 }
 
 bool Critter::IsWait()
@@ -185,6 +194,13 @@ bool Critter::IsWait()
     return Timer::GameTick() < waitEndTick;
 }
 
+void Critter::WakeUp()
+{
+    // Wakeup during processing is remembered until job pushed back
+    if( DeadlineScheduler && JobDelayTick != JOB_DELAY_WAKEUP )
+        Job::WakeUp( Job( JOB_CRITTER, this, false ), JobDelayTick );
+}
+
 void Critter::FullClear()
 {
     IsNotValid = true;
@@ -252,6 +268,7 @@ bool Critter::CheckFind( int find_type )
 
 void Critter::SetLexems( const char* lexems )
 {
+    SetJournalDirty();
     if( lexems )
     {
         uint len = Str::Length( lexems );
@@ -344,6 +361,8 @@ void Critter::SyncLockCritters( bool self_critters, bool only_players )
 
 void Critter::ProcessVisibleCritters()
 {
+    TRACE_SCOPE( TRACE_VISIBLE_CRITTERS );
+
     if( IsNotValid )
         return;
 
@@ -398,8 +417,27 @@ void Critter::ProcessVisibleCritters()
     if( !map )
         return;
 
-    CrVec critters;
-    map->GetCritters( critters, true );
+    double process_tick = Timer::AccurateTick();
+    bool   use_grid = (VisibilityGrid && !FLAG( GameOpt.LookChecks, LOOK_CHECK_SCRIPT ) );
+    uint   radius_max = 0;
+    CrVec  critters;
+    if( use_grid )
+    {
+        // Nobody sees further than highest look or show distance on map
+        uint radius = look_base_self;
+        if( show_cr1 )
+            radius = MAX( radius, Data.ShowCritterDist1 );
+        if( show_cr2 )
+            radius = MAX( radius, Data.ShowCritterDist2 );
+        if( show_cr3 )
+            radius = MAX( radius, Data.ShowCritterDist3 );
+        map->SetCritterHex( this );
+        CollectVisibleCritters( map, map->GetVisibleRadius( radius ), critters );
+    }
+    else
+    {
+        map->GetCritters( critters, true );
+    }
 
     for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
     {
@@ -552,6 +590,17 @@ void Critter::ProcessVisibleCritters()
         int look_self = look_base_self;
         int look_opp = cr->GetLook();
 
+        if( use_grid )
+        {
+            radius_max = MAX( radius_max, (uint)look_opp );
+            if( (cr->FuncId[CRITTER_EVENT_SHOW_CRITTER_1] > 0 || cr->FuncId[CRITTER_EVENT_HIDE_CRITTER_1] > 0) )
+                radius_max = MAX( radius_max, cr->Data.ShowCritterDist1 );
+            if( (cr->FuncId[CRITTER_EVENT_SHOW_CRITTER_2] > 0 || cr->FuncId[CRITTER_EVENT_HIDE_CRITTER_2] > 0) )
+                radius_max = MAX( radius_max, cr->Data.ShowCritterDist2 );
+            if( (cr->FuncId[CRITTER_EVENT_SHOW_CRITTER_3] > 0 || cr->FuncId[CRITTER_EVENT_HIDE_CRITTER_3] > 0) )
+                radius_max = MAX( radius_max, cr->Data.ShowCritterDist3 );
+        }
+
         // Dir modifier
         if( FLAG( GameOpt.LookChecks, LOOK_CHECK_DIR ) )
         {
@@ -752,10 +801,76 @@ void Critter::ProcessVisibleCritters()
             }
         }
     }
+
+    if( use_grid )
+        map->GetVisibleRadius( radius_max );
+    AddVisibilityStatistics( false, map->GetCrittersCount(), (uint)critters.size(), Timer::AccurateTick() - process_tick );
+}
+
+void Critter::CollectVisibleCritters( Map* map, uint radius, CrVec& critters )
+{
+    map->GetCrittersNear( GetHexX(), GetHexY(), radius, critters, true );
+
+    // Critters out of radius are processed only if they must be hidden
+    uint near_count = (uint)critters.size();
+    critters.insert( critters.end(), VisCr.begin(), VisCr.end() );
+    critters.insert( critters.end(), VisCrSelf.begin(), VisCrSelf.end() );
+    UIntVec vis_ids;
+    VisCr1.GetIds( vis_ids );
+    VisCr2.GetIds( vis_ids );
+    VisCr3.GetIds( vis_ids );
+    for( auto it = vis_ids.begin(), end = vis_ids.end(); it != end; ++it )
+    {
+        Critter* cr = CrMngr.GetCritter( *it, false );
+        if( cr )
+            critters.push_back( cr );
+    }
+
+    if( critters.size() > near_count )
+    {
+        if( LogicMT )
+            for( auto it = critters.begin() + near_count, end = critters.end(); it != end; ++it )
+                SYNC_LOCK( *it );
+
+        std::sort( critters.begin(), critters.end() );
+        critters.erase( std::unique( critters.begin(), critters.end() ), critters.end() );
+
+        uint map_id = map->GetId();
+        uint count = 0;
+        for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
+            if( (*it)->GetMap() == map_id )
+                critters[count++] = *it;
+        critters.resize( count );
+    }
+}
+
+void Critter::CollectVisibleItems( Map* map, int look, ItemPtrVec& items )
+{
+    map->GetItemsNear( GetHexX(), GetHexY(), look, items );
+    map->GetViewItems( items );
+
+    // Items out of look are processed only if they must be hidden
+    UIntVec vis_items;
+    VisItemLocker.Lock();
+    VisItem.GetIds( vis_items );
+    VisItemLocker.Unlock();
+
+    uint map_id = map->GetId();
+    for( auto it = vis_items.begin(), end = vis_items.end(); it != end; ++it )
+    {
+        Item* item = ItemMngr.GetItem( *it, false );
+        if( item && item->Accessory == ITEM_ACCESSORY_HEX && item->AccHex.MapId == map_id )
+            items.push_back( item );
+    }
+
+    std::sort( items.begin(), items.end() );
+    items.erase( std::unique( items.begin(), items.end() ), items.end() );
 }
 
 void Critter::ProcessVisibleItems()
 {
+    TRACE_SCOPE( TRACE_VISIBLE_ITEMS );
+
     if( IsNotValid )
         return;
 
@@ -763,8 +878,14 @@ void Critter::ProcessVisibleItems()
     if( !map )
         return;
 
+    double     process_tick = Timer::AccurateTick();
     int        look = GetLook();
-    ItemPtrVec items = map->GetItemsNoLock();
+    ItemPtrVec items;
+    if( VisibilityGrid )
+        CollectVisibleItems( map, look, items );
+    else
+        items = map->GetItemsNoLock();
+
     for( auto it = items.begin(), end = items.end(); it != end; ++it )
     {
         Item* item = *it;
@@ -819,6 +940,8 @@ void Critter::ProcessVisibleItems()
             }
         }
     }
+
+    AddVisibilityStatistics( true, (uint)map->GetItemsNoLock().size(), (uint)items.size(), Timer::AccurateTick() - process_tick );
 }
 
 void Critter::ViewMap( Map* map, int look, ushort hx, ushort hy, int dir )
@@ -951,6 +1074,31 @@ void Critter::ViewMap( Map* map, int look, ushort hx, ushort hy, int dir )
     }
 }
 
+// Vector and index of positions in it, removed element is replaced by last one
+static void AddVisIndex( CrVec& vec, IdMap<uint>& index, Critter* cr )
+{
+    index.Insert( cr->GetId(), (uint)vec.size() );
+    vec.push_back( cr );
+}
+
+static bool DelVisIndex( CrVec& vec, IdMap<uint>& index, uint crid )
+{
+    uint* pos_ptr = index.Find( crid );
+    if( !pos_ptr )
+        return false;
+
+    uint pos = *pos_ptr;
+    index.Erase( crid );
+    Critter* last = vec.back();
+    vec.pop_back();
+    if( pos < (uint)vec.size() )
+    {
+        vec[pos] = last;
+        *index.Find( last->GetId() ) = pos;
+    }
+    return true;
+}
+
 void Critter::ClearVisible()
 {
     SyncLockCritters( false, false );
@@ -959,36 +1107,26 @@ void Critter::ClearVisible()
     for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
     {
         Critter* cr = *it;
-        auto     it_ = std::find( cr->VisCrSelf.begin(), cr->VisCrSelf.end(), this );
-        if( it_ != cr->VisCrSelf.end() )
-        {
-            cr->VisCrSelf.erase( it_ );
-            cr->VisCrSelfMap.erase( this->GetId() );
-        }
+        DelVisIndex( cr->VisCrSelf, cr->VisCrSelfMap, this->GetId() );
         cr->Send_RemoveCritter( this );
     }
     VisCr.clear();
-    VisCrMap.clear();
+    VisCrMap.Clear();
 
     for( auto it = VisCrSelf.begin(), end = VisCrSelf.end(); it != end; ++it )
     {
         Critter* cr = *it;
-        auto     it_ = std::find( cr->VisCr.begin(), cr->VisCr.end(), this );
-        if( it_ != cr->VisCr.end() )
-        {
-            cr->VisCr.erase( it_ );
-            cr->VisCrMap.erase( this->GetId() );
-        }
+        DelVisIndex( cr->VisCr, cr->VisCrMap, this->GetId() );
     }
     VisCrSelf.clear();
-    VisCrSelfMap.clear();
+    VisCrSelfMap.Clear();
 
-    VisCr1.clear();
-    VisCr2.clear();
-    VisCr3.clear();
+    VisCr1.Clear();
+    VisCr2.Clear();
+    VisCr3.Clear();
 
     VisItemLocker.Lock();
-    VisItem.clear();
+    VisItem.Clear();
     VisItemLocker.Unlock();
 }
 
@@ -996,9 +1134,9 @@ Critter* Critter::GetCritSelf( uint crid, bool sync_lock )
 {
     Critter* cr = NULL;
 
-    auto     it = VisCrSelfMap.find( crid );
-    if( it != VisCrSelfMap.end() )
-        cr = (*it).second;
+    uint*    pos = VisCrSelfMap.Find( crid );
+    if( pos )
+        cr = VisCrSelf[*pos];
 
     if( cr && sync_lock )
     {
@@ -1006,8 +1144,7 @@ Critter* Critter::GetCritSelf( uint crid, bool sync_lock )
         SYNC_LOCK( cr );
 
         // Recheck
-        it = VisCrSelfMap.find( crid );
-        if( it == VisCrSelfMap.end() )
+        if( !VisCrSelfMap.Count( crid ) )
             return GetCritSelf( crid, sync_lock );
     }
 
@@ -1056,69 +1193,57 @@ void Critter::GetCrFromVisCr( CrVec& critters, int find_type, bool vis_cr_self,
 
 bool Critter::AddCrIntoVisVec( Critter* add_cr )
 {
-    if( VisCrMap.count( add_cr->GetId() ) )
+    if( VisCrMap.Count( add_cr->GetId() ) )
         return false;
 
-    VisCr.push_back( add_cr );
-    VisCrMap.insert( PAIR( add_cr->GetId(), add_cr ) );
-
-    add_cr->VisCrSelf.push_back( this );
-    add_cr->VisCrSelfMap.insert( PAIR( this->GetId(), this ) );
+    AddVisIndex( VisCr, VisCrMap, add_cr );
+    AddVisIndex( add_cr->VisCrSelf, add_cr->VisCrSelfMap, this );
     return true;
 }
 
 bool Critter::DelCrFromVisVec( Critter* del_cr )
 {
-    auto it_map = VisCrMap.find( del_cr->GetId() );
-    if( it_map == VisCrMap.end() )
+    if( !DelVisIndex( VisCr, VisCrMap, del_cr->GetId() ) )
         return false;
 
-    VisCrMap.erase( it_map );
-    VisCr.erase( std::find( VisCr.begin(), VisCr.end(), del_cr ) );
-
-    auto it = std::find( del_cr->VisCrSelf.begin(), del_cr->VisCrSelf.end(), this );
-    if( it != del_cr->VisCrSelf.end() )
-    {
-        del_cr->VisCrSelf.erase( it );
-        del_cr->VisCrSelfMap.erase( this->GetId() );
-    }
+    DelVisIndex( del_cr->VisCrSelf, del_cr->VisCrSelfMap, this->GetId() );
     return true;
 }
 
 bool Critter::AddCrIntoVisSet1( uint crid )
 {
-    return VisCr1.insert( crid ).second;
+    return VisCr1.Insert( crid );
 }
 
 bool Critter::AddCrIntoVisSet2( uint crid )
 {
-    return VisCr2.insert( crid ).second;
+    return VisCr2.Insert( crid );
 }
 
 bool Critter::AddCrIntoVisSet3( uint crid )
 {
-    return VisCr3.insert( crid ).second;
+    return VisCr3.Insert( crid );
 }
 
 bool Critter::DelCrFromVisSet1( uint crid )
 {
-    return VisCr1.erase( crid ) != 0;
+    return VisCr1.Erase( crid );
 }
 
 bool Critter::DelCrFromVisSet2( uint crid )
 {
-    return VisCr2.erase( crid ) != 0;
+    return VisCr2.Erase( crid );
 }
 
 bool Critter::DelCrFromVisSet3( uint crid )
 {
-    return VisCr3.erase( crid ) != 0;
+    return VisCr3.Erase( crid );
 }
 
 bool Critter::AddIdVisItem( uint item_id )
 {
     VisItemLocker.Lock();
-    bool result = VisItem.insert( item_id ).second;
+    bool result = VisItem.Insert( item_id );
     VisItemLocker.Unlock();
     return result;
 }
@@ -1126,7 +1251,7 @@ bool Critter::AddIdVisItem( uint item_id )
 bool Critter::DelIdVisItem( uint item_id )
 {
     VisItemLocker.Lock();
-    bool result = VisItem.erase( item_id ) != 0;
+    bool result = VisItem.Erase( item_id );
     VisItemLocker.Unlock();
     return result;
 }
@@ -1134,7 +1259,7 @@ bool Critter::DelIdVisItem( uint item_id )
 bool Critter::CountIdVisItem( uint item_id )
 {
     VisItemLocker.Lock();
-    bool result = VisItem.count( item_id ) != 0;
+    bool result = VisItem.Count( item_id );
     VisItemLocker.Unlock();
     return result;
 }
@@ -1219,6 +1344,7 @@ void Critter::SetItem( Item* item )
         GroupMove->CarId = item->GetId();
     invItems.push_back( item );
     item->AccCritter.Id = GetId();
+    item->SetJournalDirty();
 
     if( item->Accessory != ITEM_ACCESSORY_CRITTER )
     {
@@ -1271,6 +1397,7 @@ void Critter::EraseItem( Item* item, bool send )
         invItems.erase( it );
     else
         WriteLogF( _FUNC_, " - Item not found, id<%u>, pid<%u>, critter<%s>.\n", item->GetId(), item->GetProtoId(), GetInfo() );
+    item->SetJournalDirty();
 
     if( !GetMap() && GroupMove && GroupMove->CarId == item->GetId() )
     {
@@ -1723,6 +1850,8 @@ void Critter::ToKnockout( uint anim2begin, uint anim2idle, uint anim2end, uint l
     Data.Anim2Knockout = anim2idle;
     Data.Anim2KnockoutEnd = anim2end;
     KnockoutAp = lost_ap;
+    SetJournalDirty();
+    WakeUp();
     Send_Knockout( this, anim2begin, anim2idle, knock_hx, knock_hy );
     SendA_Knockout( anim2begin, anim2idle, knock_hx, knock_hy );
 }
@@ -1752,6 +1881,7 @@ void Critter::TryUpOnKnockout()
 
     // Stand up
     Data.Cond = CRITTER_CONDITION_LIFE;
+    SetJournalDirty();
     SendAA_Action( CRITTER_ACTION_STANDUP, Data.Anim2KnockoutEnd, NULL );
     SetBreakTime( GameOpt.Breaktime );
 }
@@ -1764,6 +1894,7 @@ void Critter::ToDead( uint anim2, bool send_all )
         Data.Params[ST_CURRENT_HP] = 0;
     Data.Cond = CRITTER_CONDITION_DEAD;
     Data.Anim2Dead = anim2;
+    SetJournalDirty();
 
     Item* item = ItemSlotMain;
     if( item->GetId() )
@@ -1803,6 +1934,7 @@ bool Critter::ParseScript( const char* script, bool first_time )
             return false;
         }
         Data.ScriptId = func_num;
+        SetJournalDirty();
     }
 
     if( Data.ScriptId && Script::PrepareContext( Script::GetScriptFuncBindId( Data.ScriptId ), _FUNC_, GetInfo() ) )
@@ -2569,8 +2701,11 @@ void Critter::Send_AllParams()
 }
 void Critter::Send_Param( ushort num_param )
 {
+    SetJournalDirty();
     if( IsPlayer() )
         ( (Client*)this )->Send_Param( num_param );
+    else
+        CrMngr.UpdateParamsColumn( this, num_param );
 }
 void Critter::Send_ParamOther( ushort num_param, int val )
 {
@@ -2708,77 +2843,320 @@ void Critter::Send_CritterLexems( Critter* cr )
         ( (Client*)this )->Send_CritterLexems( cr );
 }
 
-void Critter::SendA_Move( uint move_params )
+/************************************************************************/
+/* Critter messages                                                     */
+/************************************************************************/
+
+// Writers shared by single client sending and broadcasts, Buf is BufferManager or BroadcastBuffer
+
+template<class Buf>
+static void MsgCritterMove( Buf& buf, Critter* from_cr, uint move_params )
 {
-    if( VisCr.empty() )
+    buf << NETMSG_CRITTER_MOVE;
+    buf << from_cr->GetId();
+    buf << move_params;
+    buf << from_cr->GetHexX();
+    buf << from_cr->GetHexY();
+}
+
+template<class Buf>
+static void MsgCritterDir( Buf& buf, Critter* from_cr )
+{
+    buf << NETMSG_CRITTER_DIR;
+    buf << from_cr->GetId();
+    buf << from_cr->GetDir();
+}
+
+template<class Buf>
+static void MsgCritterXY( Buf& buf, Critter* cr )
+{
+    buf << NETMSG_CRITTER_XY;
+    buf << cr->GetId();
+    buf << cr->GetHexX();
+    buf << cr->GetHexY();
+    buf << cr->GetDir();
+}
+
+template<class Buf>
+static void MsgSomeItem( Buf& buf, Item* item )
+{
+    buf << NETMSG_SOME_ITEM;
+    buf << item->GetId();
+    buf << item->GetProtoId();
+    buf << item->AccCritter.Slot;
+    buf.Push( (char*)&item->Data, Item::ItemData::SendMask[ITEM_DATA_MASK_CRITTER], sizeof(item->Data) );
+}
+
+template<class Buf>
+static void MsgCritterAction( Buf& buf, Critter* from_cr, int action, int action_ext, Item* item )
+{
+    buf << NETMSG_CRITTER_ACTION;
+    buf << from_cr->GetId();
+    buf << action;
+    buf << action_ext;
+    buf << (bool)(item ? true : false);
+}
+
+template<class Buf>
+static void MsgCritterKnockout( Buf& buf, Critter* from_cr, uint anim2begin, uint anim2idle, ushort knock_hx, ushort knock_hy )
+{
+    buf << NETMSG_CRITTER_KNOCKOUT;
+    buf << from_cr->GetId();
+    buf << anim2begin;
+    buf << anim2idle;
+    buf << knock_hx;
+    buf << knock_hy;
+}
+
+template<class Buf>
+static void MsgCritterItemData( Buf& buf, Critter* from_cr, uchar slot, Item* item, bool ext_data )
+{
+    buf << NETMSG_CRITTER_ITEM_DATA;
+    buf << from_cr->GetId();
+    buf << slot;
+    buf.Push( (char*)&item->Data, Item::ItemData::SendMask[ext_data ? ITEM_DATA_MASK_CRITTER_EXT : ITEM_DATA_MASK_CRITTER], sizeof(item->Data) );
+}
+
+template<class Buf>
+static void MsgCritterAnimate( Buf& buf, Critter* from_cr, uint anim1, uint anim2, Item* item, bool clear_sequence, bool delay_play )
+{
+    buf << NETMSG_CRITTER_ANIMATE;
+    buf << from_cr->GetId();
+    buf << anim1;
+    buf << anim2;
+    buf << (bool)(item ? true : false);
+    buf << clear_sequence;
+    buf << delay_play;
+}
+
+template<class Buf>
+static void MsgCritterSetAnims( Buf& buf, Critter* from_cr, int cond, uint anim1, uint anim2 )
+{
+    buf << NETMSG_CRITTER_SET_ANIMS;
+    buf << from_cr->GetId();
+    buf << cond;
+    buf << anim1;
+    buf << anim2;
+}
+
+template<class Buf>
+static void MsgCritterParam( Buf& buf, Critter* cr, ushort num_param, int val )
+{
+    buf << NETMSG_CRITTER_PARAM;
+    buf << cr->GetId();
+    buf << num_param;
+    buf << val;
+}
+
+template<class Buf>
+static void MsgCritterText( Buf& buf, uint from_id, const char* s_str, ushort str_len, uchar how_say, ushort intellect, bool unsafe_text )
+{
+    uint msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(from_id) + sizeof(how_say) +
+                   sizeof(intellect) + sizeof(unsafe_text) + sizeof(str_len) + str_len;
+
+    buf << NETMSG_CRITTER_TEXT;
+    buf << msg_len;
+    buf << from_id;
+    buf << how_say;
+    buf << intellect;
+    buf << unsafe_text;
+    buf << str_len;
+    buf.Push( s_str, str_len );
+}
+
+template<class Buf>
+static void MsgTextMsg( Buf& buf, uint from_id, uint num_str, uchar how_say, ushort num_msg )
+{
+    buf << NETMSG_MSG;
+    buf << from_id;
+    buf << how_say;
+    buf << num_msg;
+    buf << num_str;
+}
+
+// Falls back to simple message if lexems are empty or too long
+template<class Buf>
+static void MsgTextMsgLex( Buf& buf, uint from_id, uint num_str, uchar how_say, ushort num_msg, const char* lexems )
+{
+    ushort lex_len = Str::Length( lexems );
+    if( !lex_len || lex_len > MAX_DLG_LEXEMS_TEXT )
+    {
+        MsgTextMsg( buf, from_id, num_str, how_say, num_msg );
         return;
-    // SyncLockCritters(true);
+    }
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
+    uint msg_len = NETMSG_MSG_SIZE + sizeof(lex_len) + lex_len;
+
+    buf << NETMSG_MSG_LEX;
+    buf << msg_len;
+    buf << from_id;
+    buf << how_say;
+    buf << num_msg;
+    buf << num_str;
+    buf << lex_len;
+    buf.Push( lexems, lex_len );
+}
+
+static MutexSpinlock        VisibilityLocker;
+static VisibilityStatistics VisibilityStats;
+
+void Critter::AddVisibilityStatistics( bool items, uint on_map, uint checked, double time )
+{
+    SCOPE_LOCK( VisibilityLocker );
+
+    if( !items )
     {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Move( this, move_params );
+        VisibilityStats.CritterCalls++;
+        VisibilityStats.CrittersOnMap += on_map;
+        VisibilityStats.CrittersChecked += checked;
+        VisibilityStats.CritterTime += time;
+    }
+    else
+    {
+        VisibilityStats.ItemCalls++;
+        VisibilityStats.ItemsOnMap += on_map;
+        VisibilityStats.ItemsChecked += checked;
+        VisibilityStats.ItemTime += time;
     }
 }
 
-void Critter::SendA_XY()
+string Critter::GetVisibilityStatisticsString()
 {
-    if( VisCr.empty() )
+    VisibilityStatistics stats;
+    {
+        SCOPE_LOCK( VisibilityLocker );
+        stats = VisibilityStats;
+    }
+
+    char   str[MAX_FOTEXT];
+    string result = Str::Format( str, "Visibility processing, spatial index %s\n", VisibilityGrid ? "enabled" : "disabled" );
+    result += "Type     Calls       OnMap       Checked     Time,ms     Per call,us\n";
+    result += Str::Format( str, "%-8s %-11llu %-11llu %-11llu %-11.1f %-11.2f\n", "Critters", stats.CritterCalls, stats.CrittersOnMap, stats.CrittersChecked,
+                           stats.CritterTime, stats.CritterCalls ? stats.CritterTime * 1000.0 / (double)stats.CritterCalls : 0.0 );
+    result += Str::Format( str, "%-8s %-11llu %-11llu %-11llu %-11.1f %-11.2f\n", "Items", stats.ItemCalls, stats.ItemsOnMap, stats.ItemsChecked,
+                           stats.ItemTime, stats.ItemCalls ? stats.ItemTime * 1000.0 / (double)stats.ItemCalls : 0.0 );
+    return result;
+}
+
+static MutexSpinlock       BroadcastLocker;
+static BroadcastStatistics BroadcastStats;
+
+void Critter::AddBroadcastStatistics( const BroadcastBuffer& msg, uint sends )
+{
+    if( !sends )
         return;
-    // SyncLockCritters(true);
 
+    SCOPE_LOCK( BroadcastLocker );
+
+    BroadcastStats.Messages++;
+    BroadcastStats.Sends += sends;
+    BroadcastStats.SavedMessages += sends - 1;
+    BroadcastStats.SavedBytes += (uint64)(sends - 1) * msg.GetLen();
+}
+
+void Critter::GetBroadcastStatistics( BroadcastStatistics& stats )
+{
+    SCOPE_LOCK( BroadcastLocker );
+
+    stats = BroadcastStats;
+}
+
+string Critter::GetBroadcastStatisticsString()
+{
+    BroadcastStatistics stats;
+    GetBroadcastStatistics( stats );
+
+    char   str[MAX_FOTEXT];
+    string result = "Broadcast messages\n";
+    result += Str::Format( str, "Messages: %llu\n", stats.Messages );
+    result += Str::Format( str, "Sends: %llu\n", stats.Sends );
+    result += Str::Format( str, "Saved messages: %llu\n", stats.SavedMessages );
+    result += Str::Format( str, "Saved bytes: %llu\n", stats.SavedBytes );
+    return result;
+}
+
+bool Critter::IsVisPlayers()
+{
     for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_XY( this );
-    }
+        if( (*it)->IsPlayer() )
+            return true;
+    return false;
 }
 
-void Critter::SendA_Action( int action, int action_ext, Item* item )
+void Critter::SendA_Broadcast( const BroadcastBuffer& msg, bool self )
 {
-    if( VisCr.empty() )
+    if( msg.IsEmpty() )
         return;
-    // SyncLockCritters(true);
+
+    uint sends = 0;
+    if( self && IsPlayer() && ( (Client*)this )->Send_Broadcast( msg ) )
+        sends++;
 
     for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
     {
         Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Action( this, action, action_ext, item );
+        if( cr->IsPlayer() && ( (Client*)cr )->Send_Broadcast( msg ) )
+            sends++;
     }
+
+    AddBroadcastStatistics( msg, sends );
 }
 
-void Critter::SendAA_Action( int action, int action_ext, Item* item )
+void Critter::SendA_Move( uint move_params )
 {
-    if( IsPlayer() )
-        Send_Action( this, action, action_ext, item );
+    if( !IsVisPlayers() )
+        return;
 
-    if( VisCr.empty() )
+    BroadcastBuffer msg;
+    MsgCritterMove( msg, this, move_params );
+    SendA_Broadcast( msg, false );
+}
+
+void Critter::SendA_XY()
+{
+    if( !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Action( this, action, action_ext, item );
-    }
+    BroadcastBuffer msg;
+    MsgCritterXY( msg, this );
+    SendA_Broadcast( msg, false );
+}
+
+void Critter::SendA_Action( int action, int action_ext, Item* item )
+{
+    if( !IsVisPlayers() )
+        return;
+
+    BroadcastBuffer msg;
+    MsgCritterXY( msg, this );
+    if( item )
+        MsgSomeItem( msg, item );
+    MsgCritterAction( msg, this, action, action_ext, item );
+    SendA_Broadcast( msg, false );
+}
+
+void Critter::SendAA_Action( int action, int action_ext, Item* item )
+{
+    if( !IsPlayer() && !IsVisPlayers() )
+        return;
+
+    BroadcastBuffer msg;
+    MsgCritterXY( msg, this );
+    if( item )
+        MsgSomeItem( msg, item );
+    MsgCritterAction( msg, this, action, action_ext, item );
+    SendA_Broadcast( msg, true );
 }
 
 void Critter::SendA_Knockout( uint anim2begin, uint anim2idle, ushort knock_hx, ushort knock_hy )
 {
-    if( VisCr.empty() )
+    if( !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Knockout( this, anim2begin, anim2idle, knock_hx, knock_hy );
-    }
+    BroadcastBuffer msg;
+    MsgCritterXY( msg, this );
+    MsgCritterKnockout( msg, this, anim2begin, anim2idle, knock_hx, knock_hy );
+    SendA_Broadcast( msg, false );
 }
 
 void Critter::SendAA_MoveItem( Item* item, uchar action, uchar prev_slot )
@@ -2804,84 +3182,73 @@ void Critter::SendAA_ItemData( Item* item )
         Send_AddItem( item );
 
     uchar slot = item->AccCritter.Slot;
-    if( !VisCr.empty() && slot != SLOT_INV && SlotEnabled[slot] )
+    if( slot == SLOT_INV || !SlotEnabled[slot] || !IsVisPlayers() )
+        return;
+
+    int script = (SlotDataSendEnabled[slot] ? SlotDataSendScript[slot] : 0);
+    if( !script )
     {
-        if( SlotDataSendEnabled[slot] )
+        // Send all data or half data to all
+        BroadcastBuffer msg;
+        MsgCritterItemData( msg, this, slot, item, SlotDataSendEnabled[slot] );
+        SendA_Broadcast( msg, false );
+    }
+    else
+    {
+        SyncLockCritters( false, true );
+
+        // Send all data if condition passably, else send half
+        BroadcastBuffer msg_full, msg_half;
+        uint            sends_full = 0, sends_half = 0;
+        for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
         {
-            int script = SlotDataSendScript[slot];
-            if( !script )
+            Critter* cr = *it;
+            if( !cr->IsPlayer() )
+                continue;
+
+            if( RunSlotDataSendScript( script, slot, item, this, cr ) )
             {
-                // Send all data
-                for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-                {
-                    Critter* cr = *it;
-                    if( cr->IsPlayer() )
-                        cr->Send_ItemData( this, slot, item, true );
-                }
+                if( msg_full.IsEmpty() )
+                    MsgCritterItemData( msg_full, this, slot, item, true );
+                if( ( (Client*)cr )->Send_Broadcast( msg_full ) )
+                    sends_full++;
             }
             else
             {
-                SyncLockCritters( false, true );
-
-                // Send all data if condition passably, else send half
-                for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-                {
-                    Critter* cr = *it;
-                    if( cr->IsPlayer() )
-                    {
-                        if( RunSlotDataSendScript( script, slot, item, this, cr ) )
-                            cr->Send_ItemData( this, slot, item, true );
-                        else
-                            cr->Send_ItemData( this, slot, item, false );
-                    }
-                }
-            }
-        }
-        else
-        {
-            // Send half data
-            for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-            {
-                Critter* cr = *it;
-                if( cr->IsPlayer() )
-                    cr->Send_ItemData( this, slot, item, false );
+                if( msg_half.IsEmpty() )
+                    MsgCritterItemData( msg_half, this, slot, item, false );
+                if( ( (Client*)cr )->Send_Broadcast( msg_half ) )
+                    sends_half++;
             }
         }
+
+        AddBroadcastStatistics( msg_full, sends_full );
+        AddBroadcastStatistics( msg_half, sends_half );
     }
 }
 
 void Critter::SendAA_Animate( uint anim1, uint anim2, Item* item, bool clear_sequence, bool delay_play )
 {
-    if( IsPlayer() )
-        Send_Animate( this, anim1, anim2, item, clear_sequence, delay_play );
-
-    if( VisCr.empty() )
+    if( !IsPlayer() && !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Animate( this, anim1, anim2, item, clear_sequence, delay_play );
-    }
+    BroadcastBuffer msg;
+    if( clear_sequence )
+        MsgCritterXY( msg, this );
+    if( item )
+        MsgSomeItem( msg, item );
+    MsgCritterAnimate( msg, this, anim1, anim2, item, clear_sequence, delay_play );
+    SendA_Broadcast( msg, true );
 }
 
 void Critter::SendAA_SetAnims( int cond, uint anim1, uint anim2 )
 {
-    if( IsPlayer() )
-        Send_SetAnims( this, cond, anim1, anim2 );
-
-    if( VisCr.empty() )
+    if( !IsPlayer() && !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_SetAnims( this, cond, anim1, anim2 );
-    }
+    BroadcastBuffer msg;
+    MsgCritterSetAnims( msg, this, cond, anim1, anim2 );
+    SendA_Broadcast( msg, true );
 }
 
 void Critter::SendA_GlobalInfo( GlobalMapGroup* group, uchar info_flags )
@@ -2910,107 +3277,72 @@ void Critter::SendAA_Text( CrVec& to_cr, const char* str, uchar how_say, bool un
     uint   from_id = GetId();
     ushort intellect = (how_say >= SAY_NORM && how_say <= SAY_RADIO ? IntellectCacheValue : 0);
 
-    if( IsPlayer() )
-        Send_TextEx( from_id, str, str_len, how_say, intellect, unsafe_text );
-
-    if( to_cr.empty() )
-        return;
-
-    int dist = -1;
-    if( how_say == SAY_SHOUT || how_say == SAY_SHOUT_ON_HEAD )
-        dist = GameOpt.ShoutDist + GetMultihex();
-    else if( how_say == SAY_WHISP || how_say == SAY_WHISP_ON_HEAD )
-        dist = GameOpt.WhisperDist + GetMultihex();
-
-    for( auto it = to_cr.begin(), end = to_cr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr == this || !cr->IsPlayer() )
-            continue;
-
-        // SYNC_LOCK(cr);
-
-        if( dist == -1 )
-            cr->Send_TextEx( from_id, str, str_len, how_say, intellect, unsafe_text );
-        else if( CheckDist( Data.HexX, Data.HexY, cr->Data.HexX, cr->Data.HexY, dist + cr->GetMultihex() ) )
-            cr->Send_TextEx( from_id, str, str_len, how_say, intellect, unsafe_text );
-    }
+    BroadcastBuffer msg;
+    MsgCritterText( msg, from_id, str, str_len, how_say, intellect, unsafe_text );
+    SendAA_Say( to_cr, msg, how_say );
 }
 
 void Critter::SendAA_Msg( CrVec& to_cr, uint num_str, uchar how_say, ushort num_msg )
 {
-    if( IsPlayer() )
-        Send_TextMsg( this, num_str, how_say, num_msg );
-
-    if( to_cr.empty() )
+    if( !num_str )
         return;
 
-    int dist = -1;
-    if( how_say == SAY_SHOUT || how_say == SAY_SHOUT_ON_HEAD )
-        dist = GameOpt.ShoutDist + GetMultihex();
-    else if( how_say == SAY_WHISP || how_say == SAY_WHISP_ON_HEAD )
-        dist = GameOpt.WhisperDist + GetMultihex();
-
-    for( auto it = to_cr.begin(), end = to_cr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr == this )
-            continue;
-        if( !cr->IsPlayer() )
-            continue;
-
-        // SYNC_LOCK(cr);
-
-        if( dist == -1 )
-            cr->Send_TextMsg( this, num_str, how_say, num_msg );
-        else if( CheckDist( Data.HexX, Data.HexY, cr->Data.HexX, cr->Data.HexY, dist + cr->GetMultihex() ) )
-            cr->Send_TextMsg( this, num_str, how_say, num_msg );
-    }
+    BroadcastBuffer msg;
+    MsgTextMsg( msg, GetId(), num_str, how_say, num_msg );
+    SendAA_Say( to_cr, msg, how_say );
 }
 
 void Critter::SendAA_MsgLex( CrVec& to_cr, uint num_str, uchar how_say, ushort num_msg, const char* lexems )
 {
-    if( IsPlayer() )
-        Send_TextMsgLex( this, num_str, how_say, num_msg, lexems );
-
-    if( to_cr.empty() )
+    if( !num_str )
         return;
 
-    int dist = -1;
-    if( how_say == SAY_SHOUT || how_say == SAY_SHOUT_ON_HEAD )
-        dist = GameOpt.ShoutDist + GetMultihex();
-    else if( how_say == SAY_WHISP || how_say == SAY_WHISP_ON_HEAD )
-        dist = GameOpt.WhisperDist + GetMultihex();
+    BroadcastBuffer msg;
+    MsgTextMsgLex( msg, GetId(), num_str, how_say, num_msg, lexems );
+    SendAA_Say( to_cr, msg, how_say );
+}
+
+void Critter::SendAA_Say( CrVec& to_cr, const BroadcastBuffer& msg, uchar how_say )
+{
+    uint sends = 0;
+    if( IsPlayer() && ( (Client*)this )->Send_Broadcast( msg ) )
+        sends++;
 
-    for( auto it = to_cr.begin(), end = to_cr.end(); it != end; ++it )
+    if( !to_cr.empty() )
     {
-        Critter* cr = *it;
-        if( cr == this )
-            continue;
-        if( !cr->IsPlayer() )
-            continue;
+        int dist = -1;
+        if( how_say == SAY_SHOUT || how_say == SAY_SHOUT_ON_HEAD )
+            dist = GameOpt.ShoutDist + GetMultihex();
+        else if( how_say == SAY_WHISP || how_say == SAY_WHISP_ON_HEAD )
+            dist = GameOpt.WhisperDist + GetMultihex();
+
+        for( auto it = to_cr.begin(), end = to_cr.end(); it != end; ++it )
+        {
+            Critter* cr = *it;
+            if( cr == this || !cr->IsPlayer() )
+                continue;
 
-        // SYNC_LOCK(cr);
+            // SYNC_LOCK(cr);
 
-        if( dist == -1 )
-            cr->Send_TextMsgLex( this, num_str, how_say, num_msg, lexems );
-        else if( CheckDist( Data.HexX, Data.HexY, cr->Data.HexX, cr->Data.HexY, dist + cr->GetMultihex() ) )
-            cr->Send_TextMsgLex( this, num_str, how_say, num_msg, lexems );
+            if( dist != -1 && !CheckDist( Data.HexX, Data.HexY, cr->Data.HexX, cr->Data.HexY, dist + cr->GetMultihex() ) )
+                continue;
+            if( ( (Client*)cr )->Send_Broadcast( msg ) )
+                sends++;
+        }
     }
+
+    AddBroadcastStatistics( msg, sends );
 }
 
 void Critter::SendA_Dir()
 {
-    if( VisCr.empty() )
+    SetJournalDirty();
+    if( !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Dir( this );
-    }
+    BroadcastBuffer msg;
+    MsgCritterDir( msg, this );
+    SendA_Broadcast( msg, false );
 }
 
 void Critter::SendA_Follow( uchar follow_type, ushort map_pid, uint follow_wait )
@@ -3037,16 +3369,12 @@ void Critter::SendA_Follow( uchar follow_type, ushort map_pid, uint follow_wait
 
 void Critter::SendA_ParamOther( ushort num_param, int val )
 {
-    if( VisCr.empty() )
+    if( !IsVisPlayers() )
         return;
-    // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_CritterParam( this, num_param, val );
-    }
+    BroadcastBuffer msg;
+    MsgCritterParam( msg, this, num_param, val );
+    SendA_Broadcast( msg, false );
 }
 
 void Critter::SendA_ParamCheck( ushort num_param )
@@ -3057,13 +3385,7 @@ void Critter::SendA_ParamCheck( ushort num_param )
     int script = ParamsSendScript[num_param];
     if( !script )
     {
-        int val = Data.Params[num_param];
-        for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-        {
-            Critter* cr = *it;
-            if( cr->IsPlayer() )
-                cr->Send_CritterParam( this, num_param, val );
-        }
+        SendA_ParamOther( num_param, Data.Params[num_param] );
     }
     else
     {
@@ -3197,18 +3519,162 @@ const char* Critter::GetInfo()
     return GetName();
 }
 
+static volatile long ParamsGetCalls = 0;
+static volatile long ParamsGetHits = 0;
+static volatile long ParamsGetInvalidated = 0;
+
+// Keeps critters with parameter value in [min_value, max_value]
+// Without getter script values are read straight from Data.Params, range is checked by single unsigned compare
+void Critter::FilterByParam( CrVec& critters, uint index, int min_value, int max_value, int find_type )
+{
+    if( index >= MAX_PARAMS || min_value > max_value )
+    {
+        critters.clear();
+        return;
+    }
+
+    uint range = (uint)max_value - (uint)min_value;
+    uint count = 0;
+    if( !ParamsGetScript[index] )
+    {
+        for( uint i = 0, j = (uint)critters.size(); i < j; i++ )
+        {
+            Critter* cr = critters[i];
+            if( (uint)cr->Data.Params[index] - (uint)min_value <= range && !cr->IsNotValid && cr->CheckFind( find_type ) )
+                critters[count++] = cr;
+        }
+    }
+    else
+    {
+        for( uint i = 0, j = (uint)critters.size(); i < j; i++ )
+        {
+            Critter* cr = critters[i];
+            if( !cr->IsNotValid && cr->CheckFind( find_type ) && (uint)cr->GetParam( index ) - (uint)min_value <= range )
+                critters[count++] = cr;
+        }
+    }
+    critters.resize( count );
+}
+
 int Critter::GetParam( uint index )
 {
-    if( ParamsGetScript[index] && Script::PrepareContext( ParamsGetScript[index], _FUNC_, "" ) )
+    if( ParamsGetScript[index] )
+    {
+        int offset = ParamsGetCacheOffset[index];
+        if( offset < 0 )
+            return RunParamsGetScript( index );
+
+        if( ParamsGetCacheGen != ParamsGetCacheGeneration )
+        {
+            ParamsGetCache.clear();
+            ParamsGetCache.resize( ParamsGetCacheSize );
+            ParamsGetCacheGen = ParamsGetCacheGeneration;
+        }
+
+        // Cache layout: valid flag, value, depends values
+        InterlockedIncrement( &ParamsGetCalls );
+        UIntVec& depends = ParamsGetDepends[index];
+        int*     cache = &ParamsGetCache[offset];
+        if( cache[0] )
+        {
+            uint i = 0;
+            uint j = (uint)depends.size();
+            for( ; i < j; i++ )
+                if( cache[2 + i] != Data.Params[depends[i]] )
+                    break;
+            if( i == j )
+            {
+                InterlockedIncrement( &ParamsGetHits );
+                return cache[1];
+            }
+            cache[0] = 0;
+            InterlockedIncrement( &ParamsGetInvalidated );
+        }
+
+        // Take depends before call, changes made by getter itself are caught on next call
+        for( uint i = 0, j = (uint)depends.size(); i < j; i++ )
+            cache[2 + i] = Data.Params[depends[i]];
+        bool ok = false;
+        int  value = RunParamsGetScript( index, &ok );
+        if( ok )
+        {
+            cache[1] = value;
+            cache[0] = 1;
+        }
+        return value;
+    }
+    return Data.Params[index];
+}
+
+int Critter::RunParamsGetScript( uint index, bool* ok /* = NULL */ )
+{
+    if( Script::PrepareContext( ParamsGetScript[index], _FUNC_, "" ) )
     {
         Script::SetArgObject( this );
         Script::SetArgUInt( index - (ParametersOffset[index] ? ParametersMin[index] : 0) );
         if( Script::RunPrepared() )
+        {
+            if( ok )
+                *ok = true;
             return Script::GetReturnedUInt();
+        }
     }
     return Data.Params[index];
 }
 
+void Critter::SetParamsGetDepends( uint index, const UIntVec& depends )
+{
+    ParamsGetDepends[index].clear();
+    ParamsGetCacheOffset[index] = -1;
+    ParamsGetCacheGeneration++;
+
+    if( depends.empty() )
+        return;
+
+    // Own value is always a depend
+    UIntVec& own = ParamsGetDepends[index];
+    own.push_back( index );
+    for( auto it = depends.begin(), end = depends.end(); it != end; ++it )
+        if( *it < MAX_PARAMS && std::find( own.begin(), own.end(), *it ) == own.end() )
+            own.push_back( *it );
+
+    ParamsGetCacheOffset[index] = (int)ParamsGetCacheSize;
+    ParamsGetCacheSize += 2 + (uint)own.size();
+}
+
+void Critter::ResetParamsGetCache()
+{
+    for( int i = 0; i < MAX_PARAMS; i++ )
+    {
+        ParamsGetDepends[i].clear();
+        ParamsGetCacheOffset[i] = -1;
+    }
+    ParamsGetCacheSize = 0;
+    ParamsGetCacheGeneration++;
+}
+
+void Critter::GetParamsGetStatistics( ParamsGetStatistics& stats )
+{
+    stats.Calls = (uint)ParamsGetCalls;
+    stats.Hits = (uint)ParamsGetHits;
+    stats.Invalidated = (uint)ParamsGetInvalidated;
+}
+
+string Critter::GetParamsGetStatisticsString()
+{
+    ParamsGetStatistics stats;
+    GetParamsGetStatistics( stats );
+
+    uint cached = 0;
+    for( int i = 0; i < MAX_PARAMS; i++ )
+        if( ParamsGetScript[i] && ParamsGetCacheOffset[i] >= 0 )
+            cached++;
+
+    char str[MAX_FOTEXT];
+    return Str::Format( str, "Parameters getters cache: cached params %u, calls %u, hits %u (%.1f%%), invalidated %u, script calls saved %u\n",
+                        cached, stats.Calls, stats.Hits, stats.Calls ? (double)stats.Hits * 100.0 / (double)stats.Calls : 0.0, stats.Invalidated, stats.Hits );
+}
+
 void Critter::ChangeParam( uint index )
 {
     if( !ParamsIsChanged[index] && ParamLocked != (int)index )
@@ -3216,7 +3682,9 @@ void Critter::ChangeParam( uint index )
         ParamsChanged.push_back( index );
         ParamsChanged.push_back( Data.Params[index] );
         ParamsIsChanged[index] = true;
+        WakeUp();
     }
+    SetJournalDirty();
 }
 
 IntVec CallChange;
@@ -3237,6 +3705,7 @@ void Critter::ProcessChangedParams()
             int old_val = ParamsChanged[i + 1];
             if( Data.Params[index] != old_val )
             {
+                CrMngr.UpdateParamsColumn( this, index );
                 if( ParamsChangeScript[index] )
                 {
                     CallChange.push_back( ParamsChangeScript[index] );
@@ -3534,6 +4003,8 @@ void Critter::AddCrTimeEvent( uint func_num, uint rate, uint duration, int ident
     cte.NextTime = duration;
     cte.Identifier = identifier;
     CrTimeEvents.insert( it, cte );
+    SetJournalDirty();
+    WakeUp();
 }
 
 void Critter::EraseCrTimeEvent( int index )
@@ -3541,6 +4012,7 @@ void Critter::EraseCrTimeEvent( int index )
     if( index >= (int)CrTimeEvents.size() )
         return;
     CrTimeEvents.erase( CrTimeEvents.begin() + index );
+    SetJournalDirty();
 }
 
 void Critter::ContinueTimeEvents( int offs_time )
@@ -3857,17 +4329,24 @@ void Client::Send_LoadMap( Map* map )
     GameState = STATE_TRANSFERRING;
 }
 
+bool Client::Send_Broadcast( const BroadcastBuffer& msg )
+{
+    if( IsSendDisabled() || IsOffline() )
+        return false;
+
+    BOUT_BEGIN( this );
+    Bout.Push( msg );
+    BOUT_END( this );
+    return true;
+}
+
 void Client::Send_Move( Critter* from_cr, uint move_params )
 {
     if( IsSendDisabled() || IsOffline() )
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_MOVE;
-    Bout << from_cr->GetId();
-    Bout << move_params;
-    Bout << from_cr->GetHexX();
-    Bout << from_cr->GetHexY();
+    MsgCritterMove( Bout, from_cr, move_params );
     BOUT_END( this );
 }
 
@@ -3877,9 +4356,7 @@ void Client::Send_Dir( Critter* from_cr )
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_DIR;
-    Bout << from_cr->GetId();
-    Bout << from_cr->GetDir();
+    MsgCritterDir( Bout, from_cr );
     BOUT_END( this );
 }
 
@@ -3892,11 +4369,7 @@ void Client::Send_Action( Critter* from_cr, int action, int action_ext, Item* it
         Send_SomeItem( item );
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_ACTION;
-    Bout << from_cr->GetId();
-    Bout << action;
-    Bout << action_ext;
-    Bout << (bool)(item ? true : false);
+    MsgCritterAction( Bout, from_cr, action, action_ext, item );
     BOUT_END( this );
 }
 
@@ -3907,12 +4380,7 @@ void Client::Send_Knockout( Critter* from_cr, uint anim2begin, uint anim2idle, u
     Send_XY( from_cr );
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_KNOCKOUT;
-    Bout << from_cr->GetId();
-    Bout << anim2begin;
-    Bout << anim2idle;
-    Bout << knock_hx;
-    Bout << knock_hy;
+    MsgCritterKnockout( Bout, from_cr, anim2begin, anim2idle, knock_hx, knock_hy );
     BOUT_END( this );
 }
 
@@ -3994,10 +4462,7 @@ void Client::Send_ItemData( Critter* from_cr, uchar slot, Item* item, bool ext_d
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_ITEM_DATA;
-    Bout << from_cr->GetId();
-    Bout << slot;
-    Bout.Push( (char*)&item->Data, Item::ItemData::SendMask[ext_data ? ITEM_DATA_MASK_CRITTER_EXT : ITEM_DATA_MASK_CRITTER], sizeof(item->Data) );
+    MsgCritterItemData( Bout, from_cr, slot, item, ext_data );
     BOUT_END( this );
 }
 
@@ -4011,13 +4476,7 @@ void Client::Send_Animate( Critter* from_cr, uint anim1, uint anim2, Item* item,
         Send_SomeItem( item );
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_ANIMATE;
-    Bout << from_cr->GetId();
-    Bout << anim1;
-    Bout << anim2;
-    Bout << (bool)(item ? true : false);
-    Bout << clear_sequence;
-    Bout << delay_play;
+    MsgCritterAnimate( Bout, from_cr, anim1, anim2, item, clear_sequence, delay_play );
     BOUT_END( this );
 }
 
@@ -4027,11 +4486,7 @@ void Client::Send_SetAnims( Critter* from_cr, int cond, uint anim1, uint anim2 )
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_SET_ANIMS;
-    Bout << from_cr->GetId();
-    Bout << cond;
-    Bout << anim1;
-    Bout << anim2;
+    MsgCritterSetAnims( Bout, from_cr, cond, anim1, anim2 );
     BOUT_END( this );
 }
 
@@ -4376,11 +4831,7 @@ void Client::Send_XY( Critter* cr )
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_XY;
-    Bout << cr->GetId();
-    Bout << cr->GetHexX();
-    Bout << cr->GetHexY();
-    Bout << cr->GetDir();
+    MsgCritterXY( Bout, cr );
     BOUT_END( this );
 }
 
@@ -4397,6 +4848,8 @@ void Client::Send_AllParams()
 
 void Client::Send_Param( ushort num_param )
 {
+    CrMngr.UpdateParamsColumn( this, num_param );
+
     if( IsSendDisabled() || IsOffline() )
         return;
     if( !ParamsChosenSendMask[num_param] )
@@ -4427,10 +4880,7 @@ void Client::Send_CritterParam( Critter* cr, ushort num_param, int val )
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_PARAM;
-    Bout << cr->GetId();
-    Bout << num_param;
-    Bout << val;
+    MsgCritterParam( Bout, cr, num_param, val );
     BOUT_END( this );
 }
 
@@ -4528,18 +4978,8 @@ void Client::Send_TextEx( uint from_id, const char* s_str, ushort str_len, uchar
     if( IsSendDisabled() || IsOffline() )
         return;
 
-    uint msg_len = sizeof(uint) + sizeof(msg_len) + sizeof(from_id) + sizeof(how_say) +
-                   sizeof(intellect) + sizeof(unsafe_text) + sizeof(str_len) + str_len;
-
     BOUT_BEGIN( this );
-    Bout << NETMSG_CRITTER_TEXT;
-    Bout << msg_len;
-    Bout << from_id;
-    Bout << how_say;
-    Bout << intellect;
-    Bout << unsafe_text;
-    Bout << str_len;
-    Bout.Push( s_str, str_len );
+    MsgCritterText( Bout, from_id, s_str, str_len, how_say, intellect, unsafe_text );
     BOUT_END( this );
 }
 
@@ -4549,14 +4989,9 @@ void Client::Send_TextMsg( Critter* from_cr, uint num_str, uchar how_say, ushort
         return;
     if( !num_str )
         return;
-    uint from_id = (from_cr ? from_cr->GetId() : 0);
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_MSG;
-    Bout << from_id;
-    Bout << how_say;
-    Bout << num_msg;
-    Bout << num_str;
+    MsgTextMsg( Bout, from_cr ? from_cr->GetId() : 0, num_str, how_say, num_msg );
     BOUT_END( this );
 }
 
@@ -4568,11 +5003,7 @@ void Client::Send_TextMsg( uint from_id, uint num_str, uchar how_say, ushort num
         return;
 
     BOUT_BEGIN( this );
-    Bout << NETMSG_MSG;
-    Bout << from_id;
-    Bout << how_say;
-    Bout << num_msg;
-    Bout << num_str;
+    MsgTextMsg( Bout, from_id, num_str, how_say, num_msg );
     BOUT_END( this );
 }
 
@@ -4583,25 +5014,8 @@ void Client::Send_TextMsgLex( Critter* from_cr, uint num_str, uchar how_say, ush
     if( !num_str )
         return;
 
-    ushort lex_len = Str::Length( lexems );
-    if( !lex_len || lex_len > MAX_DLG_LEXEMS_TEXT )
-    {
-        Send_TextMsg( from_cr, num_str, how_say, num_msg );
-        return;
-    }
-
-    uint from_id = (from_cr ? from_cr->GetId() : 0);
-    uint msg_len = NETMSG_MSG_SIZE + sizeof(lex_len) + lex_len;
-
     BOUT_BEGIN( this );
-    Bout << NETMSG_MSG_LEX;
-    Bout << msg_len;
-    Bout << from_id;
-    Bout << how_say;
-    Bout << num_msg;
-    Bout << num_str;
-    Bout << lex_len;
-    Bout.Push( lexems, lex_len );
+    MsgTextMsgLex( Bout, from_cr ? from_cr->GetId() : 0, num_str, how_say, num_msg, lexems );
     BOUT_END( this );
 }
 
@@ -4612,24 +5026,8 @@ void Client::Send_TextMsgLex( uint from_id, uint num_str, uchar how_say, ushort
     if( !num_str )
         return;
 
-    ushort lex_len = Str::Length( lexems );
-    if( !lex_len || lex_len > MAX_DLG_LEXEMS_TEXT )
-    {
-        Send_TextMsg( from_id, num_str, how_say, num_msg );
-        return;
-    }
-
-    uint msg_len = NETMSG_MSG_SIZE + sizeof(lex_len) + lex_len;
-
     BOUT_BEGIN( this );
-    Bout << NETMSG_MSG_LEX;
-    Bout << msg_len;
-    Bout << from_id;
-    Bout << how_say;
-    Bout << num_msg;
-    Bout << num_str;
-    Bout << lex_len;
-    Bout.Push( lexems, lex_len );
+    MsgTextMsgLex( Bout, from_id, num_str, how_say, num_msg, lexems );
     BOUT_END( this );
 }
 
@@ -5081,11 +5479,7 @@ void Client::Send_CheckUIDS()
 void Client::Send_SomeItem( Item* item )
 {
     BOUT_BEGIN( this );
-    Bout << NETMSG_SOME_ITEM;
-    Bout << item->GetId();
-    Bout << item->GetProtoId();
-    Bout << item->AccCritter.Slot;
-    Bout.Push( (char*)&item->Data, Item::ItemData::SendMask[ITEM_DATA_MASK_CRITTER], sizeof(item->Data) );
+    MsgSomeItem( Bout, item );
     BOUT_END( this );
 }
 
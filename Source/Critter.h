@@ -15,9 +15,11 @@
 #include "Defines.h"
 #include "Dialogs.h"
 #include "GameOptions.h"
+#include "IdSet.h"
 #include "Network.h"
 #include "ThreadSync.h"
 #include "Types.h"
+#include "WorldJournal.h"
 
 extern const char* CritterEventFuncName[CRITTER_EVENT_MAX];
 
@@ -32,6 +34,35 @@ extern const char* CritterEventFuncName[CRITTER_EVENT_MAX];
 #define STATE_PLAYING         (2)
 #define STATE_TRANSFERRING    (3)
 
+// Serialize-once broadcasts, see Critter::SendA_Broadcast
+struct BroadcastStatistics
+{
+    uint64 Messages;      // Messages serialized once and pushed to several clients
+    uint64 Sends;         // Total pushes of such messages
+    uint64 SavedMessages; // Serializations avoided compared to per-client sending
+    uint64 SavedBytes;
+};
+
+// Visibility processing cost, see Critter::ProcessVisibleCritters
+struct VisibilityStatistics
+{
+    uint64 CritterCalls;
+    uint64 CrittersOnMap;   // Critters on map, summed per call
+    uint64 CrittersChecked; // Critters passed visibility checks
+    double CritterTime;     // Milliseconds
+    uint64 ItemCalls;
+    uint64 ItemsOnMap;
+    uint64 ItemsChecked;
+    double ItemTime;
+};
+
+struct ParamsGetStatistics
+{
+    uint Calls;       // Getter calls of parameters with cached value
+    uint Hits;        // Calls answered from cache
+    uint Invalidated; // Cached values dropped after change of depends
+};
+
 class Critter;
 class Client;
 class Npc;
@@ -84,6 +115,10 @@ public:
     static int       ParamsSendScript[MAX_PARAMS];
     static int       ParamsChangeScript[MAX_PARAMS];
     static int       ParamsGetScript[MAX_PARAMS];
+    static UIntVec   ParamsGetDepends[MAX_PARAMS];     // Result of getter script is cached while these params keep own values
+    static int       ParamsGetCacheOffset[MAX_PARAMS]; // Offset in ParamsGetCache, -1 if not cached
+    static uint      ParamsGetCacheSize;
+    static uint      ParamsGetCacheGeneration;
     static int       ParamsDialogGetScript[MAX_PARAMS];
     static bool      SlotDataSendEnabled[0x100];
     static int       SlotDataSendScript[0x100];
@@ -94,15 +129,31 @@ public:
     bool             ParamsIsChanged[MAX_PARAMS];
     IntVec           ParamsChanged;
     int              ParamLocked;
+    IntVec           ParamsGetCache;    // Valid flag, value and values of depends for each cached getter
+    uint             ParamsGetCacheGen;
+    uint             ParamsSlot;        // Index in parameters columns of critter manager
+    uint             JournalGen;        // Generation of last change report to world journal
     static bool      SlotEnabled[0x100];
     static Item*     SlotEnabledCacheData[0x100];
     static Item*     SlotEnabledCacheDataExt[0x100];
 
+    static void   AddVisibilityStatistics( bool items, uint on_map, uint checked, double time );
+    static string GetVisibilityStatisticsString();
+    static void   AddBroadcastStatistics( const BroadcastBuffer& msg, uint sends );
+    static void   GetBroadcastStatistics( BroadcastStatistics& stats );
+    static string GetBroadcastStatisticsString();
+    static void   SetParamsGetDepends( uint index, const UIntVec& depends );
+    static void   ResetParamsGetCache();
+    static void   GetParamsGetStatistics( ParamsGetStatistics& stats );
+    static string GetParamsGetStatisticsString();
+    static void   FilterByParam( CrVec& critters, uint index, int min_value, int max_value, int find_type );
+
     CritDataExt* GetDataExt();
     void         SetMaps( uint map_id, ushort map_pid )
     {
         Data.MapId = map_id;
         Data.MapPid = map_pid;
+        SetJournalDirty();
     }
     void SetLexems( const char* lexems );
     bool IsLexems() { return Data.Lexems[0] != 0; }
@@ -113,11 +164,13 @@ public:
     // Visible critters and items
     CrVec         VisCr;
     CrVec         VisCrSelf;
-    CrMap         VisCrMap;
-    CrMap         VisCrSelfMap;
-    UIntSet       VisCr1, VisCr2, VisCr3;
-    UIntSet       VisItem;
+    IdMap<uint>   VisCrMap;     // Index in VisCr
+    IdMap<uint>   VisCrSelfMap; // Index in VisCrSelf
+    IdSet         VisCr1, VisCr2, VisCr3;
+    IdSet         VisItem;
     MutexSpinlock VisItemLocker;
+    uint          MapGridId;   // Map which spatial index contains critter
+    int           MapGridCell; // Cell in that index
     uint          ViewMapId;
     ushort        ViewMapPid, ViewMapLook, ViewMapHx, ViewMapHy;
     uchar         ViewMapDir;
@@ -126,6 +179,8 @@ public:
     void SyncLockCritters( bool self_critters, bool only_players );
     void ProcessVisibleCritters();
     void ProcessVisibleItems();
+    void CollectVisibleCritters( Map* map, uint radius, CrVec& critters );
+    void CollectVisibleItems( Map* map, int look, ItemPtrVec& items );
     void ViewMap( Map* map, int look, ushort hx, ushort hy, int dir );
     void ClearVisible();
 
@@ -272,9 +327,11 @@ public:
     bool IsBusy();
     void SetBreakTime( uint ms );
     void SetBreakTimeDelta( uint ms );
+    uint GetBreakEndTick() { return startBreakTime + breakTime; }
 
     void SetWait( uint ms );
     bool IsWait();
+    uint GetWaitEndTick() { return waitEndTick; }
 
     void FullClear();
 
@@ -330,6 +387,8 @@ public:
     void Send_CritterLexems( Critter* cr );
 
     // Send all
+    bool IsVisPlayers();
+    void SendA_Broadcast( const BroadcastBuffer& msg, bool self );
     void SendA_Move( uint move_params );
     void SendA_XY();
     void SendA_Action( int action, int action_ext, Item* item );
@@ -343,6 +402,7 @@ public:
     void SendAA_Text( CrVec& to_cr, const char* str, uchar how_say, bool unsafe_text );
     void SendAA_Msg( CrVec& to_cr, uint num_str, uchar how_say, ushort num_msg );
     void SendAA_MsgLex( CrVec& to_cr, uint num_str, uchar how_say, ushort num_msg, const char* lexems );
+    void SendAA_Say( CrVec& to_cr, const BroadcastBuffer& msg, uchar how_say );
     void SendA_Dir();
     void SendA_Follow( uchar follow_type, ushort map_pid, uint follow_wait );
     void SendA_ParamOther( ushort num_param, int val );
@@ -356,6 +416,14 @@ public:
     bool        IsPlayer()    { return !CritterIsNpc; }
     bool        IsNpc()       { return CritterIsNpc; }
     uint        GetId()       { return Data.Id; }
+    void        SetJournalDirty()
+    {
+        if( JournalGen != WorldJournal::DirtyGeneration && CritterIsNpc && Data.Id )
+        {
+            JournalGen = WorldJournal::DirtyGeneration;
+            WorldJournal::SetDirty( WORLD_SECTION_CRITTERS, 0, Data.Id );
+        }
+    }
     uint        GetMap()      { return Data.MapId; }
     ushort      GetProtoMap() { return Data.MapPid; }
     void        RefreshName();
@@ -375,6 +443,7 @@ public:
     int         GetFreeWeight();
     int         GetFreeVolume();
     int         GetParam( uint index );
+    int         RunParamsGetScript( uint index, bool* ok = NULL );
     void        ChangeParam( uint index );
     void        ProcessChangedParams();
     uint        GetFollowCrId() { return Data.Params[ST_FOLLOW_CRIT]; }
@@ -485,6 +554,10 @@ public:
     uint GlobalIdleNextTick;
     uint ApRegenerationTick;
 
+    // Deadline scheduler, release tick of delayed job
+    volatile uint JobDelayTick;
+    void          WakeUp();
+
     // Reference counter
     bool IsNotValid;
     bool CanBeRemoved;
@@ -600,6 +673,7 @@ public:
     void PingOk( uint next_ping );
 
     // Sends
+    bool Send_Broadcast( const BroadcastBuffer& msg );
     void Send_Move( Critter* from_cr, uint move_params );
     void Send_Dir( Critter* from_cr );
     void Send_AddCritter( Critter* cr );
@@ -28,6 +28,9 @@ CritterManager CrMngr;
 CritterManager::CritterManager() : isActive( false )
 {
     MEMORY_PROCESS( MEMORY_STATIC, sizeof(CritterManager) );
+    #ifdef FOCLASSIC_SERVER
+    memzero( paramsColumns, sizeof(paramsColumns) );
+    #endif
 }
 
 bool CritterManager::Init()
@@ -75,7 +78,12 @@ void CritterManager::Clear()
     for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
         SAFEREL( (*it).second );
     allCritters.clear();
+    crRegistry.Clear();
     crToDelete.clear();
+    for( uint i = 0; i < MAX_PARAMS; i++ )
+        SAFEDEL( paramsColumns[i] );
+    paramsSlots.clear();
+    paramsFreeSlots.clear();
     playersCount = 0;
     npcCount = 0;
     lastNpcId = CRITTER_ID_START_NPC;
@@ -206,7 +214,21 @@ CritData* CritterManager::GetAllProtos()
 }
 
 #ifdef FOCLASSIC_SERVER
-void CritterManager::SaveCrittersFile( void (*save_func)( void*, size_t ) )
+static void SaveCritterRecord( Critter* cr, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    cr->Data.IsDataExt = (cr->DataExt ? true : false);
+    if( record_func )
+        record_func();
+    save_func( &cr->Data, sizeof(cr->Data) );
+    if( cr->Data.IsDataExt )
+        save_func( cr->DataExt, sizeof(CritDataExt) );
+    uint te_count = (uint)cr->CrTimeEvents.size();
+    save_func( &te_count, sizeof(te_count) );
+    if( te_count )
+        save_func( &cr->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
+}
+
+void CritterManager::SaveCrittersFile( void (*save_func)( void*, size_t ), void (*record_func)() )
 {
     CrVec crits;
     for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
@@ -219,17 +241,25 @@ void CritterManager::SaveCrittersFile( void (*save_func)( void*, size_t ) )
     uint count = (uint)crits.size();   // npcCount
     save_func( &count, sizeof(count) );
     for( auto it = crits.begin(), end = crits.end(); it != end; ++it )
+        SaveCritterRecord( *it, save_func, record_func );
+}
+
+void CritterManager::SaveCrittersRecords( const UIntVec& ids, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    // Erased critters are missed, journal writes erase records for them
+    CrVec crits;
+    crits.reserve( ids.size() );
+    for( auto it = ids.begin(), end = ids.end(); it != end; ++it )
     {
-        Critter* cr = *it;
-        cr->Data.IsDataExt = (cr->DataExt ? true : false);
-        save_func( &cr->Data, sizeof(cr->Data) );
-        if( cr->Data.IsDataExt )
-            save_func( cr->DataExt, sizeof(CritDataExt) );
-        uint te_count = (uint)cr->CrTimeEvents.size();
-        save_func( &te_count, sizeof(te_count) );
-        if( te_count )
-            save_func( &cr->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
+        auto it_cr = allCritters.find( *it );
+        if( it_cr != allCritters.end() && (*it_cr).second->IsNpc() )
+            crits.push_back( (*it_cr).second );
     }
+
+    uint count = (uint)crits.size();
+    save_func( &count, sizeof(count) );
+    for( auto it = crits.begin(), end = crits.end(); it != end; ++it )
+        SaveCritterRecord( *it, save_func, record_func );
 }
 
 bool CritterManager::LoadCrittersFile( void* f, uint version )
@@ -343,6 +373,8 @@ void CritterManager::CritterGarbager()
                 continue;
             }
             allCritters.erase( it_cr );
+            crRegistry.Erase( cr->GetId() );
+            EraseParamsSlot( cr );
             npcCount--;
             crLocker.Unlock();
 
@@ -567,7 +599,12 @@ void CritterManager::AddCritter( Critter* cr )
 {
     SCOPE_LOCK( crLocker );
 
-    allCritters.insert( PAIR( cr->GetId(), cr ) );
+    if( allCritters.insert( PAIR( cr->GetId(), cr ) ).second )
+    {
+        crRegistry.Add( cr->GetId(), cr );
+        AddParamsSlot( cr );
+        cr->SetJournalDirty();
+    }
     if( cr->IsPlayer() )
         playersCount++;
     else
@@ -752,16 +789,85 @@ void CritterManager::GetGlobalMapCritters( ushort wx, ushort wy, uint radius, in
     critters = find_critters;
 }
 
-Critter* CritterManager::GetCritter( uint crid, bool sync_lock )
+static bool SortCritterByIdPred( Critter* cr1, Critter* cr2 )
 {
-    Critter* cr = NULL;
+    return cr1->GetId() < cr2->GetId();
+}
 
+void CritterManager::GetCrittersByParam( uint index, int min_value, int max_value, int find_type, CrVec& critters, bool sync_lock )
+{
+    critters.clear();
+    if( index >= MAX_PARAMS || min_value > max_value )
+        return;
+
+    // Raw values are prefiltered over column of parameter, getter scripts run only for locked critters
+    uint  range = (uint)max_value - (uint)min_value;
+    CrVec find_critters;
     crLocker.Lock();
-    auto it = allCritters.find( crid );
-    if( it != allCritters.end() )
-        cr = (*it).second;
+    if( !Critter::ParamsGetScript[index] )
+    {
+        SCOPE_LOCK( paramsLocker );
+
+        IntVec* column = paramsColumns[index];
+        if( !column )
+        {
+            column = new IntVec( paramsSlots.size() );
+            for( uint i = 0, j = (uint)paramsSlots.size(); i < j; i++ )
+                if( paramsSlots[i] )
+                    ( *column )[i] = paramsSlots[i]->Data.Params[index];
+            paramsColumns[index] = column;
+        }
+
+        // Compare without branches, matches are padded to read them by four
+        uint count = (uint)column->size();
+        paramsMatches.resize( (count + 3) / 4 * 4 );
+        if( count )
+        {
+            const int* values = &( *column )[0];
+            uchar*     matches = &paramsMatches[0];
+            for( uint i = 0; i < count; i++ )
+                matches[i] = ( (uint)values[i] - (uint)min_value <= range );
+            for( uint i = count, j = (uint)paramsMatches.size(); i < j; i++ )
+                matches[i] = 0;
+
+            for( uint i = 0; i < count; i += 4 )
+            {
+                if( !*(uint*)&matches[i] )
+                    continue;
+                for( uint k = i, l = MIN( i + 4, count ); k < l; k++ )
+                    if( matches[k] && paramsSlots[k] )
+                        find_critters.push_back( paramsSlots[k] );
+            }
+        }
+
+        // Same order as collection of all critters
+        std::sort( find_critters.begin(), find_critters.end(), SortCritterByIdPred );
+    }
+    else
+    {
+        for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
+        {
+            Critter* cr = (*it).second;
+            if( cr->CheckFind( find_type ) )
+                find_critters.push_back( cr );
+        }
+    }
     crLocker.Unlock();
 
+    if( sync_lock && LogicMT )
+    {
+        for( auto it = find_critters.begin(), end = find_critters.end(); it != end; ++it )
+            SYNC_LOCK( *it );
+    }
+    Critter::FilterByParam( find_critters, index, min_value, max_value, find_type );
+
+    critters = find_critters;
+}
+
+Critter* CritterManager::GetCritter( uint crid, bool sync_lock )
+{
+    Critter* cr = crRegistry.Get( crid );
+
     if( cr && sync_lock )
         SYNC_LOCK( cr );
     return cr;
@@ -772,13 +878,7 @@ Client* CritterManager::GetPlayer( uint crid, bool sync_lock )
     if( !CRITTER_ID_IS_PLAYER( crid ) )
         return NULL;
 
-    Critter* cr = NULL;
-
-    crLocker.Lock();
-    auto it = allCritters.find( crid );
-    if( it != allCritters.end() )
-        cr = (*it).second;
-    crLocker.Unlock();
+    Critter* cr = crRegistry.Get( crid );
 
     if( !cr || !cr->IsPlayer() )
         return NULL;
@@ -813,13 +913,7 @@ Npc* CritterManager::GetNpc( uint crid, bool sync_lock )
     if( !CRITTER_ID_IS_NPC( crid ) )
         return NULL;
 
-    Critter* cr = NULL;
-
-    crLocker.Lock();
-    auto it = allCritters.find( crid );
-    if( it != allCritters.end() )
-        cr = (*it).second;
-    crLocker.Unlock();
+    Critter* cr = crRegistry.Get( crid );
 
     if( !cr || !cr->IsNpc() )
         return NULL;
@@ -840,9 +934,55 @@ void CritterManager::EraseCritter( Critter* cr )
         else
             npcCount--;
         allCritters.erase( it );
+        crRegistry.Erase( cr->GetId() );
+        EraseParamsSlot( cr );
+        cr->SetJournalDirty();
     }
 }
 
+void CritterManager::AddParamsSlot( Critter* cr )
+{
+    SCOPE_LOCK( paramsLocker );
+
+    if( paramsFreeSlots.empty() )
+    {
+        cr->ParamsSlot = (uint)paramsSlots.size();
+        paramsSlots.push_back( cr );
+        for( uint i = 0; i < MAX_PARAMS; i++ )
+            if( paramsColumns[i] )
+                paramsColumns[i]->push_back( cr->Data.Params[i] );
+    }
+    else
+    {
+        cr->ParamsSlot = paramsFreeSlots.back();
+        paramsFreeSlots.pop_back();
+        paramsSlots[cr->ParamsSlot] = cr;
+        for( uint i = 0; i < MAX_PARAMS; i++ )
+            if( paramsColumns[i] )
+                ( *paramsColumns[i] )[cr->ParamsSlot] = cr->Data.Params[i];
+    }
+}
+
+void CritterManager::EraseParamsSlot( Critter* cr )
+{
+    SCOPE_LOCK( paramsLocker );
+
+    if( cr->ParamsSlot < (uint)paramsSlots.size() && paramsSlots[cr->ParamsSlot] == cr )
+    {
+        paramsSlots[cr->ParamsSlot] = NULL;
+        paramsFreeSlots.push_back( cr->ParamsSlot );
+    }
+    cr->ParamsSlot = uint( -1 );
+}
+
+void CritterManager::SetParamsColumnValue( Critter* cr, uint index )
+{
+    SCOPE_LOCK( paramsLocker );
+
+    if( cr->ParamsSlot < (uint)paramsSlots.size() )
+        ( *paramsColumns[index] )[cr->ParamsSlot] = cr->Data.Params[index];
+}
+
 void CritterManager::GetNpcIds( UIntSet& npc_ids )
 {
     SCOPE_LOCK( crLocker );
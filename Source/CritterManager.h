@@ -6,6 +6,7 @@
 
 #ifdef FOCLASSIC_SERVER
 # include "Critter.h"
+# include "Registry.h"
 #endif
 
 
@@ -30,14 +31,28 @@ public:
 
     #ifdef FOCLASSIC_SERVER
 private:
-    CrMap   allCritters;
-    UIntVec crToDelete;
-    uint    lastNpcId;
-    uint    playersCount, npcCount;
-    Mutex   crLocker;
+    CrMap             allCritters;
+    Registry<Critter> crRegistry;
+    UIntVec           crToDelete;
+    uint              lastNpcId;
+    uint              playersCount, npcCount;
+    Mutex             crLocker;
+
+    // Parameters of all critters in columns by slot of critter, for scans over one parameter
+    // Column is created on first scan of parameter, values are updated on parameter changes
+    CrVec             paramsSlots;
+    UIntVec           paramsFreeSlots;
+    IntVec*           paramsColumns[MAX_PARAMS];
+    UCharVec          paramsMatches;
+    MutexSpinlock     paramsLocker;
+
+    void AddParamsSlot( Critter* cr );
+    void EraseParamsSlot( Critter* cr );
+    void SetParamsColumnValue( Critter* cr, uint index );
 
 public:
-    void SaveCrittersFile( void (* save_func)( void*, size_t ) );
+    void SaveCrittersFile( void (* save_func)( void*, size_t ), void (* record_func)() = NULL );
+    void SaveCrittersRecords( const UIntVec& ids, void (* save_func)( void*, size_t ), void (* record_func)() = NULL ); // Delta save, only given NPCs
     bool LoadCrittersFile( void* f, uint version );
 
     void RunInitScriptCritters();
@@ -54,6 +69,7 @@ public:
     void     GetCopyNpcs( PcVec& npcs, bool sync_lock );
     void     GetCopyPlayers( ClVec& players, bool sync_lock );
     void     GetGlobalMapCritters( ushort wx, ushort wy, uint radius, int find_type, CrVec& critters, bool sync_lock );
+    void     GetCrittersByParam( uint index, int min_value, int max_value, int find_type, CrVec& critters, bool sync_lock );
     Critter* GetCritter( uint crid, bool sync_lock );
     Client*  GetPlayer( uint crid, bool sync_lock );
     Client*  GetPlayer( const char* name, bool sync_lock );
@@ -61,9 +77,14 @@ public:
     void     EraseCritter( Critter* cr );
     void     GetNpcIds( UIntSet& npc_ids );
 
+    // Values changed by ChangeParam or sent by Send_Param
+    void UpdateParamsColumn( Critter* cr, uint index ) { if( paramsColumns[index] ) SetParamsColumnValue( cr, index ); }
+
     uint PlayersInGame();
     uint NpcInGame();
     uint CrittersInGame();
+
+    string GetRegistryStatisticsString() { return crRegistry.GetStatisticsString( "Critters" ); }
     #endif // FOCLASSIC_SERVER
 
 
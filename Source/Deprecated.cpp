@@ -4,12 +4,14 @@
 #include "FileManager.h"
 #include "FileSystem.h"
 #include "Log.h"
+#include "Mutex.h"
 #include "Text.h"
 #include "Item.h"
 
 #if defined (FOCLASSIC_MAPPER) || defined (FOCLASSIC_SERVER)
 
 bool     ListsLoaded = false;
+Mutex    ListsLocker;
 PCharVec LstNames[PATH_LIST_COUNT];
 
 void LoadList( const char* lst_name, int path_type )
@@ -83,16 +85,21 @@ string GetPicName( uint lst_num, ushort pic_num )
 
 string Deprecated_GetPicName( int pid, int type, ushort pic_num )
 {
+    // Proto maps are loaded in parallel on server
     if( !ListsLoaded )
     {
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "tiles.lst", PATH_ART_TILES );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "items.lst", PATH_ART_ITEMS );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "scenery.lst", PATH_ART_SCENERY );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "walls.lst", PATH_ART_WALLS );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "misc.lst", PATH_ART_MISC );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "intrface.lst", PATH_ART_INTRFACE );
-        LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "inven.lst", PATH_ART_INVEN );
-        ListsLoaded = true;
+        SCOPE_LOCK( ListsLocker );
+        if( !ListsLoaded )
+        {
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "tiles.lst", PATH_ART_TILES );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "items.lst", PATH_ART_ITEMS );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "scenery.lst", PATH_ART_SCENERY );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "walls.lst", PATH_ART_WALLS );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "misc.lst", PATH_ART_MISC );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "intrface.lst", PATH_ART_INTRFACE );
+            LoadList( "data" DIR_SLASH_S "deprecated_lists" DIR_SLASH_S "inven.lst", PATH_ART_INVEN );
+            ListsLoaded = true;
+        }
     }
 
     if( pid == -1 )
@@ -3,6 +3,7 @@
 #include "FileManager.h"
 #include "FileSystem.h"
 #include "Log.h"
+#include "Mutex.h"
 #include "Text.h"
 
 #define OUT_BUF_START_SIZE    (0x100)
@@ -69,6 +70,9 @@ const char* PathList[PATH_LIST_COUNT] =
 DataFileVec FileManager::dataFiles;
 char        FileManager::dataPath[MAX_FOPATH] = { DIR_SLASH_SD };
 
+// Data files share file handle and read buffer, used by parallel loading of server prototypes
+static Mutex DataFilesLocker;
+
 void FileManager::SetDataPath( const char* path )
 {
     Str::Copy( dataPath, path );
@@ -319,6 +323,8 @@ bool FileManager::LoadFile( const char* fname, int path_type )
     }
     #endif
 
+    SCOPE_LOCK( DataFilesLocker );
+
     for( auto it = dataFiles.begin(), end = dataFiles.end(); it != end; ++it )
     {
         DataFile* dat = *it;
@@ -0,0 +1,138 @@
+#ifndef __ID_SET__
+#define __ID_SET__
+
+#include "Types.h"
+
+// Hash tables for nonzero ids, open addressing with linear probing
+// Removal shifts following entries back instead of leaving tombstones
+// Memory is allocated only when table grows, clearing keeps it
+template<class T>
+class IdMap
+{
+private:
+    struct Entry
+    {
+        uint Id;
+        T    Value;
+    };
+
+    vector<Entry> entries;    // Empty or power of two
+    uint          count;
+    uint          shift;      // 32 - log2( entries.size() )
+
+    uint Home( uint id ) const { return (id * 2654435769U) >> shift; }
+
+    void Grow()
+    {
+        vector<Entry> old;
+        old.swap( entries );
+
+        uint size = (old.empty() ? 8 : (uint)old.size() * 2);
+        entries.resize( size );
+        for( uint i = 0; i < size; i++ )
+            entries[i].Id = 0;
+        shift = 32;
+        for( uint s = size; s > 1; s >>= 1 )
+            shift--;
+
+        count = 0;
+        for( auto it = old.begin(), end = old.end(); it != end; ++it )
+            if( it->Id )
+                Insert( it->Id, it->Value );
+    }
+
+    int FindSlot( uint id ) const
+    {
+        if( !count )
+            return -1;
+
+        uint mask = (uint)entries.size() - 1;
+        for( uint i = Home( id ); ; i = (i + 1) & mask )
+        {
+            if( entries[i].Id == id )
+                return (int)i;
+            if( !entries[i].Id )
+                return -1;
+        }
+    }
+
+public:
+    IdMap() : count( 0 ), shift( 32 ) {}
+
+    uint Size() const  { return count; }
+    bool Empty() const { return !count; }
+
+    T* Find( uint id )
+    {
+        int slot = FindSlot( id );
+        return slot >= 0 ? &entries[slot].Value : NULL;
+    }
+
+    bool Count( uint id ) const { return FindSlot( id ) >= 0; }
+
+    // False if id already added
+    bool Insert( uint id, const T& value )
+    {
+        if( (count + 1) * 4 > (uint)entries.size() * 3 )
+            Grow();
+
+        uint mask = (uint)entries.size() - 1;
+        uint i = Home( id );
+        for( ; entries[i].Id; i = (i + 1) & mask )
+            if( entries[i].Id == id )
+                return false;
+
+        entries[i].Id = id;
+        entries[i].Value = value;
+        count++;
+        return true;
+    }
+
+    bool Erase( uint id )
+    {
+        int slot = FindSlot( id );
+        if( slot < 0 )
+            return false;
+
+        // Move back entries which probe sequence passes through freed slot
+        uint mask = (uint)entries.size() - 1;
+        uint i = (uint)slot;
+        for( uint j = (i + 1) & mask; entries[j].Id; j = (j + 1) & mask )
+        {
+            uint home = Home( entries[j].Id );
+            if( ( (j - home) & mask ) >= ( (j - i) & mask ) )
+            {
+                entries[i] = entries[j];
+                i = j;
+            }
+        }
+        entries[i].Id = 0;
+        count--;
+        return true;
+    }
+
+    void Clear()
+    {
+        if( !count )
+            return;
+        for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+            it->Id = 0;
+        count = 0;
+    }
+
+    void GetIds( UIntVec& ids ) const
+    {
+        ids.reserve( ids.size() + count );
+        for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+            if( it->Id )
+                ids.push_back( it->Id );
+    }
+};
+
+class IdSet : public IdMap<bool>
+{
+public:
+    bool Insert( uint id ) { return IdMap<bool>::Insert( id, true ); }
+};
+
+#endif // __ID_SET__
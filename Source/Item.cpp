@@ -55,6 +55,7 @@ Item::Item()
     memzero( this, OFFSETOF( Item, IsNotValid ) );
     # elif defined (FOCLASSIC_SERVER)
     memzero( this, sizeof(Item) );
+    Sync.SetType( SYNC_OBJECT_ITEM );
     # endif
     RefCounter = 1;
     IsNotValid = false;
@@ -359,6 +360,9 @@ void Item::Count_Set( uint val )
     else if( Data.Count < val )
         ItemMngr.AddItemStatistics( GetProtoId(), val - Data.Count );
     Data.Count = val;
+    #ifdef FOCLASSIC_SERVER
+    SetJournalDirty();
+    #endif
 }
 
 void Item::Count_Add( uint val )
@@ -368,6 +372,9 @@ void Item::Count_Add( uint val )
 
     Data.Count += val;
     ItemMngr.AddItemStatistics( GetProtoId(), val );
+    #ifdef FOCLASSIC_SERVER
+    SetJournalDirty();
+    #endif
 }
 
 void Item::Count_Sub( uint val )
@@ -379,6 +386,9 @@ void Item::Count_Sub( uint val )
         val = Data.Count;
     Data.Count -= val;
     ItemMngr.SubItemStatistics( GetProtoId(), val );
+    #ifdef FOCLASSIC_SERVER
+    SetJournalDirty();
+    #endif
 }
 
 #ifdef FOCLASSIC_SERVER
@@ -392,6 +402,7 @@ void Item::Repair()
     {
         UNSETFLAG( flags, BI_BROKEN );
         deterioration = 0;
+        SetJournalDirty();
     }
 }
 #endif
@@ -456,6 +467,9 @@ void Item::SetMode( uchar mode )
         mode = (aim << 4) | (use & 0xF);
     }
     Data.Mode = mode;
+    #ifdef FOCLASSIC_SERVER
+    SetJournalDirty();
+    #endif
 }
 
 uint Item::GetCost1st()
@@ -476,6 +490,7 @@ uint Item::GetCost1st()
 #ifdef FOCLASSIC_SERVER
 void Item::SetLexems( const char* lexems )
 {
+    SetJournalDirty();
     if( lexems )
     {
         uint len = Str::Length( lexems );
@@ -512,6 +527,9 @@ void Item::WeapLoadHolder()
     if( !Data.AmmoPid )
         Data.AmmoPid = Proto->Weapon_DefaultAmmoPid;
     Data.AmmoCount = Proto->Weapon_MaxAmmoCount;
+    #ifdef FOCLASSIC_SERVER
+    SetJournalDirty();
+    #endif
 }
 
 #ifdef FOCLASSIC_SERVER
@@ -564,6 +582,7 @@ void Item::ContSetItem( Item* item )
     ChildItems->push_back( item );
     item->Accessory = ITEM_ACCESSORY_CONTAINER;
     item->AccContainer.ContainerId = GetId();
+    item->SetJournalDirty();
 }
 
 void Item::ContEraseItem( Item* item )
@@ -591,6 +610,7 @@ void Item::ContEraseItem( Item* item )
         WriteLogF( _FUNC_, " - Item not found, id<%u>, pid<%u>, container<%u>.\n", item->GetId(), item->GetProtoId(), GetId() );
 
     item->Accessory = 0xd3;
+    item->SetJournalDirty();
 
     if( ChildItems->empty() )
         SAFEDEL( ChildItems );
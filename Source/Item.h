@@ -9,6 +9,10 @@
 #include "ThreadSync.h"
 #include "Types.h"
 
+#ifdef FOCLASSIC_SERVER
+# include "WorldJournal.h"
+#endif
+
 class Critter;
 class MapObject;
 
@@ -295,6 +299,7 @@ public:
     ItemPtrVec* ChildItems;
     char*       PLexems;
     SyncObject  Sync;
+    uint        JournalGen; // Generation of last change report to world journal
     #endif
     #ifdef FOCLASSIC_CLIENT
     ScriptString Lexems;
@@ -311,6 +316,15 @@ public:
     void Release() { if( --RefCounter <= 0 ) delete this; }
 
     #ifdef FOCLASSIC_SERVER
+    void SetJournalDirty()
+    {
+        if( JournalGen != WorldJournal::DirtyGeneration && Id )
+        {
+            JournalGen = WorldJournal::DirtyGeneration;
+            WorldJournal::SetDirty( WORLD_SECTION_ITEMS, 0, Id );
+        }
+    }
+
     void FullClear();
 
     bool ParseScript( const char* script, bool first_time );
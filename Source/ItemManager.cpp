@@ -72,6 +72,7 @@ void ItemManager::Finish()
         item->Release();
     }
     gameItems.clear();
+    itemRegistry.Clear();
     #endif
 
     Clear();
@@ -87,7 +88,8 @@ void ItemManager::Clear()
     for( auto it = gameItems.begin(), end = gameItems.end(); it != end; ++it )
         SAFEREL( (*it).second );
     gameItems.clear();
-    radioItems.clear();
+    itemRegistry.Clear();
+    radioChannels.clear();
     itemToDelete.clear();
     itemToDeleteCount.clear();
     lastItemId = 0;
@@ -592,30 +594,52 @@ void ItemManager::ClearProto( ushort pid )
 }
 
 #ifdef FOCLASSIC_SERVER
-void ItemManager::SaveAllItemsFile( void (*save_func)( void*, size_t ) )
+static void SaveItemRecord( Item* item, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    if( record_func )
+        record_func();
+    save_func( &item->Id, sizeof(item->Id) );
+    save_func( &item->Proto->ProtoId, sizeof(item->Proto->ProtoId) );
+    save_func( &item->Accessory, sizeof(item->Accessory) );
+    save_func( &item->AccBuffer[0], sizeof(item->AccBuffer) );
+    save_func( &item->Data, sizeof(item->Data) );
+    if( item->PLexems )
+    {
+        uchar lex_len = Str::Length( item->PLexems );
+        save_func( &lex_len, sizeof(lex_len) );
+        save_func( item->PLexems, lex_len );
+    }
+    else
+    {
+        uchar zero = 0;
+        save_func( &zero, sizeof(zero) );
+    }
+}
+
+void ItemManager::SaveAllItemsFile( void (*save_func)( void*, size_t ), void (*record_func)() )
 {
     uint count = (uint)gameItems.size();
     save_func( &count, sizeof(count) );
     for( auto it = gameItems.begin(), end = gameItems.end(); it != end; ++it )
+        SaveItemRecord( (*it).second, save_func, record_func );
+}
+
+void ItemManager::SaveItemsRecords( const UIntVec& ids, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    // Erased items are missed, journal writes erase records for them
+    ItemPtrVec items;
+    items.reserve( ids.size() );
+    for( auto it = ids.begin(), end = ids.end(); it != end; ++it )
     {
-        Item* item = (*it).second;
-        save_func( &item->Id, sizeof(item->Id) );
-        save_func( &item->Proto->ProtoId, sizeof(item->Proto->ProtoId) );
-        save_func( &item->Accessory, sizeof(item->Accessory) );
-        save_func( &item->AccBuffer[0], sizeof(item->AccBuffer) );
-        save_func( &item->Data, sizeof(item->Data) );
-        if( item->PLexems )
-        {
-            uchar lex_len = Str::Length( item->PLexems );
-            save_func( &lex_len, sizeof(lex_len) );
-            save_func( item->PLexems, lex_len );
-        }
-        else
-        {
-            uchar zero = 0;
-            save_func( &zero, sizeof(zero) );
-        }
+        auto it_item = gameItems.find( *it );
+        if( it_item != gameItems.end() )
+            items.push_back( (*it_item).second );
     }
+
+    uint count = (uint)items.size();
+    save_func( &count, sizeof(count) );
+    for( auto it = items.begin(), end = items.end(); it != end; ++it )
+        SaveItemRecord( *it, save_func, record_func );
 }
 
 bool ItemManager::LoadAllItemsFile( void* f, int version )
@@ -805,7 +829,8 @@ Item* ItemManager::CreateItem( ushort pid, uint count, uint item_id /* = 0 */ )
 
     // Main collection
     itemLocker.Lock();
-    gameItems.insert( PAIR( item->Id, item ) );
+    if( gameItems.insert( PAIR( item->Id, item ) ).second )
+        itemRegistry.Add( item->Id, item );
     itemLocker.Unlock();
 
     // Radio collection
@@ -860,13 +885,7 @@ Item* ItemManager::SplitItem( Item* item, uint count )
 
 Item* ItemManager::GetItem( uint item_id, bool sync_lock )
 {
-    Item* item = NULL;
-
-    itemLocker.Lock();
-    auto it = gameItems.find( item_id );
-    if( it != gameItems.end() )
-        item = (*it).second;
-    itemLocker.Unlock();
+    Item* item = itemRegistry.Get( item_id );
 
     if( item && sync_lock )
         SYNC_LOCK( item );
@@ -906,6 +925,7 @@ void ItemManager::ItemGarbager()
             }
             Item* item = (*it).second;
             gameItems.erase( it );
+            itemRegistry.Erase( id );
             itemLocker.Unlock();
 
             // Synchronize
@@ -915,7 +935,8 @@ void ItemManager::ItemGarbager()
             if( item->IsStackable() && item->GetCount() > count )
             {
                 itemLocker.Lock();
-                gameItems.insert( PAIR( item->Id, item ) );
+                if( gameItems.insert( PAIR( item->Id, item ) ).second )
+                    itemRegistry.Add( item->Id, item );
                 itemLocker.Unlock();
 
                 item->Count_Sub( count );
@@ -952,6 +973,8 @@ void ItemManager::ItemGarbager()
 
 void ItemManager::NotifyChangeItem( Item* item )
 {
+    item->SetJournalDirty();
+
     switch( item->Accessory )
     {
         case ITEM_ACCESSORY_CRITTER:
@@ -1420,22 +1443,73 @@ bool ItemManager::MoveItemsContToCritter( Item* from_cont, Critter* to_cr, uint
     return true;
 }
 
+void ItemManager::RadioErase( Item* radio )
+{
+    // Must be called with locked radioItemsLocker
+    for( auto it = radioChannels.begin(); it != radioChannels.end();)
+    {
+        ItemPtrVec& radios = it->second;
+        auto        it_radio = std::find( radios.begin(), radios.end(), radio );
+        if( it_radio != radios.end() )
+            radios.erase( it_radio );
+        if( radios.empty() )
+            radioChannels.erase( it++ );
+        else
+            ++it;
+    }
+}
+
 void ItemManager::RadioRegister( Item* radio, bool add )
 {
     SCOPE_LOCK( radioItemsLocker );
 
-    auto it = std::find( radioItems.begin(), radioItems.end(), radio );
-
     if( add )
     {
-        if( it == radioItems.end() )
-            radioItems.push_back( radio );
+        ItemPtrVec& radios = radioChannels[radio->Data.RadioChannel];
+        if( std::find( radios.begin(), radios.end(), radio ) == radios.end() )
+            radios.push_back( radio );
+        return;
     }
-    else
+
+    auto it_channel = radioChannels.find( radio->Data.RadioChannel );
+    if( it_channel != radioChannels.end() )
     {
-        if( it != radioItems.end() )
-            radioItems.erase( it );
+        ItemPtrVec& radios = it_channel->second;
+        auto        it = std::find( radios.begin(), radios.end(), radio );
+        if( it != radios.end() )
+        {
+            radios.erase( it );
+            if( radios.empty() )
+                radioChannels.erase( it_channel );
+            return;
+        }
     }
+
+    // Channel changed after registration
+    RadioErase( radio );
+}
+
+void ItemManager::RadioSetChannel( Item* radio, ushort channel )
+{
+    SCOPE_LOCK( radioItemsLocker );
+
+    ushort old_channel = radio->Data.RadioChannel;
+    radio->Data.RadioChannel = channel;
+    if( old_channel == channel )
+        return;
+
+    // Move registered radio to new channel
+    auto it_channel = radioChannels.find( old_channel );
+    if( it_channel == radioChannels.end() )
+        return;
+    ItemPtrVec& radios = it_channel->second;
+    auto        it = std::find( radios.begin(), radios.end(), radio );
+    if( it == radios.end() )
+        return;
+    radios.erase( it );
+    if( radios.empty() )
+        radioChannels.erase( it_channel );
+    radioChannels[channel].push_back( radio );
 }
 
 void ItemManager::RadioSendText( Critter* cr, const char* text, ushort text_len, bool unsafe_text, ushort text_msg, uint num_str, UShortVec& channels )
@@ -1480,9 +1554,18 @@ void ItemManager::RadioSendTextEx( ushort channel, int broadcast_type, uint from
     uint broadcast_map_id = 0;
     uint broadcast_loc_id = 0;
 
-    // Get copy of all radios
+    // Get copy of channel radios
+    static THREAD ItemPtrVec* radio_items_ = NULL;
+    if( !radio_items_ )
+        radio_items_ = new ItemPtrVec();
+    ItemPtrVec& radio_items = *radio_items_;
+
     radioItemsLocker.Lock();
-    ItemPtrVec radio_items = radioItems;
+    auto it_channel = radioChannels.find( channel );
+    if( it_channel != radioChannels.end() )
+        radio_items = it_channel->second;
+    else
+        radio_items.clear();
     radioItemsLocker.Unlock();
 
     // Multiple sending controlling
@@ -1495,7 +1578,24 @@ void ItemManager::RadioSendTextEx( ushort channel, int broadcast_type, uint from
     {
         Item* radio = *it;
 
-        if( radio->Data.RadioChannel == channel && radio->RadioIsRecvActive() )
+        // Channel changed without RadioSetChannel, move to actual channel
+        if( radio->Data.RadioChannel != channel )
+        {
+            SCOPE_LOCK( radioItemsLocker );
+
+            ItemPtrVec& radios = radioChannels[channel];
+            auto        it_radio = std::find( radios.begin(), radios.end(), radio );
+            if( it_radio != radios.end() )
+            {
+                radios.erase( it_radio );
+                radioChannels[radio->Data.RadioChannel].push_back( radio );
+            }
+            if( radios.empty() )
+                radioChannels.erase( channel );
+            continue;
+        }
+
+        if( radio->RadioIsRecvActive() )
         {
             if( broadcast_type != RADIO_BROADCAST_FORCE_ALL && radio->Data.RadioBroadcastRecv != RADIO_BROADCAST_FORCE_ALL )
             {
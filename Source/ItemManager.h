@@ -6,6 +6,10 @@
 #include "Mutex.h"
 #include "Types.h"
 
+#ifdef FOCLASSIC_SERVER
+# include "Registry.h"
+#endif
+
 #ifdef FOCLASSIC_SERVER
 class Critter;
 class Map;
@@ -50,14 +54,16 @@ public:
 
     #ifdef FOCLASSIC_SERVER
 private:
-    ItemPtrMap gameItems;
-    UIntVec    itemToDelete;
-    UIntVec    itemToDeleteCount;
-    uint       lastItemId;
-    Mutex      itemLocker;
+    ItemPtrMap     gameItems;
+    Registry<Item> itemRegistry;
+    UIntVec        itemToDelete;
+    UIntVec        itemToDeleteCount;
+    uint           lastItemId;
+    Mutex          itemLocker;
 
 public:
-    void SaveAllItemsFile( void (*save_func)( void*, size_t ) );
+    void SaveAllItemsFile( void (*save_func)( void*, size_t ), void (*record_func)() = NULL );
+    void SaveItemsRecords( const UIntVec& ids, void (*save_func)( void*, size_t ), void (*record_func)() = NULL ); // Delta save, only given items
     bool LoadAllItemsFile( void* f, int version );
     bool CheckProtoFunctions();
     void RunInitScriptItems();
@@ -71,6 +77,8 @@ public:
     Item* SplitItem( Item* item, uint count );
     Item* GetItem( uint item_id, bool sync_lock );
 
+    string GetRegistryStatisticsString() { return itemRegistry.GetStatisticsString( "Items" ); }
+
     void ItemToGarbage( Item* item );
     void ItemGarbager();
 
@@ -93,11 +101,14 @@ public:
 
     // Radio
 private:
-    ItemPtrVec radioItems;
-    Mutex      radioItemsLocker;
+    map<ushort, ItemPtrVec> radioChannels; // Radios by channel
+    Mutex                   radioItemsLocker;
+
+    void RadioErase( Item* radio );
 
 public:
     void RadioRegister( Item* radio, bool add );
+    void RadioSetChannel( Item* radio, ushort channel );
     void RadioSendText( Critter* cr, const char* text, ushort text_len, bool unsafe_text, ushort text_msg, uint num_str, UShortVec& channels );
     void RadioSendTextEx( ushort channel, int broadcast_type, uint from_map_id, ushort from_wx, ushort from_wy, const char* text, ushort text_len, ushort intellect, bool unsafe_text, ushort text_msg, uint num_str, const char* lexems );
     #endif // FOCLASSIC_SERVER
@@ -5,13 +5,197 @@
 #include "Mutex.h"
 #include "Map.h"
 #include "Item.h"
+#include "Log.h"
+#include "Text.h"
 #include "Thread.h"
+#include "Timer.h"
 #include "Vars.h"
 
-static Mutex JobLocker; // Defense code from simultaneously execution
-
 typedef deque<Job> JobDeque;
-static JobDeque Jobs;
+
+// Shared queue, used by non-logic threads and for jobs which can't be owned by one thread
+static Mutex         JobLocker; // Defense code from simultaneously execution
+static JobDeque      Jobs;
+static volatile long JobsSharedCount = 0;
+static volatile long JobsCount = 0;
+
+// Local queue of logic thread
+// Critter, map and client jobs stay in queue of thread which processed them last,
+// idle threads steal them from most loaded queue
+struct JobQueue
+{
+    Mutex         Locker;
+    JobDeque      Jobs;
+    volatile uint ThreadId;
+    volatile long Depth;
+    uint          DepthMax;
+    uint          Steals;
+    uint          Stolen;
+    uint          SharedInterval;
+    uint          SharedStreak;
+};
+
+static JobQueue      JobQueues[MAX_JOB_THREADS];
+static volatile long JobQueuesCount = 0;
+static Mutex         JobQueuesLocker;
+static THREAD JobQueue* CurJobQueue = NULL;
+
+// Delayed jobs, sorted by fast tick of release
+// Owner of job keeps release tick, to find and wake up job before deadline
+struct DelayedJob
+{
+    Job            DJob;
+    volatile uint* DelayTick;
+};
+typedef multimap<uint, DelayedJob> DelayedJobMap;
+
+static Mutex         DelayedJobsLocker;
+static DelayedJobMap DelayedJobs;
+static volatile uint DelayedJobsNextTick = MAX_UINT;
+static volatile long DelayedJobsCount = 0;
+
+static bool IsJobStealable( const Job& job )
+{
+    return !job.ThreadId && (job.Type == JOB_CRITTER || job.Type == JOB_MAP || job.Type == JOB_CLIENT);
+}
+
+static JobQueue* GetJobQueue( uint thread_id )
+{
+    if( CurJobQueue && CurJobQueue->ThreadId == thread_id )
+        return CurJobQueue;
+
+    for( long i = 0, j = JobQueuesCount; i < j; i++ )
+        if( JobQueues[i].ThreadId == thread_id )
+            return &JobQueues[i];
+    return NULL;
+}
+
+static void PushJobQueue( JobQueue* queue, const Job& job, bool front )
+{
+    SCOPE_LOCK( queue->Locker );
+
+    if( front )
+        queue->Jobs.push_front( job );
+    else
+        queue->Jobs.push_back( job );
+    queue->Depth = (long)queue->Jobs.size();
+    if( (uint)queue->Depth > queue->DepthMax )
+        queue->DepthMax = (uint)queue->Depth;
+}
+
+static bool PopJobQueue( JobQueue* queue, Job& job )
+{
+    SCOPE_LOCK( queue->Locker );
+
+    if( queue->Jobs.empty() )
+        return false;
+
+    job = queue->Jobs.front();
+    queue->Jobs.pop_front();
+    queue->Depth = (long)queue->Jobs.size();
+    return true;
+}
+
+static bool PopJobShared( Job& job )
+{
+    if( !JobsSharedCount )
+        return false;
+
+    SCOPE_LOCK( JobLocker );
+
+    if( Jobs.empty() )
+        return false;
+
+    // Check owner
+    uint tid = Thread::GetCurrentId();
+    for( auto it = Jobs.begin(); it != Jobs.end(); ++it )
+    {
+        Job& job_ = *it;
+        if( !job_.ThreadId || job_.ThreadId == tid )
+        {
+            job = job_;
+            Jobs.erase( it );
+            InterlockedDecrement( &JobsSharedCount );
+            return true;
+        }
+    }
+    return false;
+}
+
+// Take up to 'count' stealable jobs from the back of most loaded queue
+static uint StealJobs( JobQueue* thief, uint count, Job* first_job )
+{
+    JobQueue* victim = NULL;
+    long      victim_depth = 0;
+    for( long i = 0, j = JobQueuesCount; i < j; i++ )
+    {
+        JobQueue* queue = &JobQueues[i];
+        if( queue != thief && queue->ThreadId && queue->Depth > victim_depth )
+        {
+            victim = queue;
+            victim_depth = queue->Depth;
+        }
+    }
+    if( !victim )
+        return 0;
+
+    JobDeque stolen;
+    victim->Locker.Lock();
+    for( auto it = victim->Jobs.end(); it != victim->Jobs.begin() && stolen.size() < count;)
+    {
+        --it;
+        if( IsJobStealable( *it ) )
+        {
+            stolen.push_front( *it );
+            it = victim->Jobs.erase( it );
+        }
+    }
+    victim->Depth = (long)victim->Jobs.size();
+    victim->Stolen += (uint)stolen.size();
+    victim->Locker.Unlock();
+
+    if( stolen.empty() )
+        return 0;
+
+    uint stolen_count = (uint)stolen.size();
+    if( first_job )
+    {
+        *first_job = stolen.front();
+        stolen.pop_front();
+    }
+
+    thief->Locker.Lock();
+    thief->Jobs.insert( thief->Jobs.end(), stolen.begin(), stolen.end() );
+    thief->Depth = (long)thief->Jobs.size();
+    if( (uint)thief->Depth > thief->DepthMax )
+        thief->DepthMax = (uint)thief->Depth;
+    thief->Steals += stolen_count;
+    thief->Locker.Unlock();
+    return stolen_count;
+}
+
+// Called once per thread cycle, pulls work from most loaded queue and
+// recalculates how often shared queue must be visited
+static void BalanceJobQueue( JobQueue* queue )
+{
+    long max_depth = 0;
+    long queues = 0;
+    for( long i = 0, j = JobQueuesCount; i < j; i++ )
+    {
+        if( JobQueues[i].ThreadId )
+        {
+            max_depth = MAX( max_depth, JobQueues[i].Depth );
+            queues++;
+        }
+    }
+
+    if( max_depth > queue->Depth + 1 )
+        StealJobs( queue, (uint)(max_depth - queue->Depth) / 2, NULL );
+
+    // Each shared job must be processed approximately once per cycle of all threads
+    long shared = JobsSharedCount;
+    queue->SharedInterval = (uint)(shared ? queue->Depth * queues / shared : queue->Depth);
+}
 
 Job::Job() : Type( JOB_NOP ),
     Data( NULL ),
@@ -26,87 +210,370 @@ Job::Job( int type, void* data, bool cur_thread ) : Type( type ),
         ThreadId = Thread::GetCurrentId();
 }
 
-void Job::PushBack( int type )
+static void ReleaseDelayedJobs()
 {
-    SCOPE_LOCK( JobLocker );
+    if( Timer::FastTick() < DelayedJobsNextTick )
+        return;
+
+    // Released by other thread
+    if( !DelayedJobsLocker.TryLock() )
+        return;
 
-    Jobs.push_back( Job( type, NULL, 0 ) );
+    uint tick = Timer::FastTick();
+    auto it = DelayedJobs.begin(), end = DelayedJobs.end();
+    for( ; it != end && it->first <= tick; ++it )
+    {
+        *it->second.DelayTick = 0;
+        InterlockedDecrement( &DelayedJobsCount );
+        Job::PushBack( it->second.DJob );
+    }
+    DelayedJobs.erase( DelayedJobs.begin(), it );
+    DelayedJobsNextTick = (DelayedJobs.empty() ? MAX_UINT : DelayedJobs.begin()->first);
+
+    DelayedJobsLocker.Unlock();
 }
 
-void Job::PushBack( int type, void* data )
+void Job::PushBack( int type )
 {
-    SCOPE_LOCK( JobLocker );
+    PushBack( Job( type, NULL, false ) );
+}
 
-    Jobs.push_back( Job( type, data, 0 ) );
+void Job::PushBack( int type, void* data )
+{
+    PushBack( Job( type, data, false ) );
 }
 
 uint Job::PushBack( const Job& job )
 {
-    SCOPE_LOCK( JobLocker );
+    JobQueue* queue = (job.ThreadId ? GetJobQueue( job.ThreadId ) : (IsJobStealable( job ) ? CurJobQueue : NULL) );
+    if( queue )
+    {
+        PushJobQueue( queue, job, false );
+    }
+    else
+    {
+        SCOPE_LOCK( JobLocker );
+
+        Jobs.push_back( job );
+        InterlockedIncrement( &JobsSharedCount );
+    }
 
-    Jobs.push_back( job );
-    uint size = (uint)Jobs.size();
-    return size;
+    return (uint)InterlockedIncrement( &JobsCount );
 }
 
 void Job::PushFront( const Job& job )
 {
-    SCOPE_LOCK( JobLocker );
+    JobQueue* queue = (job.ThreadId ? GetJobQueue( job.ThreadId ) : (IsJobStealable( job ) ? CurJobQueue : NULL) );
+    if( queue )
+    {
+        PushJobQueue( queue, job, true );
+    }
+    else
+    {
+        SCOPE_LOCK( JobLocker );
+
+        Jobs.push_front( job );
+        InterlockedIncrement( &JobsSharedCount );
+    }
 
-    Jobs.push_front( job );
+    InterlockedIncrement( &JobsCount );
 }
 
 Job Job::PopFront()
 {
-    SCOPE_LOCK( JobLocker );
+    Job       job;
+    JobQueue* queue = CurJobQueue;
 
-    if( Jobs.empty() )
-        return Job( JOB_NOP, NULL, false );
+    // Return delayed jobs which deadline reached
+    ReleaseDelayedJobs();
 
-    Job job = Jobs.front();
-
-    // Check owner
-    uint tid = Thread::GetCurrentId();
-    if( job.ThreadId && job.ThreadId != tid )
+    // Thread without own queue
+    if( !queue )
     {
-        for( auto it = Jobs.begin() + 1; it != Jobs.end(); ++it )
+        if( PopJobShared( job ) )
         {
-            Job& job_ = *it;
-            if( !job_.ThreadId || job_.ThreadId == tid )
-            {
-                Job job__ = job_;
-                Jobs.erase( it );
-                return job__;
-            }
+            InterlockedDecrement( &JobsCount );
+            return job;
         }
         return Job( JOB_NOP, NULL, false );
     }
 
-    Jobs.pop_front();
-    return job;
+    // Visit shared queue
+    if( queue->SharedStreak >= queue->SharedInterval )
+    {
+        queue->SharedStreak = 0;
+        if( PopJobShared( job ) )
+        {
+            InterlockedDecrement( &JobsCount );
+            return job;
+        }
+    }
+
+    // Own jobs
+    if( PopJobQueue( queue, job ) )
+    {
+        queue->SharedStreak++;
+        if( job.Type == JOB_THREAD_LOOP )
+            BalanceJobQueue( queue );
+        InterlockedDecrement( &JobsCount );
+        return job;
+    }
+
+    // Nothing to do, look in shared queue and in other threads
+    if( PopJobShared( job ) || StealJobs( queue, 1, &job ) )
+    {
+        InterlockedDecrement( &JobsCount );
+        return job;
+    }
+
+    return Job( JOB_NOP, NULL, false );
 }
 
 void Job::Erase( int type )
 {
-    SCOPE_LOCK( JobLocker );
+    long erased = 0;
 
+    JobLocker.Lock();
     for( auto it = Jobs.begin(); it != Jobs.end();)
     {
         Job& job = *it;
         if( job.Type == type )
+        {
             it = Jobs.erase( it );
+            InterlockedDecrement( &JobsSharedCount );
+            erased++;
+        }
+        else
+            ++it;
+    }
+    JobLocker.Unlock();
+
+    for( long i = 0, j = JobQueuesCount; i < j; i++ )
+    {
+        JobQueue* queue = &JobQueues[i];
+        SCOPE_LOCK( queue->Locker );
+
+        for( auto it = queue->Jobs.begin(); it != queue->Jobs.end();)
+        {
+            Job& job = *it;
+            if( job.Type == type )
+            {
+                it = queue->Jobs.erase( it );
+                erased++;
+            }
+            else
+                ++it;
+        }
+        queue->Depth = (long)queue->Jobs.size();
+    }
+
+    while( erased-- )
+        InterlockedDecrement( &JobsCount );
+
+    DelayedJobsLocker.Lock();
+    for( auto it = DelayedJobs.begin(); it != DelayedJobs.end();)
+    {
+        DelayedJob& djob = it->second;
+        if( djob.DJob.Type == type )
+        {
+            *djob.DelayTick = 0;
+            it = DelayedJobs.erase( it );
+            InterlockedDecrement( &DelayedJobsCount );
+        }
         else
             ++it;
     }
+    DelayedJobsNextTick = (DelayedJobs.empty() ? MAX_UINT : DelayedJobs.begin()->first);
+    DelayedJobsLocker.Unlock();
 }
 
 uint Job::Count()
 {
-    SCOPE_LOCK( JobLocker );
-    uint count = (uint)Jobs.size();
+    return (uint)JobsCount;
+}
+
+uint Job::PushDelayed( const Job& job, uint delay, volatile uint& delay_tick )
+{
+    uint tick = Timer::FastTick() + MIN( delay, JOB_DELAY_MAX );
+    if( !tick || tick == JOB_DELAY_WAKEUP )
+        tick = 1;
+
+    SCOPE_LOCK( DelayedJobsLocker );
+
+    // Woken up while job was processed, return it to queue at once
+    // Exchanged atomically, WakeUp marks not delayed jobs without lock
+    uint prev_tick = (uint)InterlockedCompareExchange( (volatile long*)&delay_tick, (long)tick, 0 );
+    if( prev_tick == JOB_DELAY_WAKEUP )
+    {
+        delay_tick = 0;
+        return PushBack( job );
+    }
+    if( prev_tick )
+        delay_tick = tick;
+
+    DelayedJob djob;
+    djob.DJob = job;
+    djob.DelayTick = &delay_tick;
+    DelayedJobs.insert( PAIR( tick, djob ) );
+    if( tick < DelayedJobsNextTick )
+        DelayedJobsNextTick = tick;
+    InterlockedIncrement( &DelayedJobsCount );
+    return (uint)JobsCount;
+}
+
+bool Job::WakeUp( const Job& job, volatile uint& delay_tick )
+{
+    // Not delayed or already released, remember wakeup for next PushDelayed
+    // Common case, done without lock, fails only if job was delayed meanwhile
+    uint tick = delay_tick;
+    if( !tick || tick == JOB_DELAY_WAKEUP )
+    {
+        if( (uint)InterlockedCompareExchange( (volatile long*)&delay_tick, (long)JOB_DELAY_WAKEUP, (long)tick ) == tick )
+            return false;
+    }
+
+    SCOPE_LOCK( DelayedJobsLocker );
+
+    tick = delay_tick;
+    if( !tick || tick == JOB_DELAY_WAKEUP )
+    {
+        delay_tick = JOB_DELAY_WAKEUP;
+        return false;
+    }
+
+    for( auto it = DelayedJobs.lower_bound( tick ), end = DelayedJobs.end(); it != end && it->first == tick; ++it )
+    {
+        DelayedJob& djob = it->second;
+        if( djob.DelayTick == &delay_tick && djob.DJob.Type == job.Type )
+        {
+            Job wjob = djob.DJob;
+            DelayedJobs.erase( it );
+            DelayedJobsNextTick = (DelayedJobs.empty() ? MAX_UINT : DelayedJobs.begin()->first);
+            InterlockedDecrement( &DelayedJobsCount );
+            delay_tick = 0;
+            PushBack( wjob );
+            return true;
+        }
+    }
+
+    InterlockedCompareExchange( (volatile long*)&delay_tick, 0, (long)tick );
+    return false;
+}
+
+uint Job::DelayedCount()
+{
+    return (uint)DelayedJobsCount;
+}
+
+bool Job::RegisterThread()
+{
+    if( CurJobQueue )
+        return true;
+
+    SCOPE_LOCK( JobQueuesLocker );
+
+    // Reuse queue of finished thread
+    JobQueue* queue = NULL;
+    for( long i = 0; i < JobQueuesCount; i++ )
+    {
+        if( !JobQueues[i].ThreadId )
+        {
+            queue = &JobQueues[i];
+            break;
+        }
+    }
+
+    if( !queue )
+    {
+        if( JobQueuesCount >= MAX_JOB_THREADS )
+        {
+            WriteLogF( _FUNC_, " - Job queues limit<%u> reached, thread<%s> will use shared queue.\n", MAX_JOB_THREADS, Thread::GetCurrentName() );
+            return false;
+        }
+        queue = &JobQueues[JobQueuesCount];
+    }
+
+    queue->Locker.Lock();
+    queue->Jobs.clear();
+    queue->Depth = 0;
+    queue->DepthMax = 0;
+    queue->Steals = 0;
+    queue->Stolen = 0;
+    queue->SharedInterval = 0;
+    queue->SharedStreak = 0;
+    queue->ThreadId = Thread::GetCurrentId();
+    queue->Locker.Unlock();
+
+    if( queue == &JobQueues[JobQueuesCount] )
+        InterlockedIncrement( &JobQueuesCount );
+
+    CurJobQueue = queue;
+    return true;
+}
+
+void Job::UnregisterThread()
+{
+    JobQueue* queue = CurJobQueue;
+    if( !queue )
+        return;
+
+    SCOPE_LOCK( JobQueuesLocker );
+
+    // Give remaining jobs to other threads, own pinned jobs are dropped
+    queue->Locker.Lock();
+    uint     tid = queue->ThreadId;
+    JobDeque jobs;
+    jobs.swap( queue->Jobs );
+    queue->Depth = 0;
+    queue->ThreadId = 0;
+    queue->Locker.Unlock();
+
+    CurJobQueue = NULL;
+
+    for( auto it = jobs.begin(), end = jobs.end(); it != end; ++it )
+    {
+        InterlockedDecrement( &JobsCount );
+        if( it->ThreadId != tid )
+            PushBack( *it );
+    }
+}
+
+uint Job::GetThreadStatistics( JobThreadStatistics* stats, uint max_count )
+{
+    uint count = 0;
+    for( long i = 0, j = JobQueuesCount; i < j && count < max_count; i++ )
+    {
+        JobQueue* queue = &JobQueues[i];
+        if( !queue->ThreadId )
+            continue;
+
+        JobThreadStatistics& s = stats[count++];
+        s.ThreadId = queue->ThreadId;
+        s.QueueDepth = (uint)queue->Depth;
+        s.QueueDepthMax = queue->DepthMax;
+        s.Steals = queue->Steals;
+        s.Stolen = queue->Stolen;
+    }
     return count;
 }
 
+string Job::GetStatistics()
+{
+    JobThreadStatistics stats[MAX_JOB_THREADS];
+    uint                count = GetThreadStatistics( stats, MAX_JOB_THREADS );
+
+    char   str[MAX_FOTEXT];
+    string result = Str::Format( str, "Jobs: %u, shared: %u, delayed: %u\n", (uint)JobsCount, (uint)JobsSharedCount, (uint)DelayedJobsCount );
+    result += "Thread               Depth     Max       Steals    Stolen\n";
+    for( uint i = 0; i < count; i++ )
+    {
+        const char* name = Thread::FindName( stats[i].ThreadId );
+        result += Str::Format( str, "%-20s %-9u %-9u %-9u %-9u\n", name ? name : "?",
+                               stats[i].QueueDepth, stats[i].QueueDepthMax, stats[i].Steals, stats[i].Stolen );
+    }
+    return result;
+}
+
 // Deferred releasing
 static CrVec      DeferredReleaseCritters;
 static UIntVec    DeferredReleaseCrittersCycle;
@@ -123,6 +590,9 @@ static Mutex      DeferredReleaseLocker;
 
 void Job::DeferredRelease( Critter* cr )
 {
+    // Return delayed job to queue, it must be dropped before releasing
+    cr->WakeUp();
+
     SCOPE_LOCK( DeferredReleaseLocker );
 
     DeferredReleaseCritters.push_back( cr );
@@ -131,6 +601,9 @@ void Job::DeferredRelease( Critter* cr )
 
 void Job::DeferredRelease( Map* map )
 {
+    // Return delayed job to queue, it must be dropped before releasing
+    map->WakeUp();
+
     SCOPE_LOCK( DeferredReleaseLocker );
 
     DeferredReleaseMaps.push_back( map );
@@ -21,6 +21,23 @@
 #define JOB_THREAD_FINISH         (16)
 #define JOB_COUNT                 (17)
 
+// Per-thread job queues
+#define MAX_JOB_THREADS           (64)
+
+struct JobThreadStatistics
+{
+    uint ThreadId;
+    uint QueueDepth;
+    uint QueueDepthMax;
+    uint Steals;
+    uint Stolen;
+};
+
+// Delayed jobs, deadline scheduler
+#define JOB_DELAY_MIN             (50)
+#define JOB_DELAY_MAX             (1000)
+#define JOB_DELAY_WAKEUP          (MAX_UINT) // Delay tick value, wakeup requested while job is not delayed
+
 class Critter;
 class Map;
 class Location;
@@ -45,6 +62,17 @@ public:
     static void Erase( int type );
     static uint Count();
 
+    // Thread queues
+    static bool   RegisterThread();
+    static void   UnregisterThread();
+    static uint   GetThreadStatistics( JobThreadStatistics* stats, uint max_count );
+    static string GetStatistics();
+
+    // Delayed jobs
+    static uint PushDelayed( const Job& job, uint delay, volatile uint& delay_tick );
+    static bool WakeUp( const Job& job, volatile uint& delay_tick );
+    static uint DelayedCount();
+
     // Deferred releasing
     static void DeferredRelease( Critter* cr );
     static void DeferredRelease( Map* cr );
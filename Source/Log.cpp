@@ -25,6 +25,241 @@ bool               LoggingWithThread = false;
 uint               StartLogTime = 0;
 
 void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_list& list );
+void WriteLogOutput( const char* str, bool to_file );
+
+#if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+
+// Asynchronous logging
+// Each thread formats messages into own ring, writer thread takes them in order of sequence numbers and passes to outputs
+# define LOG_RING_SIZE    (0x40000)   // Power of two
+
+struct LogRecord
+{
+    uint Size;                        // Header and text, aligned to 4, zero marks wrap to ring begin
+    uint Seq;
+};
+
+struct LogRing
+{
+    volatile long Head;               // Written only by owner thread
+    volatile long Tail;               // Written only by writer thread
+    char          Data[LOG_RING_SIZE];
+};
+typedef vector<LogRing*> LogRingVec;
+
+struct LogBatchEntry
+{
+    uint Seq;
+    uint Offset;
+    bool operator<( const LogBatchEntry& other ) const { return Seq < other.Seq; }
+};
+typedef vector<LogBatchEntry> LogBatchEntryVec;
+
+static Mutex         LogRingsLocker;
+static LogRingVec    LogRings;
+static LogRingVec    FreeLogRings;            // Rings of finished threads, taken by new threads
+static bool          LogRingKeyCreated = false;
+static pthread_key_t LogRingKey;              // Returns ring to free list on thread exit
+static Mutex         LogFlushLocker;
+static THREAD LogRing* CurLogRing = NULL;
+static THREAD bool   IsLogWriterThread = false;
+static volatile bool LogAsyncEnabled = false;
+static volatile bool LogAsyncStop = false;
+static uint          LogAsyncFlushTime = 0;
+static Thread        LogWriterThread;
+static volatile long LogSequence = 0;
+static volatile long LogAsyncDropped = 0;
+static uint          LogAsyncWritten = 0;     // Changed only by writer
+static uint          LogAsyncBatches = 0;
+
+static void ReleaseLogRing( void* ring )
+{
+    // Not written messages stay in ring, next owner continues from its head
+    SCOPE_LOCK( LogRingsLocker );
+    FreeLogRings.push_back( (LogRing*)ring );
+    CurLogRing = NULL;
+}
+
+static LogRing* GetLogRing()
+{
+    if( CurLogRing )
+        return CurLogRing;
+
+    SCOPE_LOCK( LogRingsLocker );
+
+    if( !LogRingKeyCreated )
+        LogRingKeyCreated = (pthread_key_create( &LogRingKey, ReleaseLogRing ) == 0);
+
+    LogRing* ring;
+    if( !FreeLogRings.empty() )
+    {
+        ring = FreeLogRings.back();
+        FreeLogRings.pop_back();
+    }
+    else
+    {
+        ring = new LogRing();
+        ring->Head = 0;
+        ring->Tail = 0;
+        LogRings.push_back( ring );
+    }
+
+    if( LogRingKeyCreated )
+        pthread_setspecific( LogRingKey, ring );
+    CurLogRing = ring;
+    return ring;
+}
+
+// Never blocks, message is dropped if ring is full
+static void LogRingPush( const char* str )
+{
+    LogRing* ring = GetLogRing();
+    uint     len = Str::Length( str ) + 1;
+    uint     need = (sizeof(LogRecord) + len + 3) & ~3U;
+    uint     head = (uint)ring->Head;
+    uint     pos = head & (LOG_RING_SIZE - 1);
+    uint     free_size = LOG_RING_SIZE - (head - (uint)ring->Tail);
+    uint     waste = (pos + need > LOG_RING_SIZE ? LOG_RING_SIZE - pos : 0);
+
+    if( need + waste > free_size )
+    {
+        InterlockedIncrement( &LogAsyncDropped );
+        return;
+    }
+
+    if( waste )
+    {
+        ( (LogRecord*)&ring->Data[pos] )->Size = 0;
+        head += waste;
+        pos = 0;
+    }
+
+    LogRecord* record = (LogRecord*)&ring->Data[pos];
+    record->Size = need;
+    record->Seq = (uint)InterlockedIncrement( &LogSequence );
+    memcpy( &ring->Data[pos + sizeof(LogRecord)], str, len );
+    InterlockedExchange( &ring->Head, (long)(head + need) );
+}
+
+// Writer thread, or any thread after writer is stopped, under LogFlushLocker
+static void LogRingsFlush()
+{
+    static string           batch;
+    static LogBatchEntryVec entries;
+    batch.clear();
+    entries.clear();
+
+    LogRingsLocker.Lock();
+    LogRingVec rings = LogRings;
+    LogRingsLocker.Unlock();
+
+    for( auto it = rings.begin(), end = rings.end(); it != end; ++it )
+    {
+        LogRing* ring = *it;
+        uint     head = (uint)ring->Head;
+        uint     tail = (uint)ring->Tail;
+        while( tail != head )
+        {
+            uint       pos = tail & (LOG_RING_SIZE - 1);
+            LogRecord* record = (LogRecord*)&ring->Data[pos];
+            if( !record->Size )
+            {
+                tail += LOG_RING_SIZE - pos;
+                continue;
+            }
+
+            LogBatchEntry entry;
+            entry.Seq = record->Seq;
+            entry.Offset = (uint)batch.length();
+            entries.push_back( entry );
+            batch.append( &ring->Data[pos + sizeof(LogRecord)] );
+            batch.push_back( 0 );
+            tail += record->Size;
+        }
+        InterlockedExchange( &ring->Tail, (long)tail );
+    }
+
+    if( entries.empty() )
+        return;
+
+    // Restore order of messages between threads
+    std::sort( entries.begin(), entries.end() );
+
+    SCOPE_LOCK( LogLocker );
+
+    // One file write per batch
+    if( LogFileHandle )
+    {
+        string text;
+        text.reserve( batch.length() );
+        for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+            text.append( &batch[it->Offset] );
+        FileWrite( LogFileHandle, text.c_str(), (uint)text.length() );
+    }
+
+    for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+        WriteLogOutput( &batch[it->Offset], false );
+
+    LogAsyncWritten += (long)entries.size();
+    LogAsyncBatches++;
+}
+
+static void LogWriter( void* )
+{
+    IsLogWriterThread = true;
+    while( !LogAsyncStop )
+    {
+        Thread::Sleep( LogAsyncFlushTime );
+        SCOPE_LOCK( LogFlushLocker );
+        LogRingsFlush();
+    }
+}
+
+void LogAsync( bool enable, uint flush_time /* = 100 */ )
+{
+    if( LogAsyncEnabled )
+    {
+        LogAsyncEnabled = false;
+        LogAsyncStop = true;
+        LogWriterThread.Wait();
+        SCOPE_LOCK( LogFlushLocker );
+        LogRingsFlush();
+    }
+
+    if( enable )
+    {
+        LogAsyncFlushTime = MAX( flush_time, 1U );
+        LogAsyncStop = false;
+        LogAsyncEnabled = true;
+        LogWriterThread.Start( LogWriter, "LogWriter" );
+    }
+}
+
+void LogFlushAsync()
+{
+    // Called by exceptions handler, writer can be in the middle of flush, wait it a bit
+    if( !LogAsyncEnabled || IsLogWriterThread )
+        return;
+    for( int i = 0; i < 10; i++ )
+    {
+        if( LogFlushLocker.TryLock() )
+        {
+            LogRingsFlush();
+            LogFlushLocker.Unlock();
+            return;
+        }
+        Thread::Sleep( 10 );
+    }
+}
+
+void LogGetAsyncStatistics( uint& written, uint& dropped, uint& batches )
+{
+    written = LogAsyncWritten;
+    dropped = (uint)LogAsyncDropped;
+    batches = LogAsyncBatches;
+}
+
+#endif
 
 void LogToFile( const char* fname )
 {
@@ -84,6 +319,10 @@ void LogToDebugOutput( bool enable )
 
 void LogFinish()
 {
+    #if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+    LogAsync( false );
+    #endif
+
     SCOPE_LOCK( LogLocker );
 
     LogToFile( NULL );
@@ -119,10 +358,24 @@ void WriteLogX( const char* frmt, ... )
 
 void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_list& list )
 {
-    SCOPE_LOCK( LogLocker );
-
-    if( LogFunctionsInProcess )
+    #if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+    bool async = LogAsyncEnabled;
+    if( async && IsLogWriterThread && LogFunctionsInProcess )
         return;
+    #else
+    bool async = false;
+    #endif
+
+    // Synchronous output holds lock for formatting, as before
+    if( !async )
+    {
+        LogLocker.Lock();
+        if( LogFunctionsInProcess )
+        {
+            LogLocker.Unlock();
+            return;
+        }
+    }
 
     char str_tid[64] = { 0 };
     char str_time[64] = { 0 };
@@ -172,7 +425,22 @@ void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_lis
     vsnprintf( &str[len], MAX_LOGTEXT - len, frmt, list );
     str[MAX_LOGTEXT - 1] = 0;
 
-    if( LogFileHandle )
+    #if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+    if( async )
+    {
+        LogRingPush( str );
+        return;
+    }
+    #endif
+
+    WriteLogOutput( str, true );
+    LogLocker.Unlock();
+}
+
+// Under LogLocker
+void WriteLogOutput( const char* str, bool to_file )
+{
+    if( to_file && LogFileHandle )
     {
         FileWrite( LogFileHandle, str, Str::Length( str ) );
     }
@@ -25,4 +25,10 @@ void LogWithTime( bool enable );                    // Logging with time
 void LogWithThread( bool enable );                  // Logging with thread name
 void LogGetBuffer( std::string& buf );              // Get buffer, if used LogBuffer
 
+// Asynchronous logging, messages are formatted by caller thread into own ring and written by separate thread each flush_time ms
+// Message is dropped if ring of thread is full, disabling writes rest of messages
+void LogAsync( bool enable, unsigned int flush_time = 100 );
+void LogFlushAsync();                               // Write messages from rings now, called before crash dump
+void LogGetAsyncStatistics( unsigned int& written, unsigned int& dropped, unsigned int& batches );
+
 #endif // __LOG__
@@ -0,0 +1,476 @@
+#include "Core.h"
+
+#include <signal.h>
+#ifndef FO_WINDOWS
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+#include "Bot.h"
+#include "CommandLine.h"
+#include "Log.h"
+#include "Text.h"
+#include "Thread.h"
+#include "Timer.h"
+
+// Benchmark stage, bots count changes from previous stage during ramp time and then is held
+struct BotStage
+{
+    string Name;
+    uint   Actions;
+    uint   Bots;
+    uint   Time; // Seconds
+};
+typedef vector<BotStage> BotStageVec;
+
+static BotOptions    Options;
+static BotVec        Bots;
+static uint          BotThreadsCount = 0;
+static volatile long ActiveBots = 0;
+static volatile long ActiveActions = 0;
+static volatile bool BotThreadsFinish = false;
+
+#ifdef FO_WINDOWS
+static PROCESS_INFORMATION ServerProcess;
+#else
+static pid_t               ServerPid = 0;
+#endif
+static ushort              ServerAdminPort = 0;
+static string              ServerAdminKey;
+static uint                ServerStopWait = 0;
+
+static void BotThread( void* data )
+{
+    uint thread_index = (uint)(size_t)data;
+    while( !BotThreadsFinish )
+    {
+        uint tick = Timer::FastTick();
+        uint active = (uint)ActiveBots;
+        uint actions = (uint)ActiveActions;
+        for( uint i = thread_index; i < Bots.size(); i += BotThreadsCount )
+        {
+            if( i < active )
+                Bots[i]->Process( tick, actions );
+            else
+                Bots[i]->Stop();
+        }
+        Thread::Sleep( 1 );
+    }
+
+    for( uint i = thread_index; i < Bots.size(); i += BotThreadsCount )
+        Bots[i]->Stop();
+}
+
+// Format: actions:bots:seconds, actions are login, walk, chat, combat joined by '+'
+static bool ParseStage( const string& str, BotStage& stage )
+{
+    StrVec parts;
+    Str::ParseLine( str.c_str(), ':', parts, Str::ParseLineDummy );
+    if( parts.size() != 3 || !Str::IsNumber( parts[1].c_str() ) || !Str::IsNumber( parts[2].c_str() ) )
+        return false;
+
+    StrVec actions;
+    Str::ParseLine( parts[0].c_str(), '+', actions, Str::ParseLineDummy );
+    stage.Name = parts[0];
+    stage.Actions = 0;
+    for( auto it = actions.begin(), end = actions.end(); it != end; ++it )
+    {
+        if( Str::CompareCase( it->c_str(), "walk" ) )
+            stage.Actions |= BOT_ACTION_WALK;
+        else if( Str::CompareCase( it->c_str(), "chat" ) )
+            stage.Actions |= BOT_ACTION_CHAT;
+        else if( Str::CompareCase( it->c_str(), "combat" ) )
+            stage.Actions |= BOT_ACTION_COMBAT;
+        else if( !Str::CompareCase( it->c_str(), "login" ) )
+            return false;
+    }
+    stage.Bots = Str::AtoUI( parts[1].c_str() );
+    stage.Time = Str::AtoUI( parts[2].c_str() );
+    return true;
+}
+
+static bool FillSockAddr( sockaddr_in& saddr, const char* host, ushort port )
+{
+    memzero( &saddr, sizeof(saddr) );
+    saddr.sin_family = AF_INET;
+    saddr.sin_port = htons( port );
+    if( (saddr.sin_addr.s_addr = inet_addr( host ) ) == uint( -1 ) )
+    {
+        hostent* h = gethostbyname( host );
+        if( !h )
+        {
+            WriteLog( "Can't resolve remote host<%s>, error<%s>.\n", host, GetLastSocketError() );
+            return false;
+        }
+
+        memcpy( &saddr.sin_addr, h->h_addr, sizeof(in_addr) );
+    }
+    return true;
+}
+
+static bool IsServerListen()
+{
+    SOCKET sock = socket( AF_INET, SOCK_STREAM, 0 );
+    if( sock == INVALID_SOCKET )
+        return false;
+    bool result = !connect( sock, (sockaddr*)&Options.Addr, sizeof(sockaddr_in) );
+    closesocket( sock );
+    return result;
+}
+
+static bool StartServer( const string& path, const string& args )
+{
+    WriteLog( "Starting server<%s %s>.\n", path.c_str(), args.c_str() );
+
+    #ifdef FO_WINDOWS
+    STARTUPINFOA si;
+    memzero( &si, sizeof(si) );
+    si.cb = sizeof(si);
+    memzero( &ServerProcess, sizeof(ServerProcess) );
+    string cmd_line = "\"" + path + "\" " + args;
+    if( !CreateProcessA( NULL, (char*)cmd_line.c_str(), NULL, NULL, FALSE, 0, NULL, NULL, &si, &ServerProcess ) )
+    {
+        WriteLog( "Can't start server, error<%u>.\n", GetLastError() );
+        return false;
+    }
+    #else
+    StrVec argv_str;
+    Str::ParseLine( args.c_str(), ' ', argv_str, Str::ParseLineDummy );
+    vector<char*> argv;
+    argv.push_back( (char*)path.c_str() );
+    for( auto it = argv_str.begin(), end = argv_str.end(); it != end; ++it )
+        argv.push_back( (char*)it->c_str() );
+    argv.push_back( NULL );
+
+    ServerPid = fork();
+    if( ServerPid < 0 )
+    {
+        WriteLog( "Can't start server, fork fail.\n" );
+        ServerPid = 0;
+        return false;
+    }
+    if( !ServerPid )
+    {
+        execv( path.c_str(), &argv[0] );
+        _exit( 1 );
+    }
+    #endif
+    return true;
+}
+
+static bool IsServerRunning()
+{
+    #ifdef FO_WINDOWS
+    return ServerProcess.hProcess && WaitForSingleObject( ServerProcess.hProcess, 0 ) == WAIT_TIMEOUT;
+    #else
+    return ServerPid && !waitpid( ServerPid, NULL, WNOHANG );
+    #endif
+}
+
+// Admin panel answers are null terminated strings
+static bool AdminRead( SOCKET sock, string& answer )
+{
+    answer.clear();
+    while( true )
+    {
+        char buf[MAX_FOTEXT];
+        int  len = recv( sock, buf, sizeof(buf), 0 );
+        if( len <= 0 )
+            return false;
+        answer.append( buf, len );
+        if( !buf[len - 1] )
+            return true;
+    }
+}
+
+static bool AdminCommand( SOCKET sock, const char* cmd, string& answer )
+{
+    int len = (int)Str::Length( cmd ) + 1;
+    return send( sock, cmd, len, 0 ) == len && AdminRead( sock, answer );
+}
+
+// Stop game through admin panel and kill process after world is finished
+static bool StopServerAdmin( uint wait_tick )
+{
+    SOCKET sock = socket( AF_INET, SOCK_STREAM, 0 );
+    if( sock == INVALID_SOCKET )
+        return false;
+
+    sockaddr_in addr = Options.Addr;
+    addr.sin_port = htons( ServerAdminPort );
+    string      answer;
+    bool        result = false;
+    if( !connect( sock, (sockaddr*)&addr, sizeof(addr) ) && AdminRead( sock, answer ) &&
+        AdminCommand( sock, ServerAdminKey.c_str(), answer ) && answer.find( "Authorized" ) != string::npos &&
+        AdminCommand( sock, "stop", answer ) )
+    {
+        while( Timer::FastTick() < wait_tick && AdminCommand( sock, "state", answer ) )
+        {
+            if( answer.find( "stopped" ) != string::npos )
+            {
+                // No answer, process exits
+                result = (send( sock, "kill", 5, 0 ) == 5);
+                break;
+            }
+            Thread::Sleep( 100 );
+        }
+    }
+    closesocket( sock );
+
+    if( !result )
+        WriteLog( "Can't stop server through admin panel, port<%u>.\n", ServerAdminPort );
+    return result;
+}
+
+// Graceful stop lets server finish world and write last statistics snapshot
+static void StopServer()
+{
+    WriteLog( "Stopping server.\n" );
+
+    uint wait_tick = Timer::FastTick() + ServerStopWait;
+    bool graceful = (ServerAdminPort && StopServerAdmin( wait_tick ) );
+
+    #ifdef FO_WINDOWS
+    if( ServerProcess.hProcess )
+    {
+        if( !graceful )
+            WriteLog( "Server is terminated, last statistics are lost. Set ServerAdminPort and ServerAdminKey to stop it gracefully.\n" );
+        uint wait_time = (graceful && wait_tick > Timer::FastTick() ? wait_tick - Timer::FastTick() : 0);
+        if( WaitForSingleObject( ServerProcess.hProcess, wait_time ) != WAIT_OBJECT_0 )
+        {
+            if( graceful )
+                WriteLog( "Server is not stopped in time, terminate.\n" );
+            TerminateProcess( ServerProcess.hProcess, 0 );
+            WaitForSingleObject( ServerProcess.hProcess, INFINITE );
+        }
+        CloseHandle( ServerProcess.hProcess );
+        CloseHandle( ServerProcess.hThread );
+        ServerProcess.hProcess = NULL;
+    }
+    #else
+    if( ServerPid )
+    {
+        // Server finishes work on SIGTERM
+        if( !graceful )
+            kill( ServerPid, SIGTERM );
+        while( !waitpid( ServerPid, NULL, WNOHANG ) )
+        {
+            if( Timer::FastTick() >= wait_tick )
+            {
+                WriteLog( "Server is not stopped in time, kill.\n" );
+                kill( ServerPid, SIGKILL );
+                waitpid( ServerPid, NULL, 0 );
+                break;
+            }
+            Thread::Sleep( 100 );
+        }
+        ServerPid = 0;
+    }
+    #endif
+}
+
+static void WriteReport( const BotStage& stage )
+{
+    uint   connected = 0, playing = 0, logins = 0, disconnects = 0, moves = 0, texts = 0, attacks = 0;
+    uint64 bytes_send = 0, bytes_recv = 0;
+    for( auto it = Bots.begin(), end = Bots.end(); it != end; ++it )
+    {
+        Bot* bot = *it;
+        if( bot->State != BOT_STATE_DISCONNECTED )
+            connected++;
+        if( bot->State == BOT_STATE_PLAYING )
+            playing++;
+        logins += bot->Logins;
+        disconnects += bot->Disconnects;
+        moves += bot->Moves;
+        texts += bot->Texts;
+        attacks += bot->Attacks;
+        bytes_send += bot->BytesSend;
+        bytes_recv += bot->BytesReceive;
+    }
+
+    WriteLog( "Stage<%s> bots %u, connected %u, playing %u, logins %u, disconnects %u, moves %u, texts %u, attacks %u, send %u kb, recv %u kb.\n",
+              stage.Name.c_str(), (uint)ActiveBots, connected, playing, logins, disconnects, moves, texts, attacks, (uint)(bytes_send / 1024), (uint)(bytes_recv / 1024) );
+}
+
+int main( int argc, char* argv[] )
+{
+    #ifndef FO_WINDOWS
+    signal( SIGPIPE, SIG_IGN );
+    #endif
+
+    CommandLine = new CmdLine( argc, argv );
+    Timer::Init();
+    LogToDebugOutput( true );
+    if( !CommandLine->IsOptionEmpty( "LogFile" ) )
+        LogToFile( CommandLine->GetStr( "LogFile" ).c_str() );
+    LogWithTime( true );
+
+    if( CommandLine->IsOption( "Help" ) )
+    {
+        printf( "FOClassic load generator. Usage:\n"
+                "Bot [--Host 127.0.0.1] [--Port 4000] [--Stages login:100:60,walk+chat:500:120,combat:500:60]\n"
+                " [--Threads 4] [--RampTime 10] [--ReportTime 5]\n"
+                " [--NamePrefix bot] [--Password bot] [--Language engl] [--Register] [--RegParams index:value,...]\n"
+                " [--WalkTime 500] [--ChatTime 5000] [--CombatTime 2000] [--CombatAp 3] [--ReconnectTime 1000] [--DisableZlib]\n"
+                " [--Server server_executable] [--ServerArgs \"args\"] [--ServerWait 300] [--RandomSeed 1] [--StatisticsCsv file.csv]\n"
+                " [--ServerStopWait 300] [--ServerAdminPort port] [--ServerAdminKey key]\n"
+                " [--LogFile file.log]\n" );
+        return 0;
+    }
+
+    #ifdef FO_WINDOWS
+    WSADATA wsa;
+    if( WSAStartup( MAKEWORD( 2, 2 ), &wsa ) )
+    {
+        WriteLog( "WSAStartup error<%s>.\n", GetLastSocketError() );
+        return -1;
+    }
+    #endif
+
+    // Options
+    string host = CommandLine->GetStr( "Host", "127.0.0.1" );
+    if( !FillSockAddr( Options.Addr, host.c_str(), CommandLine->GetInt( "Port", 4000 ) ) )
+        return -1;
+    Options.NamePrefix = CommandLine->GetStr( "NamePrefix", "bot" );
+    Options.Password = CommandLine->GetStr( "Password", "bot" );
+    string language = CommandLine->GetStr( "Language", "engl" );
+    Options.Language = 0;
+    memcpy( &Options.Language, language.c_str(), MIN( (uint)language.length(), (uint)sizeof(Options.Language) ) );
+    Options.Register = CommandLine->IsOption( "Register" );
+    Options.DisableZlib = CommandLine->IsOption( "DisableZlib" );
+    Options.ReconnectTime = MAX( CommandLine->GetInt( "ReconnectTime", 1000 ), 0 );
+    Options.WalkTime = MAX( CommandLine->GetInt( "WalkTime", 500 ), 1 );
+    Options.ChatTime = MAX( CommandLine->GetInt( "ChatTime", 5000 ), 1 );
+    Options.CombatTime = MAX( CommandLine->GetInt( "CombatTime", 2000 ), 1 );
+    Options.CombatAp = (uchar)CLAMP( CommandLine->GetInt( "CombatAp", 3 ), 0, 255 );
+
+    StrVec reg_params = CommandLine->GetStrVec( "RegParams", ',' );
+    for( auto it = reg_params.begin(), end = reg_params.end(); it != end; ++it )
+    {
+        int index = 0, value = 0;
+        if( sscanf( it->c_str(), "%d:%d", &index, &value ) != 2 || index < 0 || index >= MAX_PARAMS )
+        {
+            WriteLog( "Invalid registration parameter<%s>.\n", it->c_str() );
+            return -1;
+        }
+        Options.RegParams.push_back( index );
+        Options.RegParams.push_back( value );
+    }
+
+    BotStageVec stages;
+    StrVec      stages_str = CommandLine->GetStrVec( "Stages", ',' );
+    if( stages_str.empty() )
+        stages_str.push_back( "walk+chat:100:60" );
+    uint        max_bots = 0;
+    for( auto it = stages_str.begin(), end = stages_str.end(); it != end; ++it )
+    {
+        BotStage stage;
+        if( !ParseStage( *it, stage ) )
+        {
+            WriteLog( "Invalid stage<%s>.\n", it->c_str() );
+            return -1;
+        }
+        stages.push_back( stage );
+        max_bots = MAX( max_bots, stage.Bots );
+    }
+
+    uint ramp_time = MAX( CommandLine->GetInt( "RampTime", 10 ), 0 ) * 1000;
+    uint report_time = MAX( CommandLine->GetInt( "ReportTime", 5 ), 1 ) * 1000;
+
+    // Server
+    string server = CommandLine->GetStr( "Server" );
+    if( !server.empty() )
+    {
+        string args = CommandLine->GetStr( "ServerArgs" );
+        args += Str::FormatBuf( " --Start --RandomSeed %d", CommandLine->GetInt( "RandomSeed", 1 ) );
+        if( !CommandLine->IsOptionEmpty( "StatisticsCsv" ) )
+            args += " --StatisticsCsv " + CommandLine->GetStr( "StatisticsCsv" );
+        ServerAdminPort = (ushort)CLAMP( CommandLine->GetInt( "ServerAdminPort", 0 ), 0, 0xFFFF );
+        ServerAdminKey = CommandLine->GetStr( "ServerAdminKey" );
+        ServerStopWait = MAX( CommandLine->GetInt( "ServerStopWait", 300 ), 1 ) * 1000;
+        if( !StartServer( server, args ) )
+            return -1;
+
+        // Server starts listen after world is loaded
+        uint wait_tick = Timer::FastTick() + MAX( CommandLine->GetInt( "ServerWait", 300 ), 1 ) * 1000;
+        while( !IsServerListen() )
+        {
+            if( !IsServerRunning() || Timer::FastTick() >= wait_tick )
+            {
+                WriteLog( "Server is not started.\n" );
+                StopServer();
+                return -1;
+            }
+            Thread::Sleep( 1000 );
+        }
+        WriteLog( "Server is started.\n" );
+    }
+
+    // Bots
+    for( uint i = 0; i < max_bots; i++ )
+        Bots.push_back( new Bot( Options, i ) );
+
+    BotThreadsCount = CLAMP( CommandLine->GetInt( "Threads", 4 ), 1, 64 );
+    Thread* threads = new Thread[BotThreadsCount];
+    for( uint i = 0; i < BotThreadsCount; i++ )
+        threads[i].Start( BotThread, Str::FormatBuf( "Bots%u", i ), (void*)(size_t)i );
+
+    WriteLog( "Bots<%u>, threads<%u>, stages<%u>.\n", max_bots, BotThreadsCount, (uint)stages.size() );
+
+    // Stages
+    uint prev_bots = 0;
+    for( auto it = stages.begin(), end = stages.end(); it != end; ++it )
+    {
+        BotStage& stage = *it;
+        WriteLog( "Stage<%s>, bots<%u>, time<%u>.\n", stage.Name.c_str(), stage.Bots, stage.Time );
+
+        InterlockedExchange( &ActiveActions, stage.Actions );
+        uint start_tick = Timer::FastTick();
+        uint stage_time = stage.Time * 1000;
+        uint stage_ramp = MIN( ramp_time, stage_time );
+        uint report_tick = start_tick + report_time;
+        while( true )
+        {
+            uint elapsed = Timer::FastTick() - start_tick;
+            if( elapsed >= stage_time )
+                break;
+
+            uint bots = stage.Bots;
+            if( elapsed < stage_ramp )
+                bots = prev_bots + (int)( (int64)( (int)stage.Bots - (int)prev_bots ) * elapsed / stage_ramp );
+            InterlockedExchange( &ActiveBots, bots );
+
+            if( start_tick + elapsed >= report_tick )
+            {
+                WriteReport( stage );
+                report_tick += report_time;
+            }
+
+            if( !server.empty() && !IsServerRunning() )
+            {
+                WriteLog( "Server is stopped.\n" );
+                break;
+            }
+            Thread::Sleep( 100 );
+        }
+        WriteReport( stage );
+        prev_bots = stage.Bots;
+    }
+
+    // Finish
+    BotThreadsFinish = true;
+    for( uint i = 0; i < BotThreadsCount; i++ )
+        threads[i].Wait();
+    delete[] threads;
+    for( auto it = Bots.begin(), end = Bots.end(); it != end; ++it )
+        delete *it;
+    Bots.clear();
+
+    if( !server.empty() )
+        StopServer();
+
+    WriteLog( "Done.\n" );
+    LogFinish();
+    return 0;
+}
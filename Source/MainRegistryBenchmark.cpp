@@ -0,0 +1,121 @@
+#include "Core.h"
+
+#include "Log.h"
+#include "Registry.h"
+#include "Text.h"
+#include "Thread.h"
+#include "Timer.h"
+
+// Lookup throughput of registry and of single mutex with ordered map, 1/4/8/16 threads
+
+#define REGISTRY_BENCHMARK_OBJECTS    (100000)
+#define REGISTRY_BENCHMARK_LOOKUPS    (200000) // Per thread
+
+struct RegistryBenchmark
+{
+    Registry<void>*   Reg;
+    map<uint, void*>* Objects;
+    Mutex*            Locker;
+    uint              Seed;
+    volatile uint     Found;
+};
+
+static void RegistryBenchmarkMutex( void* data )
+{
+    RegistryBenchmark* bench = (RegistryBenchmark*)data;
+    uint               seed = bench->Seed;
+    uint               found = 0;
+    for( uint i = 0; i < REGISTRY_BENCHMARK_LOOKUPS; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        uint id = seed % REGISTRY_BENCHMARK_OBJECTS + 1;
+
+        bench->Locker->Lock();
+        auto it = bench->Objects->find( id );
+        if( it != bench->Objects->end() )
+            found++;
+        bench->Locker->Unlock();
+    }
+    bench->Found = found;
+}
+
+static void RegistryBenchmarkRegistry( void* data )
+{
+    RegistryBenchmark* bench = (RegistryBenchmark*)data;
+    uint               seed = bench->Seed;
+    uint               found = 0;
+    for( uint i = 0; i < REGISTRY_BENCHMARK_LOOKUPS; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        uint id = seed % REGISTRY_BENCHMARK_OBJECTS + 1;
+
+        if( bench->Reg->Get( id ) )
+            found++;
+    }
+    bench->Found = found;
+}
+
+static double RunRegistryBenchmark( void (*func)( void* ), uint threads_count, Registry<void>& reg, map<uint, void*>& objects, Mutex& locker )
+{
+    Thread*            threads = new Thread[threads_count];
+    RegistryBenchmark* benches = new RegistryBenchmark[threads_count];
+
+    double tick = Timer::AccurateTick();
+    for( uint i = 0; i < threads_count; i++ )
+    {
+        benches[i].Reg = &reg;
+        benches[i].Objects = &objects;
+        benches[i].Locker = &locker;
+        benches[i].Seed = i + 1;
+        benches[i].Found = 0;
+        threads[i].Start( func, "RegistryBenchmark", &benches[i] );
+    }
+    for( uint i = 0; i < threads_count; i++ )
+        threads[i].Wait();
+    tick = Timer::AccurateTick() - tick;
+
+    delete[] threads;
+    delete[] benches;
+
+    // Million lookups per second
+    return tick > 0.0 ? (double)threads_count * REGISTRY_BENCHMARK_LOOKUPS / (tick * 1000.0) : 0.0;
+}
+
+static string GetRegistryBenchmarkString()
+{
+    static const uint threads_counts[] = { 1, 4, 8, 16 };
+
+    Registry<void>*  reg = new Registry<void>();
+    map<uint, void*> objects;
+    Mutex            locker;
+    for( uint id = 1; id <= REGISTRY_BENCHMARK_OBJECTS; id++ )
+    {
+        reg->Add( id, (void*)(size_t)id );
+        objects.insert( PAIR( id, (void*)(size_t)id ) );
+    }
+
+    char   str[MAX_FOTEXT];
+    string result = Str::Format( str, "Lookups by id, %u objects, %u lookups per thread, million lookups per second\n", REGISTRY_BENCHMARK_OBJECTS, REGISTRY_BENCHMARK_LOOKUPS );
+    result += "Threads  Mutex       Registry\n";
+    for( uint i = 0; i < sizeof(threads_counts) / sizeof(threads_counts[0]); i++ )
+    {
+        double mutex_rate = RunRegistryBenchmark( RegistryBenchmarkMutex, threads_counts[i], *reg, objects, locker );
+        double registry_rate = RunRegistryBenchmark( RegistryBenchmarkRegistry, threads_counts[i], *reg, objects, locker );
+        result += Str::Format( str, "%-8u %-11.2f %-11.2f\n", threads_counts[i], mutex_rate, registry_rate );
+    }
+
+    delete reg;
+    return result;
+}
+
+int main( int argc, char* argv[] )
+{
+    Timer::Init();
+    LogToDebugOutput( true );
+
+    WriteLog( "Registry benchmark.\n" );
+    WriteLogX( "%s", GetRegistryBenchmarkString().c_str() );
+
+    LogFinish();
+    return 0;
+}
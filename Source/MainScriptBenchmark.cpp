@@ -0,0 +1,209 @@
+#include "Core.h"
+
+#include <angelscript.h>
+#include <scriptarray.h>
+#include <scriptmath.h>
+#include <scriptstring.h>
+
+#include "CommandLine.h"
+#include "Log.h"
+#include "ScriptAot.h"
+#include "Text.h"
+#include "Timer.h"
+
+// Interpreter against native code of ahead of time compiler on same scripts
+// Native code is made in two runs, first writes translation, second loads library built from it
+
+static const char* BenchmarkScript =
+    "int64 Loops( int n )\n"
+    "{\n"
+    "    int sum = 0;\n"
+    "    for( int i = 0; i < n; i++ )\n"
+    "    {\n"
+    "        sum = sum * 31 + (i ^ (i >> 3));\n"
+    "        if( (sum & 0x10000) != 0 )\n"
+    "            sum -= i;\n"
+    "    }\n"
+    "    return sum;\n"
+    "}\n"
+    "\n"
+    "int64 ArrayMath( int n )\n"
+    "{\n"
+    "    array<double> values( 256 );\n"
+    "    for( uint i = 0; i < values.length(); i++ )\n"
+    "        values[i] = i * 0.5;\n"
+    "    double sum = 0;\n"
+    "    for( int k = 0; k < n; k++ )\n"
+    "    {\n"
+    "        for( uint i = 1; i < values.length(); i++ )\n"
+    "        {\n"
+    "            double v = values[i] * 1.0001 + values[i - 1] * 0.25;\n"
+    "            if( v > 1000.0 )\n"
+    "                v -= 1000.0;\n"
+    "            values[i] = v;\n"
+    "            sum += v;\n"
+    "        }\n"
+    "    }\n"
+    "    return int64( sum );\n"
+    "}\n"
+    "\n"
+    "int64 StringOps( int n )\n"
+    "{\n"
+    "    int64 total = 0;\n"
+    "    string s;\n"
+    "    for( int i = 0; i < n; i++ )\n"
+    "    {\n"
+    "        s = \"item\" + i;\n"
+    "        s += \"_\" + (i * 7);\n"
+    "        if( s == \"item1_7\" )\n"
+    "            total += 1000;\n"
+    "        total += s.length();\n"
+    "    }\n"
+    "    return total;\n"
+    "}\n"
+    "\n"
+    "int64 NativeCalls( int n )\n"
+    "{\n"
+    "    int result = 0;\n"
+    "    for( int i = 0; i < n; i++ )\n"
+    "        result = BenchmarkNative( result, i );\n"
+    "    return result;\n"
+    "}\n";
+
+struct ScriptBenchmarkTest
+{
+    const char* Name;
+    const char* Decl;
+    int         Iterations;
+};
+
+static const ScriptBenchmarkTest BenchmarkTests[] =
+{
+    { "Loops", "int64 Loops(int)", 20000000 },
+    { "ArrayMath", "int64 ArrayMath(int)", 20000 },
+    { "StringOps", "int64 StringOps(int)", 500000 },
+    { "NativeCalls", "int64 NativeCalls(int)", 5000000 },
+};
+
+static int BenchmarkNative( int a, int b )
+{
+    return (a ^ b) + 1;
+}
+
+static void BenchmarkMessage( const asSMessageInfo* msg, void* param )
+{
+    WriteLog( "%s(%d) : %s\n", msg->section, msg->row, msg->message );
+}
+
+static asIScriptEngine* CreateBenchmarkEngine( ScriptAot* aot )
+{
+    asIScriptEngine* engine = asCreateScriptEngine( ANGELSCRIPT_VERSION );
+    if( !engine )
+        return NULL;
+
+    engine->SetMessageCallback( asFUNCTION( BenchmarkMessage ), NULL, asCALL_CDECL );
+    if( aot )
+    {
+        engine->SetEngineProperty( asEP_INCLUDE_JIT_INSTRUCTIONS, true );
+        engine->SetJITCompiler( aot );
+    }
+
+    RegisterScriptArray( engine, true );
+    RegisterScriptString( engine );
+    RegisterScriptMath( engine );
+    engine->RegisterGlobalFunction( "int BenchmarkNative(int, int)", asFUNCTION( BenchmarkNative ), asCALL_CDECL );
+
+    asIScriptModule* module = engine->GetModule( "Benchmark", asGM_ALWAYS_CREATE );
+    if( module->AddScriptSection( "Benchmark", BenchmarkScript ) < 0 || module->Build() < 0 )
+    {
+        engine->Release();
+        return NULL;
+    }
+    return engine;
+}
+
+static bool RunBenchmarkTest( asIScriptEngine* engine, const ScriptBenchmarkTest& test, asQWORD& result, double& time )
+{
+    asIScriptFunction* func = engine->GetModule( "Benchmark" )->GetFunctionByDecl( test.Decl );
+    asIScriptContext*  ctx = engine->CreateContext();
+    if( !func || !ctx || ctx->Prepare( func ) < 0 || ctx->SetArgDWord( 0, test.Iterations ) < 0 )
+    {
+        if( ctx )
+            ctx->Release();
+        return false;
+    }
+
+    time = Timer::AccurateTick();
+    int r = ctx->Execute();
+    time = Timer::AccurateTick() - time;
+
+    result = ctx->GetReturnQWord();
+    ctx->Release();
+    return r == asEXECUTION_FINISHED;
+}
+
+static string GetScriptBenchmarkString( asIScriptEngine* interpreted, asIScriptEngine* compiled )
+{
+    char   str[MAX_FOTEXT];
+    string result = "Test        Iterations  Interpreter ms  Native ms   Speedup\n";
+    for( uint i = 0; i < sizeof(BenchmarkTests) / sizeof(BenchmarkTests[0]); i++ )
+    {
+        const ScriptBenchmarkTest& test = BenchmarkTests[i];
+        asQWORD                    interpreted_result = 0, compiled_result = 0;
+        double                     interpreted_time = 0.0, compiled_time = 0.0;
+        if( !RunBenchmarkTest( interpreted, test, interpreted_result, interpreted_time ) ||
+            !RunBenchmarkTest( compiled, test, compiled_result, compiled_time ) )
+        {
+            result += Str::Format( str, "%-11s execution fail\n", test.Name );
+            continue;
+        }
+
+        result += Str::Format( str, "%-11s %-11d %-15.1f %-11.1f %.2f%s\n", test.Name, test.Iterations, interpreted_time, compiled_time,
+                               compiled_time > 0.0 ? interpreted_time / compiled_time : 0.0, interpreted_result != compiled_result ? " (results differ)" : "" );
+    }
+    return result;
+}
+
+int main( int argc, char* argv[] )
+{
+    CommandLine = new CmdLine( argc, argv );
+    Timer::Init();
+    LogToDebugOutput( true );
+
+    if( CommandLine->IsOption( "Help" ) )
+    {
+        printf( "FOClassic script benchmark. Usage:\n"
+                "ScriptBenchmark [--Translate Benchmark.aot.cpp] [--Aot Benchmark.aot.so]\n" );
+        return 0;
+    }
+
+    WriteLog( "Script benchmark.\n" );
+
+    ScriptAot* aot = new ScriptAot();
+    string     aot_path = CommandLine->GetStr( "Aot" );
+    if( !aot_path.empty() && !aot->LoadNative( aot_path.c_str() ) )
+        WriteLog( "Native code<%s> not loaded, functions are interpreted.\n", aot_path.c_str() );
+
+    asIScriptEngine* interpreted = CreateBenchmarkEngine( NULL );
+    asIScriptEngine* compiled = CreateBenchmarkEngine( aot );
+    if( !interpreted || !compiled )
+    {
+        WriteLog( "Benchmark scripts build fail.\n" );
+        return -1;
+    }
+
+    WriteLog( "Functions with native code %u, translated %u.\n", aot->GetNativeCount(), aot->GetTranslationCount() );
+    string translate_path = CommandLine->GetStr( "Translate" );
+    if( !translate_path.empty() && aot->SaveTranslation( translate_path.c_str(), "Benchmark" ) )
+        WriteLog( "Translation saved to<%s>.\n", translate_path.c_str() );
+
+    WriteLogX( "%s", GetScriptBenchmarkString( interpreted, compiled ).c_str() );
+
+    // Compiler outlives engine, its functions are referenced until release
+    interpreted->Release();
+    compiled->Release();
+    delete aot;
+
+    LogFinish();
+    return 0;
+}
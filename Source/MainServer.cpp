@@ -37,6 +37,17 @@
 
 void InitAdminManager();
 
+// SIGTERM and SIGINT stop server like admin panel, process exits after world is finished
+#ifndef FO_WINDOWS
+volatile bool TerminateRequested = false;
+
+void TerminateSignal( int )
+{
+    TerminateRequested = true;
+    FOQuit = true;
+}
+#endif
+
 /************************************************************************/
 /* GUI & Windows service version                                        */
 /************************************************************************/
@@ -91,9 +102,11 @@ int main( int argc, char** argv )
     # endif
     Thread::SetCurrentName( "GUI" );
 
-    // Disable SIGPIPE signal
+    // Disable SIGPIPE signal, stop on termination signals
     # ifndef FO_WINDOWS
     signal( SIGPIPE, SIG_IGN );
+    signal( SIGTERM, TerminateSignal );
+    signal( SIGINT, TerminateSignal );
     # endif
 
     // Exceptions catcher
@@ -123,6 +136,8 @@ int main( int argc, char** argv )
     LogWithThread( ConfigFile->GetBool( SECTION_SERVER, "LoggingThread", true ) );
     if( CommandLine->IsOption( "LoggingDebugOutput" ) || ConfigFile->GetBool( SECTION_SERVER, "LoggingDebugOutput", false ) )
         LogToDebugOutput( true );
+    if( ConfigFile->GetBool( SECTION_SERVER, "LoggingAsync", false ) )
+        LogAsync( true, ConfigFile->GetInt( SECTION_SERVER, "LoggingFlushTime", 100 ) );
 
     // Init event
     GameInitEvent.Disallow();
@@ -259,6 +274,11 @@ int main( int argc, char** argv )
                 UpdateInfo();
                 CheckTextBoxSize( false );
             }
+
+            # ifndef FO_WINDOWS
+            if( TerminateRequested && Server.Stopped() )
+                break;
+            # endif
         }
         Fl::unlock();
         GUIUpdateThread.Finish();
@@ -268,6 +288,8 @@ int main( int argc, char** argv )
         while( !FOQuit )
             Thread::Sleep( 100 );
     }
+    if( FOQuit )
+        LoopThread.Wait();
 
     // Finish
     Timer::Finish();
@@ -984,9 +1006,11 @@ int main( int argc, char** argv )
     // Threading
     Thread::SetCurrentName( "Daemon" );
 
-    // Disable SIGPIPE signal
+    // Disable SIGPIPE signal, stop on termination signals
     # ifndef FO_WINDOWS
     signal( SIGPIPE, SIG_IGN );
+    signal( SIGTERM, TerminateSignal );
+    signal( SIGINT, TerminateSignal );
     # endif
 
     // Exceptions catcher
@@ -1005,6 +1029,8 @@ int main( int argc, char** argv )
     LogWithThread( ConfigFile->GetBool( SECTION_SERVER, "LoggingThread", true ) );
     LogToDebugOutput( CommandLine->IsOption( "LoggingDebugOutput" ) || ConfigFile->GetBool( "LoggingDebugOutput", false ) );
     LogToFile( "./FOnlineServerDaemon.log" );
+    if( ConfigFile->GetBool( SECTION_SERVER, "LoggingAsync", false ) )
+        LogAsync( true, ConfigFile->GetInt( SECTION_SERVER, "LoggingFlushTime", 100 ) );
 
     // Log version
     WriteLog( "FOClassic server daemon, version %u.\n", FOCLASSIC_VERSION );
@@ -1014,7 +1040,7 @@ int main( int argc, char** argv )
             WriteLog( "Command line<%s>.\n", cmdline.c_str() );
     }
 
-    DaemonLoop();     // Never out from here
+    DaemonLoop();     // Out only on termination signal
     return 0;
 }
 
@@ -1027,15 +1053,17 @@ void DaemonLoop()
     InitAdminManager( NULL );
 
     // Daemon loop
-    while( true )
-        Thread::Sleep( 1000 );
+    while( !TerminateRequested )
+        Thread::Sleep( 100 );
+    LoopThread.Wait();
 }
 
 void GameLoopThread( void* )
 {
     if( Server.Init() )
     {
-        FOQuit = false;
+        if( !TerminateRequested )
+            FOQuit = false;
         Server.MainLoop();
         Server.Finish();
     }
@@ -37,12 +37,13 @@ const char* MapEventFuncName[MAP_EVENT_MAX] =
 /************************************************************************/
 
 Map::Map() : RefCounter( 1 ), IsNotValid( false ), hexFlags( NULL ),
-    mapLocation( NULL ), Proto( NULL ), NeedProcess( false ),
+    mapLocation( NULL ), gridWidth( 0 ), gridHeight( 0 ), gridMultihexMax( 0 ), gridVisibleMax( 0 ), pathCacheHits( 0 ), pathCacheMisses( 0 ), pathGraph( NULL ), Proto( NULL ), NeedProcess( false ), JobDelayTick( 0 ),
     IsTurnBasedOn( false ), TurnBasedEndTick( 0 ), TurnSequenceCur( 0 ),
     IsTurnBasedTimeout( false ), TurnBasedBeginSecond( 0 ), NeedEndTurnBased( false ),
     TurnBasedRound( 0 ), TurnBasedTurn( 0 ), TurnBasedWholeTurn( 0 )
 {
     MEMORY_PROCESS( MEMORY_MAP, sizeof(Map) );
+    Sync.SetType( SYNC_OBJECT_MAP );
     memzero( &Data, sizeof(Data) );
     memzero( FuncId, sizeof(FuncId) );
     memzero( LoopEnabled, sizeof(LoopEnabled) );
@@ -55,6 +56,7 @@ Map::~Map()
     MEMORY_PROCESS( MEMORY_MAP, -(int)sizeof(Map) );
     MEMORY_PROCESS( MEMORY_MAP_FIELD, -(Proto->Header.MaxHexX * Proto->Header.MaxHexY) );
     SAFEDELA( hexFlags );
+    SAFEDEL( pathGraph );
 }
 
 bool Map::Init( ProtoMap* proto, Location* location )
@@ -67,6 +69,10 @@ bool Map::Init( ProtoMap* proto, Location* location )
     if( !hexFlags )
         return false;
     memzero( hexFlags, proto->Header.MaxHexX * proto->Header.MaxHexY );
+    gridWidth = (proto->Header.MaxHexX + MAP_GRID_CELL - 1) / MAP_GRID_CELL;
+    gridHeight = (proto->Header.MaxHexY + MAP_GRID_CELL - 1) / MAP_GRID_CELL;
+    gridCritters.resize( gridWidth * gridHeight );
+    gridItems.resize( gridWidth * gridHeight );
     memzero( &Data, sizeof(Data) );
     Proto = proto;
     mapLocation = location;
@@ -95,6 +101,8 @@ void Map::Clear( bool full )
     IsNotValid = true;
 
     PcVec del_npc = mapNpcs;
+    for( auto it = mapCritters.begin(), end = mapCritters.end(); it != end; ++it )
+        GridSetCritter( *it, false );
     mapCritters.clear();
     mapPlayers.clear();
     mapNpcs.clear();
@@ -102,8 +110,16 @@ void Map::Clear( bool full )
     ItemPtrVec del_items = hexItems;
     hexItems.clear();
 
+    for( auto it = gridCritters.begin(), end = gridCritters.end(); it != end; ++it )
+        it->clear();
+    for( auto it = gridItems.begin(), end = gridItems.end(); it != end; ++it )
+        it->clear();
+    gridViewItems.clear();
+
     dataLocker.Unlock();
 
+    ClearPathCache();
+
     if( full )
     {
         for( auto it = del_npc.begin(), end = del_npc.end(); it != end; ++it )
@@ -439,23 +455,43 @@ bool Map::Generate()
     return true;
 }
 
-void Map::Process()
+uint Map::Process()
 {
+    // Time in milliseconds until next loop event
+    uint wait = MAX_UINT;
+
     if( IsTurnBasedOn )
+    {
         ProcessTurnBased();
+        wait = 0;
+    }
 
     if( NeedProcess )
     {
         uint tick = Timer::GameTick();
         for( int i = 0; i < MAP_LOOP_FUNC_MAX; i++ )
         {
-            if( LoopEnabled[i] && tick - LoopLastTick[i] >= LoopWaitTick[i] )
+            if( LoopEnabled[i] )
             {
-                EventLoop( i );
-                LoopLastTick[i] = tick;
+                if( tick - LoopLastTick[i] >= LoopWaitTick[i] )
+                {
+                    EventLoop( i );
+                    LoopLastTick[i] = tick;
+                }
+                uint elapsed = tick - LoopLastTick[i];
+                wait = MIN( wait, LoopWaitTick[i] > elapsed ? LoopWaitTick[i] - elapsed : 0 );
             }
         }
     }
+
+    return wait;
+}
+
+void Map::WakeUp()
+{
+    // Wakeup during processing is remembered until job pushed back
+    if( DeadlineScheduler && JobDelayTick != JOB_DELAY_WAKEUP )
+        Job::WakeUp( Job( JOB_MAP, this, false ), JobDelayTick );
 }
 
 Location* Map::GetLocation( bool lock )
@@ -465,6 +501,12 @@ Location* Map::GetLocation( bool lock )
     return mapLocation;
 }
 
+void Map::SetJournalDirty()
+{
+    if( mapLocation )
+        mapLocation->SetJournalDirty();
+}
+
 bool Map::GetStartCoord( ushort& hx, ushort& hy, uchar& dir, uint entire )
 {
     ProtoMap::MapEntire* ent;
@@ -566,6 +608,7 @@ void Map::AddCritter( Critter* cr )
         else
             mapNpcs.push_back( (Npc*)cr );
         mapCritters.push_back( cr );
+        GridSetCritter( cr, true );
 
         cr->SetMaps( GetId(), GetPid() );
     }
@@ -609,9 +652,11 @@ void Map::EraseCritter( Critter* cr )
         auto it = std::find( mapCritters.begin(), mapCritters.end(), cr );
         if( it != mapCritters.end() )
             mapCritters.erase( it );
+        GridSetCritter( cr, false );
     }
 
     cr->SetTimeout( TO_BATTLE, 0 );
+    cr->SetJournalDirty();
 
     MapMngr.RunGarbager();
 }
@@ -710,8 +755,10 @@ void Map::SetItem( Item* item, ushort hx, ushort hy )
     item->AccHex.MapId = GetId();
     item->AccHex.HexX = hx;
     item->AccHex.HexY = hy;
+    item->SetJournalDirty();
 
     hexItems.push_back( item );
+    GridAddItem( item );
     SetHexFlag( hx, hy, HEX_FLAG_ITEM );
 
     if( !item->IsPassed() )
@@ -722,6 +769,8 @@ void Map::SetItem( Item* item, ushort hx, ushort hy )
         SetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
     if( item->IsBlocks() )
         PlaceItemBlocks( hx, hy, item->Proto );
+    if( !item->IsPassed() || item->IsGag() || item->IsBlocks() )
+        ClearPathCache();
 
     if( item->FuncId[ITEM_EVENT_WALK] > 0 )
         SetHexFlag( hx, hy, HEX_FLAG_WALK_ITEM );
@@ -747,6 +796,8 @@ void Map::EraseItem( uint item_id )
 
     Item* item = *it;
     hexItems.erase( it );
+    GridEraseItem( item );
+    item->SetJournalDirty();
 
     ushort hx = item->AccHex.HexX;
     ushort hy = item->AccHex.HexY;
@@ -801,6 +852,8 @@ void Map::ChangeDataItem( Item* item )
 
 void Map::ChangeViewItem( Item* item )
 {
+    GridViewItem( item );
+
     CrVec critters;
     GetCritters( critters, true );
 
@@ -891,6 +944,129 @@ void Map::AnimateItem( Item* item, uchar from_frm, uchar to_frm )
     }
 }
 
+uint Map::GetGridCell( ushort hx, ushort hy )
+{
+    uint x = MIN( hx, GetMaxHexX() - 1 ) / MAP_GRID_CELL;
+    uint y = MIN( hy, GetMaxHexY() - 1 ) / MAP_GRID_CELL;
+    return y * gridWidth + x;
+}
+
+void Map::GetGridRect( ushort hx, ushort hy, uint radius, uint& x1, uint& y1, uint& x2, uint& y2 )
+{
+    // Hex distance is never less than offset by any axis, so square covers radius
+    x1 = ( (uint)hx > radius ? hx - radius : 0 ) / MAP_GRID_CELL;
+    y1 = ( (uint)hy > radius ? hy - radius : 0 ) / MAP_GRID_CELL;
+    x2 = MIN( (uint)hx + radius, (uint)GetMaxHexX() - 1 ) / MAP_GRID_CELL;
+    y2 = MIN( (uint)hy + radius, (uint)GetMaxHexY() - 1 ) / MAP_GRID_CELL;
+    x1 = MIN( x1, x2 );
+    y1 = MIN( y1, y2 );
+}
+
+static void EraseGridCritter( CrVec& cell_critters, Critter* cr )
+{
+    auto it = std::find( cell_critters.begin(), cell_critters.end(), cr );
+    if( it != cell_critters.end() )
+    {
+        *it = cell_critters.back();
+        cell_critters.pop_back();
+    }
+}
+
+void Map::GridSetCritter( Critter* cr, bool add )
+{
+    // Must be called with locked dataLocker
+    bool indexed = (cr->MapGridId == GetId() && cr->MapGridCell >= 0);
+    if( add )
+    {
+        if( cr->GetMultihex() > gridMultihexMax )
+            gridMultihexMax = cr->GetMultihex();
+
+        int cell = (int)GetGridCell( cr->GetHexX(), cr->GetHexY() );
+        if( indexed && cell == cr->MapGridCell )
+            return;
+        if( indexed )
+            EraseGridCritter( gridCritters[cr->MapGridCell], cr );
+        gridCritters[cell].push_back( cr );
+        cr->MapGridId = GetId();
+        cr->MapGridCell = cell;
+    }
+    else if( indexed )
+    {
+        EraseGridCritter( gridCritters[cr->MapGridCell], cr );
+        cr->MapGridId = 0;
+        cr->MapGridCell = -1;
+    }
+    else
+    {
+        // Critter already added to another map, cell is unknown
+        for( auto it = gridCritters.begin(), end = gridCritters.end(); it != end; ++it )
+            EraseGridCritter( *it, cr );
+    }
+}
+
+void Map::GridCollectCritters( ushort hx, ushort hy, uint radius, CrVec& critters )
+{
+    // Must be called with locked dataLocker
+    uint x1, y1, x2, y2;
+    GetGridRect( hx, hy, radius, x1, y1, x2, y2 );
+    for( uint y = y1; y <= y2; y++ )
+    {
+        for( uint x = x1; x <= x2; x++ )
+        {
+            CrVec& cell_critters = gridCritters[y * gridWidth + x];
+            critters.insert( critters.end(), cell_critters.begin(), cell_critters.end() );
+        }
+    }
+}
+
+void Map::GridAddItem( Item* item )
+{
+    gridItems[GetGridCell( item->AccHex.HexX, item->AccHex.HexY )].push_back( item );
+    if( item->IsAlwaysView() || item->IsTrap() )
+        gridViewItems.push_back( item );
+}
+
+void Map::GridEraseItem( Item* item )
+{
+    ItemPtrVec& cell_items = gridItems[GetGridCell( item->AccHex.HexX, item->AccHex.HexY )];
+    auto        it = std::find( cell_items.begin(), cell_items.end(), item );
+    if( it != cell_items.end() )
+        cell_items.erase( it );
+
+    it = std::find( gridViewItems.begin(), gridViewItems.end(), item );
+    if( it != gridViewItems.end() )
+        gridViewItems.erase( it );
+}
+
+void Map::GridViewItem( Item* item )
+{
+    auto it = std::find( gridViewItems.begin(), gridViewItems.end(), item );
+    bool view = (item->IsAlwaysView() || item->IsTrap() );
+    if( view && it == gridViewItems.end() )
+        gridViewItems.push_back( item );
+    else if( !view && it != gridViewItems.end() )
+        gridViewItems.erase( it );
+}
+
+void Map::GetItemsNear( ushort hx, ushort hy, uint radius, ItemPtrVec& items )
+{
+    uint x1, y1, x2, y2;
+    GetGridRect( hx, hy, radius, x1, y1, x2, y2 );
+    for( uint y = y1; y <= y2; y++ )
+    {
+        for( uint x = x1; x <= x2; x++ )
+        {
+            ItemPtrVec& cell_items = gridItems[y * gridWidth + x];
+            items.insert( items.end(), cell_items.begin(), cell_items.end() );
+        }
+    }
+}
+
+void Map::GetViewItems( ItemPtrVec& items )
+{
+    items.insert( items.end(), gridViewItems.begin(), gridViewItems.end() );
+}
+
 #pragma MESSAGE("Add explicit sync lock.")
 Item* Map::GetItem( uint item_id )
 {
@@ -979,7 +1155,11 @@ Item* Map::GetItemGag( ushort hx, ushort hy )
 
 void Map::GetItemsHex( ushort hx, ushort hy, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    if( hx >= GetMaxHexX() || hy >= GetMaxHexY() )
+        return;
+
+    ItemPtrVec& cell_items = gridItems[GetGridCell( hx, hy )];
+    for( auto it = cell_items.begin(), end = cell_items.end(); it != end; ++it )
     {
         Item* item = *it;
         if( item->AccHex.HexX == hx && item->AccHex.HexY == hy )
@@ -993,11 +1173,20 @@ void Map::GetItemsHex( ushort hx, ushort hy, ItemPtrVec& items, bool lock )
 
 void Map::GetItemsHexEx( ushort hx, ushort hy, uint radius, ushort pid, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    uint x1, y1, x2, y2;
+    GetGridRect( hx, hy, radius, x1, y1, x2, y2 );
+    for( uint y = y1; y <= y2; y++ )
     {
-        Item* item = *it;
-        if( (!pid || item->GetProtoId() == pid) && DistGame( item->AccHex.HexX, item->AccHex.HexY, hx, hy ) <= radius )
-            items.push_back( item );
+        for( uint x = x1; x <= x2; x++ )
+        {
+            ItemPtrVec& cell_items = gridItems[y * gridWidth + x];
+            for( auto it = cell_items.begin(), end = cell_items.end(); it != end; ++it )
+            {
+                Item* item = *it;
+                if( (!pid || item->GetProtoId() == pid) && DistGame( item->AccHex.HexX, item->AccHex.HexY, hx, hy ) <= radius )
+                    items.push_back( item );
+            }
+        }
     }
 
     if( lock )
@@ -1051,6 +1240,7 @@ void Map::GetItemsTrap( ushort hx, ushort hy, ItemPtrVec& traps, bool lock )
 
 void Map::RecacheHexBlock( ushort hx, ushort hy )
 {
+    ClearPathCache();
     UnsetHexFlag( hx, hy, HEX_FLAG_BLOCK_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
     bool is_block = false;
@@ -1090,6 +1280,7 @@ void Map::RecacheHexShoot( ushort hx, ushort hy )
 
 void Map::RecacheHexBlockShoot( ushort hx, ushort hy )
 {
+    ClearPathCache();
     UnsetHexFlag( hx, hy, HEX_FLAG_BLOCK_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_NRAKE_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
@@ -1119,6 +1310,145 @@ void Map::RecacheHexBlockShoot( ushort hx, ushort hy )
         SetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
 }
 
+bool Map::GetCachedPath( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint multihex, uint cut, bool check_cr, bool check_gag_items, PathStepVec& path )
+{
+    SCOPE_LOCK( pathCacheLocker );
+
+    uint tick = Timer::FastTick();
+    for( auto it = pathCache.begin(); it != pathCache.end();)
+    {
+        PathCacheEntry& entry = *it;
+
+        // Expired, path can be shorter after critters moved
+        if( tick - entry.CreateTick >= PathCacheTime )
+        {
+            it = pathCache.erase( it );
+            continue;
+        }
+
+        if( entry.ToX != to_hx || entry.ToY != to_hy || entry.Multihex != multihex || entry.Cut != cut ||
+            entry.CheckCrit != check_cr || entry.CheckGagItems != check_gag_items )
+        {
+            ++it;
+            continue;
+        }
+
+        // Start hex is beginning of path or one of its steps
+        uint begin = 0;
+        uint count = (uint)entry.Path.size();
+        if( entry.FromX != from_hx || entry.FromY != from_hy )
+        {
+            for( ; begin < count; begin++ )
+                if( entry.Path[begin].HexX == from_hx && entry.Path[begin].HexY == from_hy )
+                    break;
+            if( begin == count )
+            {
+                ++it;
+                continue;
+            }
+            begin++;
+        }
+        if( begin == count )
+        {
+            ++it;
+            continue;
+        }
+
+        // Rest of path must be passable as for new search
+        bool passed = true;
+        for( uint i = begin; i < count && passed; i++ )
+        {
+            PathStep& ps = entry.Path[i];
+            if( !multihex )
+            {
+                ushort flags = GetHexFlags( ps.HexX, ps.HexY );
+                passed = (!FLAG( flags, HEX_FLAG_NOWAY ) ||
+                          (check_gag_items && FLAG( flags, HEX_FLAG_GAG_ITEM << 8 ) ) ||
+                          (check_cr && FLAG( flags, HEX_FLAG_CRITTER << 8 ) ) );
+            }
+            else
+            {
+                passed = IsMovePassed( ps.HexX, ps.HexY, ps.Dir, multihex );
+            }
+        }
+        if( !passed )
+        {
+            it = pathCache.erase( it );
+            continue;
+        }
+
+        path.assign( entry.Path.begin() + begin, entry.Path.end() );
+        entry.UseTick = tick;
+        pathCacheHits++;
+        return true;
+    }
+
+    pathCacheMisses++;
+    return false;
+}
+
+void Map::SetCachedPath( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint multihex, uint cut, bool check_cr, bool check_gag_items, const PathStepVec& path )
+{
+    SCOPE_LOCK( pathCacheLocker );
+
+    // Replace least recently used path
+    uint tick = Timer::FastTick();
+    if( pathCache.size() >= MAP_PATH_CACHE_SIZE )
+    {
+        auto oldest = pathCache.begin();
+        for( auto it = pathCache.begin(), end = pathCache.end(); it != end; ++it )
+            if( tick - it->UseTick > tick - oldest->UseTick )
+                oldest = it;
+        pathCache.erase( oldest );
+    }
+
+    pathCache.push_back( PathCacheEntry() );
+    PathCacheEntry& entry = pathCache.back();
+    entry.FromX = from_hx;
+    entry.FromY = from_hy;
+    entry.ToX = to_hx;
+    entry.ToY = to_hy;
+    entry.Multihex = multihex;
+    entry.Cut = cut;
+    entry.CheckCrit = check_cr;
+    entry.CheckGagItems = check_gag_items;
+    entry.CreateTick = tick;
+    entry.UseTick = tick;
+    entry.Path = path;
+}
+
+void Map::ClearPathCache()
+{
+    SCOPE_LOCK( pathCacheLocker );
+
+    pathCache.clear();
+}
+
+PathGraph* Map::GetPathGraph()
+{
+    if( pathGraph )
+        return pathGraph;
+
+    SCOPE_LOCK( pathGraphLocker );
+
+    // Static blockers of proto map never change, graph is kept for map lifetime
+    if( !pathGraph )
+    {
+        PathGraph* graph = new PathGraph();
+        graph->Build( GetMaxHexX(), GetMaxHexY(), Proto->HexFlags );
+        pathGraph = graph;
+    }
+    return pathGraph;
+}
+
+void Map::GetPathCacheStatistics( uint& hits, uint& misses )
+{
+    SCOPE_LOCK( pathCacheLocker );
+
+    hits = pathCacheHits;
+    misses = pathCacheMisses;
+}
+
 ushort Map::GetHexFlags( ushort hx, ushort hy )
 {
     return (hexFlags[hy * GetMaxHexX() + hx] << 8) | Proto->HexFlags[hy * GetMaxHexX() + hx];
@@ -1410,18 +1740,25 @@ Critter* Map::GetHexCritter( ushort hx, ushort hy, bool dead, bool sync_lock )
     return cr;
 }
 
-void Map::GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters, bool sync_lock )
+static void FilterCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters )
 {
-    dataLocker.Lock();
-    CrVec find_critters;
-    find_critters.reserve( mapCritters.size() );
-    for( auto it = mapCritters.begin(), end = mapCritters.end(); it != end; ++it )
+    uint count = 0;
+    for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
     {
         Critter* cr = *it;
         if( cr->CheckFind( find_type ) && CheckDist( hx, hy, cr->GetHexX(), cr->GetHexY(), radius + cr->GetMultihex() ) )
-            find_critters.push_back( cr );
+            critters[count++] = cr;
     }
+    critters.resize( count );
+}
+
+void Map::GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters, bool sync_lock )
+{
+    dataLocker.Lock();
+    CrVec find_critters;
+    GridCollectCritters( hx, hy, radius + gridMultihexMax, find_critters );
     dataLocker.Unlock();
+    FilterCrittersHex( hx, hy, radius, find_type, find_critters );
 
     if( sync_lock && LogicMT )
     {
@@ -1432,14 +1769,9 @@ void Map::GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVe
         // Recheck
         dataLocker.Lock();
         CrVec find_critters2;
-        find_critters2.reserve( find_critters.size() );
-        for( auto it = mapCritters.begin(), end = mapCritters.end(); it != end; ++it )
-        {
-            Critter* cr = *it;
-            if( cr->CheckFind( find_type ) && CheckDist( hx, hy, cr->GetHexX(), cr->GetHexY(), radius + cr->GetMultihex() ) )
-                find_critters2.push_back( cr );
-        }
+        GridCollectCritters( hx, hy, radius + gridMultihexMax, find_critters2 );
         dataLocker.Unlock();
+        FilterCrittersHex( hx, hy, radius, find_type, find_critters2 );
 
         // Search again
         if( !CompareContainers( find_critters, find_critters2 ) )
@@ -1481,6 +1813,50 @@ void Map::GetCritters( CrVec& critters, bool sync_lock )
     }
 }
 
+void Map::GetCrittersNear( ushort hx, ushort hy, uint radius, CrVec& critters, bool sync_lock )
+{
+    dataLocker.Lock();
+    GridCollectCritters( hx, hy, radius, critters );
+    dataLocker.Unlock();
+
+    if( sync_lock && LogicMT )
+    {
+        // Synchronize
+        for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
+            SYNC_LOCK( *it );
+
+        // Recheck after synchronization
+        CrVec critters2;
+        dataLocker.Lock();
+        GridCollectCritters( hx, hy, radius, critters2 );
+        dataLocker.Unlock();
+        if( !CompareContainers( critters, critters2 ) )
+        {
+            critters.clear();
+            GetCrittersNear( hx, hy, radius, critters, sync_lock );
+        }
+    }
+}
+
+void Map::SetCritterHex( Critter* cr )
+{
+    cr->SetJournalDirty();
+
+    SCOPE_LOCK( dataLocker );
+
+    if( cr->MapGridId == GetId() )
+        GridSetCritter( cr, true );
+}
+
+uint Map::GetVisibleRadius( uint radius )
+{
+    SCOPE_LOCK( dataLocker );
+
+    if( radius > gridVisibleMax )
+        gridVisibleMax = radius;
+    return gridVisibleMax;
+}
+
 void Map::GetPlayers( ClVec& players, bool sync_lock )
 {
     dataLocker.Lock();
@@ -1715,6 +2091,7 @@ bool Map::ParseScript( const char* script, bool first_time )
             return false;
         }
         Data.ScriptId = func_num;
+        SetJournalDirty();
     }
 
     if( Data.ScriptId && Script::PrepareContext( Script::GetScriptFuncBindId( Data.ScriptId ), _FUNC_, Str::FormatBuf( "Map id<%u>, pid<%u>", GetId(), GetPid() ) ) )
@@ -1810,6 +2187,7 @@ void Map::SetLoopTime( uint loop_num, uint ms )
     if( loop_num >= MAP_LOOP_FUNC_MAX )
         return;
     LoopWaitTick[loop_num] = ms;
+    WakeUp();
 }
 
 uchar Map::GetRain()
@@ -1822,6 +2200,7 @@ void Map::SetRain( uchar capacity )
     if( Data.MapRain == capacity )
         return;
     Data.MapRain = capacity;
+    SetJournalDirty();
 
     SCOPE_LOCK( dataLocker );
 
@@ -1844,6 +2223,7 @@ void Map::SetTime( int time )
     if( Data.MapTime == time )
         return;
     Data.MapTime = time;
+    SetJournalDirty();
 
     for( auto it = mapPlayers.begin(), end = mapPlayers.end(); it != end; ++it )
     {
@@ -1875,6 +2255,7 @@ void Map::SetDayTime( uint day_part, uint time )
             Data.MapDayTime[2] = Data.MapDayTime[1];
         if( Data.MapDayTime[3] < Data.MapDayTime[2] )
             Data.MapDayTime[3] = Data.MapDayTime[2];
+        SetJournalDirty();
 
         for( auto it = mapPlayers.begin(), end = mapPlayers.end(); it != end; ++it )
         {
@@ -1905,6 +2286,7 @@ void Map::SetDayColor( uint day_part, uchar r, uchar g, uchar b )
         Data.MapDayColor[0 + day_part] = r;
         Data.MapDayColor[4 + day_part] = g;
         Data.MapDayColor[8 + day_part] = b;
+        SetJournalDirty();
 
         for( auto it = mapPlayers.begin(), end = mapPlayers.end(); it != end; ++it )
         {
@@ -1929,6 +2311,7 @@ void Map::SetData( uint index, int value )
         SCOPE_LOCK( dataLocker );
 
         Data.UserData[index] = value;
+        SetJournalDirty();
     }
 }
 
@@ -1984,6 +2367,7 @@ void Map::BeginTurnBased( Critter* first_cr )
 
     IsTurnBasedOn = true;
     NeedEndTurnBased = false;
+    WakeUp();
     TurnBasedRound = 0;
     TurnBasedTurn = 0;
     TurnBasedWholeTurn = 0;
@@ -2305,6 +2689,8 @@ void Location::Clear( bool full )
 
 void Location::Update()
 {
+    MapMngr.UpdateLocationZones( this );
+
     ClVec players;
     CrMngr.GetCopyPlayers( players, true );
 
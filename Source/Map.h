@@ -7,9 +7,11 @@
 #include "Defines.h"
 #include "Item.h"
 #include "Mutex.h"
+#include "PathGraph.h"
 #include "ProtoMap.h"
 #include "ThreadSync.h"
 #include "Types.h"
+#include "WorldJournal.h"
 
 extern const char* MapEventFuncName[MAP_EVENT_MAX];
 
@@ -18,9 +20,39 @@ extern const char* MapEventFuncName[MAP_EVENT_MAX];
 #define MAP_LOOP_DEFAULT_TICK    (60 * 60000)
 #define MAP_MAX_DATA             (100)
 
+// Spatial index cell size, in hexes
+#define MAP_GRID_CELL            (16)
+
+// Path cache
+#define MAP_PATH_CACHE_SIZE      (32)
+#define MAP_PATH_CACHE_STEPS     (10) // Shorter paths are not cached
+
 class Map;
 class Location;
 
+struct PathStep
+{
+    ushort HexX;
+    ushort HexY;
+    uint   MoveParams;
+    uchar  Dir;
+};
+typedef vector<PathStep> PathStepVec;
+
+struct PathCacheEntry
+{
+    ushort      FromX, FromY;
+    ushort      ToX, ToY;
+    uint        Multihex;
+    uint        Cut;
+    bool        CheckCrit;
+    bool        CheckGagItems;
+    uint        CreateTick;
+    uint        UseTick;
+    PathStepVec Path;
+};
+typedef vector<PathCacheEntry> PathCacheEntryVec;
+
 class Map
 {
 public:
@@ -35,6 +67,33 @@ private:
     ItemPtrVec hexItems;
     Location*  mapLocation;
 
+    // Spatial index, critters and items by cells of MAP_GRID_CELL x MAP_GRID_CELL hexes
+    uint               gridWidth;
+    uint               gridHeight;
+    vector<CrVec>      gridCritters;
+    vector<ItemPtrVec> gridItems;
+    ItemPtrVec         gridViewItems;   // Always visible items and traps, checked regardless of distance
+    uint               gridMultihexMax; // Highest multihex of critters on map
+    uint               gridVisibleMax;  // Highest look or show distance of critters on map
+
+    uint GetGridCell( ushort hx, ushort hy );
+    void GetGridRect( ushort hx, ushort hy, uint radius, uint& x1, uint& y1, uint& x2, uint& y2 );
+    void GridSetCritter( Critter* cr, bool add );
+    void GridCollectCritters( ushort hx, ushort hy, uint radius, CrVec& critters );
+    void GridAddItem( Item* item );
+    void GridEraseItem( Item* item );
+    void GridViewItem( Item* item );
+
+    // Path cache, long routes found on map, dropped when item blockers changed
+    MutexSpinlock     pathCacheLocker;
+    PathCacheEntryVec pathCache;
+    uint              pathCacheHits;
+    uint              pathCacheMisses;
+
+    // Hierarchical path finding graph, built on first use
+    Mutex               pathGraphLocker;
+    PathGraph* volatile pathGraph;
+
 public:
     struct MapData
     {
@@ -58,14 +117,19 @@ public:
     uint      LoopLastTick[MAP_LOOP_FUNC_MAX];
     uint      LoopWaitTick[MAP_LOOP_FUNC_MAX];
 
+    // Deadline scheduler, release tick of delayed job
+    volatile uint JobDelayTick;
+    void          WakeUp();
+
     bool Init( ProtoMap* proto, Location* location );
     bool Generate();
     void Clear( bool full );
-    void Process();
+    uint Process();
     void Lock()   { dataLocker.Lock(); }
     void Unlock() { dataLocker.Unlock(); }
 
     Location* GetLocation( bool lock );
+    void      SetJournalDirty(); // Data of map is saved in record of location
     ushort    GetMaxHexX() { return Proto->Header.MaxHexX; }
     ushort    GetMaxHexY() { return Proto->Header.MaxHexY; }
     void      SetLoopTime( uint loop_num, uint ms );
@@ -122,10 +186,18 @@ public:
     void        GetItemsPid( ushort pid, ItemPtrVec& items, bool lock );
     void        GetItemsType( int type, ItemPtrVec& items, bool lock );
     void        GetItemsTrap( ushort hx, ushort hy, ItemPtrVec& items, bool lock );
+    void        GetItemsNear( ushort hx, ushort hy, uint radius, ItemPtrVec& items ); // Items in cells around hex, without distance check
+    void        GetViewItems( ItemPtrVec& items );
     void        RecacheHexBlock( ushort hx, ushort hy );
     void        RecacheHexShoot( ushort hx, ushort hy );
     void        RecacheHexBlockShoot( ushort hx, ushort hy );
 
+    bool GetCachedPath( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint multihex, uint cut, bool check_cr, bool check_gag_items, PathStepVec& path );
+    void SetCachedPath( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint multihex, uint cut, bool check_cr, bool check_gag_items, const PathStepVec& path );
+    void ClearPathCache();
+    void GetPathCacheStatistics( uint& hits, uint& misses );
+    PathGraph* GetPathGraph();
+
     ushort GetHexFlags( ushort hx, ushort hy );
     void   SetHexFlag( ushort hx, ushort hy, uchar flag );
     void   UnsetHexFlag( ushort hx, ushort hy, uchar flag );
@@ -152,6 +224,9 @@ public:
     void     GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters, bool sync_lock ); // Critters append
 
     void   GetCritters( CrVec& critters, bool sync_lock );
+    void   GetCrittersNear( ushort hx, ushort hy, uint radius, CrVec& critters, bool sync_lock ); // Critters in cells around hex, without distance check
+    void   SetCritterHex( Critter* cr );                                                          // Update index after position or multihex change
+    uint   GetVisibleRadius( uint radius );
     void   GetPlayers( ClVec& players, bool sync_lock );
     void   GetNpcs( PcVec& npcs, bool sync_lock );
     CrVec& GetCrittersNoLock() { return mapCritters; }
@@ -283,6 +358,7 @@ public:
 
     ProtoLocation* Proto;
     volatile int   GeckCount;
+    uint           JournalGen; // Generation of last change report to world journal, maps are saved with location
     int            FuncId[LOCATION_EVENT_MAX];
 
     bool       Init( ProtoLocation* proto, ushort wx, ushort wy );
@@ -290,6 +366,14 @@ public:
     void       Update();
     bool       IsVisible()       { return Data.Visible || (Data.GeckVisible && GeckCount > 0); }
     uint       GetId()           { return Data.LocId; }
+    void       SetJournalDirty()
+    {
+        if( JournalGen != WorldJournal::DirtyGeneration && Data.LocId )
+        {
+            JournalGen = WorldJournal::DirtyGeneration;
+            WorldJournal::SetDirty( WORLD_SECTION_LOCATIONS, 0, Data.LocId );
+        }
+    }
     void       SetId( uint _id ) { Data.LocId = _id; }
     ushort     GetPid()          { return Data.LocPid; }
     uint       GetRadius()       { return Data.Radius; }
@@ -325,7 +409,11 @@ public:
         RefCounter--;
         if( RefCounter <= 0 ) delete this;
     }
-    Location() : RefCounter( 1 ), Proto( NULL ), IsNotValid( false ) { memzero( (void*)&Data, sizeof(Data) ); }
+    Location() : RefCounter( 1 ), Proto( NULL ), JournalGen( 0 ), IsNotValid( false )
+    {
+        memzero( (void*)&Data, sizeof(Data) );
+        Sync.SetType( SYNC_OBJECT_LOCATION );
+    }
 };
 typedef map<uint, Location*> LocMap;
 typedef vector<Location*>    LocVec;
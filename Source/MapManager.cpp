@@ -14,7 +14,9 @@
 #include "Script.h"
 #include "ScriptFunctions.h"
 #include "Text.h"
+#include "Thread.h"
 #include "Timer.h"
+#include "Tracer.h"
 
 MapManager MapMngr;
 
@@ -123,7 +125,7 @@ void GlobalMapGroup::Clear()
 MapManager::MapManager() : lastMapId( 0 ), lastLocId( 0 ), runGarbager( true )
 {
     MEMORY_PROCESS( MEMORY_STATIC, sizeof(MapManager) );
-    MEMORY_PROCESS( MEMORY_STATIC, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) );     // Grid, see below
+    MEMORY_PROCESS( MEMORY_STATIC, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) * (sizeof(short) + sizeof(ushort) ) ); // Grid and grid epochs, see below
 }
 
 bool MapManager::Init()
@@ -162,6 +164,10 @@ void MapManager::Finish()
     }
     allLocations.clear();
     allMaps.clear();
+    locRegistry.Clear();
+    locZones.clear();
+    locZoneRects.Clear();
+    mapRegistry.Clear();
 
     for( int i = 0; i < MAX_PROTO_MAPS; i++ )
         ProtoMaps[i].Clear();
@@ -178,9 +184,13 @@ void MapManager::Clear()
     for( auto it = allLocations.begin(); it != allLocations.end(); ++it )
         SAFEREL( (*it).second );
     allLocations.clear();
+    locRegistry.Clear();
+    locZones.clear();
+    locZoneRects.Clear();
     for( auto it = allMaps.begin(); it != allMaps.end(); ++it )
         SAFEREL( (*it).second );
     allMaps.clear();
+    mapRegistry.Clear();
 }
 
 UIntPair EntranceParser( const char* str )
@@ -191,7 +201,87 @@ UIntPair EntranceParser( const char* str )
     return UIntPair( val1, val2 );
 }
 
-bool MapManager::LoadLocationsProtos()
+struct ProtoMapTask
+{
+    ProtoMap* Map;
+    ushort    Pid;
+    char      Name[MAX_FOPATH];
+};
+typedef vector<ProtoMapTask> ProtoMapTaskVec;
+
+static ProtoMapTaskVec ProtoMapTasks;
+static volatile long   ProtoMapTasksNext = 0;
+
+static void ProtoMapsLoader( void* )
+{
+    while( true )
+    {
+        uint index = (uint)InterlockedIncrement( &ProtoMapTasksNext ) - 1;
+        if( index >= ProtoMapTasks.size() )
+            break;
+
+        // Fail is reported by second try in LoadLocationProto
+        ProtoMapTask& task = ProtoMapTasks[index];
+        task.Map->Init( task.Pid, task.Name, PATH_SERVER_MAPS );
+    }
+}
+
+void MapManager::LoadProtoMaps( IniParser& city_txt, uint threads )
+{
+    // Collect not loaded maps of all locations, errors are checked later by LoadLocationProto
+    ProtoMapTasks.clear();
+    ProtoMapTasksNext = 0;
+
+    bool collected[MAX_PROTO_MAPS] = { 0 };
+    char app[MAX_FOTEXT];
+    char key[MAX_FOTEXT];
+    char res[MAX_FOTEXT];
+    for( int i = 1; i < MAX_PROTO_LOCATIONS; i++ )
+    {
+        Str::Format( app, "Area %u", i );
+        if( !city_txt.IsCachedApp( app ) )
+            continue;
+
+        for( uint cur_map = 0; city_txt.GetStr( app, Str::Format( key, "map_%u", cur_map ), "", res ); cur_map++ )
+        {
+            ProtoMapTask task;
+            if( sscanf( res, "%s%hu", task.Name, &task.Pid ) != 2 || !task.Pid || task.Pid >= MAX_PROTO_MAPS )
+                break;
+
+            size_t len = Str::Length( task.Name );
+            if( task.Name[len - 1] == '*' )
+            {
+                if( len == 1 )
+                    break;
+                task.Name[len - 1] = 0;
+            }
+
+            task.Map = &ProtoMaps[task.Pid];
+            if( collected[task.Pid] || task.Map->IsInit() )
+                continue;
+
+            collected[task.Pid] = true;
+            ProtoMapTasks.push_back( task );
+        }
+    }
+
+    // Parse maps in threads
+    threads = MIN( threads, (uint)ProtoMapTasks.size() );
+    if( threads > 1 )
+    {
+        WriteLog( "Load map prototypes in threads<%u>, maps<%u>...\n", threads, ProtoMapTasks.size() );
+
+        Thread* loaders = new Thread[threads];
+        for( uint i = 0; i < threads; i++ )
+            loaders[i].Start( ProtoMapsLoader, Str::FormatBuf( "ProtoMaps%u", i ) );
+        for( uint i = 0; i < threads; i++ )
+            loaders[i].Wait();
+        delete[] loaders;
+    }
+    ProtoMapTasks.clear();
+}
+
+bool MapManager::LoadLocationsProtos( uint threads /* = 1 */ )
 {
     WriteLog( "Load location and map prototypes...\n" );
 
@@ -205,6 +295,10 @@ bool MapManager::LoadLocationsProtos()
 
     city_txt.CacheApps();
 
+    // Map files are independent, parse them first
+    if( threads > 1 )
+        LoadProtoMaps( city_txt, threads );
+
     int  errors = 0;
     uint loaded = 0;
     char res[MAX_FOTEXT];
@@ -380,25 +474,47 @@ bool MapManager::LoadLocationProto( IniParser& city_txt, ProtoLocation& ploc, us
     return true;
 }
 
-void MapManager::SaveAllLocationsAndMapsFile( void (*save_func)( void*, size_t ) )
+static void SaveLocationRecord( Location* loc, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    if( record_func )
+        record_func();
+    save_func( &loc->Data, sizeof(loc->Data) );
+
+    MapVec& maps = loc->GetMapsNoLock();
+    uint    map_count = (uint)maps.size();
+    save_func( &map_count, sizeof(map_count) );
+    for( auto it = maps.begin(), end = maps.end(); it != end; ++it )
+    {
+        Map* map = *it;
+        save_func( &map->Data, sizeof(map->Data) );
+    }
+}
+
+void MapManager::SaveAllLocationsAndMapsFile( void (*save_func)( void*, size_t ), void (*record_func)() )
 {
     uint count = (uint)allLocations.size();
     save_func( &count, sizeof(count) );
 
     for( auto it = allLocations.begin(), end = allLocations.end(); it != end; ++it )
-    {
-        Location* loc = (*it).second;
-        save_func( &loc->Data, sizeof(loc->Data) );
+        SaveLocationRecord( (*it).second, save_func, record_func );
+}
 
-        MapVec& maps = loc->GetMapsNoLock();
-        uint    map_count = (uint)maps.size();
-        save_func( &map_count, sizeof(map_count) );
-        for( auto it_ = maps.begin(), end_ = maps.end(); it_ != end_; ++it_ )
-        {
-            Map* map = *it_;
-            save_func( &map->Data, sizeof(map->Data) );
-        }
+void MapManager::SaveLocationsRecords( const UIntVec& ids, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    // Erased locations are missed, journal writes erase records for them
+    LocVec locs;
+    locs.reserve( ids.size() );
+    for( auto it = ids.begin(), end = ids.end(); it != end; ++it )
+    {
+        auto it_loc = allLocations.find( *it );
+        if( it_loc != allLocations.end() )
+            locs.push_back( (*it_loc).second );
     }
+
+    uint count = (uint)locs.size();
+    save_func( &count, sizeof(count) );
+    for( auto it = locs.begin(), end = locs.end(); it != end; ++it )
+        SaveLocationRecord( *it, save_func, record_func );
 }
 
 bool MapManager::LoadAllLocationsAndMapsFile( void* f )
@@ -461,6 +577,7 @@ bool MapManager::LoadAllLocationsAndMapsFile( void* f )
             return false;
         }
         loc->Data = data;
+        UpdateLocationZones( loc );
 
         for( uint j = 0; j < map_count; j++ )
         {
@@ -491,7 +608,7 @@ string MapManager::GetLocationsMapsStatistics()
     Str::Format( str, "Maps count: %u\n", allMaps.size() );
     result += str;
     result += "Location Name        Id          Pid  X     Y     Radius Color    Visible GeckVisible GeckCount AutoGarbage ToGarbage\n";
-    result += "          Map Name            Id          Pid  Time Rain TbAviable TbOn   Script\n";
+    result += "          Map Name            Id          Pid  Time Rain TbAviable TbOn   PathHits    PathMisses  Script\n";
     for( auto it = allLocations.begin(), end = allLocations.end(); it != end; ++it )
     {
         Location* loc = (*it).second;
@@ -505,9 +622,11 @@ string MapManager::GetLocationsMapsStatistics()
         for( auto it_ = maps.begin(), end_ = maps.end(); it_ != end_; ++it_ )
         {
             Map* map = *it_;
-            Str::Format( str, "     %2u) %-20s %09u   %-4u %-4d %-4u %-9s %-6s %-50s\n",
+            uint path_hits, path_misses;
+            map->GetPathCacheStatistics( path_hits, path_misses );
+            Str::Format( str, "     %2u) %-20s %09u   %-4u %-4d %-4u %-9s %-6s %-11u %-11u %-50s\n",
                          map_index, map->Proto->GetName(), map->GetId(), map->GetPid(), map->GetTime(), map->GetRain(),
-                         map->Data.IsTurnBasedAviable ? "true" : "false", map->IsTurnBasedOn ? "true" : "false",
+                         map->Data.IsTurnBasedAviable ? "true" : "false", map->IsTurnBasedOn ? "true" : "false", path_hits, path_misses,
                          map->Data.ScriptId ? Script::GetScriptFuncName( map->Data.ScriptId ).c_str() : "" );
             result += str;
             map_index++;
@@ -663,7 +782,12 @@ Location* MapManager::CreateLocation( ushort pid_loc, ushort wx, ushort wy, uint
     SYNC_LOCK( loc );
 
     mapLocker.Lock();
-    allLocations.insert( PAIR( loc->GetId(), loc ) );
+    if( allLocations.insert( PAIR( loc->GetId(), loc ) ).second )
+    {
+        locRegistry.Add( loc->GetId(), loc );
+        Rect zones = GetLocationZoneRect( loc );
+        AddLocationToZones( loc, zones );
+    }
     mapLocker.Unlock();
 
     // Generate location maps
@@ -736,7 +860,8 @@ Map* MapManager::CreateMap( ushort pid_map, Location* loc_map, uint map_id )
     Job::PushBack( JOB_MAP, map );
 
     mapLocker.Lock();
-    allMaps.insert( PAIR( map->GetId(), map ) );
+    if( allMaps.insert( PAIR( map->GetId(), map ) ).second )
+        mapRegistry.Add( map->GetId(), map );
     mapLocker.Unlock();
 
     return map;
@@ -747,13 +872,7 @@ Map* MapManager::GetMap( uint map_id, bool sync_lock )
     if( !map_id )
         return NULL;
 
-    Map* map = NULL;
-
-    mapLocker.Lock();
-    auto it = allMaps.find( map_id );
-    if( it != allMaps.end() )
-        map = (*it).second;
-    mapLocker.Unlock();
+    Map* map = mapRegistry.Get( map_id );
 
     if( map && sync_lock )
         SYNC_LOCK( map );
@@ -832,15 +951,9 @@ Location* MapManager::GetLocation( uint loc_id )
     if( !loc_id )
         return NULL;
 
-    mapLocker.Lock();
-    auto it = allLocations.find( loc_id );
-    if( it == allLocations.end() )
-    {
-        mapLocker.Unlock();
+    Location* loc = locRegistry.Get( loc_id );
+    if( !loc )
         return NULL;
-    }
-    Location* loc = (*it).second;
-    mapLocker.Unlock();
 
     SYNC_LOCK( loc );
     return loc;
@@ -885,16 +998,170 @@ void MapManager::GetZoneLocations( int zx, int zy, int zone_radius, UIntVec& loc
 {
     SCOPE_LOCK( mapLocker );
 
+    LocVec locs;
+    FindZoneLocations( Rect( zx - zone_radius, zy - zone_radius, zx + zone_radius, zy + zone_radius ), locs );
+
     int wx = zx * GM_ZONE_LEN;
     int wy = zy * GM_ZONE_LEN;
-    for( auto it = allLocations.begin(), end = allLocations.end(); it != end; ++it )
+    for( auto it = locs.begin(), end = locs.end(); it != end; ++it )
     {
-        Location* loc = (*it).second;
+        Location* loc = *it;
         if( loc->IsVisible() && IsIntersectZone( wx, wy, 0, loc->Data.WX, loc->Data.WY, loc->GetRadius(), zone_radius ) )
             loc_ids.push_back( loc->GetId() );
     }
 }
 
+void MapManager::GetRadiusLocations( int wx, int wy, uint radius, LocVec& locs )
+{
+    SCOPE_LOCK( mapLocker );
+
+    int    zl = GM_ZONE_LEN;
+    int    r = (int)MIN( radius, (uint)0x20000 );
+    LocVec locs_;
+    FindZoneLocations( Rect( (wx - r) / zl, (wy - r) / zl, (wx + r) / zl, (wy + r) / zl ), locs_ );
+
+    for( auto it = locs_.begin(), end = locs_.end(); it != end; ++it )
+    {
+        Location* loc = *it;
+        if( DistSqrt( wx, wy, loc->Data.WX, loc->Data.WY ) <= radius + loc->GetRadius() )
+            locs.push_back( loc );
+    }
+}
+
+Location* MapManager::GetNearestLocation( int wx, int wy, uint radius, bool only_visible )
+{
+    SCOPE_LOCK( mapLocker );
+
+    if( locZones.empty() )
+        return NULL;
+
+    int zl = GM_ZONE_LEN;
+    int zx = CLAMP( wx / zl, 0, GM__MAXZONEX - 1 );
+    int zy = CLAMP( wy / zl, 0, GM__MAXZONEY - 1 );
+    int max_ring = MAX( MAX( zx, GM__MAXZONEX - 1 - zx ), MAX( zy, GM__MAXZONEY - 1 - zy ) );
+
+    // Distance is counted to location edge, scan rings of zones around point
+    Location* nearest = NULL;
+    uint      nearest_dist = 0;
+    for( int ring = 0; ring <= max_ring; ring++ )
+    {
+        // Locations which are not found yet are at least ring - 1 zones far
+        uint ring_dist = (uint)MAX( ring - 1, 0 ) * zl;
+        if( ring_dist > radius || (nearest && nearest_dist <= ring_dist) )
+            break;
+
+        for( int y = zy - ring; y <= zy + ring; y++ )
+        {
+            if( y < 0 || y >= GM__MAXZONEY )
+                continue;
+
+            int step = (y == zy - ring || y == zy + ring ? 1 : MAX( ring * 2, 1 ) );
+            for( int x = zx - ring; x <= zx + ring; x += step )
+            {
+                if( x < 0 || x >= GM__MAXZONEX )
+                    continue;
+
+                LocVec& zone = locZones[y * GM__MAXZONEX + x];
+                for( auto it = zone.begin(), end = zone.end(); it != end; ++it )
+                {
+                    Location* loc = *it;
+                    if( only_visible && !loc->IsVisible() )
+                        continue;
+
+                    uint dist = DistSqrt( wx, wy, loc->Data.WX, loc->Data.WY );
+                    dist = (dist > loc->GetRadius() ? dist - loc->GetRadius() : 0);
+                    if( dist <= radius && (!nearest || dist < nearest_dist) )
+                    {
+                        nearest = loc;
+                        nearest_dist = dist;
+                    }
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+Rect MapManager::GetLocationZoneRect( Location* loc )
+{
+    int zl = GM_ZONE_LEN;
+    int wx = loc->Data.WX;
+    int wy = loc->Data.WY;
+    int r = loc->GetRadius();
+    return Rect( CLAMP( (wx - r) / zl, 0, GM__MAXZONEX - 1 ), CLAMP( (wy - r) / zl, 0, GM__MAXZONEY - 1 ),
+                 CLAMP( (wx + r) / zl, 0, GM__MAXZONEX - 1 ), CLAMP( (wy + r) / zl, 0, GM__MAXZONEY - 1 ) );
+}
+
+void MapManager::AddLocationToZones( Location* loc, const Rect& r )
+{
+    if( locZones.empty() )
+        locZones.resize( GM__MAXZONEX * GM__MAXZONEY );
+
+    for( int y = r.T; y <= r.B; y++ )
+        for( int x = r.L; x <= r.R; x++ )
+            locZones[y * GM__MAXZONEX + x].push_back( loc );
+    locZoneRects.Insert( loc->GetId(), r );
+}
+
+void MapManager::EraseLocationFromZones( Location* loc, const Rect& r )
+{
+    for( int y = r.T; y <= r.B; y++ )
+    {
+        for( int x = r.L; x <= r.R; x++ )
+        {
+            LocVec& zone = locZones[y * GM__MAXZONEX + x];
+            auto    it = std::find( zone.begin(), zone.end(), loc );
+            if( it != zone.end() )
+            {
+                *it = zone.back();
+                zone.pop_back();
+            }
+        }
+    }
+    locZoneRects.Erase( loc->GetId() );
+}
+
+void MapManager::FindZoneLocations( const Rect& zones, LocVec& locs )
+{
+    if( locZones.empty() )
+        return;
+
+    Rect r( CLAMP( zones.L, 0, GM__MAXZONEX - 1 ), CLAMP( zones.T, 0, GM__MAXZONEY - 1 ),
+            CLAMP( zones.R, 0, GM__MAXZONEX - 1 ), CLAMP( zones.B, 0, GM__MAXZONEY - 1 ) );
+    for( int y = r.T; y <= r.B; y++ )
+    {
+        for( int x = r.L; x <= r.R; x++ )
+        {
+            LocVec& zone = locZones[y * GM__MAXZONEX + x];
+            for( auto it = zone.begin(), end = zone.end(); it != end; ++it )
+            {
+                // Take location only in first zone of rects intersection
+                Rect* loc_zones = locZoneRects.Find( (*it)->GetId() );
+                if( loc_zones && x == MAX( r.L, loc_zones->L ) && y == MAX( r.T, loc_zones->T ) )
+                    locs.push_back( *it );
+            }
+        }
+    }
+}
+
+void MapManager::UpdateLocationZones( Location* loc )
+{
+    loc->SetJournalDirty();
+
+    SCOPE_LOCK( mapLocker );
+
+    Rect* zones = locZoneRects.Find( loc->GetId() );
+    if( !zones )
+        return;
+
+    Rect new_zones = GetLocationZoneRect( loc );
+    if( zones->L != new_zones.L || zones->T != new_zones.T || zones->R != new_zones.R || zones->B != new_zones.B )
+    {
+        EraseLocationFromZones( loc, *zones );
+        AddLocationToZones( loc, new_zones );
+    }
+}
+
 void MapManager::GetLocations( LocVec& locs, bool lock )
 {
     SCOPE_LOCK( mapLocker );
@@ -947,6 +1214,11 @@ void MapManager::LocationGarbager()
                 auto it = allLocations.find( loc->GetId() );
                 if( it != allLocations.end() )
                     allLocations.erase( it );
+                locRegistry.Erase( loc->GetId() );
+                loc->SetJournalDirty();
+                Rect* zones = locZoneRects.Find( loc->GetId() );
+                if( zones )
+                    EraseLocationFromZones( loc, *zones );
                 mapLocker.Unlock();
 
                 // Delete maps
@@ -962,6 +1234,7 @@ void MapManager::LocationGarbager()
                     // Delete from main array
                     mapLocker.Lock();
                     allMaps.erase( map->GetId() );
+                    mapRegistry.Erase( map->GetId() );
                     mapLocker.Unlock();
                 }
 
@@ -1033,6 +1306,8 @@ void MapManager::GM_GroupMove( GlobalMapGroup* group )
 
 void MapManager::GM_GlobalProcess( Critter* cr, GlobalMapGroup* group, int type )
 {
+    TRACE_SCOPE( TRACE_GLOBAL_PROCESS );
+
     static THREAD int recursion_depth = 0;
     if( ++recursion_depth > 100 )
     {
@@ -1140,6 +1415,7 @@ void MapManager::GM_GlobalProcess( Critter* cr, GlobalMapGroup* group, int type
             {
                 cr->Data.WorldX = cur_wxi;
                 cr->Data.WorldY = cur_wyi;
+                cr->SetJournalDirty();
                 cr->Send_GlobalInfo( GM_INFO_GROUP_PARAM );
             }
         }
@@ -1306,6 +1582,7 @@ void MapManager::GM_GroupStartMove( Critter* cr )
 
     cr->Data.HexX = 0;
     cr->Data.HexY = 0;
+    cr->SetJournalDirty();
     cr->GroupMove = cr->GroupSelf;
     GlobalMapGroup* group = cr->GroupMove;
     group->Clear();
@@ -1359,6 +1636,7 @@ void MapManager::GM_AddCritToGroup( Critter* cr, uint rule_id )
     cr->Data.WorldY = (uint)group->CurY;
     cr->Data.HexX = (rule_id >> 16) & 0xFFFF;
     cr->Data.HexY = rule_id & 0xFFFF;
+    cr->SetJournalDirty();
 
     for( auto it = group->CritMove.begin(), end = group->CritMove.end(); it != end; ++it )
         (*it)->Send_AddCritter( cr );
@@ -1426,6 +1704,7 @@ void MapManager::GM_GiveRule( Critter* cr, Critter* new_rule )
     new_rule->GroupSelf->Rule = new_rule;
     cr->GroupSelf->Clear();
     new_rule->GroupMove = new_rule->GroupSelf;
+    new_rule->WakeUp();
     UNSETFLAG( cr->Flags, CRITTER_FLAG_RULEGROUP );
     SETFLAG( new_rule->Flags, CRITTER_FLAG_RULEGROUP );
 
@@ -1771,19 +2050,87 @@ void MapManager::TraceBullet( TraceData& trace )
     }
 }
 
-int THREAD           MapGridOffsX = 0;
-int THREAD           MapGridOffsY = 0;
-static THREAD short* Grid = NULL;
-#define GRID( x, y )    Grid[( (FPATH_MAX_PATH + 1) + (y) - MapGridOffsY ) * (FPATH_MAX_PATH * 2 + 2) + ( (FPATH_MAX_PATH + 1) + (x) - MapGridOffsX )]
-int MapManager::FindPath( PathFindData& pfd )
+int THREAD            MapGridOffsX = 0;
+int THREAD            MapGridOffsY = 0;
+static THREAD short*  Grid = NULL;
+static THREAD ushort* GridEpochs = NULL;
+static THREAD ushort  GridEpoch = 0;
+#define GRID_SIDE       (FPATH_MAX_PATH * 2 + 2)
+#define GRID( x, y )    GridCell( ( (FPATH_MAX_PATH + 1) + (y) - MapGridOffsY ) * GRID_SIDE + ( (FPATH_MAX_PATH + 1) + (x) - MapGridOffsX ) )
+
+// Cells written by previous searches are cleared on first access, instead of clearing whole grid for every search
+static inline short& GridCell( int index )
 {
-    // Allocate temporary grid
-    if( !Grid )
+    if( GridEpochs[index] != GridEpoch )
     {
-        Grid = new short[(FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2)];
-        if( !Grid )
-            return FPATH_ALLOC_FAIL;
+        GridEpochs[index] = GridEpoch;
+        Grid[index] = 0;
     }
+    return Grid[index];
+}
+
+static void NextGridEpoch()
+{
+    if( ++GridEpoch == 0 )
+    {
+        memzero( GridEpochs, GRID_SIDE * GRID_SIDE * sizeof(ushort) );
+        GridEpoch = 1;
+    }
+}
+
+// A* nodes, indexed by map hex
+struct AStarNode
+{
+    uint   Epoch;
+    uint   Cost;
+    uint   Parent;
+    ushort Steps;
+    uchar  Dir;
+    bool   Closed;
+};
+
+struct AStarOpenNode
+{
+    uint Estimate;
+    uint Cost;
+    uint Index;
+};
+typedef vector<AStarOpenNode> AStarOpenNodeVec;
+
+#define ASTAR_GAG_COST        (10)             // Same distance as gag hexes deferring in BFS
+#define ASTAR_CRITTER_COST    (FPATH_MAX_PATH) // Critters are passed only if there is no other way
+
+static THREAD AStarNode*        AStarNodes = NULL;
+static THREAD uint              AStarNodesCount = 0;
+static THREAD uint              AStarEpoch = 0;
+static THREAD AStarOpenNodeVec* AStarOpen = NULL;
+
+static inline AStarNode& AStarGetNode( uint index )
+{
+    AStarNode& node = AStarNodes[index];
+    if( node.Epoch != AStarEpoch )
+    {
+        node.Epoch = AStarEpoch;
+        node.Cost = uint( -1 );
+        node.Closed = false;
+    }
+    return node;
+}
+
+// Heap order, lowest estimate on top, deeper node first on equal estimates
+static bool AStarOpenCompare( const AStarOpenNode& a, const AStarOpenNode& b )
+{
+    if( a.Estimate != b.Estimate )
+        return a.Estimate > b.Estimate;
+    return a.Cost < b.Cost;
+}
+
+static MutexSpinlock      PathFindLocker;
+static PathFindStatistics PathFindStats[FPATH_FINDER_COUNT];
+
+int MapManager::FindPath( PathFindData& pfd )
+{
+    TRACE_SCOPE( TRACE_FIND_PATH );
 
     // Data
     uint   map_id = pfd.MapId;
@@ -1841,6 +2188,179 @@ int MapManager::FindPath( PathFindData& pfd )
             return FPATH_HEX_BUSY_RING;
     }
 
+    // Route found by previous search
+    uint path_num = (pathNumCur + 1 < FPATH_DATA_SIZE ? pathNumCur + 1 : 1);
+    if( PathCacheTime && map->GetCachedPath( from_hx, from_hy, to_hx, to_hy, multihex, cut, check_cr, check_gag_items, pathesPool[path_num] ) )
+    {
+        pathNumCur = path_num;
+    }
+    else
+    {
+        // Search
+        int    finder = (PathFinder > 0 && PathFinder < FPATH_FINDER_COUNT ? PathFinder : FPATH_FINDER_BFS);
+        uint   nodes = 0;
+        double tick = Timer::AccurateTick();
+        int    result;
+        if( finder == FPATH_FINDER_HIERARCHICAL )
+            result = FindPathHierarchical( map, pfd, nodes );
+        else if( finder == FPATH_FINDER_ASTAR )
+            result = FindPathAStar( map, pfd, nodes );
+        else
+            result = FindPathBFS( map, pfd, nodes );
+        tick = Timer::AccurateTick() - tick;
+
+        {
+            SCOPE_LOCK( PathFindLocker );
+
+            PathFindStatistics& stats = PathFindStats[finder];
+            stats.Calls++;
+            if( result == FPATH_OK )
+                stats.Found++;
+            stats.Nodes += nodes;
+            stats.Time += tick;
+        }
+
+        if( result != FPATH_OK )
+            return result;
+
+        if( PathCacheTime && pathesPool[pathNumCur].size() >= MAP_PATH_CACHE_STEPS )
+            map->SetCachedPath( from_hx, from_hy, to_hx, to_hy, multihex, cut, check_cr, check_gag_items, pathesPool[pathNumCur] );
+    }
+    PathStepVec& path = pathesPool[pathNumCur];
+
+    // Check for closed door and critter
+    if( check_cr || check_gag_items )
+    {
+        for( int i = 0, j = (int)path.size(); i < j; i++ )
+        {
+            PathStep& ps = path[i];
+            if( map->IsHexPassed( ps.HexX, ps.HexY ) )
+                continue;
+
+            if( check_gag_items && map->IsHexGag( ps.HexX, ps.HexY ) )
+            {
+                Item* item = map->GetItemGag( ps.HexX, ps.HexY );
+                if( !item )
+                    continue;
+                pfd.GagItem = item;
+                path.resize( i );
+                break;
+            }
+
+            if( check_cr && map->IsFlagCritter( ps.HexX, ps.HexY, false ) )
+            {
+                Critter* cr = map->GetHexCritter( ps.HexX, ps.HexY, false, false );
+                if( !cr || cr == pfd.FromCritter )
+                    continue;
+                pfd.GagCritter = cr;
+                path.resize( i );
+                break;
+            }
+        }
+    }
+
+    // Trace
+    if( trace )
+    {
+        IntVec trace_seq;
+        ushort targ_hx = pfd.TraceCr->GetHexX();
+        ushort targ_hy = pfd.TraceCr->GetHexY();
+        bool   trace_ok = false;
+
+        trace_seq.resize( path.size() + 4 );
+        for( int i = 0, j = (int)path.size(); i < j; i++ )
+        {
+            PathStep& ps = path[i];
+            if( map->IsHexGag( ps.HexX, ps.HexY ) )
+            {
+                trace_seq[i + 2 - 2] += 1;
+                trace_seq[i + 2 - 1] += 2;
+                trace_seq[i + 2 - 0] += 3;
+                trace_seq[i + 2 + 1] += 2;
+                trace_seq[i + 2 + 2] += 1;
+            }
+        }
+
+        TraceData trace_;
+        trace_.TraceMap = map;
+        trace_.EndHx = targ_hx;
+        trace_.EndHy = targ_hy;
+        trace_.FindCr = pfd.TraceCr;
+        for( int k = 0; k < 5; k++ )
+        {
+            for( int i = 0, j = (int)path.size(); i < j; i++ )
+            {
+                if( k < 4 && trace_seq[i + 2] != k )
+                    continue;
+                if( k == 4 && trace_seq[i + 2] < 4 )
+                    continue;
+
+                PathStep& ps = path[i];
+
+                if( !CheckDist( ps.HexX, ps.HexY, targ_hx, targ_hy, trace ) )
+                    continue;
+
+                trace_.BeginHx = ps.HexX;
+                trace_.BeginHy = ps.HexY;
+                TraceBullet( trace_ );
+                if( trace_.IsCritterFounded )
+                {
+                    trace_ok = true;
+                    path.resize( i + 1 );
+                    goto label_TraceOk;
+                }
+            }
+        }
+
+        if( !trace_ok && !pfd.GagItem && !pfd.GagCritter )
+            return FPATH_TRACE_FAIL;
+label_TraceOk:
+        if( trace_ok )
+        {
+            pfd.GagItem = NULL;
+            pfd.GagCritter = NULL;
+        }
+    }
+
+    // Parse move params
+    PathSetMoveParams( path, is_run );
+
+    // Number of path
+    if( path.empty() )
+        return FPATH_ALREADY_HERE;
+    pfd.PathNum = pathNumCur;
+
+    // New X,Y
+    PathStep& ps = path[path.size() - 1];
+    pfd.NewToX = ps.HexX;
+    pfd.NewToY = ps.HexY;
+    return FPATH_OK;
+}
+
+int MapManager::FindPathBFS( Map* map, PathFindData& pfd, uint& nodes )
+{
+    // Allocate temporary grid
+    if( !Grid )
+    {
+        Grid = new short[GRID_SIDE * GRID_SIDE];
+        GridEpochs = new ushort[GRID_SIDE * GRID_SIDE];
+        if( !Grid || !GridEpochs )
+            return FPATH_ALLOC_FAIL;
+        memzero( GridEpochs, GRID_SIDE * GRID_SIDE * sizeof(ushort) );
+    }
+
+    ushort from_hx = pfd.FromX;
+    ushort from_hy = pfd.FromY;
+    ushort to_hx = pfd.ToX;
+    ushort to_hy = pfd.ToY;
+    uint   multihex = pfd.Multihex;
+    uint   cut = pfd.Cut;
+    bool   check_cr = pfd.CheckCrit;
+    bool   check_gag_items = pfd.CheckGagItems;
+    int    dirs_count = DIRS_COUNT;
+    ushort maxhx = map->GetMaxHexX();
+    ushort maxhy = map->GetMaxHexY();
+
     // Parse previous move params
     /*UShortPairVec first_steps;
        uchar first_dir=pfd.MoveParams&7;
@@ -1861,7 +2381,7 @@ int MapManager::FindPath( PathFindData& pfd )
 
     // Prepare
     int numindex = 1;
-    memzero( Grid, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) * sizeof(short) );
+    NextGridEpoch();
     MapGridOffsX = from_hx;
     MapGridOffsY = from_hy;
     GRID( from_hx, from_hy ) = numindex;
@@ -1885,6 +2405,8 @@ int MapManager::FindPath( PathFindData& pfd )
             cy = coords[p].second;
             numindex = GRID( cx, cy );
 
+            nodes++;
+
             if( CheckDist( cx, cy, to_hx, to_hy, cut ) )
                 goto label_FindOk;
             if( ++numindex > FPATH_MAX_PATH )
@@ -2073,115 +2595,244 @@ label_FindOk:
         smooth_iteration++;
     }
 
-    // Check for closed door and critter
-    if( check_cr || check_gag_items )
+    return FPATH_OK;
+}
+
+// Steps are added to path, search is stopped after max_nodes taken hexes
+static int AStarSearch( Map* map, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, uint cut, uint multihex,
+                        bool check_cr, bool check_gag_items, uint max_nodes, uint& nodes, PathStepVec& path )
+{
+    int    dirs_count = DIRS_COUNT;
+    ushort maxhx = map->GetMaxHexX();
+    ushort maxhy = map->GetMaxHexY();
+
+    // Allocate nodes for whole map, reused by next searches
+    uint nodes_count = maxhx * maxhy;
+    if( nodes_count > AStarNodesCount )
     {
-        for( int i = 0, j = (int)path.size(); i < j; i++ )
+        delete[] AStarNodes;
+        AStarNodes = new AStarNode[nodes_count];
+        AStarNodesCount = 0;
+        if( !AStarNodes )
+            return FPATH_ALLOC_FAIL;
+        memzero( AStarNodes, nodes_count * sizeof(AStarNode) );
+        AStarNodesCount = nodes_count;
+        AStarEpoch = 0;
+    }
+    if( !AStarOpen )
+    {
+        AStarOpen = new AStarOpenNodeVec();
+        AStarOpen->reserve( 1000 );
+    }
+
+    if( ++AStarEpoch == 0 )
+    {
+        memzero( AStarNodes, AStarNodesCount * sizeof(AStarNode) );
+        AStarEpoch = 1;
+    }
+
+    AStarOpenNodeVec& open = *AStarOpen;
+    open.clear();
+
+    // First point
+    uint       from_index = from_hy * maxhx + from_hx;
+    AStarNode& from = AStarGetNode( from_index );
+    from.Cost = 0;
+    from.Parent = from_index;
+    from.Steps = 0;
+    from.Dir = 0;
+
+    AStarOpenNode first = { (uint)MAX( DistGame( from_hx, from_hy, to_hx, to_hy ) - (int)cut, 0 ), 0, from_index };
+    open.push_back( first );
+
+    // Begin search
+    bool too_far = false;
+    uint found_index = uint( -1 );
+    uint search_nodes = 0;
+    while( !open.empty() && search_nodes < max_nodes )
+    {
+        AStarOpenNode cur = open.front();
+        std::pop_heap( open.begin(), open.end(), AStarOpenCompare );
+        open.pop_back();
+
+        // Skip outdated entries
+        AStarNode& node = AStarNodes[cur.Index];
+        if( node.Closed || node.Cost != cur.Cost )
+            continue;
+        node.Closed = true;
+        search_nodes++;
+
+        ushort cx = cur.Index % maxhx;
+        ushort cy = cur.Index / maxhx;
+        if( CheckDist( cx, cy, to_hx, to_hy, cut ) )
         {
-            PathStep& ps = path[i];
-            if( map->IsHexPassed( ps.HexX, ps.HexY ) )
+            found_index = cur.Index;
+            break;
+        }
+        if( node.Steps + 1 >= FPATH_MAX_PATH )
+        {
+            too_far = true;
+            continue;
+        }
+
+        short* sx, * sy;
+        GetHexOffsets( cx & 1, sx, sy );
+
+        for( int j = 0; j < dirs_count; j++ )
+        {
+            short nx = (short)cx + sx[j];
+            short ny = (short)cy + sy[j];
+            if( nx < 0 || ny < 0 || nx >= maxhx || ny >= maxhy )
                 continue;
 
-            if( check_gag_items && map->IsHexGag( ps.HexX, ps.HexY ) )
+            uint       next_index = ny * maxhx + nx;
+            AStarNode& next = AStarGetNode( next_index );
+            if( next.Closed )
+                continue;
+
+            uint cost = node.Cost + 1;
+            if( !multihex )
             {
-                Item* item = map->GetItemGag( ps.HexX, ps.HexY );
-                if( !item )
+                ushort flags = map->GetHexFlags( nx, ny );
+                if( !FLAG( flags, HEX_FLAG_NOWAY ) )
+                    ;
+                else if( check_gag_items && FLAG( flags, HEX_FLAG_GAG_ITEM << 8 ) )
+                    cost += ASTAR_GAG_COST;
+                else if( check_cr && FLAG( flags, HEX_FLAG_CRITTER << 8 ) )
+                    cost += ASTAR_CRITTER_COST;
+                else
+                {
+                    next.Closed = true;
                     continue;
-                pfd.GagItem = item;
-                path.resize( i );
-                break;
+                }
             }
-
-            if( check_cr && map->IsFlagCritter( ps.HexX, ps.HexY, false ) )
+            else if( !map->IsMovePassed( nx, ny, j, multihex ) )
             {
-                Critter* cr = map->GetHexCritter( ps.HexX, ps.HexY, false, false );
-                if( !cr || cr == pfd.FromCritter )
-                    continue;
-                pfd.GagCritter = cr;
-                path.resize( i );
-                break;
+                continue;
             }
+
+            if( cost >= next.Cost )
+                continue;
+
+            next.Cost = cost;
+            next.Parent = cur.Index;
+            next.Steps = node.Steps + 1;
+            next.Dir = j;
+
+            AStarOpenNode open_node = { cost + (uint)MAX( DistGame( nx, ny, to_hx, to_hy ) - (int)cut, 0 ), cost, next_index };
+            open.push_back( open_node );
+            std::push_heap( open.begin(), open.end(), AStarOpenCompare );
         }
     }
+    nodes += search_nodes;
 
-    // Trace
-    if( trace )
+    if( found_index == uint( -1 ) )
+        return too_far ? FPATH_TOOFAR : FPATH_DEADLOCK;
+
+    // Collect path from end
+    uint base = (uint)path.size();
+    path.resize( base + AStarNodes[found_index].Steps );
+    for( uint index = found_index; index != from_index;)
     {
-        IntVec trace_seq;
-        ushort targ_hx = pfd.TraceCr->GetHexX();
-        ushort targ_hy = pfd.TraceCr->GetHexY();
-        bool   trace_ok = false;
+        AStarNode& node = AStarNodes[index];
+        PathStep&  ps = path[base + node.Steps - 1];
+        ps.HexX = index % maxhx;
+        ps.HexY = index / maxhx;
+        ps.Dir = node.Dir;
+        index = node.Parent;
+    }
+    return FPATH_OK;
+}
 
-        trace_seq.resize( path.size() + 4 );
-        for( int i = 0, j = (int)path.size(); i < j; i++ )
-        {
-            PathStep& ps = path[i];
-            if( map->IsHexGag( ps.HexX, ps.HexY ) )
-            {
-                trace_seq[i + 2 - 2] += 1;
-                trace_seq[i + 2 - 1] += 2;
-                trace_seq[i + 2 - 0] += 3;
-                trace_seq[i + 2 + 1] += 2;
-                trace_seq[i + 2 + 2] += 1;
-            }
-        }
+int MapManager::FindPathAStar( Map* map, PathFindData& pfd, uint& nodes )
+{
+    uint         path_num = (pathNumCur + 1 < FPATH_DATA_SIZE ? pathNumCur + 1 : 1);
+    PathStepVec& path = pathesPool[path_num];
+    path.clear();
 
-        TraceData trace_;
-        trace_.TraceMap = map;
-        trace_.EndHx = targ_hx;
-        trace_.EndHy = targ_hy;
-        trace_.FindCr = pfd.TraceCr;
-        for( int k = 0; k < 5; k++ )
-        {
-            for( int i = 0, j = (int)path.size(); i < j; i++ )
-            {
-                if( k < 4 && trace_seq[i + 2] != k )
-                    continue;
-                if( k == 4 && trace_seq[i + 2] < 4 )
-                    continue;
+    int result = AStarSearch( map, pfd.FromX, pfd.FromY, pfd.ToX, pfd.ToY, pfd.Cut, pfd.Multihex, pfd.CheckCrit, pfd.CheckGagItems, uint( -1 ), nodes, path );
+    if( result == FPATH_OK )
+        pathNumCur = path_num;
+    return result;
+}
 
-                PathStep& ps = path[i];
+int MapManager::FindPathHierarchical( Map* map, PathFindData& pfd, uint& nodes )
+{
+    ushort from_hx = pfd.FromX;
+    ushort from_hy = pfd.FromY;
+    ushort to_hx = pfd.ToX;
+    ushort to_hy = pfd.ToY;
+    uint   cut = pfd.Cut;
+    bool   check_cr = pfd.CheckCrit;
+    bool   check_gag_items = pfd.CheckGagItems;
 
-                if( !CheckDist( ps.HexX, ps.HexY, targ_hx, targ_hy, trace ) )
-                    continue;
+    // Short routes and multihex critters are searched directly
+    if( pfd.Multihex || DistGame( from_hx, from_hy, to_hx, to_hy ) <= PATH_CLUSTER_SIZE * 2 )
+        return FindPathAStar( map, pfd, nodes );
 
-                trace_.BeginHx = ps.HexX;
-                trace_.BeginHy = ps.HexY;
-                TraceBullet( trace_ );
-                if( trace_.IsCritterFounded )
-                {
-                    trace_ok = true;
-                    path.resize( i + 1 );
-                    goto label_TraceOk;
-                }
-            }
-        }
+    // Route over portals of clusters, searched again on any fail
+    UShortPairVec waypoints;
+    if( !map->GetPathGraph()->FindRoute( from_hx, from_hy, to_hx, to_hy, waypoints, nodes ) )
+        return FindPathAStar( map, pfd, nodes );
 
-        if( !trace_ok && !pfd.GagItem && !pfd.GagCritter )
-            return FPATH_TRACE_FAIL;
-label_TraceOk:
-        if( trace_ok )
-        {
-            pfd.GagItem = NULL;
-            pfd.GagCritter = NULL;
-        }
-    }
+    uint         path_num = (pathNumCur + 1 < FPATH_DATA_SIZE ? pathNumCur + 1 : 1);
+    PathStepVec& path = pathesPool[path_num];
+    path.clear();
 
-    // Parse move params
-    PathSetMoveParams( path, is_run );
+    // Local searches between portals, dynamic blockers are avoided here
+    ushort cx = from_hx;
+    ushort cy = from_hy;
+    for( uint i = 0; i < (uint)waypoints.size() && !CheckDist( cx, cy, to_hx, to_hy, cut ); i++ )
+    {
+        ushort wx = waypoints[i].first;
+        ushort wy = waypoints[i].second;
+        ushort flags = map->GetHexFlags( wx, wy );
+        if( FLAG( flags, HEX_FLAG_NOWAY ) )
+            continue;
 
-    // Number of path
-    if( path.empty() )
-        return FPATH_ALREADY_HERE;
-    pfd.PathNum = pathNumCur;
+        if( AStarSearch( map, cx, cy, wx, wy, 0, 0, check_cr, check_gag_items, FPATH_SEGMENT_NODES, nodes, path ) != FPATH_OK )
+            return FindPathAStar( map, pfd, nodes );
+        cx = wx;
+        cy = wy;
+    }
+    if( !CheckDist( cx, cy, to_hx, to_hy, cut ) &&
+        AStarSearch( map, cx, cy, to_hx, to_hy, cut, 0, check_cr, check_gag_items, FPATH_SEGMENT_NODES, nodes, path ) != FPATH_OK )
+        return FindPathAStar( map, pfd, nodes );
 
-    // New X,Y
-    PathStep& ps = path[path.size() - 1];
-    pfd.NewToX = ps.HexX;
-    pfd.NewToY = ps.HexY;
+    // Detour is longer than allowed path, full search can find shorter one
+    if( path.size() >= FPATH_MAX_PATH )
+        return FindPathAStar( map, pfd, nodes );
+
+    pathNumCur = path_num;
     return FPATH_OK;
 }
 
+void MapManager::GetPathFindStatistics( PathFindStatistics* stats )
+{
+    SCOPE_LOCK( PathFindLocker );
+
+    memcpy( stats, PathFindStats, sizeof(PathFindStats) );
+}
+
+string MapManager::GetPathFindStatisticsString()
+{
+    static const char* finder_names[FPATH_FINDER_COUNT] = { "BFS", "A*", "HPA*" };
+
+    PathFindStatistics stats[FPATH_FINDER_COUNT];
+    GetPathFindStatistics( stats );
+
+    char   str[MAX_FOTEXT];
+    string result = Str::Format( str, "Path finding, current algorithm %s\n", finder_names[PathFinder > 0 && PathFinder < FPATH_FINDER_COUNT ? PathFinder : FPATH_FINDER_BFS] );
+    result += "Type     Calls       Found       Nodes       Time,ms     Per call,us Nodes/call\n";
+    for( int i = 0; i < FPATH_FINDER_COUNT; i++ )
+    {
+        PathFindStatistics& s = stats[i];
+        result += Str::Format( str, "%-8s %-11llu %-11llu %-11llu %-11.1f %-11.2f %-11.1f\n", finder_names[i], s.Calls, s.Found, s.Nodes, s.Time,
+                               s.Calls ? s.Time * 1000.0 / (double)s.Calls : 0.0, s.Calls ? (double)s.Nodes / (double)s.Calls : 0.0 );
+    }
+    return result;
+}
+
 int MapManager::FindPathGrid( ushort& hx, ushort& hy, int index, bool smooth_switcher )
 {
     // Hexagonal
@@ -2630,6 +3281,7 @@ bool MapManager::Transit( Critter* cr, Map* map, ushort hx, ushort hy, uchar dir
         cr->Data.HexX = hx;
         cr->Data.HexY = hy;
         map->SetFlagCritter( hx, hy, multihex, is_dead );
+        map->SetCritterHex( cr );
         cr->SetBreakTime( 0 );
         cr->Send_ParamOther( OTHER_TELEPORT, (cr->GetHexX() << 16) | (cr->GetHexY() ) );
         cr->ClearVisible();
@@ -2728,6 +3380,9 @@ bool MapManager::AddCrToMap( Critter* cr, Map* map, ushort tx, ushort ty, uint r
         map->AddCritter( cr );
         cr->LockMapTransfers--;
     }
+
+    // Recalculate processing deadline on new place
+    cr->WakeUp();
     return true;
 }
 
@@ -2,10 +2,13 @@
 #define __MAP_MANAGER__
 
 #include "Critter.h"
+#include "FlexRect.h"
+#include "IdSet.h"
 #include "IniParser.h"
 #include "Item.h"
 #include "Map.h"
 #include "ProtoMap.h"
+#include "Registry.h"
 #include "Types.h"
 
 class GlobalMapGroup
@@ -84,6 +87,23 @@ struct TraceData
 #define FPATH_TRACE_TARG_NULL_PTR    (13)
 #define FPATH_ALLOC_FAIL             (14)
 
+// Path finding algorithms, selected with PathFinder in server config
+#define FPATH_FINDER_BFS             (0)
+#define FPATH_FINDER_ASTAR           (1)
+#define FPATH_FINDER_HIERARCHICAL    (2) // A* over clusters graph, refined by local A* between portals
+#define FPATH_FINDER_COUNT           (3)
+
+// Hexes taken by local search between portals, before fallback to full search
+#define FPATH_SEGMENT_NODES          (PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE * 8)
+
+struct PathFindStatistics
+{
+    uint64 Calls;
+    uint64 Found;
+    uint64 Nodes;    // Hexes taken from search queue
+    double Time;     // Milliseconds
+};
+
 struct PathFindData
 {
     uint     MapId;
@@ -110,15 +130,6 @@ struct PathFindData
     }
 };
 
-struct PathStep
-{
-    ushort HexX;
-    ushort HexY;
-    uint   MoveParams;
-    uchar  Dir;
-};
-typedef vector<PathStep> PathStepVec;
-
 class MapManager
 {
 private:
@@ -135,9 +146,11 @@ public:
     void Finish();
     void Clear();
 
-    bool   LoadLocationsProtos();
+    bool   LoadLocationsProtos( uint threads = 1 );
+    void   LoadProtoMaps( IniParser& city_txt, uint threads );
     bool   LoadLocationProto( IniParser& city_txt, ProtoLocation& ploc, ushort pid );
-    void   SaveAllLocationsAndMapsFile( void (*save_func)( void*, size_t ) );
+    void   SaveAllLocationsAndMapsFile( void (*save_func)( void*, size_t ), void (*record_func)() = NULL );
+    void   SaveLocationsRecords( const UIntVec& ids, void (*save_func)( void*, size_t ), void (*record_func)() = NULL ); // Delta save, only given locations
     bool   LoadAllLocationsAndMapsFile( void* f );
     string GetLocationsMapsStatistics();
     void   RunInitScriptMaps();
@@ -154,8 +167,10 @@ public:
 
     // Global map
 public:
-    bool IsIntersectZone( int wx1, int wy1, int wx1_radius, int wx2, int wy2, int wx2_radius, int zones );
-    void GetZoneLocations( int zx, int zy, int zone_radius, UIntVec& loc_ids );
+    bool      IsIntersectZone( int wx1, int wy1, int wx1_radius, int wx2, int wy2, int wx2_radius, int zones );
+    void      GetZoneLocations( int zx, int zy, int zone_radius, UIntVec& loc_ids );
+    void      GetRadiusLocations( int wx, int wy, uint radius, LocVec& locs );
+    Location* GetNearestLocation( int wx, int wy, uint radius, bool only_visible );
 
     void         GM_GroupStartMove( Critter* cr );
     void         GM_AddCritToGroup( Critter* cr, uint rule_id );
@@ -173,8 +188,19 @@ public:
 
     // Locations
 private:
-    LocMap        allLocations;
-    volatile bool runGarbager;
+    LocMap             allLocations;
+    Registry<Location> locRegistry;
+    volatile bool      runGarbager;
+
+    // Grid of global map zones, location is added to all zones covered by its radius
+    // Script can change coordinates and radius without notify, index is synchronized on Location::Update and on garbager pass
+    vector<LocVec>     locZones;
+    IdMap<Rect>        locZoneRects;
+
+    Rect GetLocationZoneRect( Location* loc );
+    void AddLocationToZones( Location* loc, const Rect& r );
+    void EraseLocationFromZones( Location* loc, const Rect& r );
+    void FindZoneLocations( const Rect& zones, LocVec& locs ); // Each location once, checked only by indexed rect
 
 public:
     bool           IsInitProtoLocation( ushort pid_loc );
@@ -186,13 +212,19 @@ public:
     void           GetLocations( LocVec& locs, bool lock );
     uint           GetLocationsCount();
     void           LocationGarbager();
+    void           UpdateLocationZones( Location* loc );
     void           RunGarbager() { runGarbager = true; }
 
     // Maps
 private:
-    MapMap      allMaps;
-    PathStepVec pathesPool[FPATH_DATA_SIZE];
-    uint        pathNumCur;
+    MapMap        allMaps;
+    Registry<Map> mapRegistry;
+    PathStepVec   pathesPool[FPATH_DATA_SIZE];
+    uint          pathNumCur;
+
+    int FindPathBFS( Map* map, PathFindData& pfd, uint& nodes );
+    int FindPathAStar( Map* map, PathFindData& pfd, uint& nodes );
+    int FindPathHierarchical( Map* map, PathFindData& pfd, uint& nodes );
 
 public:
     bool         IsInitProtoMap( ushort pid_map );
@@ -208,6 +240,9 @@ public:
     int          FindPathGrid( ushort& hx, ushort& hy, int index, bool smooth_switcher );
     PathStepVec& GetPath( uint num ) { return pathesPool[num]; }
     void         PathSetMoveParams( PathStepVec& path, bool is_run );
+
+    static void   GetPathFindStatistics( PathFindStatistics* stats );
+    static string GetPathFindStatisticsString();
 };
 
 extern MapManager MapMngr;
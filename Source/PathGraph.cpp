@@ -0,0 +1,380 @@
+#include "Core.h"
+
+#include "GameOptions.h"
+#include "PathGraph.h"
+
+#define PATH_CLUSTER_HEXES    (PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE)
+#define PATH_NO_DIST          (0xFFFF)
+
+// Passable pair of hexes of neighbour clusters
+struct PathCrossing
+{
+    uint64 Clusters;
+    uint   From;
+    uint   To;
+
+    bool operator<( const PathCrossing& r ) const { return Clusters < r.Clusters || (Clusters == r.Clusters && (From < r.From || (From == r.From && To < r.To) ) ); }
+};
+typedef vector<PathCrossing> PathCrossingVec;
+
+struct PathRawEdge
+{
+    uint          From;
+    PathGraphEdge Edge;
+
+    bool operator<( const PathRawEdge& r ) const { return From < r.From; }
+};
+typedef vector<PathRawEdge> PathRawEdgeVec;
+
+struct PathOpenNode
+{
+    uint Estimate;
+    uint Cost;
+    uint Index;
+};
+typedef vector<PathOpenNode> PathOpenNodeVec;
+
+// Search data of thread, sized by graph
+struct PathGraphSearch
+{
+    UIntVec          Cost;
+    UIntVec          Parent;
+    UCharVec         Closed;
+    PathOpenNodeVec  Open;
+    PathGraphEdgeVec StartEdges;
+    PathGraphEdgeVec GoalEdges;
+};
+
+static THREAD PathGraphSearch* Search = NULL;
+
+static bool PathOpenCompare( const PathOpenNode& a, const PathOpenNode& b )
+{
+    if( a.Estimate != b.Estimate )
+        return a.Estimate > b.Estimate;
+    return a.Cost < b.Cost;
+}
+
+PathGraph::PathGraph() : maxHexX( 0 ), maxHexY( 0 ), clustersX( 0 ), clustersY( 0 ), staticFlags( NULL )
+{
+    //
+}
+
+bool PathGraph::IsPassed( ushort hx, ushort hy )
+{
+    return !FLAG( staticFlags[hy * maxHexX + hx], HEX_FLAG_BLOCK );
+}
+
+uint PathGraph::GetCluster( ushort hx, ushort hy )
+{
+    return (hy / PATH_CLUSTER_SIZE) * clustersX + hx / PATH_CLUSTER_SIZE;
+}
+
+uint PathGraph::GetClusterIndex( ushort hx, ushort hy )
+{
+    return (hy % PATH_CLUSTER_SIZE) * PATH_CLUSTER_SIZE + hx % PATH_CLUSTER_SIZE;
+}
+
+// Distances from hex to all hexes of its cluster, without leaving cluster
+void PathGraph::GetClusterDistances( ushort hx, ushort hy, ushort* dist )
+{
+    for( uint i = 0; i < PATH_CLUSTER_HEXES; i++ )
+        dist[i] = PATH_NO_DIST;
+
+    int    x1 = hx / PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE;
+    int    y1 = hy / PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE;
+    int    x2 = MIN( x1 + PATH_CLUSTER_SIZE, (int)maxHexX );
+    int    y2 = MIN( y1 + PATH_CLUSTER_SIZE, (int)maxHexY );
+    int    dirs_count = DIRS_COUNT;
+    ushort queue[PATH_CLUSTER_HEXES];
+    uint   queue_begin = 0;
+    uint   queue_end = 0;
+
+    // Start hex can be blocked, it is target of search with cut
+    dist[GetClusterIndex( hx, hy )] = 0;
+    queue[queue_end++] = GetClusterIndex( hx, hy );
+    while( queue_begin < queue_end )
+    {
+        uint   index = queue[queue_begin++];
+        ushort cx = x1 + index % PATH_CLUSTER_SIZE;
+        ushort cy = y1 + index / PATH_CLUSTER_SIZE;
+
+        short* sx, * sy;
+        GetHexOffsets( cx & 1, sx, sy );
+        for( int j = 0; j < dirs_count; j++ )
+        {
+            int nx = cx + sx[j];
+            int ny = cy + sy[j];
+            if( nx < x1 || ny < y1 || nx >= x2 || ny >= y2 || !IsPassed( nx, ny ) )
+                continue;
+
+            uint next = GetClusterIndex( nx, ny );
+            if( dist[next] != PATH_NO_DIST )
+                continue;
+            dist[next] = dist[index] + 1;
+            queue[queue_end++] = next;
+        }
+    }
+}
+
+void PathGraph::Build( ushort maxhx, ushort maxhy, const uchar* static_flags )
+{
+    maxHexX = maxhx;
+    maxHexY = maxhy;
+    staticFlags = static_flags;
+    clustersX = (maxhx + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+    clustersY = (maxhy + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+    graphNodes.clear();
+    graphEdges.clear();
+    clusterNodes.clear();
+    clusterNodes.resize( clustersX * clustersY );
+
+    // Crossings between clusters, each pair of hexes once from cluster with lower index
+    int             dirs_count = DIRS_COUNT;
+    PathCrossingVec crossings;
+    for( ushort hy = 0; hy < maxhy; hy++ )
+    {
+        for( ushort hx = 0; hx < maxhx; hx++ )
+        {
+            if( !IsPassed( hx, hy ) )
+                continue;
+
+            uint   cluster = GetCluster( hx, hy );
+            short* sx, * sy;
+            GetHexOffsets( hx & 1, sx, sy );
+            for( int j = 0; j < dirs_count; j++ )
+            {
+                int nx = hx + sx[j];
+                int ny = hy + sy[j];
+                if( nx < 0 || ny < 0 || nx >= maxhx || ny >= maxhy || !IsPassed( nx, ny ) )
+                    continue;
+
+                uint next_cluster = GetCluster( nx, ny );
+                if( next_cluster <= cluster )
+                    continue;
+
+                PathCrossing c;
+                c.Clusters = ( ( (uint64)cluster ) << 32 ) | next_cluster;
+                c.From = hy * maxhx + hx;
+                c.To = ny * maxhx + nx;
+                crossings.push_back( c );
+            }
+        }
+    }
+    std::sort( crossings.begin(), crossings.end() );
+
+    // Entrances are runs of neighbour crossings, portals are placed in middle or on ends of long ones
+    UIntMap        hex_nodes;
+    PathRawEdgeVec raw_edges;
+    for( uint begin = 0; begin < (uint)crossings.size();)
+    {
+        uint end = begin + 1;
+        while( end < (uint)crossings.size() && crossings[end].Clusters == crossings[begin].Clusters )
+        {
+            uint prev = crossings[end - 1].From;
+            uint cur = crossings[end].From;
+            if( prev != cur && DistGame( prev % maxhx, prev / maxhx, cur % maxhx, cur / maxhx ) > 1 )
+                break;
+            end++;
+        }
+
+        uint portals[2] = { begin + (end - begin) / 2, end - 1 };
+        uint portals_count = 1;
+        if( end - begin > PATH_ENTRANCE_SPLIT )
+        {
+            portals[0] = begin;
+            portals_count = 2;
+        }
+
+        for( uint p = 0; p < portals_count; p++ )
+        {
+            PathCrossing& c = crossings[portals[p]];
+            uint          pair_nodes[2];
+            uint          hexes[2] = { c.From, c.To };
+            for( int i = 0; i < 2; i++ )
+            {
+                auto it = hex_nodes.find( hexes[i] );
+                if( it == hex_nodes.end() )
+                {
+                    PathGraphNode node;
+                    node.HexX = hexes[i] % maxhx;
+                    node.HexY = hexes[i] / maxhx;
+                    node.FirstEdge = 0;
+                    node.EdgesCount = 0;
+                    it = hex_nodes.insert( PAIR( hexes[i], (uint)graphNodes.size() ) ).first;
+                    clusterNodes[GetCluster( node.HexX, node.HexY )].push_back( (uint)graphNodes.size() );
+                    graphNodes.push_back( node );
+                }
+                pair_nodes[i] = it->second;
+            }
+
+            PathRawEdge e;
+            e.Edge.Cost = 1;
+            e.From = pair_nodes[0];
+            e.Edge.To = pair_nodes[1];
+            raw_edges.push_back( e );
+            e.From = pair_nodes[1];
+            e.Edge.To = pair_nodes[0];
+            raw_edges.push_back( e );
+        }
+
+        begin = end;
+    }
+
+    // Portals of same cluster are connected by distances inside of cluster
+    ushort dist[PATH_CLUSTER_HEXES];
+    for( uint i = 0; i < (uint)clusterNodes.size(); i++ )
+    {
+        UIntVec& cluster_nodes = clusterNodes[i];
+        for( uint j = 0; j < (uint)cluster_nodes.size(); j++ )
+        {
+            PathGraphNode& from = graphNodes[cluster_nodes[j]];
+            GetClusterDistances( from.HexX, from.HexY, dist );
+            for( uint k = 0; k < (uint)cluster_nodes.size(); k++ )
+            {
+                PathGraphNode& to = graphNodes[cluster_nodes[k]];
+                ushort         d = dist[GetClusterIndex( to.HexX, to.HexY )];
+                if( k == j || d == PATH_NO_DIST )
+                    continue;
+
+                PathRawEdge e;
+                e.From = cluster_nodes[j];
+                e.Edge.To = cluster_nodes[k];
+                e.Edge.Cost = d;
+                raw_edges.push_back( e );
+            }
+        }
+    }
+
+    std::stable_sort( raw_edges.begin(), raw_edges.end() );
+    graphEdges.resize( raw_edges.size() );
+    for( uint i = 0; i < (uint)raw_edges.size(); i++ )
+    {
+        PathGraphNode& node = graphNodes[raw_edges[i].From];
+        if( !node.EdgesCount )
+            node.FirstEdge = i;
+        node.EdgesCount++;
+        graphEdges[i] = raw_edges[i].Edge;
+    }
+}
+
+bool PathGraph::FindRoute( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, UShortPairVec& waypoints, uint& nodes )
+{
+    waypoints.clear();
+    if( !Search )
+        Search = new PathGraphSearch();
+    PathGraphSearch& s = *Search;
+
+    // Start and goal are temporary nodes, connected to portals of own clusters
+    uint   start = (uint)graphNodes.size();
+    uint   goal = start + 1;
+    ushort dist[PATH_CLUSTER_HEXES];
+
+    s.StartEdges.clear();
+    GetClusterDistances( from_hx, from_hy, dist );
+    UIntVec& start_nodes = clusterNodes[GetCluster( from_hx, from_hy )];
+    for( uint i = 0; i < (uint)start_nodes.size(); i++ )
+    {
+        PathGraphNode& node = graphNodes[start_nodes[i]];
+        ushort         d = dist[GetClusterIndex( node.HexX, node.HexY )];
+        if( d != PATH_NO_DIST )
+        {
+            PathGraphEdge e = { start_nodes[i], d };
+            s.StartEdges.push_back( e );
+        }
+    }
+
+    s.GoalEdges.clear();
+    GetClusterDistances( to_hx, to_hy, dist );
+    UIntVec& goal_nodes = clusterNodes[GetCluster( to_hx, to_hy )];
+    for( uint i = 0; i < (uint)goal_nodes.size(); i++ )
+    {
+        PathGraphNode& node = graphNodes[goal_nodes[i]];
+        ushort         d = dist[GetClusterIndex( node.HexX, node.HexY )];
+        if( d != PATH_NO_DIST )
+        {
+            PathGraphEdge e = { goal_nodes[i], d };
+            s.GoalEdges.push_back( e );
+        }
+    }
+
+    if( s.StartEdges.empty() || s.GoalEdges.empty() )
+        return false;
+
+    s.Cost.assign( goal + 1, uint( -1 ) );
+    s.Parent.assign( goal + 1, start );
+    s.Closed.assign( goal + 1, 0 );
+    s.Open.clear();
+
+    s.Cost[start] = 0;
+    PathOpenNode first = { DistGame( from_hx, from_hy, to_hx, to_hy ), 0, start };
+    s.Open.push_back( first );
+
+    while( !s.Open.empty() )
+    {
+        PathOpenNode cur = s.Open.front();
+        std::pop_heap( s.Open.begin(), s.Open.end(), PathOpenCompare );
+        s.Open.pop_back();
+
+        if( s.Closed[cur.Index] || s.Cost[cur.Index] != cur.Cost )
+            continue;
+        s.Closed[cur.Index] = 1;
+        nodes++;
+
+        if( cur.Index == goal )
+            break;
+
+        const PathGraphEdge* edges;
+        uint                 edges_count;
+        if( cur.Index == start )
+        {
+            edges = &s.StartEdges[0];
+            edges_count = (uint)s.StartEdges.size();
+        }
+        else
+        {
+            PathGraphNode& node = graphNodes[cur.Index];
+            edges = (node.EdgesCount ? &graphEdges[node.FirstEdge] : NULL);
+            edges_count = node.EdgesCount;
+        }
+
+        for( uint i = 0; i <= edges_count; i++ )
+        {
+            uint next, cost;
+            if( i < edges_count )
+            {
+                next = edges[i].To;
+                cost = cur.Cost + edges[i].Cost;
+            }
+            else
+            {
+                // Portals of goal cluster lead to goal
+                next = goal;
+                cost = uint( -1 );
+                for( uint j = 0; j < (uint)s.GoalEdges.size(); j++ )
+                    if( s.GoalEdges[j].To == cur.Index )
+                        cost = cur.Cost + s.GoalEdges[j].Cost;
+                if( cost == uint( -1 ) )
+                    continue;
+            }
+
+            if( s.Closed[next] || cost >= s.Cost[next] )
+                continue;
+
+            s.Cost[next] = cost;
+            s.Parent[next] = cur.Index;
+
+            uint         estimate = cost + (next == goal ? 0 : DistGame( graphNodes[next].HexX, graphNodes[next].HexY, to_hx, to_hy ) );
+            PathOpenNode open_node = { estimate, cost, next };
+            s.Open.push_back( open_node );
+            std::push_heap( s.Open.begin(), s.Open.end(), PathOpenCompare );
+        }
+    }
+
+    if( !s.Closed[goal] )
+        return false;
+
+    for( uint index = s.Parent[goal]; index != start; index = s.Parent[index] )
+        waypoints.push_back( UShortPair( graphNodes[index].HexX, graphNodes[index].HexY ) );
+    std::reverse( waypoints.begin(), waypoints.end() );
+    return true;
+}
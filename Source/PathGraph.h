@@ -0,0 +1,60 @@
+#ifndef __PATH_GRAPH__
+#define __PATH_GRAPH__
+
+#include "Types.h"
+
+// Clusters of hierarchical path finding, in hexes
+#define PATH_CLUSTER_SIZE       (16)
+// Long cluster entrances get portal on each end instead of one in middle
+#define PATH_ENTRANCE_SPLIT     (8)
+
+struct PathGraphEdge
+{
+    uint To;
+    uint Cost;
+};
+typedef vector<PathGraphEdge> PathGraphEdgeVec;
+
+// Portal hex on cluster border, edges are stored sequentially in graph
+struct PathGraphNode
+{
+    ushort HexX;
+    ushort HexY;
+    uint   FirstEdge;
+    uint   EdgesCount;
+};
+typedef vector<PathGraphNode> PathGraphNodeVec;
+
+// Abstract graph of map over static blockers of proto map
+// Portals are placed on passable entrances between clusters, connected by distances inside clusters
+// Graph is built once and only read after, dynamic blockers are handled by local searches between portals
+class PathGraph
+{
+public:
+    PathGraph();
+
+    void Build( ushort maxhx, ushort maxhy, const uchar* static_flags );
+
+    // Portals between start and goal, false if goal is not reachable over graph
+    bool FindRoute( ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, UShortPairVec& waypoints, uint& nodes );
+
+    uint GetNodesCount() { return (uint)graphNodes.size(); }
+    uint GetEdgesCount() { return (uint)graphEdges.size(); }
+
+private:
+    ushort           maxHexX;
+    ushort           maxHexY;
+    uint             clustersX;
+    uint             clustersY;
+    const uchar*     staticFlags;
+    PathGraphNodeVec graphNodes;
+    PathGraphEdgeVec graphEdges;
+    vector<UIntVec>  clusterNodes;
+
+    bool IsPassed( ushort hx, ushort hy );
+    uint GetCluster( ushort hx, ushort hy );
+    uint GetClusterIndex( ushort hx, ushort hy );
+    void GetClusterDistances( ushort hx, ushort hy, ushort* dist );
+};
+
+#endif // __PATH_GRAPH__
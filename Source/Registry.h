@@ -0,0 +1,106 @@
+#ifndef __REGISTRY__
+#define __REGISTRY__
+
+#include <unordered_map>
+
+#include "Mutex.h"
+#include "Text.h"
+#include "Types.h"
+
+// Registry shards count, power of two
+#define REGISTRY_SHARDS    (16)
+
+// Objects by id, lookup locks only one shard instead of whole collection
+// Managers keep own ordered collections for enumeration, registry is used for lookups by id
+template<class T>
+class Registry
+{
+private:
+    struct Shard
+    {
+        MutexSpinlock                Locker;
+        std::unordered_map<uint, T*> Objects;
+        uint                         Lookups;     // Changed under shard lock
+        uint                         Misses;
+        char                         Padding[64]; // Shard locks in different cache lines
+    };
+    Shard shards[REGISTRY_SHARDS];
+
+    Shard& GetShard( uint id ) { return shards[id & (REGISTRY_SHARDS - 1)]; }
+
+public:
+    Registry()
+    {
+        for( int i = 0; i < REGISTRY_SHARDS; i++ )
+            shards[i].Lookups = shards[i].Misses = 0;
+    }
+
+    void Add( uint id, T* obj )
+    {
+        Shard& shard = GetShard( id );
+        SCOPE_LOCK( shard.Locker );
+        shard.Objects[id] = obj;
+    }
+
+    void Erase( uint id )
+    {
+        Shard& shard = GetShard( id );
+        SCOPE_LOCK( shard.Locker );
+        shard.Objects.erase( id );
+    }
+
+    T* Get( uint id )
+    {
+        Shard& shard = GetShard( id );
+        SCOPE_LOCK( shard.Locker );
+        auto   it = shard.Objects.find( id );
+        shard.Lookups++;
+        if( it == shard.Objects.end() )
+        {
+            shard.Misses++;
+            return NULL;
+        }
+        return it->second;
+    }
+
+    void Clear()
+    {
+        for( int i = 0; i < REGISTRY_SHARDS; i++ )
+        {
+            SCOPE_LOCK( shards[i].Locker );
+            shards[i].Objects.clear();
+        }
+    }
+
+    uint Count()
+    {
+        uint count = 0;
+        for( int i = 0; i < REGISTRY_SHARDS; i++ )
+        {
+            SCOPE_LOCK( shards[i].Locker );
+            count += (uint)shards[i].Objects.size();
+        }
+        return count;
+    }
+
+    // Objects, lookups and misses, smallest and largest shard show balance of ids
+    string GetStatisticsString( const char* name )
+    {
+        uint objects = 0, lookups = 0, misses = 0, min_shard = MAX_UINT, max_shard = 0;
+        for( int i = 0; i < REGISTRY_SHARDS; i++ )
+        {
+            SCOPE_LOCK( shards[i].Locker );
+            uint size = (uint)shards[i].Objects.size();
+            objects += size;
+            lookups += shards[i].Lookups;
+            misses += shards[i].Misses;
+            min_shard = MIN( min_shard, size );
+            max_shard = MAX( max_shard, size );
+        }
+
+        char str[MAX_FOTEXT];
+        return Str::Format( str, "%-10s %-10u %-12u %-10u %u..%u\n", name, objects, lookups, misses, min_shard, max_shard );
+    }
+};
+
+#endif // __REGISTRY__
@@ -25,6 +25,10 @@
 #include "Types.h"
 #include "Version.h"
 
+#ifdef FOCLASSIC_SERVER
+# include "ScriptAot.h"
+#endif
+
 #ifdef SCRIPT_MULTITHREADING
 # include "Mutex.h"
 # include "ThreadSync.h"
@@ -51,8 +55,9 @@ public:
     string             FuncName;
     string             FuncDecl;
     size_t             NativeFuncAddr;
+    bool               ThreadSafe;
 
-    BindFunction( asIScriptFunction* script_func, size_t native_func_addr, const char* module_name,  const char* func_name, const char* func_decl )
+    BindFunction( asIScriptFunction* script_func, size_t native_func_addr, const char* module_name,  const char* func_name, const char* func_decl, bool thread_safe = false )
     {
         IsScriptCall = (native_func_addr == 0);
         ScriptFunc = script_func;
@@ -60,9 +65,20 @@ public:
         ModuleName = module_name;
         FuncName = func_name;
         FuncDecl = (func_decl ? func_decl : "");
+        ThreadSafe = thread_safe;
     }
 };
 typedef vector<BindFunction> BindFunctionVec;
+
+// Thread copy of binds, used by PrepareContext without locking
+struct BindCacheEntry
+{
+    bool               IsScriptCall;
+    asIScriptFunction* ScriptFunc;
+    size_t             NativeFuncAddr;
+    bool               ThreadSafe;
+};
+typedef vector<BindCacheEntry> BindCacheVec;
 asIScriptEngine* Engine = NULL;
 void*            EngineLogFile = NULL;
 int              ScriptsPath = PATH_SCRIPTS;
@@ -81,13 +97,30 @@ void CollectGarbage( asDWORD flags );
 BindFunctionVec BindedFunctions;
 #ifdef SCRIPT_MULTITHREADING
 Mutex           BindedFunctionsLocker;
+volatile long   BindedFunctionsGeneration = 1; // Changed on each new or rebinded function, invalidates thread caches
+THREAD BindCacheVec* BindCache = NULL;
+THREAD long          BindCacheGeneration = 0;
 #endif
 StrVec          ScriptFuncCache;
 IntVec          ScriptFuncBindId;
 
 bool            ConcurrentExecution = false;
+StrSet          ThreadSafeModulesConfig; // Modules from config
+StrSet          ThreadSafeModules;       // Modules from config which import only from thread safe modules
 #ifdef SCRIPT_MULTITHREADING
 Mutex           ConcurrentExecutionLocker;
+THREAD int      ExecutionLockLevel = 0; // Recursion level which holds ConcurrentExecutionLocker, zero if not holded
+
+struct
+{
+    volatile long Executions;
+    volatile long ThreadSafeExecutions; // Started without ConcurrentExecutionLocker
+    uint          Locks;                // Fields below are changed under ConcurrentExecutionLocker
+    uint          LockWaits;
+    uint64        LockWaitTime;         // Microseconds
+    uint          LockWaitMax;
+    uint          BindCacheRefreshes;   // Changed under BindedFunctionsLocker
+} ExecutionStats;
 #endif
 
 #ifdef FOCLASSIC_SERVER
@@ -197,6 +230,15 @@ BINARY_SIGNATURE( ScriptSaveSignature,   BINARY_TYPE_SCRIPTSAVE, FOCLASSIC_VERSI
 
 bool LoadLibraryCompiler = false;
 
+// Native code compiler, library stays loaded until exit because compiled code lives there
+typedef asIJITCompiler* (* CreateJitCompilerFunc)();
+string                JitCompilerPath;
+CreateJitCompilerFunc CreateJitCompiler = NULL;
+
+#ifdef FOCLASSIC_SERVER
+bool AotCompiler = false;
+#endif
+
 // Contexts
 THREAD asIScriptContext* GlobalCtx[GLOBAL_CONTEXT_STACK_SIZE] = { 0 };
 THREAD uint              GlobalCtxIndex = 0;
@@ -240,6 +282,9 @@ bool Script::Init( bool with_log, Preprocessor::Pragma::Callback* pragma_callbac
     BindedFunctions.reserve( 10000 );
     BindedFunctions.push_back( BindFunction( 0, 0, "", "", "" ) );     // None
     BindedFunctions.push_back( BindFunction( 0, 0, "", "", "" ) );     // Temp
+    #ifdef SCRIPT_MULTITHREADING
+    InterlockedIncrement( &BindedFunctionsGeneration );
+    #endif
 
     if( !InitThread() )
         return false;
@@ -419,6 +464,9 @@ void Script::Finish()
     RunTimeoutThread.Wait();
 
     BindedFunctions.clear();
+    #ifdef SCRIPT_MULTITHREADING
+    InterlockedIncrement( &BindedFunctionsGeneration );
+    #endif
     ScriptPreprocessor->SetPragmaCallback( NULL );
     ScriptPreprocessor->UndefAll();
     UnloadScripts();
@@ -568,11 +616,80 @@ void Script::SetConcurrentExecution( bool enabled )
     ConcurrentExecution = enabled;
 }
 
+void Script::SetThreadSafeModules( const char* modules )
+{
+    ThreadSafeModulesConfig.clear();
+
+    StrVec names;
+    Str::ParseLine( modules, ' ', names, Str::ParseLineDummy );
+    for( auto it = names.begin(), end = names.end(); it != end; ++it )
+        ThreadSafeModulesConfig.insert( *it );
+    ThreadSafeModules = ThreadSafeModulesConfig;
+}
+
 void Script::SetLoadLibraryCompiler( bool enabled )
 {
     LoadLibraryCompiler = enabled;
 }
 
+// External compiler, takes precedence over ahead of time compiler
+void Script::SetJitCompiler( const char* dll_path )
+{
+    JitCompilerPath = (dll_path ? dll_path : "");
+    CreateJitCompiler = NULL;
+    if( JitCompilerPath.empty() )
+        return;
+
+    void* dll = DLL_Load( JitCompilerPath.c_str() );
+    if( !dll )
+    {
+        WriteLogF( _FUNC_, " - Can't load JIT compiler<%s>, scripts will be interpreted.\n", JitCompilerPath.c_str() );
+        return;
+    }
+
+    CreateJitCompiler = (CreateJitCompilerFunc)DLL_GetAddress( dll, "CreateJitCompiler" );
+    if( !CreateJitCompiler )
+    {
+        WriteLogF( _FUNC_, " - Function<CreateJitCompiler> not found in JIT compiler<%s>, scripts will be interpreted.\n", JitCompilerPath.c_str() );
+        DLL_Free( dll );
+    }
+}
+
+#ifdef FOCLASSIC_SERVER
+void Script::SetAotCompiler( bool enabled )
+{
+    AotCompiler = enabled;
+}
+
+// Native code is looked up next to script binary, translation of functions without it is saved there for building by hand
+static void GetScriptAotPath( const char* fname_script, char* path )
+{
+    FileManager::GetFullPath( fname_script, ScriptsPath, path );
+    FileManager::EraseExtension( path );
+    Str::Append( path, MAX_FOPATH, ".aot" );
+}
+
+static void SaveScriptAot( ScriptAot* aot, const char* fname_aot, const char* module_name )
+{
+    if( !aot->GetTranslationCount() )
+        return;
+
+    const char* path = Str::FormatBuf( "%s.cpp", fname_aot );
+    if( aot->SaveTranslation( path, module_name ) )
+        WriteLog( "Script<%s> has %u functions without native code, translation saved to<%s>.\n", module_name, aot->GetTranslationCount(), path );
+    else
+        WriteLogF( _FUNC_, " - Can't save translation<%s>, script<%s>.\n", path, module_name );
+}
+#endif
+
+// Binaries saved with and without JIT instructions are not interchangeable
+static void GetScriptSaveSignature( uchar* signature )
+{
+    memcpy( signature, ScriptSaveSignature, sizeof(ScriptSaveSignature) );
+    if( Script::GetEngine()->GetJITCompiler() )
+        signature[5] = 'J';
+}
+
 void Script::UnloadScripts()
 {
     EngineData*      edata = (EngineData*)Engine->GetUserData();
@@ -1005,7 +1122,28 @@ asIScriptEngine* Script::CreateEngine( Preprocessor::Pragma::Callback* pragma_ca
     EngineData* edata = new EngineData();
     edata->PragmaCB = pragma_callback;
     edata->DllTarget = dll_target;
+    edata->JitCompiler = NULL;
+    edata->Aot = NULL;
     engine->SetUserData( edata );
+
+    // Functions which compiler can't handle stay in interpreter
+    if( CreateJitCompiler )
+    {
+        edata->JitCompiler = CreateJitCompiler();
+        if( edata->JitCompiler && engine->SetJITCompiler( edata->JitCompiler ) >= 0 )
+            engine->SetEngineProperty( asEP_INCLUDE_JIT_INSTRUCTIONS, true );
+        else
+            WriteLogF( _FUNC_, " - Can't create JIT compiler<%s>, scripts will be interpreted.\n", JitCompilerPath.c_str() );
+    }
+    #ifdef FOCLASSIC_SERVER
+    else if( AotCompiler && edata->DllTarget == "SERVER" )
+    {
+        edata->Aot = new ScriptAot();
+        edata->JitCompiler = edata->Aot;
+        engine->SetEngineProperty( asEP_INCLUDE_JIT_INSTRUCTIONS, true );
+        engine->SetJITCompiler( edata->JitCompiler );
+    }
+    #endif
     return engine;
 }
 
@@ -1017,8 +1155,10 @@ void Script::FinishEngine( asIScriptEngine*& engine )
         delete edata->PragmaCB;
         for( auto it = edata->LoadedDlls.begin(), end = edata->LoadedDlls.end(); it != end; ++it )
             DLL_Free( (*it).second.second );
-        delete edata;
         engine->Release();
+        if( edata->JitCompiler )
+            delete edata->JitCompiler;
+        delete edata;
         engine = NULL;
     }
 }
@@ -1502,6 +1642,21 @@ bool Script::LoadScript( const char* module_name, const char* source, bool skip_
     // Set current pragmas
     ScriptPreprocessor->SetPragmaCallback( edata->PragmaCB );
 
+    #ifdef FOCLASSIC_SERVER
+    // Native code must be registered before functions are compiled
+    char fname_aot[MAX_FOPATH] = { 0 };
+    if( edata->Aot )
+    {
+        GetScriptAotPath( fname_script, fname_aot );
+        edata->Aot->ClearTranslation();
+        # ifdef FO_WINDOWS
+        edata->Aot->LoadNative( Str::FormatBuf( "%s.dll", fname_aot ) );
+        # else
+        edata->Aot->LoadNative( Str::FormatBuf( "%s.so", fname_aot ) );
+        # endif
+    }
+    #endif
+
     // Try load precompiled script
     FileManager file_bin;
     if( !skip_binary )
@@ -1514,8 +1669,10 @@ bool Script::LoadScript( const char* module_name, const char* source, bool skip_
         {
             // Check signature
             uchar signature[sizeof(ScriptSaveSignature)];
+            uchar expected_signature[sizeof(ScriptSaveSignature)];
+            GetScriptSaveSignature( expected_signature );
             bool  bin_signature = file_bin.CopyMem( signature, sizeof(signature) );
-            bool  load = (bin_signature && memcmp( ScriptSaveSignature, signature, sizeof(ScriptSaveSignature) ) == 0);
+            bool  load = (bin_signature && memcmp( expected_signature, signature, sizeof(ScriptSaveSignature) ) == 0);
 
             // Check AngelScript version
             if( load )
@@ -1606,6 +1763,10 @@ bool Script::LoadScript( const char* module_name, const char* source, bool skip_
                     {
                         ScriptPreprocessor->GetParsedPragmas() = pragmas;
                         modules.push_back( module );
+                        #ifdef FOCLASSIC_SERVER
+                        if( edata->Aot )
+                            SaveScriptAot( edata->Aot, fname_aot, module_real );
+                        #endif
                         return true;
                     }
                     else
@@ -1776,6 +1937,11 @@ public:
     // Done, add to collection
     modules.push_back( module );
 
+    #ifdef FOCLASSIC_SERVER
+    if( edata->Aot )
+        SaveScriptAot( edata->Aot, fname_aot, module_real );
+    #endif
+
     // Save binary version of script and preprocessed version
     if( !skip_binary && !file_bin.IsLoaded() )
     {
@@ -1801,7 +1967,9 @@ public:
                 dependencies[d].erase( 0, Str::Length( scripts_path ) );
             }
 
-            file_bin.SetData( (uchar*)ScriptSaveSignature, sizeof(ScriptSaveSignature) );
+            uchar signature[sizeof(ScriptSaveSignature)];
+            GetScriptSaveSignature( signature );
+            file_bin.SetData( signature, sizeof(signature) );
             file_bin.SetBEUInt( (uint)ANGELSCRIPT_VERSION );
             file_bin.SetBEUInt( (uint)dependencies.size() );
             for( uint i = 0, j = (uint)dependencies.size(); i < j; i++ )
@@ -1937,6 +2105,32 @@ int Script::BindImportedFunctions()
         }
     }
 
+    // Imported functions are called by engine directly, without execution lock,
+    // module importing from not thread safe one is executed under lock
+    ThreadSafeModules = ThreadSafeModulesConfig;
+    for( bool changed = true; changed;)
+    {
+        changed = false;
+        for( auto it = modules.begin(), end = modules.end(); it != end; ++it )
+        {
+            asIScriptModule* module = *it;
+            if( !ThreadSafeModules.count( module->GetName() ) )
+                continue;
+
+            for( asUINT i = 0, j = module->GetImportedFunctionCount(); i < j; i++ )
+            {
+                const char* importModuleName = module->GetImportedFunctionSourceModule( i );
+                if( !ThreadSafeModules.count( importModuleName ) )
+                {
+                    WriteLog( "Module<%s> imports from not thread safe module<%s>, executed under lock.\n", module->GetName(), importModuleName );
+                    ThreadSafeModules.erase( module->GetName() );
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
     WriteLog( "Import scripts functions... %s\n", !errors ? "OK" : "failed" );
 
     return errors;
@@ -1992,7 +2186,7 @@ int Script::Bind( const char* module_name, const char* func_name, const char* de
         }
 
         // Create new bind
-        BindedFunctions.push_back( BindFunction( script_func, 0, module_name, func_name, decl ) );
+        BindedFunctions.push_back( BindFunction( script_func, 0, module_name, func_name, decl, ThreadSafeModules.count( module_name ) != 0 ) );
     }
     else
     {
@@ -2034,6 +2228,9 @@ int Script::Bind( const char* module_name, const char* func_name, const char* de
         // Create new bind
         BindedFunctions.push_back( BindFunction( 0, func, module_name, func_name, decl ) );
     }
+    #ifdef SCRIPT_MULTITHREADING
+    InterlockedIncrement( &BindedFunctionsGeneration );
+    #endif
     return (int)BindedFunctions.size() - 1;
 }
 
@@ -2071,9 +2268,13 @@ int Script::RebindFunctions()
             else
             {
                 bf.ScriptFunc = BindedFunctions[1].ScriptFunc;
+                bf.ThreadSafe = (ThreadSafeModules.count( bf.ModuleName ) != 0);
             }
         }
     }
+    #ifdef SCRIPT_MULTITHREADING
+    InterlockedIncrement( &BindedFunctionsGeneration );
+    #endif
     return errors;
 }
 
@@ -2229,7 +2430,28 @@ typedef vector<EndExecutionCallback> EndExecutionCallbackVec;
 THREAD EndExecutionCallbackVec* EndExecutionCallbacks;
 #endif
 
-void Script::BeginExecution()
+#ifdef SCRIPT_MULTITHREADING
+static void LockExecution()
+{
+    if( ConcurrentExecutionLocker.TryLock() )
+    {
+        ExecutionStats.Locks++;
+        return;
+    }
+
+    double tick = Timer::AccurateTick();
+    ConcurrentExecutionLocker.Lock();
+    uint   wait = (uint)( (Timer::AccurateTick() - tick) * 1000.0 );
+
+    ExecutionStats.Locks++;
+    ExecutionStats.LockWaits++;
+    ExecutionStats.LockWaitTime += wait;
+    if( wait > ExecutionStats.LockWaitMax )
+        ExecutionStats.LockWaitMax = wait;
+}
+#endif
+
+void Script::BeginExecution( bool thread_safe /* = false */ )
 {
     #ifdef SCRIPT_MULTITHREADING
     if( !LogicMT )
@@ -2238,20 +2460,33 @@ void Script::BeginExecution()
     if( !ExecutionRecursionCounter )
     {
         GarbageLocker.EnterCode();
+        InterlockedIncrement( &ExecutionStats.Executions );
 
         SyncManager* sync_mngr = SyncManager::GetForCurThread();
-        if( !ConcurrentExecution )
+        if( !ConcurrentExecution && !thread_safe )
         {
             sync_mngr->Suspend();
-            ConcurrentExecutionLocker.Lock();
+            LockExecution();
             sync_mngr->PushPriority( 5 );
             sync_mngr->Resume();
+            ExecutionLockLevel = 1;
         }
         else
         {
+            if( !ConcurrentExecution )
+                InterlockedIncrement( &ExecutionStats.ThreadSafeExecutions );
             sync_mngr->PushPriority( 5 );
         }
     }
+    else if( !ConcurrentExecution && !thread_safe && !ExecutionLockLevel )
+    {
+        // Not thread safe function called from thread safe one
+        SyncManager* sync_mngr = SyncManager::GetForCurThread();
+        sync_mngr->Suspend();
+        LockExecution();
+        sync_mngr->Resume();
+        ExecutionLockLevel = ExecutionRecursionCounter + 1;
+    }
     ExecutionRecursionCounter++;
     #endif
 }
@@ -2263,11 +2498,16 @@ void Script::EndExecution()
         return;
 
     ExecutionRecursionCounter--;
+
+    bool unlock = (ExecutionLockLevel && ExecutionLockLevel == ExecutionRecursionCounter + 1);
+    if( unlock )
+        ExecutionLockLevel = 0;
+
     if( !ExecutionRecursionCounter )
     {
         GarbageLocker.LeaveCode();
 
-        if( !ConcurrentExecution )
+        if( unlock )
         {
             ConcurrentExecutionLocker.Unlock();
 
@@ -2306,7 +2546,28 @@ void Script::EndExecution()
             EndExecutionCallbacks->clear();
         }
     }
+    else if( unlock )
+    {
+        ConcurrentExecutionLocker.Unlock();
+    }
+    #endif
+}
+
+string Script::GetExecutionStatistics()
+{
+    char str[MAX_FOTEXT];
+    #ifdef SCRIPT_MULTITHREADING
+    if( LogicMT )
+    {
+        uint   locks = ExecutionStats.Locks;
+        uint   waits = ExecutionStats.LockWaits;
+        uint64 wait_time = ExecutionStats.LockWaitTime;
+        return Str::Format( str, "Script execution: %s; executions %u, thread safe %u, locks %u, lock waits %u, wait time %llu ms, avg %u us, max %u us; bind cache refreshes %u\n",
+                            ConcurrentExecution ? "concurrent" : "locked", (uint)ExecutionStats.Executions, (uint)ExecutionStats.ThreadSafeExecutions,
+                            locks, waits, wait_time / 1000, waits ? (uint)(wait_time / waits) : 0, ExecutionStats.LockWaitMax, ExecutionStats.BindCacheRefreshes );
+    }
     #endif
+    return Str::Format( str, "Script execution: single thread\n" );
 }
 
 void Script::AddEndExecutionCallback( EndExecutionCallback func )
@@ -2323,32 +2584,79 @@ void Script::AddEndExecutionCallback( EndExecutionCallback func )
     #endif
 }
 
-bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx_info )
+#ifdef SCRIPT_MULTITHREADING
+// Called under BindedFunctionsLocker
+static void RefreshBindCache()
+{
+    if( !BindCache )
+        BindCache = new BindCacheVec();
+
+    BindCache->resize( BindedFunctions.size() );
+    for( size_t i = 0, j = BindedFunctions.size(); i < j; i++ )
+    {
+        BindFunction&   bf = BindedFunctions[i];
+        BindCacheEntry& bc = (*BindCache)[i];
+        bc.IsScriptCall = bf.IsScriptCall;
+        bc.ScriptFunc = bf.ScriptFunc;
+        bc.NativeFuncAddr = bf.NativeFuncAddr;
+        bc.ThreadSafe = bf.ThreadSafe;
+    }
+    BindCacheGeneration = BindedFunctionsGeneration;
+    ExecutionStats.BindCacheRefreshes++;
+}
+#endif
+
+static bool GetBindFunction( int bind_id, BindCacheEntry& bind )
 {
     #ifdef SCRIPT_MULTITHREADING
     if( LogicMT )
-        BindedFunctionsLocker.Lock();
+    {
+        // Temporary bind is changed in place, always take it under lock
+        if( bind_id > 1 && BindCache && BindCacheGeneration == BindedFunctionsGeneration && bind_id < (int)BindCache->size() )
+        {
+            bind = (*BindCache)[bind_id];
+            return true;
+        }
+
+        SCOPE_LOCK( BindedFunctionsLocker );
+
+        if( bind_id <= 0 || bind_id >= (int)BindedFunctions.size() )
+            return false;
+        if( bind_id > 1 )
+            RefreshBindCache();
+
+        BindFunction& bf = BindedFunctions[bind_id];
+        bind.IsScriptCall = bf.IsScriptCall;
+        bind.ScriptFunc = bf.ScriptFunc;
+        bind.NativeFuncAddr = bf.NativeFuncAddr;
+        bind.ThreadSafe = bf.ThreadSafe;
+        return true;
+    }
     #endif
 
     if( bind_id <= 0 || bind_id >= (int)BindedFunctions.size() )
+        return false;
+
+    BindFunction& bf = BindedFunctions[bind_id];
+    bind.IsScriptCall = bf.IsScriptCall;
+    bind.ScriptFunc = bf.ScriptFunc;
+    bind.NativeFuncAddr = bf.NativeFuncAddr;
+    bind.ThreadSafe = bf.ThreadSafe;
+    return true;
+}
+
+bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx_info )
+{
+    BindCacheEntry bind;
+    if( !GetBindFunction( bind_id, bind ) )
     {
         WriteLogF( _FUNC_, " - Invalid bind id<%d>. Context info<%s>.\n", bind_id, ctx_info );
-        #ifdef SCRIPT_MULTITHREADING
-        if( LogicMT )
-            BindedFunctionsLocker.Unlock();
-        #endif
         return false;
     }
 
-    BindFunction&      bf = BindedFunctions[bind_id];
-    bool               is_script = bf.IsScriptCall;
-    asIScriptFunction* script_func = bf.ScriptFunc;
-    size_t             func_addr = bf.NativeFuncAddr;
-
-    #ifdef SCRIPT_MULTITHREADING
-    if( LogicMT )
-        BindedFunctionsLocker.Unlock();
-    #endif
+    bool               is_script = bind.IsScriptCall;
+    asIScriptFunction* script_func = bind.ScriptFunc;
+    size_t             func_addr = bind.NativeFuncAddr;
 
     if( is_script )
     {
@@ -2359,7 +2667,7 @@ bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx
         if( !ctx )
             return false;
 
-        BeginExecution();
+        BeginExecution( bind.ThreadSafe );
 
         Str::Copy( (char*)ctx->GetUserData(), CONTEXT_BUFFER_SIZE, call_func );
         Str::Append( (char*)ctx->GetUserData(), CONTEXT_BUFFER_SIZE, " : " );
@@ -2379,7 +2687,7 @@ bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx
     }
     else
     {
-        BeginExecution();
+        BeginExecution( bind.ThreadSafe );
 
         NativeFuncAddr = func_addr;
         ScriptCall = false;
@@ -2699,7 +3007,15 @@ bool Script::SynchronizeThread()
 {
     #ifdef SCRIPT_MULTITHREADING
     if( !ConcurrentExecution )
+    {
+        // Thread safe module is executed without lock, it can't be synchronized
+        if( LogicMT && ExecutionRecursionCounter && !ExecutionLockLevel )
+        {
+            WriteLogF( _FUNC_, " - Synchronization in thread safe module is not allowed.\n" );
+            return false;
+        }
         return true;
+    }
 
     SynchronizeThreadLocalLocker.Lock();     // Local lock
 
@@ -2736,7 +3052,7 @@ bool Script::ResynchronizeThread()
 {
     #ifdef SCRIPT_MULTITHREADING
     if( !ConcurrentExecution )
-        return true;
+        return !(LogicMT && ExecutionRecursionCounter && !ExecutionLockLevel);
 
     SynchronizeThreadLocalLocker.Lock();     // Local lock
 
@@ -12,6 +12,8 @@
 #define GLOBAL_CONTEXT_STACK_SIZE    (10)
 #define CONTEXT_BUFFER_SIZE          (512)
 
+class ScriptAot;
+
 typedef void ( * EndExecutionCallback )();
 typedef std::vector<asIScriptModule*> ScriptModuleVec;
 
@@ -21,6 +23,8 @@ struct EngineData
     Preprocessor::Pragma::Callback*  PragmaCB;
     string                           DllTarget;
     map<string, pair<string, void*>> LoadedDlls;
+    asIJITCompiler*                  JitCompiler;
+    ScriptAot*                       Aot; // Same object as JitCompiler if ahead of time compiler is used
 };
 
 namespace Script
@@ -33,7 +37,12 @@ namespace Script
     void* LoadDynamicLibrary( const char* dll_name );
     void  SetWrongGlobalObjects( StrVec& names );
     void  SetConcurrentExecution( bool enabled );
+    void  SetThreadSafeModules( const char* modules ); // Space separated, functions of these modules runs without ConcurrentExecutionLocker
     void  SetLoadLibraryCompiler( bool enabled );
+    void  SetJitCompiler( const char* dll_path ); // External library exporting asIJITCompiler* CreateJitCompiler(), empty to interpret scripts
+    #ifdef FOCLASSIC_SERVER
+    void  SetAotCompiler( bool enabled );         // Native code from <script>.aot.so/dll, translation saved to <script>.aot.cpp, ignored if external JIT compiler is set
+    #endif
 
     void UnloadScripts();
     bool ReloadScripts( const char* config, const char* key, bool skip_binaries, const char* file_pefix = NULL );
@@ -98,9 +107,10 @@ namespace Script
     string        GetScriptFuncName( uint func_num );
 
     // Script execution
-    void BeginExecution();
-    void EndExecution();
-    void AddEndExecutionCallback( EndExecutionCallback func );
+    void   BeginExecution( bool thread_safe = false );
+    void   EndExecution();
+    void   AddEndExecutionCallback( EndExecutionCallback func );
+    string GetExecutionStatistics();
 
     bool   PrepareContext( int bind_id, const char* call_func, const char* ctx_info );
     void   SetArgUChar( uchar value );
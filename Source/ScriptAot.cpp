@@ -0,0 +1,1094 @@
+#include "Core.h"
+
+#include "DynamicLibrary.h"
+#include "FileSystem.h"
+#include "Log.h"
+#include "ScriptAot.h"
+#include "Text.h"
+
+// Native run after entry shorter than this is not worth of call from interpreter
+#define AOT_MIN_RUN    (2)
+
+// Common part of generated sources, %u are pointer size and library version
+static const char* AotHeader =
+    "#include <math.h>\n"
+    "#include <string.h>\n"
+    "#include <angelscript.h>\n"
+    "\n"
+    "#if AS_PTR_SIZE != %u || ANGELSCRIPT_VERSION != %u\n"
+    "# error \"AngelScript headers differ from server\"\n"
+    "#endif\n"
+    "\n"
+    "#if defined (_MSC_VER)\n"
+    "# define AOT_ALIAS\n"
+    "# define AOT_EXPORT    extern \"C\" __declspec( dllexport )\n"
+    "#else\n"
+    "# define AOT_ALIAS     __attribute__( (__may_alias__) )\n"
+    "# define AOT_EXPORT    extern \"C\" __attribute__( (visibility( \"default\" ) ) )\n"
+    "#endif\n"
+    "\n"
+    "typedef asBYTE AOT_ALIAS      aot_u8;\n"
+    "typedef signed char AOT_ALIAS aot_i8;\n"
+    "typedef asWORD AOT_ALIAS      aot_u16;\n"
+    "typedef short AOT_ALIAS       aot_i16;\n"
+    "typedef asDWORD AOT_ALIAS     aot_u32;\n"
+    "typedef int AOT_ALIAS         aot_i32;\n"
+    "typedef asQWORD AOT_ALIAS     aot_u64;\n"
+    "typedef asINT64 AOT_ALIAS     aot_i64;\n"
+    "typedef float AOT_ALIAS       aot_f32;\n"
+    "typedef double AOT_ALIAS      aot_f64;\n"
+    "typedef asPWORD AOT_ALIAS     aot_ptr;\n"
+    "\n"
+    "#define AOT_V( type, var )       (*(type*)(fp - (var) ) )\n"
+    "#define AOT_S( type, offset )    (*(type*)(sp + (offset) ) )\n"
+    "#define AOT_R( type )            (*(type*)&vr)\n"
+    "#define AOT_ARG( type, pos )     (*(type*)(bc + (pos) ) )\n"
+    "#define AOT_CMP( x, y )          ( (x) == (y) ? 0 : ( (x) < (y) ? -1 : 1) )\n"
+    "#define AOT_EXIT( pos )          { regs->programPointer = bc + (pos); goto aot_exit; }\n"
+    "\n"
+    "static inline float aot_float( asDWORD bits )\n"
+    "{\n"
+    "    float f;\n"
+    "    memcpy( &f, &bits, sizeof(f) );\n"
+    "    return f;\n"
+    "}\n"
+    "\n"
+    "struct ScriptAotFunction\n"
+    "{\n"
+    "    asQWORD       Hash;\n"
+    "    asUINT        EntriesCount;\n"
+    "    const asUINT* Entries;\n"
+    "    asJITFunction Function;\n"
+    "};\n"
+    "\n"
+    "struct ScriptAotTable\n"
+    "{\n"
+    "    asUINT                   Version;\n"
+    "    asUINT                   PointerSize;\n"
+    "    asUINT                   AngelScriptVersion;\n"
+    "    asUINT                   FunctionsCount;\n"
+    "    const ScriptAotFunction* Functions;\n"
+    "};\n";
+
+// Operands which differ between engines are skipped, generated code reads them from live bytecode
+static void MaskInstruction( asDWORD* instr )
+{
+    // Unused parts are left uninitialized by bytecode loader
+    asBYTE op = *(asBYTE*)instr;
+    ( (asBYTE*)instr )[1] = 0;
+    switch( asBCInfo[op].type )
+    {
+    case asBCTYPE_NO_ARG:
+    case asBCTYPE_DW_ARG:
+    case asBCTYPE_QW_ARG:
+    case asBCTYPE_DW_DW_ARG:
+    case asBCTYPE_QW_DW_ARG:
+        *( ( (asWORD*)instr ) + 1 ) = 0;
+        break;
+    case asBCTYPE_wW_rW_ARG:
+    case asBCTYPE_rW_rW_ARG:
+    case asBCTYPE_wW_W_ARG:
+    case asBCTYPE_wW_rW_DW_ARG:
+    case asBCTYPE_rW_W_DW_ARG:
+        *( ( (asWORD*)instr ) + 3 ) = 0;
+        break;
+    default:
+        break;
+    }
+
+    switch( op )
+    {
+    case asBC_PshGPtr:
+    case asBC_PshG4:
+    case asBC_LdGRdR4:
+    case asBC_REFCPY:
+    case asBC_FREE:
+    case asBC_OBJTYPE:
+    case asBC_CpyVtoG4:
+    case asBC_CpyGtoV4:
+    case asBC_LDG:
+    case asBC_PGA:
+    case asBC_SetG4:
+    case asBC_JitEntry:
+    case asBC_FuncPtr:
+    case asBC_RefCpyV:
+        memset( instr + 1, 0, AS_PTR_SIZE * sizeof(asDWORD) );
+        break;
+    case asBC_ALLOC:
+        memset( instr + 1, 0, (AS_PTR_SIZE + 1) * sizeof(asDWORD) );
+        break;
+    case asBC_CALL:
+    case asBC_CALLSYS:
+    case asBC_CALLBND:
+    case asBC_CALLINTF:
+    case asBC_TYPEID:
+    case asBC_Cast:
+    case asBC_COPY:
+    case asBC_ADDSi:
+    case asBC_LoadThisR:
+        instr[1] = 0;
+        break;
+    case asBC_LoadRObjR:
+    case asBC_LoadVObjR:
+        instr[2] = 0;
+        break;
+    case asBC_STR:
+        *( ( (asWORD*)instr ) + 1 ) = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+static asUINT GetInstructionSize( asBYTE op )
+{
+    return asBCTypeSize[asBCInfo[op].type];
+}
+
+// FNV-1a of declaration and masked bytecode
+static asQWORD GetFunctionHash( asIScriptFunction* func, const asDWORD* bc, asUINT length )
+{
+    asQWORD     hash = 14695981039346656037ULL;
+    const char* decl = func->GetDeclaration( true, true );
+    for( ; *decl; decl++ )
+        hash = (hash ^ (uchar)*decl) * 1099511628211ULL;
+
+    asDWORD instr[4];
+    for( asUINT pos = 0; pos < length; )
+    {
+        asUINT size = GetInstructionSize( *(asBYTE*)(bc + pos) );
+        if( !size || size > 4 || pos + size > length )
+            break;
+
+        memcpy( instr, bc + pos, size * sizeof(asDWORD) );
+        MaskInstruction( instr );
+        for( asUINT i = 0; i < size * sizeof(asDWORD); i++ )
+            hash = (hash ^ ( (uchar*)instr )[i]) * 1099511628211ULL;
+        pos += size;
+    }
+    return hash;
+}
+
+static bool IsBoolInstruction( asBYTE op )
+{
+    return op == asBC_NOT || (op >= asBC_TZ && op <= asBC_TNP) || op == asBC_ClrHi;
+}
+
+// Calls, allocations, strings and reference counting need engine internals
+static bool IsInterpreted( asBYTE op )
+{
+    switch( op )
+    {
+    case asBC_CALL:
+    case asBC_RET:
+    case asBC_STR:
+    case asBC_CALLSYS:
+    case asBC_CALLBND:
+    case asBC_ALLOC:
+    case asBC_REFCPY:
+    case asBC_CALLINTF:
+    case asBC_Cast:
+    case asBC_CallPtr:
+    case asBC_RefCpyV:
+        return true;
+    default:
+        break;
+    }
+
+    // Native code writes booleans as single byte, same as interpreter of most platforms
+    if( IsBoolInstruction( op ) && sizeof(bool) != 1 )
+        return true;
+    return op >= asBC_MAXBYTECODE;
+}
+
+static bool IsJump( asBYTE op )
+{
+    return op == asBC_JMP || (op >= asBC_JZ && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ;
+}
+
+static const char* GetBinaryOperator( asBYTE op, const char*& type )
+{
+    switch( op )
+    {
+    case asBC_ADDi:
+        type = "aot_u32";
+        return "+";
+    case asBC_SUBi:
+        type = "aot_u32";
+        return "-";
+    case asBC_MULi:
+        type = "aot_u32";
+        return "*";
+    case asBC_BAND:
+        type = "aot_u32";
+        return "&";
+    case asBC_BOR:
+        type = "aot_u32";
+        return "|";
+    case asBC_BXOR:
+        type = "aot_u32";
+        return "^";
+    case asBC_ADDf:
+        type = "aot_f32";
+        return "+";
+    case asBC_SUBf:
+        type = "aot_f32";
+        return "-";
+    case asBC_MULf:
+        type = "aot_f32";
+        return "*";
+    case asBC_ADDd:
+        type = "aot_f64";
+        return "+";
+    case asBC_SUBd:
+        type = "aot_f64";
+        return "-";
+    case asBC_MULd:
+        type = "aot_f64";
+        return "*";
+    case asBC_ADDi64:
+        type = "aot_u64";
+        return "+";
+    case asBC_SUBi64:
+        type = "aot_u64";
+        return "-";
+    case asBC_MULi64:
+        type = "aot_u64";
+        return "*";
+    case asBC_BAND64:
+        type = "aot_u64";
+        return "&";
+    case asBC_BOR64:
+        type = "aot_u64";
+        return "|";
+    case asBC_BXOR64:
+        type = "aot_u64";
+        return "^";
+    default:
+        break;
+    }
+    return NULL;
+}
+
+// Result type, expression with %d of source variable
+static bool GetConversion( asBYTE op, const char*& type, const char*& expr )
+{
+    switch( op )
+    {
+    case asBC_iTOf:
+        type = "aot_f32", expr = "(float)AOT_V( aot_i32, %d )";
+        break;
+    case asBC_fTOi:
+        type = "aot_i32", expr = "(int)AOT_V( aot_f32, %d )";
+        break;
+    case asBC_uTOf:
+        type = "aot_f32", expr = "(float)AOT_V( aot_u32, %d )";
+        break;
+    case asBC_fTOu:
+        type = "aot_u32", expr = "(asUINT)(int)AOT_V( aot_f32, %d )";
+        break;
+    case asBC_sbTOi:
+        type = "aot_i32", expr = "AOT_V( aot_i8, %d )";
+        break;
+    case asBC_swTOi:
+        type = "aot_i32", expr = "AOT_V( aot_i16, %d )";
+        break;
+    case asBC_ubTOi:
+        type = "aot_u32", expr = "AOT_V( aot_u8, %d )";
+        break;
+    case asBC_uwTOi:
+        type = "aot_u32", expr = "AOT_V( aot_u16, %d )";
+        break;
+    case asBC_dTOi:
+        type = "aot_i32", expr = "(int)AOT_V( aot_f64, %d )";
+        break;
+    case asBC_dTOu:
+        type = "aot_u32", expr = "(asUINT)(int)AOT_V( aot_f64, %d )";
+        break;
+    case asBC_dTOf:
+        type = "aot_f32", expr = "(float)AOT_V( aot_f64, %d )";
+        break;
+    case asBC_iTOd:
+        type = "aot_f64", expr = "(double)AOT_V( aot_i32, %d )";
+        break;
+    case asBC_uTOd:
+        type = "aot_f64", expr = "(double)AOT_V( aot_u32, %d )";
+        break;
+    case asBC_fTOd:
+        type = "aot_f64", expr = "(double)AOT_V( aot_f32, %d )";
+        break;
+    case asBC_i64TOi:
+        type = "aot_i32", expr = "(int)AOT_V( aot_i64, %d )";
+        break;
+    case asBC_uTOi64:
+        type = "aot_i64", expr = "(asINT64)AOT_V( aot_u32, %d )";
+        break;
+    case asBC_iTOi64:
+        type = "aot_i64", expr = "(asINT64)AOT_V( aot_i32, %d )";
+        break;
+    case asBC_fTOi64:
+        type = "aot_i64", expr = "(asINT64)AOT_V( aot_f32, %d )";
+        break;
+    case asBC_dTOi64:
+        type = "aot_i64", expr = "(asINT64)AOT_V( aot_f64, %d )";
+        break;
+    case asBC_fTOu64:
+        type = "aot_u64", expr = "(asQWORD)(asINT64)AOT_V( aot_f32, %d )";
+        break;
+    case asBC_dTOu64:
+        type = "aot_u64", expr = "(asQWORD)(asINT64)AOT_V( aot_f64, %d )";
+        break;
+    case asBC_i64TOf:
+        type = "aot_f32", expr = "(float)AOT_V( aot_i64, %d )";
+        break;
+    case asBC_u64TOf:
+        type = "aot_f32", expr = "(float)AOT_V( aot_u64, %d )";
+        break;
+    case asBC_i64TOd:
+        type = "aot_f64", expr = "(double)AOT_V( aot_i64, %d )";
+        break;
+    case asBC_u64TOd:
+        type = "aot_f64", expr = "(double)AOT_V( aot_u64, %d )";
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+static const char* GetCompareType( asBYTE op )
+{
+    switch( op )
+    {
+    case asBC_CMPd:
+        return "aot_f64";
+    case asBC_CMPu:
+        return "aot_u32";
+    case asBC_CMPf:
+        return "aot_f32";
+    case asBC_CMPi:
+        return "aot_i32";
+    case asBC_CMPi64:
+        return "aot_i64";
+    case asBC_CMPu64:
+        return "aot_u64";
+    case asBC_CmpPtr:
+        return "aot_ptr";
+    default:
+        break;
+    }
+    return NULL;
+}
+
+// Same semantic as asCContext::ExecuteNext, state before instruction is passed back to interpreter on exceptions
+static void EmitInstruction( string& code, const asDWORD* bc, asUINT pos, asUINT table_size )
+{
+    const asDWORD* instr = bc + pos;
+    asBYTE         op = *(asBYTE*)instr;
+    int            a0 = asBC_SWORDARG0( instr );
+    int            a1 = asBC_SWORDARG1( instr );
+    int            a2 = asBC_SWORDARG2( instr );
+    asUINT         w0 = asBC_WORDARG0( instr );
+    asUINT         size = GetInstructionSize( op );
+    asDWORD        d1 = (size > 1 ? instr[1] : 0);
+    asDWORD        d2 = (size > 2 ? instr[2] : 0);
+    asQWORD        q1 = 0;
+    if( size > 2 )
+        memcpy( &q1, instr + 1, sizeof(q1) );
+    int            target = (int)pos + 2 + (int)d1;
+    const char*    type = NULL;
+    const char*    expr = NULL;
+
+    if( ( expr = GetBinaryOperator( op, type ) ) != NULL )
+    {
+        code += Str::FormatBuf( "    AOT_V( %s, %d ) = AOT_V( %s, %d ) %s AOT_V( %s, %d );\n", type, a0, type, a1, expr, type, a2 );
+        return;
+    }
+    if( GetConversion( op, type, expr ) )
+    {
+        int from = (asBCInfo[op].type == asBCTYPE_wW_rW_ARG ? a1 : a0);
+        code += Str::FormatBuf( "    AOT_V( %s, %d ) = ", type, a0 );
+        code += Str::FormatBuf( expr, from );
+        code += ";\n";
+        return;
+    }
+    if( ( type = GetCompareType( op ) ) != NULL )
+    {
+        code += Str::FormatBuf( "    AOT_R( aot_i32 ) = AOT_CMP( AOT_V( %s, %d ), AOT_V( %s, %d ) );\n", type, a0, type, a1 );
+        return;
+    }
+
+    switch( op )
+    {
+    // Stack
+    case asBC_PopPtr:
+        code += "    sp += AS_PTR_SIZE;\n";
+        break;
+    case asBC_PshGPtr:
+        code += Str::FormatBuf( "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = *(aot_ptr*)AOT_ARG( aot_ptr, %u );\n", pos + 1 );
+        break;
+    case asBC_PshC4:
+        code += Str::FormatBuf( "    sp -= 1;\n    AOT_S( aot_u32, 0 ) = 0x%08Xu;\n", d1 );
+        break;
+    case asBC_PshV4:
+        code += Str::FormatBuf( "    sp -= 1;\n    AOT_S( aot_u32, 0 ) = AOT_V( aot_u32, %d );\n", a0 );
+        break;
+    case asBC_PSF:
+        code += Str::FormatBuf( "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = (aot_ptr)(fp - (%d) );\n", a0 );
+        break;
+    case asBC_SwapPtr:
+        code += "    { aot_ptr p = AOT_S( aot_ptr, 0 ); AOT_S( aot_ptr, 0 ) = AOT_S( aot_ptr, AS_PTR_SIZE ); AOT_S( aot_ptr, AS_PTR_SIZE ) = p; }\n";
+        break;
+    case asBC_PshG4:
+        code += Str::FormatBuf( "    sp -= 1;\n    AOT_S( aot_u32, 0 ) = *(aot_u32*)AOT_ARG( aot_ptr, %u );\n", pos + 1 );
+        break;
+    case asBC_PshC8:
+        code += Str::FormatBuf( "    sp -= 2;\n    AOT_S( aot_u64, 0 ) = 0x%016llXull;\n", (unsigned long long)q1 );
+        break;
+    case asBC_PshVPtr:
+        code += Str::FormatBuf( "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = AOT_V( aot_ptr, %d );\n", a0 );
+        break;
+    case asBC_PshV8:
+        code += Str::FormatBuf( "    sp -= 2;\n    AOT_S( aot_u64, 0 ) = AOT_V( aot_u64, %d );\n", a0 );
+        break;
+    case asBC_RDSPtr:
+        code += Str::FormatBuf( "    if( !AOT_S( aot_ptr, 0 ) ) AOT_EXIT( %u );\n    AOT_S( aot_ptr, 0 ) = *(aot_ptr*)AOT_S( aot_ptr, 0 );\n", pos );
+        break;
+    case asBC_PopRPtr:
+        code += "    AOT_R( aot_ptr ) = AOT_S( aot_ptr, 0 );\n    sp += AS_PTR_SIZE;\n";
+        break;
+    case asBC_PshRPtr:
+        code += "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = AOT_R( aot_ptr );\n";
+        break;
+    case asBC_PshNull:
+        code += "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = 0;\n";
+        break;
+    case asBC_OBJTYPE:
+    case asBC_PGA:
+    case asBC_FuncPtr:
+        code += Str::FormatBuf( "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = AOT_ARG( aot_ptr, %u );\n", pos + 1 );
+        break;
+    case asBC_TYPEID:
+        code += Str::FormatBuf( "    sp -= 1;\n    AOT_S( aot_u32, 0 ) = AOT_ARG( aot_u32, %u );\n", pos + 1 );
+        break;
+    case asBC_VAR:
+        code += Str::FormatBuf( "    sp -= AS_PTR_SIZE;\n    AOT_S( aot_ptr, 0 ) = (aot_ptr)(%d);\n", a0 );
+        break;
+    case asBC_COPY:
+        code += Str::FormatBuf( "    {\n"
+                                "        void* d = (void*)AOT_S( aot_ptr, 0 );\n"
+                                "        void* s = (void*)AOT_S( aot_ptr, AS_PTR_SIZE );\n"
+                                "        if( !s || !d ) AOT_EXIT( %u );\n"
+                                "        memcpy( d, s, %u );\n"
+                                "        sp += AS_PTR_SIZE;\n"
+                                "        AOT_S( aot_ptr, 0 ) = (aot_ptr)d;\n"
+                                "    }\n", pos, w0 * 4 );
+        break;
+    case asBC_GETOBJ:
+        code += Str::FormatBuf( "    { aot_ptr* a = &AOT_S( aot_ptr, %u ); aot_ptr* v = (aot_ptr*)(fp - *(aot_u32*)a); *a = *v; *v = 0; }\n", w0 );
+        break;
+    case asBC_GETOBJREF:
+        code += Str::FormatBuf( "    { aot_ptr* a = &AOT_S( aot_ptr, %u ); *a = *(aot_ptr*)(fp - *a); }\n", w0 );
+        break;
+    case asBC_GETREF:
+        code += Str::FormatBuf( "    { aot_ptr* a = &AOT_S( aot_ptr, %u ); *a = (aot_ptr)(fp - (int)*a); }\n", w0 );
+        break;
+    case asBC_CHKREF:
+        code += Str::FormatBuf( "    if( !AOT_S( aot_ptr, 0 ) ) AOT_EXIT( %u );\n", pos );
+        break;
+    case asBC_ChkRefS:
+        code += Str::FormatBuf( "    if( !*(aot_ptr*)AOT_S( aot_ptr, 0 ) ) AOT_EXIT( %u );\n", pos );
+        break;
+    case asBC_ChkNullS:
+        code += Str::FormatBuf( "    if( !AOT_S( aot_ptr, %u ) ) AOT_EXIT( %u );\n", w0, pos );
+        break;
+    case asBC_ADDSi:
+        code += Str::FormatBuf( "    if( !AOT_S( aot_ptr, 0 ) ) AOT_EXIT( %u );\n    AOT_S( aot_ptr, 0 ) += (%d);\n", pos, a0 );
+        break;
+
+    // Jumps
+    case asBC_JMP:
+        code += Str::FormatBuf( "    goto L%d;\n", target );
+        break;
+    case asBC_JZ:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) == 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JNZ:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) != 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JS:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) < 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JNS:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) >= 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JP:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) > 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JNP:
+        code += Str::FormatBuf( "    if( AOT_R( aot_i32 ) <= 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JLowZ:
+        code += Str::FormatBuf( "    if( AOT_R( aot_u8 ) == 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JLowNZ:
+        code += Str::FormatBuf( "    if( AOT_R( aot_u8 ) != 0 ) goto L%d;\n", target );
+        break;
+    case asBC_JMPP:
+        code += Str::FormatBuf( "    switch( AOT_V( aot_i32, %d ) )\n    {\n", a0 );
+        for( asUINT i = 0; i < table_size; i++ )
+            code += Str::FormatBuf( "    case %u: goto L%u;\n", i, pos + 1 + i * 2 );
+        code += Str::FormatBuf( "    default: AOT_EXIT( %u );\n    }\n", pos );
+        break;
+
+    // Booleans in value register and variables
+    case asBC_NOT:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = (AOT_V( aot_u8, %d ) == 0 ? 1 : 0);\n", a0, a0 );
+        break;
+    case asBC_TZ:
+        code += "    vr = (AOT_R( aot_i32 ) == 0 ? 1 : 0);\n";
+        break;
+    case asBC_TNZ:
+        code += "    vr = (AOT_R( aot_i32 ) != 0 ? 1 : 0);\n";
+        break;
+    case asBC_TS:
+        code += "    vr = (AOT_R( aot_i32 ) < 0 ? 1 : 0);\n";
+        break;
+    case asBC_TNS:
+        code += "    vr = (AOT_R( aot_i32 ) >= 0 ? 1 : 0);\n";
+        break;
+    case asBC_TP:
+        code += "    vr = (AOT_R( aot_i32 ) > 0 ? 1 : 0);\n";
+        break;
+    case asBC_TNP:
+        code += "    vr = (AOT_R( aot_i32 ) <= 0 ? 1 : 0);\n";
+        break;
+    case asBC_ClrHi:
+        code += "    AOT_R( aot_u32 ) &= 0xFFu;\n";
+        break;
+    case asBC_iTOb:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) &= 0xFFu;\n", a0 );
+        break;
+    case asBC_iTOw:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) &= 0xFFFFu;\n", a0 );
+        break;
+
+    // Arithmetic
+    case asBC_NEGi:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = 0u - AOT_V( aot_u32, %d );\n", a0, a0 );
+        break;
+    case asBC_NEGf:
+        code += Str::FormatBuf( "    AOT_V( aot_f32, %d ) = -AOT_V( aot_f32, %d );\n", a0, a0 );
+        break;
+    case asBC_NEGd:
+        code += Str::FormatBuf( "    AOT_V( aot_f64, %d ) = -AOT_V( aot_f64, %d );\n", a0, a0 );
+        break;
+    case asBC_NEGi64:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = 0ull - AOT_V( aot_u64, %d );\n", a0, a0 );
+        break;
+    case asBC_INCi16:
+        code += "    ++*(aot_u16*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_INCi8:
+        code += "    ++*(aot_u8*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECi16:
+        code += "    --*(aot_u16*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECi8:
+        code += "    --*(aot_u8*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_INCi:
+        code += "    ++*(aot_u32*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECi:
+        code += "    --*(aot_u32*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_INCf:
+        code += "    ++*(aot_f32*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECf:
+        code += "    --*(aot_f32*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_INCd:
+        code += "    ++*(aot_f64*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECd:
+        code += "    --*(aot_f64*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_INCi64:
+        code += "    ++*(aot_u64*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_DECi64:
+        code += "    --*(aot_u64*)AOT_R( aot_ptr );\n";
+        break;
+    case asBC_IncVi:
+        code += Str::FormatBuf( "    ++AOT_V( aot_u32, %d );\n", a0 );
+        break;
+    case asBC_DecVi:
+        code += Str::FormatBuf( "    --AOT_V( aot_u32, %d );\n", a0 );
+        break;
+    case asBC_BNOT:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = ~AOT_V( aot_u32, %d );\n", a0, a0 );
+        break;
+    case asBC_BNOT64:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = ~AOT_V( aot_u64, %d );\n", a0, a0 );
+        break;
+    case asBC_BSLL:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = AOT_V( aot_u32, %d ) << (AOT_V( aot_u32, %d ) & 31);\n", a0, a1, a2 );
+        break;
+    case asBC_BSRL:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = AOT_V( aot_u32, %d ) >> (AOT_V( aot_u32, %d ) & 31);\n", a0, a1, a2 );
+        break;
+    case asBC_BSRA:
+        code += Str::FormatBuf( "    AOT_V( aot_i32, %d ) = AOT_V( aot_i32, %d ) >> (AOT_V( aot_u32, %d ) & 31);\n", a0, a1, a2 );
+        break;
+    case asBC_BSLL64:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = AOT_V( aot_u64, %d ) << (AOT_V( aot_u32, %d ) & 63);\n", a0, a1, a2 );
+        break;
+    case asBC_BSRL64:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = AOT_V( aot_u64, %d ) >> (AOT_V( aot_u32, %d ) & 63);\n", a0, a1, a2 );
+        break;
+    case asBC_BSRA64:
+        code += Str::FormatBuf( "    AOT_V( aot_i64, %d ) = AOT_V( aot_i64, %d ) >> (AOT_V( aot_u32, %d ) & 63);\n", a0, a1, a2 );
+        break;
+    case asBC_DIVi:
+    case asBC_MODi:
+        code += Str::FormatBuf( "    {\n"
+                                "        int d = AOT_V( aot_i32, %d );\n"
+                                "        if( d == 0 || (d == -1 && AOT_V( aot_i32, %d ) == (int)0x80000000) ) AOT_EXIT( %u );\n"
+                                "        AOT_V( aot_i32, %d ) = AOT_V( aot_i32, %d ) %s d;\n"
+                                "    }\n", a2, a1, pos, a0, a1, op == asBC_DIVi ? "/" : "%" );
+        break;
+    case asBC_DIVi64:
+    case asBC_MODi64:
+        code += Str::FormatBuf( "    {\n"
+                                "        asINT64 d = AOT_V( aot_i64, %d );\n"
+                                "        if( d == 0 || (d == -1 && AOT_V( aot_i64, %d ) == (asINT64)0x8000000000000000ull) ) AOT_EXIT( %u );\n"
+                                "        AOT_V( aot_i64, %d ) = AOT_V( aot_i64, %d ) %s d;\n"
+                                "    }\n", a2, a1, pos, a0, a1, op == asBC_DIVi64 ? "/" : "%" );
+        break;
+    case asBC_DIVu:
+    case asBC_MODu:
+    case asBC_DIVu64:
+    case asBC_MODu64:
+        type = (op == asBC_DIVu || op == asBC_MODu ? "aot_u32" : "aot_u64");
+        code += Str::FormatBuf( "    if( AOT_V( %s, %d ) == 0 ) AOT_EXIT( %u );\n    AOT_V( %s, %d ) = AOT_V( %s, %d ) %s AOT_V( %s, %d );\n",
+                                type, a2, pos, type, a0, type, a1, op == asBC_DIVu || op == asBC_DIVu64 ? "/" : "%", type, a2 );
+        break;
+    case asBC_DIVf:
+    case asBC_DIVd:
+        type = (op == asBC_DIVf ? "aot_f32" : "aot_f64");
+        code += Str::FormatBuf( "    if( AOT_V( %s, %d ) == 0 ) AOT_EXIT( %u );\n    AOT_V( %s, %d ) = AOT_V( %s, %d ) / AOT_V( %s, %d );\n",
+                                type, a2, pos, type, a0, type, a1, type, a2 );
+        break;
+    case asBC_MODf:
+    case asBC_MODd:
+        type = (op == asBC_MODf ? "aot_f32" : "aot_f64");
+        code += Str::FormatBuf( "    if( AOT_V( %s, %d ) == 0 ) AOT_EXIT( %u );\n    AOT_V( %s, %d ) = %s( AOT_V( %s, %d ), AOT_V( %s, %d ) );\n",
+                                type, a2, pos, type, a0, op == asBC_MODf ? "fmodf" : "fmod", type, a1, type, a2 );
+        break;
+    case asBC_ADDIi:
+    case asBC_SUBIi:
+    case asBC_MULIi:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = AOT_V( aot_u32, %d ) %s 0x%08Xu;\n", a0, a1, op == asBC_ADDIi ? "+" : (op == asBC_SUBIi ? "-" : "*"), d2 );
+        break;
+    case asBC_ADDIf:
+    case asBC_SUBIf:
+    case asBC_MULIf:
+        code += Str::FormatBuf( "    AOT_V( aot_f32, %d ) = AOT_V( aot_f32, %d ) %s aot_float( 0x%08Xu );\n", a0, a1, op == asBC_ADDIf ? "+" : (op == asBC_SUBIf ? "-" : "*"), d2 );
+        break;
+    case asBC_CMPIi:
+        code += Str::FormatBuf( "    AOT_R( aot_i32 ) = AOT_CMP( AOT_V( aot_i32, %d ), (int)0x%08Xu );\n", a0, d1 );
+        break;
+    case asBC_CMPIf:
+        code += Str::FormatBuf( "    AOT_R( aot_i32 ) = AOT_CMP( AOT_V( aot_f32, %d ), aot_float( 0x%08Xu ) );\n", a0, d1 );
+        break;
+    case asBC_CMPIu:
+        code += Str::FormatBuf( "    AOT_R( aot_i32 ) = AOT_CMP( AOT_V( aot_u32, %d ), 0x%08Xu );\n", a0, d1 );
+        break;
+
+    // Variables, globals and value register
+    case asBC_SetV1:
+    case asBC_SetV2:
+    case asBC_SetV4:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = 0x%08Xu;\n", a0, d1 );
+        break;
+    case asBC_SetV8:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = 0x%016llXull;\n", a0, (unsigned long long)q1 );
+        break;
+    case asBC_SetG4:
+        code += Str::FormatBuf( "    *(aot_u32*)AOT_ARG( aot_ptr, %u ) = 0x%08Xu;\n", pos + 1, instr[1 + AS_PTR_SIZE] );
+        break;
+    case asBC_ClrVPtr:
+        code += Str::FormatBuf( "    AOT_V( aot_ptr, %d ) = 0;\n", a0 );
+        break;
+    case asBC_CpyVtoV4:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = AOT_V( aot_u32, %d );\n", a0, a1 );
+        break;
+    case asBC_CpyVtoV8:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = AOT_V( aot_u64, %d );\n", a0, a1 );
+        break;
+    case asBC_CpyVtoR4:
+        code += Str::FormatBuf( "    AOT_R( aot_u32 ) = AOT_V( aot_u32, %d );\n", a0 );
+        break;
+    case asBC_CpyVtoR8:
+        code += Str::FormatBuf( "    vr = AOT_V( aot_u64, %d );\n", a0 );
+        break;
+    case asBC_CpyVtoG4:
+        code += Str::FormatBuf( "    *(aot_u32*)AOT_ARG( aot_ptr, %u ) = AOT_V( aot_u32, %d );\n", pos + 1, a0 );
+        break;
+    case asBC_CpyRtoV4:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = AOT_R( aot_u32 );\n", a0 );
+        break;
+    case asBC_CpyRtoV8:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = vr;\n", a0 );
+        break;
+    case asBC_CpyGtoV4:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = *(aot_u32*)AOT_ARG( aot_ptr, %u );\n", a0, pos + 1 );
+        break;
+    case asBC_WRTV1:
+        code += Str::FormatBuf( "    *(aot_u8*)AOT_R( aot_ptr ) = AOT_V( aot_u8, %d );\n", a0 );
+        break;
+    case asBC_WRTV2:
+        code += Str::FormatBuf( "    *(aot_u16*)AOT_R( aot_ptr ) = AOT_V( aot_u16, %d );\n", a0 );
+        break;
+    case asBC_WRTV4:
+        code += Str::FormatBuf( "    *(aot_u32*)AOT_R( aot_ptr ) = AOT_V( aot_u32, %d );\n", a0 );
+        break;
+    case asBC_WRTV8:
+        code += Str::FormatBuf( "    *(aot_u64*)AOT_R( aot_ptr ) = AOT_V( aot_u64, %d );\n", a0 );
+        break;
+    case asBC_RDR1:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = *(aot_u8*)AOT_R( aot_ptr );\n", a0 );
+        break;
+    case asBC_RDR2:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = *(aot_u16*)AOT_R( aot_ptr );\n", a0 );
+        break;
+    case asBC_RDR4:
+        code += Str::FormatBuf( "    AOT_V( aot_u32, %d ) = *(aot_u32*)AOT_R( aot_ptr );\n", a0 );
+        break;
+    case asBC_RDR8:
+        code += Str::FormatBuf( "    AOT_V( aot_u64, %d ) = *(aot_u64*)AOT_R( aot_ptr );\n", a0 );
+        break;
+    case asBC_LDG:
+        code += Str::FormatBuf( "    AOT_R( aot_ptr ) = AOT_ARG( aot_ptr, %u );\n", pos + 1 );
+        break;
+    case asBC_LdGRdR4:
+        code += Str::FormatBuf( "    AOT_R( aot_ptr ) = AOT_ARG( aot_ptr, %u );\n    AOT_V( aot_u32, %d ) = *(aot_u32*)AOT_R( aot_ptr );\n", pos + 1, a0 );
+        break;
+    case asBC_LDV:
+        code += Str::FormatBuf( "    AOT_R( aot_ptr ) = (aot_ptr)(fp - (%d) );\n", a0 );
+        break;
+    case asBC_LoadThisR:
+        code += Str::FormatBuf( "    if( !AOT_V( aot_ptr, 0 ) ) AOT_EXIT( %u );\n    AOT_R( aot_ptr ) = AOT_V( aot_ptr, 0 ) + (%d);\n", pos, a0 );
+        break;
+    case asBC_LoadRObjR:
+        code += Str::FormatBuf( "    if( !AOT_V( aot_ptr, %d ) ) AOT_EXIT( %u );\n    AOT_R( aot_ptr ) = AOT_V( aot_ptr, %d ) + (%d);\n", a0, pos, a0, a1 );
+        break;
+    case asBC_LoadVObjR:
+        code += Str::FormatBuf( "    AOT_R( aot_ptr ) = (aot_ptr)(fp - (%d) ) + (%d);\n", a0, a1 );
+        break;
+
+    // Object register
+    case asBC_LOADOBJ:
+        code += Str::FormatBuf( "    regs->objectType = 0;\n    regs->objectRegister = (void*)AOT_V( aot_ptr, %d );\n    AOT_V( aot_ptr, %d ) = 0;\n", a0, a0 );
+        break;
+    case asBC_STOREOBJ:
+        code += Str::FormatBuf( "    AOT_V( aot_ptr, %d ) = (aot_ptr)regs->objectRegister;\n    regs->objectRegister = 0;\n", a0 );
+        break;
+    case asBC_ChkNullV:
+        code += Str::FormatBuf( "    if( !AOT_V( aot_ptr, %d ) ) AOT_EXIT( %u );\n", a0, pos );
+        break;
+
+    // Interpreter is needed only for actual work
+    case asBC_FREE:
+        code += Str::FormatBuf( "    if( AOT_V( aot_ptr, %d ) ) AOT_EXIT( %u );\n", a0, pos );
+        break;
+    case asBC_SUSPEND:
+        code += Str::FormatBuf( "    if( regs->doProcessSuspend ) AOT_EXIT( %u );\n", pos );
+        break;
+    case asBC_JitEntry:
+        break;
+
+    default:
+        code += Str::FormatBuf( "    AOT_EXIT( %u );\n", pos );
+        break;
+    }
+}
+
+// Source of native function or false if it is not worth of translation
+static bool TranslateFunction( asDWORD* bc, asUINT length, asQWORD hash, string& code, UIntVec& entries )
+{
+    // Split to instructions
+    UIntVec positions;
+    IntVec  index( length, -1 );
+    for( asUINT pos = 0; pos < length; )
+    {
+        asBYTE op = *(asBYTE*)(bc + pos);
+        asUINT size = GetInstructionSize( op );
+        if( !size || pos + size > length )
+            return false;
+        index[pos] = (int)positions.size();
+        positions.push_back( pos );
+        pos += size;
+    }
+
+    uint      count = (uint)positions.size();
+    UCharVec  native( count, 0 );
+    UIntVec   table( count, 0 );
+    for( uint i = 0; i < count; i++ )
+    {
+        asBYTE op = *(asBYTE*)(bc + positions[i]);
+        native[i] = !IsInterpreted( op );
+        if( op == asBC_JMPP )
+        {
+            for( uint j = i + 1; j < count && *(asBYTE*)(bc + positions[j]) == asBC_JMP; j++ )
+                table[i]++;
+        }
+        if( IsJump( op ) )
+        {
+            int target = (int)positions[i] + 2 + asBC_INTARG( bc + positions[i] );
+            if( target < 0 || target >= (int)length || index[target] < 0 )
+                return false;
+        }
+        // Last instruction can't fall through to anything
+        if( i + 1 == count && op != asBC_JMP )
+            native[i] = 0;
+    }
+
+    // Enable entries with enough native work after them
+    for( uint i = 0; i < count; i++ )
+    {
+        if( *(asBYTE*)(bc + positions[i]) != asBC_JitEntry )
+            continue;
+
+        uint run = 0;
+        for( uint j = i + 1; j < count && native[j]; j++ )
+        {
+            asBYTE op = *(asBYTE*)(bc + positions[j]);
+            if( op == asBC_JitEntry )
+                continue;
+            if( ++run >= AOT_MIN_RUN || IsJump( op ) || op == asBC_JMPP )
+            {
+                entries.push_back( positions[i] );
+                break;
+            }
+        }
+    }
+    if( entries.empty() )
+        return false;
+
+    // Code reachable from entries, jump targets get labels
+    UCharVec reachable( count, 0 );
+    UCharVec labels( count, 0 );
+    UIntVec  stack;
+    for( uint i = 0; i < entries.size(); i++ )
+    {
+        uint k = index[entries[i]];
+        labels[k] = reachable[k] = 1;
+        stack.push_back( k );
+    }
+    while( !stack.empty() )
+    {
+        uint i = stack.back();
+        stack.pop_back();
+        if( !native[i] )
+            continue;
+
+        asBYTE  op = *(asBYTE*)(bc + positions[i]);
+        UIntVec next;
+        if( IsJump( op ) )
+        {
+            next.push_back( index[positions[i] + 2 + asBC_INTARG( bc + positions[i] )] );
+            labels[next.back()] = 1;
+        }
+        if( op == asBC_JMPP )
+        {
+            for( uint j = 0; j < table[i]; j++ )
+            {
+                next.push_back( i + 1 + j );
+                labels[i + 1 + j] = 1;
+            }
+        }
+        else if( op != asBC_JMP )
+        {
+            next.push_back( i + 1 );
+        }
+        for( uint j = 0; j < next.size(); j++ )
+        {
+            if( !reachable[next[j]] )
+            {
+                reachable[next[j]] = 1;
+                stack.push_back( next[j] );
+            }
+        }
+    }
+
+    code += Str::FormatBuf( "static const asUINT E_%016llX[] = { ", (unsigned long long)hash );
+    for( uint i = 0; i < entries.size(); i++ )
+        code += Str::FormatBuf( "%s%u", i ? ", " : "", entries[i] );
+    code += " };\n\n";
+
+    code += Str::FormatBuf( "static void F_%016llX( asSVMRegisters* regs, asPWORD entry )\n{\n", (unsigned long long)hash );
+    code += "    asDWORD* bc;\n"
+            "    asDWORD* fp = regs->stackFramePointer;\n"
+            "    asDWORD* sp = regs->stackPointer;\n"
+            "    asQWORD  vr = regs->valueRegister;\n"
+            "\n"
+            "    switch( entry )\n"
+            "    {\n";
+    for( uint i = 0; i < entries.size(); i++ )
+        code += Str::FormatBuf( "    case %u:\n        bc = regs->programPointer - %u;\n        goto L%u;\n", i + 1, entries[i], entries[i] );
+    code += "    default:\n"
+            "        regs->programPointer += 1 + AS_PTR_SIZE;\n"
+            "        goto aot_exit;\n"
+            "    }\n"
+            "\n";
+
+    for( uint i = 0; i < count; i++ )
+    {
+        if( !reachable[i] )
+            continue;
+        if( labels[i] )
+            code += Str::FormatBuf( "L%u:\n", positions[i] );
+        if( native[i] )
+            EmitInstruction( code, bc, positions[i], table[i] );
+        else
+            code += Str::FormatBuf( "    AOT_EXIT( %u );\n", positions[i] );
+    }
+
+    code += "\n"
+            "aot_exit:\n"
+            "    regs->stackPointer = sp;\n"
+            "    regs->valueRegister = vr;\n"
+            "}\n";
+    return true;
+}
+
+ScriptAot::ScriptAot() : nativeCount( 0 )
+{
+    //
+}
+
+ScriptAot::~ScriptAot()
+{
+    for( auto it = libraries.begin(), end = libraries.end(); it != end; ++it )
+        DLL_Free( it->second );
+}
+
+bool ScriptAot::LoadNative( const char* path )
+{
+    if( libraries.count( path ) )
+        return true;
+    if( !FileExist( path ) )
+        return false;
+
+    void* dll = DLL_Load( path );
+    if( !dll )
+    {
+        WriteLogF( _FUNC_, " - Can't load native code<%s>, error<%s>.\n", path, DLL_Error() );
+        return false;
+    }
+
+    typedef const ScriptAotTable* (* GetTableFunc)();
+    GetTableFunc          get_table = (GetTableFunc)DLL_GetAddress( dll, "GetScriptAotTable" );
+    const ScriptAotTable* table = (get_table ? get_table() : NULL);
+    if( !table || table->Version != SCRIPT_AOT_VERSION || table->PointerSize != AS_PTR_SIZE || table->AngelScriptVersion != ANGELSCRIPT_VERSION )
+    {
+        WriteLogF( _FUNC_, " - Native code<%s> is built for other server, translate scripts again.\n", path );
+        DLL_Free( dll );
+        return false;
+    }
+
+    for( asUINT i = 0; i < table->FunctionsCount; i++ )
+        functions[table->Functions[i].Hash] = &table->Functions[i];
+    libraries.insert( PAIR( string( path ), dll ) );
+    return true;
+}
+
+void ScriptAot::ClearTranslation()
+{
+    translation.clear();
+    nativeCount = 0;
+}
+
+bool ScriptAot::SaveTranslation( const char* path, const char* module_name )
+{
+    string code = Str::FormatBuf( "// Native code of module<%s>, generated by server from bytecode\n", module_name );
+    code += "// Functions are matched by bytecode, library of changed scripts must be built again\n\n";
+    code += Str::FormatBuf( AotHeader, AS_PTR_SIZE, ANGELSCRIPT_VERSION );
+    for( auto it = translation.begin(), end = translation.end(); it != end; ++it )
+    {
+        code += "\n// ";
+        code += it->second.Declaration;
+        code += "\n";
+        code += it->second.Code;
+    }
+
+    code += "\nstatic const ScriptAotFunction Functions[] =\n{\n";
+    for( auto it = translation.begin(), end = translation.end(); it != end; ++it )
+    {
+        unsigned long long hash = it->first;
+        code += Str::FormatBuf( "    { 0x%016llXull, %u, E_%016llX, F_%016llX },\n", hash, (uint)it->second.Entries.size(), hash, hash );
+    }
+    code += "};\n\n";
+    code += "AOT_EXPORT const ScriptAotTable* GetScriptAotTable()\n{\n";
+    code += Str::FormatBuf( "    static const ScriptAotTable table = { %u, AS_PTR_SIZE, ANGELSCRIPT_VERSION, %u, Functions };\n", SCRIPT_AOT_VERSION, (uint)translation.size() );
+    code += "    return &table;\n}\n";
+
+    void* file = FileOpen( path, true );
+    if( !file )
+    {
+        WriteLogF( _FUNC_, " - Can't create file<%s>.\n", path );
+        return false;
+    }
+    bool result = FileWrite( file, code.c_str(), (uint)code.length() );
+    FileClose( file );
+    return result;
+}
+
+int ScriptAot::CompileFunction( asIScriptFunction* func, asJITFunction* output )
+{
+    asUINT   length = 0;
+    asDWORD* bc = func->GetByteCode( &length );
+    if( !bc || !length )
+        return asNOT_SUPPORTED;
+
+    asQWORD hash = GetFunctionHash( func, bc, length );
+    auto    it = functions.find( hash );
+    if( it != functions.end() )
+    {
+        // Entries are numbered from one, zero argument keeps interpreter going
+        const ScriptAotFunction* native = it->second;
+        for( asUINT i = 0; i < native->EntriesCount; i++ )
+        {
+            asUINT pos = native->Entries[i];
+            if( pos + 1 + AS_PTR_SIZE > length || *(asBYTE*)(bc + pos) != asBC_JitEntry )
+                return asNOT_SUPPORTED;
+        }
+        for( asUINT i = 0; i < native->EntriesCount; i++ )
+            *(asPWORD*)(bc + native->Entries[i] + 1) = i + 1;
+
+        *output = native->Function;
+        nativeCount++;
+        return asSUCCESS;
+    }
+
+    // Collect source for next build of library
+    if( !translation.count( hash ) )
+    {
+        Translation t;
+        if( TranslateFunction( bc, length, hash, t.Code, t.Entries ) )
+        {
+            t.Declaration = func->GetDeclaration( true, true );
+            translation.insert( PAIR( hash, t ) );
+        }
+    }
+    return asNOT_SUPPORTED;
+}
+
+void ScriptAot::ReleaseJITFunction( asJITFunction func )
+{
+    // Code lives in libraries until compiler is destroyed
+}
@@ -0,0 +1,73 @@
+#ifndef __SCRIPT_AOT__
+#define __SCRIPT_AOT__
+
+#include <unordered_map>
+
+#include <angelscript.h>
+
+#include "Types.h"
+
+// Version of generated sources, libraries of other version are ignored
+#define SCRIPT_AOT_VERSION    (1)
+
+// Layout of table exported by library of translated module, repeated in generated source
+struct ScriptAotFunction
+{
+    asQWORD       Hash;
+    asUINT        EntriesCount;
+    const asUINT* Entries; // Offsets of JitEntry instructions
+    asJITFunction Function;
+};
+
+struct ScriptAotTable
+{
+    asUINT                   Version;
+    asUINT                   PointerSize;
+    asUINT                   AngelScriptVersion;
+    asUINT                   FunctionsCount;
+    const ScriptAotFunction* Functions;
+};
+
+// Ahead of time compiler of script bytecode
+// Functions are translated to C++, source is built to library per module with regular C++ compiler
+// Native code is found by hash of declaration and bytecode, changed or unknown functions stay in interpreter
+// Arithmetic, comparisons, jumps and variables run natively, calls, allocations, strings and exceptions return to interpreter
+// Engine must include JIT instructions, compiler is not thread safe and is used while modules are built or loaded
+class ScriptAot : public asIJITCompiler
+{
+public:
+    ScriptAot();
+    virtual ~ScriptAot();
+
+    // Register functions of library, false if library is missing or built for other engine
+    bool LoadNative( const char* path );
+
+    // Functions compiled without native code are translated and collected until saved or cleared
+    void ClearTranslation();
+    uint GetTranslationCount() { return (uint)translation.size(); }
+    bool SaveTranslation( const char* path, const char* module_name );
+
+    // Functions which got native code since translation was cleared
+    uint GetNativeCount() { return nativeCount; }
+
+    virtual int  CompileFunction( asIScriptFunction* func, asJITFunction* output );
+    virtual void ReleaseJITFunction( asJITFunction func );
+
+private:
+    // Generated source of function, named by hash
+    struct Translation
+    {
+        string  Declaration;
+        string  Code;
+        UIntVec Entries;
+    };
+    typedef std::unordered_map<asQWORD, const ScriptAotFunction*> FunctionMap;
+    typedef map<asQWORD, Translation>                              TranslationMap;
+
+    FunctionMap        functions;
+    map<string, void*> libraries;
+    TranslationMap     translation;
+    uint               nativeCount;
+};
+
+#endif // __SCRIPT_AOT__
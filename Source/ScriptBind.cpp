@@ -942,6 +942,7 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterGlobalFunction( engine, "bool LoadImage(uint index, string@+ imageName, uint imageDepth, int pathType)", focFUNCTION( BIND_CLASS Global_LoadImage ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetImageColor(uint index, uint x, uint y)", focFUNCTION( BIND_CLASS Global_GetImageColor ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "bool SetParameterDialogGetBehaviour(uint index, string& funcName)", focFUNCTION( BIND_CLASS Global_SetParameterDialogGetBehaviour ), asCALL_CDECL );
+        RegisterGlobalFunction( engine, "bool SetParameterGetDepends(uint index, uint[]& depends)", focFUNCTION( BIND_CLASS Global_SetParameterGetDepends ), asCALL_CDECL );
     }
     #endif
 
@@ -1029,6 +1030,7 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterGlobalFunction( engine, "void GetProtoCritter(uint16 protoId, int[]& data)", focFUNCTION( BIND_CLASS Global_GetProtoCritter ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "void DeleteNpc(Critter& npc)", focFUNCTION( BIND_CLASS Global_DeleteNpc ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetAllNpc(uint16 pid, Critter@[]@+ npc)", focFUNCTION( BIND_CLASS Global_GetAllNpc ), asCALL_CDECL );
+        RegisterGlobalFunction( engine, "uint GetCrittersByParam(uint index, int minValue, int maxValue, int findType, Critter@[]@+ critters)", focFUNCTION( BIND_CLASS Global_GetCrittersByParam ), asCALL_CDECL );
         // Player
         RegisterGlobalFunction( engine, "Critter@+ GetPlayer(string& name)", focFUNCTION( BIND_CLASS Global_GetPlayer ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetPlayerId(string& name)", focFUNCTION( BIND_CLASS Global_GetPlayerId ), asCALL_CDECL );
@@ -1473,7 +1475,6 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterObjectProperty( engine, "Item", "uint16 LockerCondition", focOFFSET( Item, Data.LockerCondition ) );
         RegisterObjectProperty( engine, "Item", "uint16 LockerComplexity", focOFFSET( Item, Data.LockerComplexity ) );
         RegisterObjectProperty( engine, "Item", "uint16 Charge", focOFFSET( Item, Data.Charge ) );
-        RegisterObjectProperty( engine, "Item", "uint16 RadioChannel", focOFFSET( Item, Data.RadioChannel ) );
         RegisterObjectProperty( engine, "Item", "uint16 RadioFlags", focOFFSET( Item, Data.RadioFlags ) );
         RegisterObjectProperty( engine, "Item", "uint8 RadioBroadcastSend", focOFFSET( Item, Data.RadioBroadcastSend ) );
         RegisterObjectProperty( engine, "Item", "uint8 RadioBroadcastRecv", focOFFSET( Item, Data.RadioBroadcastRecv ) );
@@ -1486,6 +1487,8 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterObjectMethod( engine, "Item", "uint get_Flags() const", focFUNCTION( BIND_CLASS Item_get_Flags ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Item", "void set_TrapValue(int16 val)", focFUNCTION( BIND_CLASS Item_set_TrapValue ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Item", "int16 get_TrapValue() const", focFUNCTION( BIND_CLASS Item_get_TrapValue ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Item", "void set_RadioChannel(uint16 value)", focFUNCTION( BIND_CLASS Item_set_RadioChannel ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Item", "uint16 get_RadioChannel() const", focFUNCTION( BIND_CLASS Item_get_RadioChannel ), asCALL_CDECL_OBJFIRST );
 
         RegisterObjectMethod( engine, "Item", "bool LockerOpen()", focFUNCTION( BIND_CLASS Item_LockerOpen ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Item", "bool LockerClose()", focFUNCTION( BIND_CLASS Item_LockerClose ), asCALL_CDECL_OBJFIRST );
@@ -1611,19 +1614,24 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterGlobalFunction( engine, "Location@+ GetLocationByPid(uint16 locPid, uint skipCount)", focFUNCTION( BIND_CLASS Global_GetLocationByPid ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetLocations(uint16 worldX, uint16 worldY, uint radius, Location@[]@+ locations)", focFUNCTION( BIND_CLASS Global_GetLocations ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetVisibleLocations(uint16 worldX, uint16 worldY, uint radius, Critter@+ visibleBy, Location@[]@+ locations)", focFUNCTION( BIND_CLASS Global_GetVisibleLocations ), asCALL_CDECL );
+        RegisterGlobalFunction( engine, "Location@+ GetNearestLocation(uint16 worldX, uint16 worldY, uint radius, bool onlyVisible)", focFUNCTION( BIND_CLASS Global_GetNearestLocation ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "uint GetZoneLocationIds(uint16 zoneX, uint16 zoneY, uint zoneRadius, uint[]@+ locationIds)", focFUNCTION( BIND_CLASS Global_GetZoneLocationIds ), asCALL_CDECL );
 
         RegisterObjectProperty( engine, "Location", "const uint Id", focOFFSET( Location, Data.LocId ) );
-        RegisterObjectProperty( engine, "Location", "uint16 WorldX", focOFFSET( Location, Data.WX ) );
-        RegisterObjectProperty( engine, "Location", "uint16 WorldY", focOFFSET( Location, Data.WY ) );
         RegisterObjectProperty( engine, "Location", "bool Visible", focOFFSET( Location, Data.Visible ) );
         RegisterObjectProperty( engine, "Location", "bool GeckVisible", focOFFSET( Location, Data.GeckVisible ) );
         RegisterObjectProperty( engine, "Location", "bool AutoGarbage", focOFFSET( Location, Data.AutoGarbage ) );
         RegisterObjectProperty( engine, "Location", "int GeckCount", focOFFSET( Location, GeckCount ) );
-        RegisterObjectProperty( engine, "Location", "uint16 Radius", focOFFSET( Location, Data.Radius ) );
         RegisterObjectProperty( engine, "Location", "uint Color", focOFFSET( Location, Data.Color ) );
         RegisterObjectProperty( engine, "Location", "const bool IsNotValid", focOFFSET( Location, IsNotValid ) );
 
+        RegisterObjectMethod( engine, "Location", "void set_WorldX(uint16 value)", focFUNCTION( BIND_CLASS Location_set_WorldX ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Location", "uint16 get_WorldX() const", focFUNCTION( BIND_CLASS Location_get_WorldX ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Location", "void set_WorldY(uint16 value)", focFUNCTION( BIND_CLASS Location_set_WorldY ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Location", "uint16 get_WorldY() const", focFUNCTION( BIND_CLASS Location_get_WorldY ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Location", "void set_Radius(uint16 value)", focFUNCTION( BIND_CLASS Location_set_Radius ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Location", "uint16 get_Radius() const", focFUNCTION( BIND_CLASS Location_get_Radius ), asCALL_CDECL_OBJFIRST );
+
         RegisterGlobalFunction( engine, "uint CreateLocation(uint16 locPid, uint16 worldX, uint16 worldY, Critter@[]@+ critters)", focFUNCTION( BIND_CLASS Global_CreateLocation ), asCALL_CDECL );
         RegisterGlobalFunction( engine, "void DeleteLocation(uint locId)", focFUNCTION( BIND_CLASS Global_DeleteLocation ), asCALL_CDECL );
 
@@ -1699,6 +1707,7 @@ bool ScriptBind::RegisterAll( asIScriptEngine* engine, const uchar& bind )
         RegisterObjectMethod( engine, "Map", "Critter@+ GetCritter(uint critterId) const", focFUNCTION( BIND_CLASS Map_GetCritterById ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Map", "uint GetCrittersHex(uint16 hexX, uint16 hexY, uint radius, int findType, Critter@[]@+ critters) const", focFUNCTION( BIND_CLASS Map_GetCritters ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Map", "uint GetCritters(uint16 pid, int findType, Critter@[]@+ critters) const", focFUNCTION( BIND_CLASS Map_GetCrittersByPids ), asCALL_CDECL_OBJFIRST );
+        RegisterObjectMethod( engine, "Map", "uint GetCrittersByParam(uint index, int minValue, int maxValue, int findType, Critter@[]@+ critters) const", focFUNCTION( BIND_CLASS Map_GetCrittersByParam ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Map", "uint GetCrittersPath(uint16 fromHx, uint16 fromHy, uint16 toHx, uint16 toHy, float angle, uint dist, int findType, Critter@[]@+ critters) const", focFUNCTION( BIND_CLASS Map_GetCrittersInPath ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Map", "uint GetCrittersPath(uint16 fromHx, uint16 fromHy, uint16 toHx, uint16 toHy, float angle, uint dist, int findType, Critter@[]@+ critters, uint16& preBlockHx, uint16& preBlockHy, uint16& blockHx, uint16& blockHy) const", focFUNCTION( BIND_CLASS Map_GetCrittersInPathBlock ), asCALL_CDECL_OBJFIRST );
         RegisterObjectMethod( engine, "Map", "uint GetCrittersWhoViewPath(uint16 fromHx, uint16 fromHy, uint16 toHx, uint16 toHy, int findType, Critter@[]@+ critters) const", focFUNCTION( BIND_CLASS Map_GetCrittersWhoViewPath ), asCALL_CDECL_OBJFIRST );
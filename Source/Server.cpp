@@ -2,6 +2,7 @@
 
 #include "FL/Fl.H"
 
+#include "ClientStore.h"
 #include "CommandLine.h"
 #include "ConfigFile.h"
 #include "ConstantsManager.h"
@@ -17,13 +18,21 @@
 #include "NetProtocol.h"
 #include "Network.h"
 #include "Random.h"
+#include "Registry.h"
 #include "Scores.h"
 #include "Script.h"
 #include "ScriptBind.h"
 #include "Server.h"
 #include "SinglePlayer.h"
 #include "Text.h"
+#include "Tracer.h"
 #include "Vars.h"
+#include "WorldJournal.h"
+
+#if defined (FO_LINUX)
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
 
 void* zlib_alloc( void* opaque, unsigned int items, unsigned int size ) { return calloc( items, size ); }
 void  zlib_free( void* opaque, void* address )                          { free( address ); }
@@ -49,6 +58,9 @@ uint                        FOServer::NetIOThreadsCount = 0;
 ClVec                       FOServer::ConnectedClients;
 Mutex                       FOServer::ConnectedClientsLocker;
 FOServer::Statistics_       FOServer::Statistics;
+void*                       FOServer::StatisticsCsvFile = NULL;
+uint                        FOServer::StatisticsCsvTime = 0;
+uint                        FOServer::StatisticsCsvNextTick = 0;
 FOServer::ClientSaveDataVec FOServer::ClientsSaveData;
 size_t                      FOServer::ClientsSaveDataCount = 0;
 PUCharVec                   FOServer::WorldSaveData;
@@ -60,6 +72,11 @@ MutexEvent                  FOServer::DumpEndEvent;
 uint                        FOServer::SaveWorldIndex = 0;
 uint                        FOServer::SaveWorldTime = 0;
 uint                        FOServer::SaveWorldNextTick = 0;
+uint                        FOServer::SaveWorldJournal = 0;
+uint                        FOServer::SaveWorldJournalCount = 0;
+bool                        FOServer::SaveWorldDelta = false;
+int                         FOServer::SaveWorldForkPid = 0;
+double                      FOServer::SaveWorldForkTick = 0.0;
 UIntVec                     FOServer::SaveWorldDeleteIndexes;
 Thread                      FOServer::DumpThread;
 Thread*                     FOServer::LogicThreads;
@@ -71,6 +88,8 @@ FOServer::HoloInfoMap       FOServer::HolodiskInfo;
 Mutex                       FOServer::HolodiskLocker;
 uint                        FOServer::LastHoloId = 0;
 FOServer::TimeEventVec      FOServer::TimeEvents;
+FOServer::TimeEventMap      FOServer::TimeEventsByNum;
+FOServer::TimeEventVec      FOServer::TimeEventsInProcess;
 uint                        FOServer::TimeEventsLastNum = 0;
 Mutex                       FOServer::TimeEventsLocker;
 FOServer::AnyDataMap        FOServer::AnyData;
@@ -161,6 +180,7 @@ void FOServer::Finish()
     ActiveInProcess = true;
 
     // World dumper
+    WaitForkedWorldSave( true );
     if( WorldSaveManager )
     {
         DumpEndEvent.Wait();
@@ -181,6 +201,8 @@ void FOServer::Finish()
     SaveWorldIndex = 0;
     SaveWorldTime = 0;
     SaveWorldNextTick = 0;
+    SaveWorldJournalCount = 0;
+    SaveWorldDelta = false;
 
     // End script
     if( Script::PrepareContext( ServerFunctions.Finish, _FUNC_, "Game" ) )
@@ -239,6 +261,16 @@ void FOServer::Finish()
     FinishLangPacks();
     FileManager::EndOfWork();
 
+    // Clients data
+    ClientStore::Close();
+
+    if( StatisticsCsvFile )
+    {
+        WriteStatisticsCsv();
+        FileClose( StatisticsCsvFile );
+        StatisticsCsvFile = NULL;
+    }
+
     // Statistics
     WriteLog( "Server stopped.\n" );
     WriteLog( "Statistics:\n" );
@@ -250,10 +282,33 @@ void FOServer::Finish()
     WriteLog( "Min cycle period: %u\n", Statistics.LoopMin );
     WriteLog( "Max cycle period: %u\n", Statistics.LoopMax );
     WriteLog( "Count of lags (>100ms): %u\n", Statistics.LagsCount );
+    uint log_written, log_dropped, log_batches;
+    LogGetAsyncStatistics( log_written, log_dropped, log_batches );
+    if( log_written || log_dropped )
+        WriteLog( "Async log: written %u, dropped %u, batches %u\n", log_written, log_dropped, log_batches );
+    for( uint i = 0; i < Statistics.JobThreadsCount; i++ )
+    {
+        JobThreadStatistics& stats = Statistics.JobThreads[i];
+        WriteLog( "Jobs thread<%u>: max depth %u, steals %u, stolen %u\n", i, stats.QueueDepthMax, stats.Steals, stats.Stolen );
+    }
 
     ActiveInProcess = false;
 }
 
+void FOServer::WriteStatisticsCsv()
+{
+    ConnectedClientsLocker.Lock();
+    uint conn_count = (uint)ConnectedClients.size();
+    ConnectedClientsLocker.Unlock();
+
+    char str[MAX_FOTEXT];
+    Str::Format( str, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%lld,%lld,%lld,%lld\n",
+                 Statistics.Uptime, conn_count, PlayersInGame(), NpcInGame(), Statistics.CycleTime, Statistics.FPS,
+                 Statistics.LoopTime / (Statistics.LoopCycles ? Statistics.LoopCycles : 1), Statistics.LoopMin, Statistics.LoopMax, Statistics.LagsCount,
+                 Statistics.BytesSend, Statistics.BytesRecv, Statistics.DataReal, Statistics.DataCompressed );
+    FileWrite( StatisticsCsvFile, str, Str::Length( str ) );
+}
+
 string FOServer::GetIngamePlayersStatistics()
 {
     static string result;
@@ -431,6 +486,14 @@ void FOServer::DeleteClientFile( const char* client_name )
     char old_client_fname[MAX_FOPATH];
     Str::Format( old_client_fname, "%s%s.client", clients_path, client_name );
 
+    // Client file remains only from import
+    if( ClientStore::IsOpened() )
+    {
+        ClientStore::Delete( client_name );
+        if( !FileExist( old_client_fname ) )
+            return;
+    }
+
     // Make new name
     char new_client_fname[MAX_FOPATH];
     for( uint i = 0; ; i++ )
@@ -500,6 +563,8 @@ void FOServer::MainLoop()
 
     // Start logic threads
     WriteLog( "Starting logic threads, count<%u>.\n", LogicThreadCount );
+    if( DeadlineScheduler )
+        WriteLog( "Deadline scheduler enabled, idle critters and maps delayed up to %u ms.\n", JOB_DELAY_MAX );
     WriteLog( "***   Starting game loop   ***\n" );
 
     LogicThreads = new Thread[LogicThreadCount];
@@ -560,12 +625,17 @@ void FOServer::MainLoop()
         #endif
 
         // World saver
+        if( SaveWorldForkPid )
+            WaitForkedWorldSave( false );
         if( Timer::FastTick() >= SaveWorldNextTick )
         {
+            double pause_tick = Timer::AccurateTick();
             SynchronizeLogicThreads();
             SaveWorld( NULL );
             SaveWorldNextTick = Timer::FastTick() + SaveWorldTime;
             ResynchronizeLogicThreads();
+            WorldJournal::SetPauseTime( Timer::AccurateTick() - pause_tick );
+            FinishWorldSave();
         }
 
         // Client script
@@ -579,6 +649,11 @@ void FOServer::MainLoop()
 
         // Statistics
         Statistics.Uptime = (Timer::FastTick() - Statistics.ServerStartTick) / 1000;
+        if( StatisticsCsvFile && Timer::FastTick() >= StatisticsCsvNextTick )
+        {
+            WriteStatisticsCsv();
+            StatisticsCsvNextTick = Timer::FastTick() + StatisticsCsvTime;
+        }
 
 //		sync_mngr->UnlockAll();
         Thread::Sleep( 100 );
@@ -630,7 +705,9 @@ void FOServer::MainLoop()
     Job::ProcessDeferredReleasing();
 
     // Save
+    WaitForkedWorldSave( true );
     SaveWorld( NULL );
+    FinishWorldSave();
 
     // Last unlock
     sync_mngr->UnlockAll();
@@ -657,7 +734,8 @@ void FOServer::Logic_Work( void* data )
     if( !Script::InitThread() )
         return;
 
-    // Add sleep job for current thread
+    // Own jobs queue and sleep job for current thread
+    Job::RegisterThread();
     Job::PushBack( Job( JOB_THREAD_LOOP, NULL, true ) );
 
     // Get synchronize manager
@@ -674,11 +752,16 @@ void FOServer::Logic_Work( void* data )
     {
         sync_mngr->UnlockAll();
         Job job = Job::PopFront();
+        TRACE_SCOPE( job.Type );
+
+        // Deadline scheduler, time to postpone job
+        uint           job_delay = 0;
+        volatile uint* job_delay_tick = NULL;
 
         if( job.Type == JOB_CLIENT )
         {
             Client* cl = (Client*)job.Data;
-            SYNC_LOCK( cl );
+            cl->Sync.Lock();                                            // Processing alone is not reported to world journal
 
             // Disconnect
             if( cl->IsOffline() )
@@ -735,7 +818,7 @@ void FOServer::Logic_Work( void* data )
         else if( job.Type == JOB_CRITTER )
         {
             Critter* cr = (Critter*)job.Data;
-            SYNC_LOCK( cr );
+            cr->Sync.Lock();
 
             // Player specific
             if( cr->CanBeRemoved )
@@ -746,19 +829,29 @@ void FOServer::Logic_Work( void* data )
                 continue;
 
             // Process logic
-            ProcessCritter( cr );
+            uint wait = ProcessCritter( cr );
+            if( DeadlineScheduler )
+            {
+                job_delay = wait;
+                job_delay_tick = &cr->JobDelayTick;
+            }
         }
         else if( job.Type == JOB_MAP )
         {
             Map* map = (Map*)job.Data;
-            SYNC_LOCK( map );
+            map->Sync.Lock();
 
             // Check for removing
             if( map->IsNotValid )
                 continue;
 
             // Process logic
-            map->Process();
+            uint wait = map->Process();
+            if( DeadlineScheduler )
+            {
+                job_delay = wait;
+                job_delay_tick = &map->JobDelayTick;
+            }
         }
         else if( job.Type == JOB_TIME_EVENTS )
         {
@@ -888,6 +981,7 @@ void FOServer::Logic_Work( void* data )
             Statistics.LoopMin = loop_min / count;
             Statistics.LoopMax = loop_max / count;
             Statistics.LagsCount = lags / count;
+            Statistics.JobThreadsCount = Job::GetThreadStatistics( Statistics.JobThreads, MAX_JOB_THREADS );
             stats_locker.Unlock();
 
             // Set real cycle count for deferred releasing
@@ -913,7 +1007,11 @@ void FOServer::Logic_Work( void* data )
         }
 
         // Add job to back
-        uint job_count = Job::PushBack( job );
+        uint job_count;
+        if( job_delay >= JOB_DELAY_MIN )
+            job_count = Job::PushDelayed( job, job_delay, *job_delay_tick );
+        else
+            job_count = Job::PushBack( job );
 
         // Calculate fps
         static volatile uint job_cur = 0;
@@ -932,6 +1030,7 @@ void FOServer::Logic_Work( void* data )
         }
     }
 
+    Job::UnregisterThread();
     sync_mngr->UnlockAll();
     Script::FinishThread();
 }
@@ -1222,6 +1321,8 @@ void FOServer::NetIO_Input( bufferevent* bev, void* arg )
 
 void FOServer::NetIO_Output( bufferevent* bev, void* arg )
 {
+    TRACE_SCOPE( TRACE_NET_OUTPUT );
+
     CheckThreadName();
 
     Client::NetIOArg* arg_ = (Client::NetIOArg*)arg;
@@ -1243,9 +1344,9 @@ void FOServer::NetIO_Output( bufferevent* bev, void* arg )
     uint               write_len = 0;
     if( !GameOpt.DisableZlibCompression && !cl->DisableZlib )
     {
-        uint to_compr = cl->Bout.GetEndPos();
-        if( to_compr > output_buffer_len )
-            to_compr = output_buffer_len;
+        // Deflate takes all pending data and stops when output buffer is full,
+        // not consumed rest stays in Bout until next write callback
+        uint to_compr = cl->Bout.GetDataLen();
 
         cl->Zstrm.next_in = (uchar*)cl->Bout.GetCurData();
         cl->Zstrm.avail_in = to_compr;
@@ -1269,24 +1370,28 @@ void FOServer::NetIO_Output( bufferevent* bev, void* arg )
         Statistics.DataReal += real;
         Statistics.DataCompressed += compr;
     }
-    // Without compressing
+    // Without compressing, append all data to socket buffer directly
     else
     {
-        uint len = cl->Bout.GetEndPos();
-        if( len > output_buffer_len )
-            len = output_buffer_len;
-        memcpy( output_buffer, cl->Bout.GetCurData(), len );
-        write_len = len;
+        uint len = cl->Bout.GetDataLen();
+        if( bufferevent_write( bev, cl->Bout.GetCurData(), len ) )
+        {
+            WriteLogF( _FUNC_, " - Send fail.\n" );
+            cl->Bout.Unlock();
+            cl->Shutdown();
+            return;
+        }
         cl->Bout.Cut( len );
         Statistics.DataReal += len;
         Statistics.DataCompressed += len;
+        Statistics.BytesSend += len;
     }
     if( cl->Bout.IsEmpty() )
         cl->Bout.Reset();
     cl->Bout.Unlock();
 
     // Append to buffer
-    if( bufferevent_write( bev, output_buffer, write_len ) )
+    if( write_len && bufferevent_write( bev, output_buffer, write_len ) )
     {
         WriteLogF( _FUNC_, " - Send fail.\n" );
         cl->Shutdown();
@@ -1380,6 +1485,8 @@ void FOServer::NetIO_Input( Client::NetIOArg* io )
 
 void FOServer::NetIO_Output( Client::NetIOArg* io )
 {
+    TRACE_SCOPE( TRACE_NET_OUTPUT );
+
     Client* cl = (Client*)io->PClient;
 
     // Nothing to send
@@ -1394,7 +1501,7 @@ void FOServer::NetIO_Output( Client::NetIOArg* io )
     // Compress
     if( !GameOpt.DisableZlibCompression && !cl->DisableZlib )
     {
-        uint to_compr = cl->Bout.GetEndPos();
+        uint to_compr = cl->Bout.GetDataLen();
         if( to_compr > WSA_BUF_SIZE )
             to_compr = WSA_BUF_SIZE;
 
@@ -1423,7 +1530,7 @@ void FOServer::NetIO_Output( Client::NetIOArg* io )
     // Without compressing
     else
     {
-        uint len = cl->Bout.GetEndPos();
+        uint len = cl->Bout.GetDataLen();
         if( len > WSA_BUF_SIZE )
             len = WSA_BUF_SIZE;
         memcpy( io->Buffer.buf, cl->Bout.GetCurData(), len );
@@ -1450,6 +1557,8 @@ void FOServer::NetIO_Output( Client::NetIOArg* io )
 
 void FOServer::Process( ClientPtr& cl )
 {
+    TRACE_SCOPE( TRACE_NET_INPUT );
+
     if( cl->IsOffline() || cl->IsNotValid )
     {
         cl->Bin.LockReset();
@@ -2145,6 +2254,64 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
                 case 5:
                     result = ItemMngr.GetItemsStatistics();
                     break;
+                case 6:
+                    result = Job::GetStatistics();
+                    break;
+                case 7:
+                    result = SyncManager::GetStatisticsString();
+                    break;
+                case 8:
+                    result = WorldJournal::GetStatisticsString();
+                    break;
+                case 9:
+                    result = Critter::GetBroadcastStatisticsString();
+                    break;
+                case 10:
+                    result = Critter::GetVisibilityStatisticsString();
+                    break;
+                case 11:
+                    result = MapManager::GetPathFindStatisticsString();
+                    break;
+                case 12:
+                    result = "Registry   Objects    Lookups      Misses     Shards\n";
+                    result += CrMngr.GetRegistryStatisticsString();
+                    result += ItemMngr.GetRegistryStatisticsString();
+                    break;
+                case 13:
+                    result = ClientStore::GetStatisticsString();
+                    break;
+                case 14:
+                    result = Tracer::GetStatisticsString();
+                    break;
+                case 15:
+                {
+                    string fname;
+                    if( !LatencyProfiler )
+                        result = "Latency profiler: disabled\n";
+                    else if( Tracer::ExportChromeTrace( fname ) )
+                        result = "Saving trace to<" + fname + ">.\n";
+                    else if( fname.empty() )
+                        result = "Trace export is already in progress.\n";
+                    else
+                        result = "Unable to save trace to<" + fname + ">.\n";
+                    break;
+                }
+                case 16:
+                    result = Script::GetExecutionStatistics();
+                    break;
+                case 17:
+                    result = Critter::GetParamsGetStatisticsString();
+                    break;
+                case 18:
+                    result = DataFile::GetCacheStatisticsString();
+                    break;
+                case 19:
+                {
+                    uint log_written, log_dropped, log_batches;
+                    LogGetAsyncStatistics( log_written, log_dropped, log_batches );
+                    result = Str::FormatBuf( "Async log: written %u, dropped %u, batches %u\n", log_written, log_dropped, log_batches );
+                    break;
+                }
                 default:
                     break;
             }
@@ -3256,6 +3423,8 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
 
 void FOServer::SaveGameInfoFile()
 {
+    WorldJournal::BeginSection( WORLD_SECTION_GAME_INFO );
+
     // Singleplayer info
     uint sp = (SingleplayerSave.Valid ? SINGLEPLAYER_SAVE_LAST : 0);
     AddWorldSaveData( &sp, sizeof(sp) );
@@ -3414,8 +3583,41 @@ bool FOServer::Init()
     return Active;
 }
 
+// Time of initialization steps, printed at end of InitReal
+struct InitStage
+{
+    const char* Name;
+    double      Time;
+};
+static vector<InitStage> InitStages;
+static double            InitStagesTick = 0.0;
+
+static void InitStageDone( const char* name )
+{
+    double    tick = Timer::AccurateTick();
+    InitStage stage = { name, tick - InitStagesTick };
+    InitStages.push_back( stage );
+    InitStagesTick = tick;
+}
+
+static void WriteInitStages()
+{
+    double total = 0.0;
+    WriteLog( "Initialization stages:\n" );
+    for( auto it = InitStages.begin(), end = InitStages.end(); it != end; ++it )
+    {
+        WriteLog( "  %-40s %10.1f ms\n", it->Name, it->Time );
+        total += it->Time;
+    }
+    WriteLog( "  %-40s %10.1f ms\n", "Total", total );
+    InitStages.clear();
+}
+
 bool FOServer::InitReal()
 {
+    InitStages.clear();
+    InitStagesTick = Timer::AccurateTick();
+
     FileManager::InitDataFiles( DIR_SLASH_SD );
 
     WriteLog( "***   Starting initialization   ****\n" );
@@ -3429,6 +3631,7 @@ bool FOServer::InitReal()
     memzero( Critter::ParamsSendEnabled, sizeof(Critter::ParamsSendEnabled) );
     memzero( Critter::ParamsChangeScript, sizeof(Critter::ParamsChangeScript) );
     memzero( Critter::ParamsGetScript, sizeof(Critter::ParamsGetScript) );
+    Critter::ResetParamsGetCache();
     memzero( Critter::SlotDataSendEnabled, sizeof(Critter::SlotDataSendEnabled) );
     for( int i = 0; i < MAX_PARAMS; i++ )
         Critter::ParamsChosenSendMask[i] = uint( -1 );
@@ -3458,6 +3661,14 @@ bool FOServer::InitReal()
     TimeEventsLastNum = 0;
     VarsGarbageLastTick = Timer::FastTick();
 
+    // Fixed seed makes world generation and game logic repeatable between benchmark runs
+    uint random_seed = CommandLine->GetInt( "RandomSeed", ConfigFile->GetInt( "Server", "RandomSeed", 0 ) );
+    if( random_seed )
+    {
+        DefaultRandomizer.Generate( random_seed );
+        WriteLog( "Random seed<%u>.\n", random_seed );
+    }
+
     // Profiler
     uint sample_time = ConfigFile->GetInt( "Server", "ProfilerSampleInterval", 0 );
     uint profiler_mode = ConfigFile->GetInt( "Server", "ProfilerMode", 0 );
@@ -3475,6 +3686,9 @@ bool FOServer::InitReal()
     if( LogicThreadCount == 1 )
         Script::SetConcurrentExecution( false );
     LogicMT = (LogicThreadCount != 1);
+    uint init_threads = ConfigFile->GetInt( "Server", "InitThreadCount", 0 );
+    if( !init_threads )
+        init_threads = CpuCount;
 
     if( !Singleplayer )
     {
@@ -3489,18 +3703,23 @@ bool FOServer::InitReal()
     FileManager::CreateDirectoryTree( FileManager::GetFullPath( "", PATH_SERVER_BANS ) );
 
     ConstantsManager::Initialize( PATH_SERVER_DATA ); // Generate name of defines
+    InitStageDone( "Constants" );
     if( !InitLangPacks( LangPacks ) )
         return false;                                 // Language packs
+    InitStageDone( "Language packs" );
     if( !InitScriptSystem() )
         return false;                                 // Script system
+    InitStageDone( "Script system" );
     if( !ReloadExternalScripts( SCRIPT_BIND_MAPPER ) )
     {}                                                // Mapper scripts
     if( !ReloadExternalScripts( SCRIPT_BIND_CLIENT ) )
         return false;                                 // Client scripts, after language packs initialization
+    InitStageDone( "External scripts" );
     if( !Singleplayer && !LoadClientsData() )
         return false;
     if( !Singleplayer )
         LoadBans();
+    InitStageDone( "Clients and bans" );
 
     // Managers
     if( !AIMngr.Init() )
@@ -3513,29 +3732,36 @@ bool FOServer::InitReal()
         return false;                    // Map manager
     if( !VarMngr.Init( FileManager::GetFullPath( "", PATH_SERVER_SCRIPTS ) ) )
         return false;                    // Var Manager (only before dialog manager!)
+    InitStageDone( "Managers" );
     if( !DlgMngr.LoadDialogs( DIALOGS_LST_NAME ) )
         return false;                    // Dialog manager
+    InitStageDone( "Dialogs" );
     if( !InitLangPacksDialogs( LangPacks ) )
         return false;                    // Create FONPC.MSG, FODLG.MSG, need call after InitLangPacks and DlgMngr.LoadDialogs
     if( !InitCrafts( LangPacks ) )
         return false;                    // MrFixit
     if( !InitLangCrTypes( LangPacks ) )
         return false;                    // Critter types
+    InitStageDone( "Dialogs, crafts and critter types texts" );
     // if(!MapMngr.LoadRelief()) return false; // Global map relief
 
     // Prototypes
     if( !ItemMngr.LoadProtos() )
         return false;                          // Proto items
+    InitStageDone( "Proto items" );
     if( !CrMngr.LoadProtos() )
         return false;                          // Proto critters
-    if( !MapMngr.LoadLocationsProtos() )
-        return false;                          // Proto locations and maps
+    InitStageDone( "Proto critters" );
+    if( !MapMngr.LoadLocationsProtos( init_threads ) )
+        return false;                          // Proto locations and maps, maps are parsed in parallel after proto items
+    InitStageDone( "Proto locations and maps" );
     if( !ItemMngr.CheckProtoFunctions() )
         return false;                          // Check valid of proto functions
 
     // Initialization script
     Script::PrepareContext( ServerFunctions.Init, _FUNC_, "Game" );
     Script::RunPrepared();
+    InitStageDone( "Init script" );
 
     // World loading
     if( !Singleplayer )
@@ -3551,6 +3777,8 @@ bool FOServer::InitReal()
         // Clear unused variables
         VarsGarbarger( true );
     }
+    InitStageDone( "World" );
+    WriteInitStages();
 
     // End of initialization
     Statistics.BytesSend = 0;
@@ -3559,6 +3787,24 @@ bool FOServer::InitReal()
     Statistics.DataCompressed = 1;
     Statistics.ServerStartTick = Timer::FastTick();
 
+    // Statistics snapshots
+    string csv = CommandLine->GetStr( "StatisticsCsv", ConfigFile->GetStr( "Server", "StatisticsCsv", "" ) );
+    if( !csv.empty() )
+    {
+        StatisticsCsvFile = FileOpen( csv.c_str(), true, true );
+        if( !StatisticsCsvFile )
+        {
+            WriteLog( "Can't create statistics file<%s>.\n", csv.c_str() );
+            return false;
+        }
+
+        const char* header = "Uptime,Online,Players,Npc,CycleTime,FPS,LoopAvg,LoopMin,LoopMax,Lags,BytesSend,BytesRecv,DataReal,DataCompressed\n";
+        FileWrite( StatisticsCsvFile, header, Str::Length( header ) );
+        StatisticsCsvTime = MAX( CommandLine->GetInt( "StatisticsCsvTime", ConfigFile->GetInt( "Server", "StatisticsCsvTime", 1000 ) ), 100 );
+        StatisticsCsvNextTick = Timer::FastTick() + StatisticsCsvTime;
+        WriteLog( "Statistics snapshots to<%s>, every %u ms.\n", csv.c_str(), StatisticsCsvTime );
+    }
+
     // Net
     #ifdef FO_WINDOWS
     WSADATA wsa;
@@ -3751,6 +3997,28 @@ bool FOServer::InitReal()
     }
     SaveWorldTime = ConfigFile->GetInt( "Server", "WorldSaveTime", 60 ) * 60 * 1000;
     SaveWorldNextTick = Timer::FastTick() + SaveWorldTime;
+    SaveWorldJournal = ConfigFile->GetInt( "Server", "WorldSaveJournal", 0 );
+    SaveWorldJournalCount = 0;
+    #if defined (FO_LINUX)
+    if( WorldSaveFork )
+    {
+        WriteLog( "World save in forked process enabled.\n" );
+        if( SaveWorldJournal )
+        {
+            WriteLog( "World save journal is not compatible with forked saving, disabled.\n" );
+            SaveWorldJournal = 0;
+        }
+    }
+    #else
+    if( WorldSaveFork )
+    {
+        WriteLog( "World save in forked process is not supported on this platform.\n" );
+        WorldSaveFork = false;
+    }
+    #endif
+    if( SaveWorldJournal )
+        WriteLog( "World save journal enabled, full save every %u saves.\n", SaveWorldJournal + 1 );
+    WorldJournal::SetTracking( SaveWorldJournal != 0 );
 
     Active = true;
 
@@ -4118,6 +4386,118 @@ void FOServer::LoadBans()
     ProcessBans();
 }
 
+static void SaveLastClientId( const char* fname, uint last_id )
+{
+    void* f = FileOpen( fname, true );
+    if( f )
+    {
+        char last_id_str[128];
+        Str::Format( last_id_str, "%u", last_id );
+        FileWrite( f, last_id_str, Str::Length( last_id_str ) );
+        FileClose( f );
+    }
+}
+
+static bool ReadClientFile( const char* fname, UCharVec& data )
+{
+    void* f = FileOpen( fname, false );
+    if( !f )
+        return false;
+
+    data.resize( FileGetSize( f ) );
+    bool ok = (data.empty() || FileRead( f, &data[0], (uint)data.size() ));
+    FileClose( f );
+    return ok;
+}
+
+static void MakeClientSaveData( UCharVec& data, const char* pass_hash, const CritData& cr_data, const CritDataExt& data_ext, const Critter::CrTimeEventVec& time_events )
+{
+    uint te_count = (uint)time_events.size();
+    data.resize( sizeof(ClientSaveSignature) + PASS_HASH_SIZE + sizeof(CritData) + sizeof(CritDataExt) + sizeof(te_count) + te_count * sizeof(Critter::CrTimeEvent) );
+
+    uchar* ptr = &data[0];
+    memcpy( ptr, ClientSaveSignature, sizeof(ClientSaveSignature) );
+    ptr += sizeof(ClientSaveSignature);
+    memcpy( ptr, pass_hash, PASS_HASH_SIZE );
+    ptr += PASS_HASH_SIZE;
+    memcpy( ptr, &cr_data, sizeof(CritData) );
+    ptr += sizeof(CritData);
+    memcpy( ptr, &data_ext, sizeof(CritDataExt) );
+    ptr += sizeof(CritDataExt);
+    memcpy( ptr, &te_count, sizeof(te_count) );
+    ptr += sizeof(te_count);
+    if( te_count )
+        memcpy( ptr, &time_events[0], te_count * sizeof(Critter::CrTimeEvent) );
+}
+
+static bool ReadClientSaveData( const UCharVec& data, uint& pos, void* buf, uint size )
+{
+    if( pos + size > (uint)data.size() )
+        return false;
+
+    memcpy( buf, &data[pos], size );
+    pos += size;
+    return true;
+}
+
+static bool WriteClientFile( const char* fname, const UCharVec& data )
+{
+    void* f = FileOpen( fname, true );
+    if( !f )
+        return false;
+
+    FileWrite( f, &data[0], (uint)data.size() );
+    FileClose( f );
+    return true;
+}
+
+bool FOServer::LoadClientStore( const char* last_id_fname )
+{
+    ClientStoreEntryVec entries;
+    ClientStore::GetEntries( entries );
+
+    UIntSet id_already;
+    for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+    {
+        ClientStoreEntry& entry = *it;
+
+        // Check id
+        if( !CRITTER_ID_IS_PLAYER( entry.Id ) )
+        {
+            WriteLog( "Wrong id<%u> of client<%s>. Skipped.\n", entry.Id, entry.Name );
+            continue;
+        }
+
+        // Check uniqueness of id
+        if( id_already.count( entry.Id ) )
+        {
+            WriteLog( "Id<%u> of user<%s> already used by another client. Skipped.\n", entry.Id, entry.Name );
+            continue;
+        }
+        id_already.insert( entry.Id );
+
+        ClientData data;
+        data.Clear();
+        Str::Copy( data.ClientName, entry.Name );
+        memcpy( data.ClientPassHash, entry.PassHash, PASS_HASH_SIZE );
+        data.ClientId = entry.Id;
+        ClientsData.push_back( data );
+
+        if( entry.Id > LastClientId )
+            LastClientId = entry.Id;
+    }
+
+    SaveLastClientId( last_id_fname, LastClientId );
+
+    // Reserve memory for future clients data
+    if( ClientsData.size() > 10000 )
+        ClientsData.reserve( ClientsData.size() * 2 );
+
+    WriteLog( "Load clients data.. loaded<%u> from store.\n", ClientsData.size() );
+    WriteLog( "%s", ClientStore::GetStatisticsString().c_str() );
+    return true;
+}
+
 bool FOServer::LoadClientsData()
 {
     WriteLog( "Load clients data...\n" );
@@ -4152,6 +4532,35 @@ bool FOServer::LoadClientsData()
     char        cache_fname[MAX_FOPATH];
     Str::Format( cache_fname, "%sclients_list.txt", clients_path );
 
+    // Accounts store, client files are imported on first start and exported back after disabling
+    char import_fname[MAX_FOPATH];
+    Str::Format( import_fname, "%sclient_store_import", clients_path );
+    if( ClientStore::Exists( clients_path ) )
+    {
+        if( FileExist( import_fname ) )
+        {
+            WriteLog( "Previous import of client files to store was interrupted, restart import.\n" );
+            ClientStore::Retire( clients_path );
+            FileDelete( import_fname );
+        }
+        else if( !ClientStore::Open( clients_path ) )
+        {
+            WriteLog( "Unable to open clients store.\n" );
+            return false;
+        }
+        else if( ClientStoreEnabled )
+        {
+            return LoadClientStore( last_id_fname );
+        }
+        else
+        {
+            uint count = ClientStore::Export( clients_path );
+            ClientStore::Retire( clients_path );
+            FileDelete( cache_fname );
+            WriteLog( "Clients store exported to client files, count<%u>.\n", count );
+        }
+    }
+
     if( FileExist( "cache_fail" ) )
     {
         FileDelete( "cache_fail" );
@@ -4372,19 +4781,41 @@ bool FOServer::LoadClientsData()
     }
 
     // Refresh last id
-    last_id_file = FileOpen( last_id_fname, true );
-    if( last_id_file )
-    {
-        char last_id_str[128];
-        Str::Format( last_id_str, "%u", LastClientId );
-        FileWrite( last_id_file, last_id_str, Str::Length( last_id_str ) );
-        FileClose( last_id_file );
-    }
+    SaveLastClientId( last_id_fname, LastClientId );
 
     // Save cache
     if( file_find )
         file_cache_write.SaveOutBufToFile( cache_fname, -1 );
 
+    // First start with accounts store
+    if( ClientStoreEnabled )
+    {
+        void* f = FileOpen( import_fname, true );
+        if( !f || !ClientStore::Open( clients_path ) )
+        {
+            WriteLog( "Unable to create clients store.\n" );
+            FileClose( f );
+            return false;
+        }
+        FileClose( f );
+
+        UCharVec data;
+        for( auto it = ClientsData.begin(), end = ClientsData.end(); it != end; ++it )
+        {
+            ClientData& cd = *it;
+            char        client_fname[MAX_FOPATH];
+            Str::Format( client_fname, "%s%s.client", clients_path, cd.ClientName );
+            if( !ReadClientFile( client_fname, data ) || !ClientStore::Save( cd.ClientName, cd.ClientId, cd.ClientPassHash, data ) )
+            {
+                WriteLog( "Unable to import client save file<%s> to clients store.\n", client_fname );
+                ClientStore::Close();
+                return false;
+            }
+        }
+        FileDelete( import_fname );
+        WriteLog( "Client files imported to clients store, count<%u>.\n", ClientsData.size() );
+    }
+
     // Reserve memory for future clients data
     if( ClientsData.size() > 10000 )
         ClientsData.reserve( ClientsData.size() * 2 );
@@ -4417,25 +4848,28 @@ bool FOServer::SaveClient( Client* cl, bool deferred )
     }
     else
     {
-        char fname[MAX_FOPATH];
-        FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
-        Str::Append( fname, ".client" );
-        void* f = FileOpen( fname, true );
-        if( !f )
+        UCharVec data;
+        MakeClientSaveData( data, cl->PassHash, cl->Data, *data_ext, cl->CrTimeEvents );
+
+        if( ClientStore::IsOpened() )
         {
-            WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
-            return false;
+            if( !ClientStore::Save( cl->Name, cl->GetId(), cl->PassHash, data ) )
+            {
+                WriteLogF( _FUNC_, " - Unable to save client<%s> to store.\n", cl->Name );
+                return false;
+            }
+        }
+        else
+        {
+            char fname[MAX_FOPATH];
+            FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
+            Str::Append( fname, ".client" );
+            if( !WriteClientFile( fname, data ) )
+            {
+                WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
+                return false;
+            }
         }
-
-        FileWrite( f, ClientSaveSignature, sizeof(ClientSaveSignature) );
-        FileWrite( f, cl->PassHash, sizeof(cl->PassHash) );
-        FileWrite( f, &cl->Data, sizeof(cl->Data) );
-        FileWrite( f, data_ext, sizeof(CritDataExt) );
-        uint te_count = (uint)cl->CrTimeEvents.size();
-        FileWrite( f, &te_count, sizeof(te_count) );
-        if( te_count )
-            FileWrite( f, &cl->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
-        FileClose( f );
 
         cl->Data.Temp = 0;
     }
@@ -4457,19 +4891,20 @@ bool FOServer::LoadClient( Client* cl )
     char fname[MAX_FOPATH];
     FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
     Str::Append( fname, ".client" );
-    void* f = FileOpen( fname, false );
-    if( !f )
+
+    // Read data, same layout in store and client file
+    UCharVec data;
+    if( ClientStore::IsOpened() ? !ClientStore::Load( cl->Name, data ) : !ReadClientFile( fname, data ) )
     {
         WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
         return false;
     }
 
-    // Read data
+    uint  pos = 0;
     uchar signature[sizeof(ClientSaveSignature)];
-    if( !FileRead( f, signature, sizeof(signature) ) )
+    if( !ReadClientSaveData( data, pos, signature, sizeof(signature) ) )
     {
         WriteLog( "Unable to read signature of client save file<%s>.\n", fname );
-        FileClose( f );
         return false;
     }
 
@@ -4478,7 +4913,6 @@ bool FOServer::LoadClient( Client* cl )
     if( signature[0] == 'F' && signature[1] == 'O' && signature[2] == 0 )
     {
         WriteLog( "Client save file<%s> ignored.\n", fname );
-        FileClose( f );
         return false;
     }
     #else
@@ -4491,7 +4925,7 @@ bool FOServer::LoadClient( Client* cl )
             WriteLog( "Legacy client<%s> ignored (invalid version; expected 2, got %u)\n", fname, signature[3] );
             return false;
         }
-        FileSetPointer( f, 4, SEEK_SET );
+        pos = 4;
         legacy = true;
     }
     #endif
@@ -4503,34 +4937,28 @@ bool FOServer::LoadClient( Client* cl )
     #endif
     {
         if( !BINARY_SIGNATURE_VALID( ClientSaveSignature, signature ) )
-        {
-            FileClose( f );
             return false;
-        }
     }
 
-    if( !FileRead( f, cl->PassHash, sizeof(cl->PassHash) ) )
-        goto label_FileTruncated;
-    if( !FileRead( f, &cl->Data, sizeof(cl->Data) ) )
-        goto label_FileTruncated;
-    if( !FileRead( f, data_ext, sizeof(CritDataExt) ) )
-        goto label_FileTruncated;
     uint te_count;
-    if( !FileRead( f, &te_count, sizeof(te_count) ) )
+    if( !ReadClientSaveData( data, pos, cl->PassHash, sizeof(cl->PassHash) ) ||
+        !ReadClientSaveData( data, pos, &cl->Data, sizeof(cl->Data) ) ||
+        !ReadClientSaveData( data, pos, data_ext, sizeof(CritDataExt) ) ||
+        !ReadClientSaveData( data, pos, &te_count, sizeof(te_count) ) )
         goto label_FileTruncated;
     if( te_count )
     {
+        if( te_count > ( (uint)data.size() - pos ) / sizeof(Critter::CrTimeEvent) )
+            goto label_FileTruncated;
         cl->CrTimeEvents.resize( te_count );
-        if( !FileRead( f, &cl->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) ) )
+        if( !ReadClientSaveData( data, pos, &cl->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) ) )
             goto label_FileTruncated;
     }
-    FileClose( f );
 
     return true;
 
 label_FileTruncated:
     WriteLogF( _FUNC_, " - Client save file<%s> truncated.\n", fname );
-    FileClose( f );
     return false;
 }
 
@@ -4545,33 +4973,38 @@ bool FOServer::NewWorld()
 
 void FOServer::SaveWorld( const char* fname )
 {
+    TRACE_SCOPE( TRACE_SAVE_WORLD );
+
     if( !fname && Singleplayer )
         return;                           // Disable autosaving in singleplayer mode
 
-    double tick;
+    // Autosave in forked process, parent continues after snapshot
+    bool forked = (!fname && WorldSaveFork && !FOQuit);
+    if( forked && !WaitForkedWorldSave( false ) )
+    {
+        WriteLog( "World save skipped, previous save process<%d> is still running.\n", SaveWorldForkPid );
+        return;
+    }
+
     if( WorldSaveManager )
     {
         // Be sure what Dump_Work thread in wait state
         DumpEndEvent.Wait();
         DumpEndEvent.Disallow();
-        tick = Timer::AccurateTick();
+    }
+
+    double tick = Timer::AccurateTick();
+
+    // Autosaves between full saves writes only changes to journal of last world dump
+    bool journal = (!fname && SaveWorldJournal);
+    SaveWorldDelta = (journal && SaveWorldIndex && SaveWorldJournalCount < SaveWorldJournal && WorldJournal::HasState() );
+
+    if( WorldSaveManager )
+    {
         WorldSaveDataBufCount = 0;
         WorldSaveDataBufFreeSize = 0;
         ClientsSaveDataCount = 0;
     }
-    else
-    {
-        // Save directly to file
-        tick = Timer::AccurateTick();
-        char auto_fname[MAX_FOPATH];
-        Str::Format( auto_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
-        DumpFile = FileOpen( fname ? fname : auto_fname, true );
-        if( !DumpFile )
-        {
-            WriteLog( "Can't create dump file<%s>.\n", fname ? fname : auto_fname );
-            return;
-        }
-    }
 
     // ServerFunctions.SaveWorld
     SaveWorldDeleteIndexes.clear();
@@ -4585,37 +5018,40 @@ void FOServer::SaveWorld( const char* fname )
         delete_indexes->Release();
     }
 
-    AddWorldSaveData( (char*)WorldSaveSignature, sizeof(WorldSaveSignature) );
+    // Fork failed, save in current process
+    if( forked && !ForkWorldSave() )
+        forked = false;
 
-    // SaveGameInfoFile
-    SaveGameInfoFile();
+    double fork_tick = Timer::AccurateTick();
 
-    // SaveAllLocationsAndMapsFile
-    MapMngr.SaveAllLocationsAndMapsFile( AddWorldSaveData );
-
-    // SaveCrittersFile
-    CrMngr.SaveCrittersFile( AddWorldSaveData );
-
-    // SaveAllItemsFile
-    ItemMngr.SaveAllItemsFile( AddWorldSaveData );
-
-    // SaveVarsDataFile
-    VarMngr.SaveVarsDataFile( AddWorldSaveData );
-
-    // SaveHoloInfoFile
-    SaveHoloInfoFile();
-
-    // SaveAnyDataFile
-    SaveAnyDataFile();
+    if( !forked )
+    {
+        if( !WorldSaveManager && !SaveWorldDelta )
+        {
+            // Save directly to file
+            char auto_fname[MAX_FOPATH];
+            Str::Format( auto_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
+            DumpFile = FileOpen( fname ? fname : auto_fname, true );
+            if( !DumpFile )
+            {
+                WriteLog( "Can't create dump file<%s>.\n", fname ? fname : auto_fname );
+                return;
+            }
+            if( !fname )
+                FileDelete( WorldJournal::GetJournalName( auto_fname ).c_str() );
+        }
 
-    // SaveTimeEventsFile
-    SaveTimeEventsFile();
+        if( journal )
+            WorldJournal::BeginSave( SaveWorldDelta );
 
-    // SaveScriptFunctionsFile
-    SaveScriptFunctionsFile();
+        SaveWorldData();
 
-    ushort version = BINARY_SIGNATURE_VERSION( WorldSaveSignature );
-    AddWorldSaveData( &version, sizeof(version) );
+        if( journal )
+        {
+            WorldJournal::EndSave();
+            SaveWorldJournalCount = (SaveWorldDelta ? SaveWorldJournalCount + 1 : 0);
+        }
+    }
 
     // SaveClient
     ConnectedClientsLocker.Lock();
@@ -4643,6 +5079,14 @@ void FOServer::SaveWorld( const char* fname )
         // Awake Dump_Work
         DumpBeginEvent.Allow();
     }
+    else if( forked )
+    {
+        // World dump is written by child process
+    }
+    else if( SaveWorldDelta )
+    {
+        // Journal block is written by FinishWorldSave
+    }
     else
     {
         FileClose( DumpFile );
@@ -4652,7 +5096,186 @@ void FOServer::SaveWorld( const char* fname )
             SaveWorldIndex = 0;
     }
 
-    WriteLog( "World saved in %g ms.\n", Timer::AccurateTick() - tick );
+    if( forked )
+    {
+        WriteLog( "World save started in process<%d>, logic stall %g ms (fork %g ms).\n",
+                  SaveWorldForkPid, Timer::AccurateTick() - tick, fork_tick - SaveWorldForkTick );
+    }
+    else
+    {
+        WriteLog( "World saved in %g ms.\n", Timer::AccurateTick() - tick );
+    }
+}
+
+void FOServer::FinishWorldSave()
+{
+    // Dump_Work processes journal itself
+    if( WorldSaveManager || !WorldJournal::IsPending() )
+        return;
+
+    WorldJournal::ProcessSave();
+    if( WorldJournal::IsDelta() )
+    {
+        char world_fname[MAX_FOPATH];
+        Str::Format( world_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex );
+        if( !WorldJournal::WriteBlock( WorldJournal::GetJournalName( world_fname ).c_str(), world_fname ) )
+            WorldJournal::Reset();
+    }
+}
+
+void FOServer::SaveWorldData()
+{
+    AddWorldSaveData( (char*)WorldSaveSignature, sizeof(WorldSaveSignature) );
+
+    // SaveGameInfoFile
+    SaveGameInfoFile();
+
+    // Delta save goes only to journal, records and sections reported as changed are serialized
+    if( WorldJournal::IsActive() && WorldJournal::IsDelta() )
+    {
+        UIntVec            ids;
+        WorldJournalKeyVec keys;
+
+        WorldJournal::BeginSection( WORLD_SECTION_LOCATIONS );
+        WorldJournal::GetDirtyIds( WORLD_SECTION_LOCATIONS, ids );
+        MapMngr.SaveLocationsRecords( ids, AddWorldSaveData, AddWorldSaveRecord );
+
+        WorldJournal::BeginSection( WORLD_SECTION_CRITTERS );
+        WorldJournal::GetDirtyIds( WORLD_SECTION_CRITTERS, ids );
+        CrMngr.SaveCrittersRecords( ids, AddWorldSaveData, AddWorldSaveRecord );
+
+        WorldJournal::BeginSection( WORLD_SECTION_ITEMS );
+        WorldJournal::GetDirtyIds( WORLD_SECTION_ITEMS, ids );
+        ItemMngr.SaveItemsRecords( ids, AddWorldSaveData, AddWorldSaveRecord );
+
+        WorldJournal::BeginSection( WORLD_SECTION_VARS );
+        WorldJournal::GetDirtyKeys( WORLD_SECTION_VARS, keys );
+        VarMngr.SaveVarsRecords( keys, AddWorldSaveData, AddWorldSaveRecord );
+
+        if( WorldJournal::IsSectionDirty( WORLD_SECTION_HOLO ) )
+        {
+            WorldJournal::BeginSection( WORLD_SECTION_HOLO );
+            SaveHoloInfoFile();
+        }
+        if( WorldJournal::IsSectionDirty( WORLD_SECTION_ANY_DATA ) )
+        {
+            WorldJournal::BeginSection( WORLD_SECTION_ANY_DATA );
+            SaveAnyDataFile();
+        }
+        if( WorldJournal::IsSectionDirty( WORLD_SECTION_TIME_EVENTS ) )
+        {
+            WorldJournal::BeginSection( WORLD_SECTION_TIME_EVENTS );
+            SaveTimeEventsFile();
+        }
+
+        WorldJournal::BeginSection( WORLD_SECTION_SCRIPT_FUNCTIONS );
+        SaveScriptFunctionsFile();
+        WorldJournal::EndSection();
+        return;
+    }
+
+    // SaveAllLocationsAndMapsFile
+    WorldJournal::BeginSection( WORLD_SECTION_LOCATIONS );
+    MapMngr.SaveAllLocationsAndMapsFile( AddWorldSaveData, AddWorldSaveRecord );
+
+    // SaveCrittersFile
+    WorldJournal::BeginSection( WORLD_SECTION_CRITTERS );
+    CrMngr.SaveCrittersFile( AddWorldSaveData, AddWorldSaveRecord );
+
+    // SaveAllItemsFile
+    WorldJournal::BeginSection( WORLD_SECTION_ITEMS );
+    ItemMngr.SaveAllItemsFile( AddWorldSaveData, AddWorldSaveRecord );
+
+    // SaveVarsDataFile
+    WorldJournal::BeginSection( WORLD_SECTION_VARS );
+    VarMngr.SaveVarsDataFile( AddWorldSaveData, AddWorldSaveRecord );
+
+    // SaveHoloInfoFile
+    WorldJournal::BeginSection( WORLD_SECTION_HOLO );
+    SaveHoloInfoFile();
+
+    // SaveAnyDataFile
+    WorldJournal::BeginSection( WORLD_SECTION_ANY_DATA );
+    SaveAnyDataFile();
+
+    // SaveTimeEventsFile
+    WorldJournal::BeginSection( WORLD_SECTION_TIME_EVENTS );
+    SaveTimeEventsFile();
+
+    // SaveScriptFunctionsFile
+    WorldJournal::BeginSection( WORLD_SECTION_SCRIPT_FUNCTIONS );
+    SaveScriptFunctionsFile();
+    WorldJournal::EndSection();
+
+    ushort version = BINARY_SIGNATURE_VERSION( WorldSaveSignature );
+    AddWorldSaveData( &version, sizeof(version) );
+}
+
+bool FOServer::ForkWorldSave()
+{
+    #if defined (FO_LINUX)
+    char fname[MAX_FOPATH];
+    char tmp_fname[MAX_FOPATH];
+    Str::Format( fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
+    Str::Format( tmp_fname, "%s.tmp", fname );
+
+    SaveWorldForkTick = Timer::AccurateTick();
+    pid_t pid = fork();
+    if( pid < 0 )
+    {
+        WriteLog( "Can't fork world save process, error<%d>.\n", errno );
+        return false;
+    }
+
+    if( !pid )
+    {
+        // Child process contains only current thread, locks of other threads can stay locked forever
+        // Don't use logging and scripts, write dump from memory snapshot and quit without cleanup
+        WorldSaveManager = false;
+        DumpFile = FileOpen( tmp_fname, true );
+        if( !DumpFile )
+            _exit( 1 );
+        SaveWorldData();
+        FileClose( DumpFile );
+        FileDelete( WorldJournal::GetJournalName( fname ).c_str() );
+        _exit( FileRename( tmp_fname, fname ) ? 0 : 1 );
+    }
+
+    SaveWorldForkPid = pid;
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+bool FOServer::WaitForkedWorldSave( bool wait )
+{
+    #if defined (FO_LINUX)
+    if( !SaveWorldForkPid )
+        return true;
+
+    int   status = 0;
+    pid_t pid = waitpid( SaveWorldForkPid, &status, wait ? 0 : WNOHANG );
+    if( !pid )
+        return false;
+
+    if( pid == SaveWorldForkPid && WIFEXITED( status ) && WEXITSTATUS( status ) == 0 )
+    {
+        WriteLog( "World saved by process<%d> in %g ms.\n", SaveWorldForkPid, Timer::AccurateTick() - SaveWorldForkTick );
+        SaveWorldIndex++;
+        if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
+            SaveWorldIndex = 0;
+    }
+    else
+    {
+        char tmp_fname[MAX_FOPATH];
+        Str::Format( tmp_fname, "%sworld%04d.fo.tmp", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
+        FileDelete( tmp_fname );
+        WriteLog( "World save process<%d> failed.\n", SaveWorldForkPid );
+    }
+    SaveWorldForkPid = 0;
+    #endif
+    return true;
 }
 
 bool FOServer::LoadWorld( const char* fname )
@@ -4669,9 +5292,29 @@ bool FOServer::LoadWorld( const char* fname )
             f = FileOpen( auto_fname, false );
             if( f )
             {
+                SaveWorldIndex = i;
+
+                // Merge changes from journal to next world dump
+                string journal_fname = WorldJournal::GetJournalName( auto_fname );
+                if( FileExist( journal_fname.c_str() ) && i < WORLD_SAVE_MAX_INDEX )
+                {
+                    char merged_fname[MAX_FOPATH];
+                    Str::Format( merged_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), i + 1 );
+                    if( WorldJournal::Apply( auto_fname, journal_fname.c_str(), merged_fname ) )
+                    {
+                        void* f_merged = FileOpen( merged_fname, false );
+                        if( f_merged )
+                        {
+                            FileClose( f );
+                            f = f_merged;
+                            Str::Copy( auto_fname, merged_fname );
+                            SaveWorldIndex = i + 1;
+                        }
+                    }
+                }
+
                 WriteLog( "Load world<%s>...\n", auto_fname );
                 fname = Str::Duplicate( auto_fname );
-                SaveWorldIndex = i;
                 break;
             }
         }
@@ -4868,9 +5511,11 @@ void FOServer::UnloadWorld()
     AnyData.clear();
 
     // Time events
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        delete *it;
+    for( auto it = TimeEventsByNum.begin(), end = TimeEventsByNum.end(); it != end; ++it )
+        delete it->second;
     TimeEvents.clear();
+    TimeEventsByNum.clear();
+    TimeEventsInProcess.clear();
     TimeEventsLastNum = 0;
 
     // Script functions
@@ -4878,9 +5523,30 @@ void FOServer::UnloadWorld()
 
     // Singleplayer header
     SingleplayerSave.Valid = false;
+
+    // Journal state
+    WorldJournal::Reset();
+    SaveWorldJournalCount = 0;
 }
 
 void FOServer::AddWorldSaveData( void* data, size_t size )
+{
+    if( WorldJournal::IsActive() )
+    {
+        WorldJournal::AddData( data, size );
+        if( WorldJournal::IsDelta() )
+            return;
+    }
+
+    WriteWorldSaveData( data, size );
+}
+
+void FOServer::AddWorldSaveRecord()
+{
+    WorldJournal::BeginRecord();
+}
+
+void FOServer::WriteWorldSaveData( void* data, size_t size )
 {
     if( !WorldSaveManager )
     {
@@ -4907,7 +5573,7 @@ void FOServer::AddWorldSaveData( void* data, size_t size )
         memcpy( &ptr[WORLD_SAVE_DATA_BUFFER_SIZE - WorldSaveDataBufFreeSize], data, flush );
         WorldSaveDataBufFreeSize -= flush;
         if( !WorldSaveDataBufFreeSize )
-            AddWorldSaveData( ( (uchar*)data ) + flush, size - flush );
+            WriteWorldSaveData( ( (uchar*)data ) + flush, size - flush );
     }
 }
 
@@ -4945,64 +5611,85 @@ void FOServer::Dump_Work( void* data )
         char clients_path[MAX_FOPATH];
         FileManager::GetFullPath( NULL, PATH_SERVER_CLIENTS, clients_path );
 
-        // Save world data
-        void* fworld = FileOpen( Str::Format( fname, "%sworld%04d.fo", save_path, SaveWorldIndex + 1 ), true );
-        if( fworld )
+        // Save world data, journal is hashed here to keep it out of logic threads pause
+        WorldJournal::ProcessSave();
+        if( SaveWorldDelta )
         {
-            for( uint i = 0; i < WorldSaveDataBufCount; i++ )
-            {
-                uchar* ptr = WorldSaveData[i];
-                size_t flush = WORLD_SAVE_DATA_BUFFER_SIZE;
-                if( i == WorldSaveDataBufCount - 1 )
-                    flush -= WorldSaveDataBufFreeSize;
-                FileWrite( fworld, ptr, flush );
-                Thread::Sleep( 1 );
-            }
-            FileClose( fworld );
-            SaveWorldIndex++;
-            if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
-                SaveWorldIndex = 0;
+            // Append changes to journal of last world dump
+            char journal_fname[MAX_FOPATH];
+            Str::Format( fname, "%sworld%04d.fo", save_path, SaveWorldIndex );
+            Str::Copy( journal_fname, WorldJournal::GetJournalName( fname ).c_str() );
+            if( !WorldJournal::WriteBlock( journal_fname, fname ) )
+                WorldJournal::Reset();
         }
-        else
+        else if( WorldSaveDataBufCount )
         {
-            WriteLogF( _FUNC_, " - Can't create world dump file<%s>.\n", fname );
+            void* fworld = FileOpen( Str::Format( fname, "%sworld%04d.fo", save_path, SaveWorldIndex + 1 ), true );
+            if( fworld )
+            {
+                // Previous journal with same index is stale
+                FileDelete( WorldJournal::GetJournalName( fname ).c_str() );
+
+                for( uint i = 0; i < WorldSaveDataBufCount; i++ )
+                {
+                    uchar* ptr = WorldSaveData[i];
+                    size_t flush = WORLD_SAVE_DATA_BUFFER_SIZE;
+                    if( i == WorldSaveDataBufCount - 1 )
+                        flush -= WorldSaveDataBufFreeSize;
+                    FileWrite( fworld, ptr, flush );
+                    Thread::Sleep( 1 );
+                }
+                FileClose( fworld );
+                SaveWorldIndex++;
+                if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
+                    SaveWorldIndex = 0;
+            }
+            else
+            {
+                WriteLogF( _FUNC_, " - Can't create world dump file<%s>.\n", fname );
+                WorldJournal::Reset();
+            }
         }
 
         // Save clients data
+        UCharVec client_data;
         for( uint i = 0; i < ClientsSaveDataCount; i++ )
         {
             ClientSaveData& csd = ClientsSaveData[i];
+            MakeClientSaveData( client_data, csd.PasswordHash, csd.Data, csd.DataExt, csd.TimeEvents );
+
+            // Store appends records, no need to pause between files
+            if( ClientStore::IsOpened() )
+            {
+                if( !ClientStore::Save( csd.Name, csd.Data.Id, csd.PasswordHash, client_data ) )
+                    WriteLogF( _FUNC_, " - Unable to save client<%s> to store.\n", csd.Name );
+                continue;
+            }
 
-            char            fname[MAX_FOPATH];
+            char fname[MAX_FOPATH];
             Str::Format( fname, "%s%s.client", clients_path, csd.Name );
-            void*           fc = FileOpen( fname, true );
-            if( !fc )
+            if( !WriteClientFile( fname, client_data ) )
             {
                 WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
                 continue;
             }
-
-            FileWrite( fc, ClientSaveSignature, sizeof(ClientSaveSignature) );
-            FileWrite( fc, csd.PasswordHash, sizeof(csd.PasswordHash) );
-            FileWrite( fc, &csd.Data, sizeof(csd.Data) );
-            FileWrite( fc, &csd.DataExt, sizeof(csd.DataExt) );
-            uint te_count = (uint)csd.TimeEvents.size();
-            FileWrite( fc, &te_count, sizeof(te_count) );
-            if( te_count )
-                FileWrite( fc, &csd.TimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
-            FileClose( fc );
             Thread::Sleep( 1 );
         }
 
         // Clear old dump files
         for( auto it = SaveWorldDeleteIndexes.begin(), end = SaveWorldDeleteIndexes.end(); it != end; ++it )
         {
+            // Journal still refers to current world dump
+            if( SaveWorldDelta && *it == SaveWorldIndex )
+                continue;
+
             void* fold = FileOpen( Str::Format( fname, "%sworld%04d.fo", save_path, *it ), true );
             if( fold )
             {
                 FileClose( fold );
                 FileDelete( fname );
             }
+            FileDelete( WorldJournal::GetJournalName( fname ).c_str() );
         }
 
         // Notify about end of processing
@@ -5124,18 +5811,25 @@ void FOServer::VarsGarbarger( bool force )
 /* Time events                                                          */
 /************************************************************************/
 
+static bool TimeEventLess( FOServer::TimeEvent* te1, FOServer::TimeEvent* te2 )
+{
+    return te1->FullSecond < te2->FullSecond || (te1->FullSecond == te2->FullSecond && te1->Num < te2->Num);
+}
+
 void FOServer::SaveTimeEventsFile()
 {
-    uint count = 0;
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        if( (*it)->IsSaved )
-            count++;
+    // Saved in order of firing, as before heap storage
+    TimeEventVec saved;
+    for( auto it = TimeEventsByNum.begin(), end = TimeEventsByNum.end(); it != end; ++it )
+        if( it->second->IsSaved )
+            saved.push_back( it->second );
+    std::sort( saved.begin(), saved.end(), TimeEventLess );
+
+    uint count = (uint)saved.size();
     AddWorldSaveData( &count, sizeof(count) );
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    for( auto it = saved.begin(), end = saved.end(); it != end; ++it )
     {
         TimeEvent* te = *it;
-        if( !te->IsSaved )
-            continue;
         AddWorldSaveData( &te->Num, sizeof(te->Num) );
         ushort script_name_len = (ushort)te->FuncName.length();
         AddWorldSaveData( &script_name_len, sizeof(script_name_len) );
@@ -5217,7 +5911,8 @@ bool FOServer::LoadTimeEventsFile( void* f )
         if( values_size )
             te->Values = values;
 
-        TimeEvents.push_back( te );
+        TimeEventsByNum[num] = te;
+        AddTimeEvent( te );
         if( num > TimeEventsLastNum )
             TimeEventsLastNum = num;
     }
@@ -5230,16 +5925,68 @@ void FOServer::AddTimeEvent( TimeEvent* te )
 {
     // Invoked in locked scope
 
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    te->HeapIndex = (uint)TimeEvents.size();
+    TimeEvents.push_back( te );
+    SiftTimeEvent( te->HeapIndex );
+    WorldJournal::SetSectionDirty( WORLD_SECTION_TIME_EVENTS );
+}
+
+void FOServer::RemoveTimeEvent( TimeEvent* te )
+{
+    // Invoked in locked scope
+
+    uint index = te->HeapIndex;
+    if( index >= TimeEvents.size() )
+        return;
+
+    TimeEvent* last = TimeEvents.back();
+    TimeEvents.pop_back();
+    te->HeapIndex = uint( -1 );
+    if( last != te )
     {
-        TimeEvent* te_ = *it;
-        if( te->FullSecond < te_->FullSecond )
-        {
-            TimeEvents.insert( it, te );
-            return;
-        }
+        TimeEvents[index] = last;
+        last->HeapIndex = index;
+        SiftTimeEvent( index );
     }
-    TimeEvents.push_back( te );
+    WorldJournal::SetSectionDirty( WORLD_SECTION_TIME_EVENTS );
+}
+
+void FOServer::SiftTimeEvent( uint index )
+{
+    // Invoked in locked scope
+
+    TimeEvent* te = TimeEvents[index];
+
+    // Up
+    while( index > 0 )
+    {
+        uint parent = (index - 1) / 2;
+        if( !TimeEventLess( te, TimeEvents[parent] ) )
+            break;
+        TimeEvents[index] = TimeEvents[parent];
+        TimeEvents[index]->HeapIndex = index;
+        index = parent;
+    }
+
+    // Down
+    uint count = (uint)TimeEvents.size();
+    while( true )
+    {
+        uint child = index * 2 + 1;
+        if( child >= count )
+            break;
+        if( child + 1 < count && TimeEventLess( TimeEvents[child + 1], TimeEvents[child] ) )
+            child++;
+        if( !TimeEventLess( TimeEvents[child], te ) )
+            break;
+        TimeEvents[index] = TimeEvents[child];
+        TimeEvents[index]->HeapIndex = index;
+        index = child;
+    }
+
+    TimeEvents[index] = te;
+    te->HeapIndex = index;
+    WorldJournal::SetSectionDirty( WORLD_SECTION_TIME_EVENTS );
 }
 
 uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save )
@@ -5273,6 +6020,7 @@ uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int
     te->InProcess = 0;
     te->EraseMe = false;
     te->Rate = 0;
+    te->HeapIndex = uint( -1 );
 
     if( values == 1 )
     {
@@ -5290,6 +6038,7 @@ uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int
         }
     }
 
+    TimeEventsByNum[te->Num] = te;
     AddTimeEvent( te );
     TimeEventsLastNum++;
     return TimeEventsLastNum;
@@ -5300,16 +6049,18 @@ void FOServer::TimeEventEndScriptCallback()
     SCOPE_LOCK( TimeEventsLocker );
 
     uint tid = Thread::GetCurrentId();
-    for( auto it = TimeEvents.begin(); it != TimeEvents.end();)
+    for( auto it = TimeEventsInProcess.begin(); it != TimeEventsInProcess.end();)
     {
         TimeEvent* te = *it;
         if( te->InProcess == tid )
         {
+            it = TimeEventsInProcess.erase( it );
             te->InProcess = 0;
 
             if( te->EraseMe )
             {
-                it = TimeEvents.erase( it );
+                RemoveTimeEvent( te );
+                TimeEventsByNum.erase( te->Num );
                 delete te;
             }
         }
@@ -5328,15 +6079,9 @@ bool FOServer::GetTimeEvent( uint num, uint& duration, ScriptArray* values )
     // Find event
     while( true )
     {
-        for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        {
-            TimeEvent* te_ = *it;
-            if( te_->Num == num )
-            {
-                te = te_;
-                break;
-            }
-        }
+        auto it = TimeEventsByNum.find( num );
+        if( it != TimeEventsByNum.end() )
+            te = it->second;
 
         // Event not found or erased
         if( !te || te->EraseMe )
@@ -5364,9 +6109,12 @@ bool FOServer::GetTimeEvent( uint num, uint& duration, ScriptArray* values )
         Script::AppendVectorToArray( te->Values, values );
     duration = (te->FullSecond > GameOpt.FullSecond ? te->FullSecond - GameOpt.FullSecond : 0);
 
-    // Lock for current thread
-    if( LogicMT )
+    // Lock for current thread, running event is already locked by own thread
+    if( LogicMT && te->InProcess != tid )
+    {
         te->InProcess = tid;
+        TimeEventsInProcess.push_back( te );
+    }
 
     // Add end of script execution callback to unlock event if SetTimeEvent not be called
     if( LogicMT )
@@ -5386,15 +6134,9 @@ bool FOServer::SetTimeEvent( uint num, uint duration, ScriptArray* values )
     // Find event
     while( true )
     {
-        for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        {
-            TimeEvent* te_ = *it;
-            if( te_->Num == num )
-            {
-                te = te_;
-                break;
-            }
-        }
+        auto it = TimeEventsByNum.find( num );
+        if( it != TimeEventsByNum.end() )
+            te = it->second;
 
         // Event not found or erased
         if( !te || te->EraseMe )
@@ -5422,8 +6164,20 @@ bool FOServer::SetTimeEvent( uint num, uint duration, ScriptArray* values )
         Script::AssignScriptArrayInVector( te->Values, values );
     te->FullSecond = GameOpt.FullSecond + duration;
 
-    // Unlock from current thread
-    te->InProcess = 0;
+    // Running event is placed back to heap by RunTimeEvent
+    if( te->HeapIndex != uint( -1 ) )
+    {
+        SiftTimeEvent( te->HeapIndex );
+
+        // Unlock from current thread
+        if( te->InProcess )
+        {
+            te->InProcess = 0;
+            auto it = std::find( TimeEventsInProcess.begin(), TimeEventsInProcess.end(), te );
+            if( it != TimeEventsInProcess.end() )
+                TimeEventsInProcess.erase( it );
+        }
+    }
 
     TimeEventsLocker.Unlock();
     return true;
@@ -5433,48 +6187,68 @@ bool FOServer::EraseTimeEvent( uint num )
 {
     SCOPE_LOCK( TimeEventsLocker );
 
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    auto it = TimeEventsByNum.find( num );
+    if( it == TimeEventsByNum.end() )
+        return false;
+
+    TimeEvent* te = it->second;
+    if( te->InProcess || te->HeapIndex == uint( -1 ) )
     {
-        TimeEvent* te = *it;
-        if( te->Num == num )
-        {
-            if( te->InProcess )
-            {
-                te->EraseMe = true;
-            }
-            else
-            {
-                delete te;
-                TimeEvents.erase( it );
-            }
-            return true;
-        }
+        te->EraseMe = true;
     }
-
-    return false;
+    else
+    {
+        RemoveTimeEvent( te );
+        TimeEventsByNum.erase( it );
+        delete te;
+    }
+    return true;
 }
 
 void FOServer::ProcessTimeEvents()
 {
-    TimeEventsLocker.Lock();
+    // Due events are taken in batches, other time events jobs run next batches in parallel
+    SyncManager* sync_mngr = SyncManager::GetForCurThread();
+    for( uint i = 0; i < TIME_EVENTS_PER_JOB; i++ )
+    {
+        TimeEvent* te = PopTimeEvent();
+        if( !te )
+            break;
+
+        RunTimeEvent( te );
+        sync_mngr->UnlockAll();
+    }
+}
+
+FOServer::TimeEvent* FOServer::PopTimeEvent()
+{
+    SCOPE_LOCK( TimeEventsLocker );
 
-    TimeEvent* cur_event = NULL;
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    // Events locked by GetTimeEvent in other threads are skipped
+    TimeEvent*   cur_event = NULL;
+    TimeEventVec skipped;
+    while( !TimeEvents.empty() && TimeEvents[0]->FullSecond <= GameOpt.FullSecond )
     {
-        TimeEvent* te = *it;
-        if( !te->InProcess && te->FullSecond <= GameOpt.FullSecond )
+        TimeEvent* te = TimeEvents[0];
+        RemoveTimeEvent( te );
+        if( te->InProcess )
         {
-            te->InProcess = Thread::GetCurrentId();
-            cur_event = te;
-            break;
+            skipped.push_back( te );
+            continue;
         }
-    }
 
-    TimeEventsLocker.Unlock();
+        te->InProcess = Thread::GetCurrentId();
+        cur_event = te;
+        break;
+    }
 
-    if( !cur_event )
-        return;
+    for( auto it = skipped.begin(), end = skipped.end(); it != end; ++it )
+        AddTimeEvent( *it );
+    return cur_event;
+}
 
+void FOServer::RunTimeEvent( TimeEvent* cur_event )
+{
     uint wait_time = 0;
     if( Script::PrepareContext( cur_event->BindId, _FUNC_, Str::FormatBuf( "Time event<%u>, name<%s>", cur_event->Num, cur_event->FuncName.c_str() ) ) )
     {
@@ -5532,9 +6306,6 @@ void FOServer::ProcessTimeEvents()
 
     TimeEventsLocker.Lock();
 
-    auto it = std::find( TimeEvents.begin(), TimeEvents.end(), cur_event );
-    TimeEvents.erase( it );
-
     if( wait_time && !cur_event->EraseMe )
     {
         cur_event->FullSecond = GameOpt.FullSecond + wait_time;
@@ -5544,6 +6315,7 @@ void FOServer::ProcessTimeEvents()
     }
     else
     {
+        TimeEventsByNum.erase( cur_event->Num );
         delete cur_event;
     }
 
@@ -5554,7 +6326,7 @@ uint FOServer::GetTimeEventsCount()
 {
     SCOPE_LOCK( TimeEventsLocker );
 
-    uint count = (uint)TimeEvents.size();
+    uint count = (uint)TimeEventsByNum.size();
     return count;
 }
 
@@ -5562,17 +6334,22 @@ string FOServer::GetTimeEventsStatistics()
 {
     SCOPE_LOCK( TimeEventsLocker );
 
+    TimeEventVec events;
+    for( auto it = TimeEventsByNum.begin(), end = TimeEventsByNum.end(); it != end; ++it )
+        events.push_back( it->second );
+    std::sort( events.begin(), events.end(), TimeEventLess );
+
     static string result;
     char          str[1024];
-    Str::Format( str, "Time events: %u\n", TimeEvents.size() );
+    Str::Format( str, "Time events: %u\n", events.size() );
     result = str;
     DateTime st = Timer::GetGameTime( GameOpt.FullSecond );
     Str::Format( str, "Game time: %02u.%02u.%04u %02u:%02u:%02u\n", st.Day, st.Month, st.Year, st.Hour, st.Minute, st.Second );
     result += str;
     result += "Number    Date       Time     Rate Saved Function                            Values\n";
-    for( uint i = 0, j = (uint)TimeEvents.size(); i < j; i++ )
+    for( uint i = 0, j = (uint)events.size(); i < j; i++ )
     {
-        TimeEvent* te = TimeEvents[i];
+        TimeEvent* te = events[i];
         st = Timer::GetGameTime( te->FullSecond );
         Str::Format( str, "%09u %02u.%02u.%04u %02u:%02u:%02u %04u %-5s %-35s", te->Num, st.Day, st.Month, st.Year, st.Hour, st.Minute, st.Second, te->Rate, te->IsSaved ? "true" : "false", te->FuncName.c_str() );
         result += str;
@@ -5699,6 +6476,7 @@ bool FOServer::SetAnyData( const string& name, const uchar* data, uint data_size
     if( data_size )
         memcpy( &data_[0], data, data_size );
     MEMORY_PROCESS( MEMORY_ANY_DATA, (int)data_.capacity() );
+    WorldJournal::SetSectionDirty( WORLD_SECTION_ANY_DATA );
     return true;
 }
 
@@ -5738,7 +6516,8 @@ void FOServer::EraseAnyData( const string& name )
 {
     SCOPE_LOCK( AnyDataLocker );
 
-    AnyData.erase( name );
+    if( AnyData.erase( name ) )
+        WorldJournal::SetSectionDirty( WORLD_SECTION_ANY_DATA );
 }
 
 string FOServer::GetAnyDataStatistics()
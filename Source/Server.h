@@ -3,11 +3,13 @@
 
 #include <scriptarray.h>
 #include <scriptstring.h>
+#include <unordered_map>
 
 #include "BufferManager.h"
 #include "CraftManager.h"
 #include "Critter.h"
 #include "CritterManager.h"
+#include "Jobs.h"
 #include "ProtoMap.h"
 #include "Scores.h"
 #include "Timer.h"
@@ -129,6 +131,7 @@ public:
 
     // Time events
     #define TIME_EVENTS_PER_CYCLE            (10)
+    #define TIME_EVENTS_PER_JOB              (50) // Due events processed by one job
     struct TimeEvent
     {
         uint    Num;
@@ -141,24 +144,31 @@ public:
         bool    IsSaved;
         uint    InProcess;
         bool    EraseMe;
+        uint    HeapIndex; // Position in TimeEvents, uint( -1 ) while event script is running
     };
-    typedef vector<TimeEvent*> TimeEventVec;
-    static TimeEventVec TimeEvents;
-    static TimeEventVec TimeEventsInProcess;
+    typedef vector<TimeEvent*>                   TimeEventVec;
+    typedef std::unordered_map<uint, TimeEvent*> TimeEventMap;
+    static TimeEventVec TimeEvents;          // Binary min heap by FullSecond and Num
+    static TimeEventMap TimeEventsByNum;     // All events, including running ones
+    static TimeEventVec TimeEventsInProcess; // Locked by GetTimeEvent until end of script execution
     static uint         TimeEventsLastNum;
     static Mutex        TimeEventsLocker;
 
-    static void   SaveTimeEventsFile();
-    static bool   LoadTimeEventsFile( void* f );
-    static void   AddTimeEvent( TimeEvent* te );
-    static uint   CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save );
-    static void   TimeEventEndScriptCallback();
-    static bool   GetTimeEvent( uint num, uint& duration, ScriptArray* values );
-    static bool   SetTimeEvent( uint num, uint duration, ScriptArray* values );
-    static bool   EraseTimeEvent( uint num );
-    static void   ProcessTimeEvents();
-    static uint   GetTimeEventsCount();
-    static string GetTimeEventsStatistics();
+    static void       SaveTimeEventsFile();
+    static bool       LoadTimeEventsFile( void* f );
+    static void       AddTimeEvent( TimeEvent* te );
+    static void       RemoveTimeEvent( TimeEvent* te );
+    static void       SiftTimeEvent( uint index );
+    static TimeEvent* PopTimeEvent();
+    static void       RunTimeEvent( TimeEvent* te );
+    static uint       CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save );
+    static void       TimeEventEndScriptCallback();
+    static bool       GetTimeEvent( uint num, uint& duration, ScriptArray* values );
+    static bool       SetTimeEvent( uint num, uint duration, ScriptArray* values );
+    static bool       EraseTimeEvent( uint num );
+    static void       ProcessTimeEvents();
+    static uint       GetTimeEventsCount();
+    static string     GetTimeEventsStatistics();
 
     static void SaveScriptFunctionsFile();
     static bool LoadScriptFunctionsFile( void* f );
@@ -234,7 +244,7 @@ public:
     static bool AI_PickItem( Npc* npc, Map* map, ushort hx, ushort hy, ushort pid, uint use_item_id );
     static bool AI_ReloadWeapon( Npc* npc, Map* map, Item* weap, uint ammo_id );
     static bool TransferAllNpc();
-    static void ProcessCritter( Critter* cr );
+    static uint ProcessCritter( Critter* cr );
     static bool Dialog_Compile( Npc* npc, Client* cl, const Dialog& base_dlg, Dialog& compiled_dlg );
     static bool Dialog_CheckDemand( Npc* npc, Client* cl, DialogAnswer& answer, bool recheck );
     static uint Dialog_UseResult( Npc* npc, Client* cl, DialogAnswer& answer );
@@ -351,6 +361,10 @@ public:
     static size_t     WorldSaveDataBufCount, WorldSaveDataBufFreeSize;
 
     static uint       SaveWorldIndex, SaveWorldTime, SaveWorldNextTick;
+    static uint       SaveWorldJournal, SaveWorldJournalCount; // Delta saves between full saves
+    static bool       SaveWorldDelta;
+    static int        SaveWorldForkPid; // Process which writes world dump, WorldSaveFork
+    static double     SaveWorldForkTick;
     static UIntVec    SaveWorldDeleteIndexes;
     static void*      DumpFile;
     static MutexEvent DumpBeginEvent, DumpEndEvent;
@@ -360,9 +374,15 @@ public:
     static bool LoadClient( Client* cl );
     static bool NewWorld();
     static void SaveWorld( const char* fname );
+    static void SaveWorldData();
+    static void FinishWorldSave(); // Journal processing, after logic threads resume
+    static bool ForkWorldSave();
+    static bool WaitForkedWorldSave( bool wait );
     static bool LoadWorld( const char* fname );
     static void UnloadWorld();
     static void AddWorldSaveData( void* data, size_t size );
+    static void AddWorldSaveRecord();
+    static void WriteWorldSaveData( void* data, size_t size );
     static void AddClientSaveData( Client* cl );
     static void Dump_Work( void* data );
 
@@ -426,6 +446,7 @@ public:
     static volatile uint LastClientId;
 
     static bool        LoadClientsData();
+    static bool        LoadClientStore( const char* last_id_fname );
     static ClientData* GetClientData( const char* name )
     {
         auto it = std::find( ClientsData.begin(), ClientsData.end(), name );
@@ -457,8 +478,17 @@ public:
         uint  LoopMin;
         uint  LoopMax;
         uint  LagsCount;
+
+        uint                JobThreadsCount;
+        JobThreadStatistics JobThreads[MAX_JOB_THREADS];
     } static Statistics;
 
+    // Statistics snapshots for benchmarks, one csv line per period
+    static void* StatisticsCsvFile;
+    static uint  StatisticsCsvTime;
+    static uint  StatisticsCsvNextTick;
+    static void  WriteStatisticsCsv();
+
     static uint   PlayersInGame() { return CrMngr.PlayersInGame(); }
     static uint   NpcInGame()     { return CrMngr.NpcInGame(); }
     static string GetIngamePlayersStatistics();
@@ -535,10 +565,12 @@ public:
         static void Item_EventMove( Item* item, Critter* cr, uchar from_slot );
         static void Item_EventWalk( Item* item, Critter* cr, bool entered, uchar dir );
 
-        static void  Item_set_Flags( Item* item, uint value );
-        static uint  Item_get_Flags( Item* item );
-        static void  Item_set_TrapValue( Item* item, short value );
-        static short Item_get_TrapValue( Item* item );
+        static void   Item_set_Flags( Item* item, uint value );
+        static uint   Item_get_Flags( Item* item );
+        static void   Item_set_TrapValue( Item* item, short value );
+        static short  Item_get_TrapValue( Item* item );
+        static void   Item_set_RadioChannel( Item* item, ushort value );
+        static ushort Item_get_RadioChannel( Item* item );
 
         static uint CraftItem_GetShowParams( CraftItem* craft, ScriptArray* nums, ScriptArray* vals, ScriptArray* ors );
         static uint CraftItem_GetNeedParams( CraftItem* craft, ScriptArray* nums, ScriptArray* vals, ScriptArray* ors );
@@ -773,6 +805,7 @@ public:
         static Critter*   Map_GetCritterById( Map* map, uint crid );
         static uint       Map_GetCritters( Map* map, ushort hx, ushort hy, uint radius, int find_type, ScriptArray* critters );
         static uint       Map_GetCrittersByPids( Map* map, ushort pid, int find_type, ScriptArray* critters );
+        static uint       Map_GetCrittersByParam( Map* map, uint index, int min_value, int max_value, int find_type, ScriptArray* critters );
         static uint       Map_GetCrittersInPath( Map* map, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, float angle, uint dist, int find_type, ScriptArray* critters );
         static uint       Map_GetCrittersInPathBlock( Map* map, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, float angle, uint dist, int find_type, ScriptArray* critters, ushort& pre_block_hx, ushort& pre_block_hy, ushort& block_hx, ushort& block_hy );
         static uint       Map_GetCrittersWhoViewPath( Map* map, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, int find_type, ScriptArray* critters );
@@ -822,6 +855,12 @@ public:
         static void Map_EventTurnBasedProcess( Map* map, Critter* cr, bool begin_turn );
 
         static uint   Location_GetId( Location* loc );
+        static void   Location_set_WorldX( Location* loc, ushort value );
+        static ushort Location_get_WorldX( Location* loc );
+        static void   Location_set_WorldY( Location* loc, ushort value );
+        static ushort Location_get_WorldY( Location* loc );
+        static void   Location_set_Radius( Location* loc, ushort value );
+        static ushort Location_get_Radius( Location* loc );
         static ushort Location_GetProtoId( Location* loc );
         static bool   Location_SetEvent( Location* loc, int event_type, ScriptString* func_name );
         static uint   Location_GetMapCount( Location* loc );
@@ -882,6 +921,7 @@ public:
         static Location*     Global_GetLocationByPid( ushort loc_pid, uint skip_count );
         static uint          Global_GetLocations( ushort wx, ushort wy, uint radius, ScriptArray* locations );
         static uint          Global_GetVisibleLocations( ushort wx, ushort wy, uint radius, Critter* cr, ScriptArray* locations );
+        static Location*     Global_GetNearestLocation( ushort wx, ushort wy, uint radius, bool only_visible );
         static uint          Global_GetZoneLocationIds( ushort zx, ushort zy, uint zone_radius, ScriptArray* locations );
         static bool          Global_StrToInt( ScriptString* text, int& result );
         static bool          Global_StrToFloat( ScriptString* text, float& result );
@@ -902,6 +942,7 @@ public:
         static uint          Global_GetAllPlayers( ScriptArray* players );
         static uint          Global_GetRegisteredPlayers( ScriptArray* ids, ScriptArray* names );
         static uint          Global_GetAllNpc( ushort pid, ScriptArray* npc );
+        static uint          Global_GetCrittersByParam( uint index, int min_value, int max_value, int find_type, ScriptArray* critters );
         static uint          Global_GetAllMaps( ushort pid, ScriptArray* maps );
         static uint          Global_GetAllLocations( ushort pid, ScriptArray* locations );
         static uint          Global_GetScriptId( ScriptString& script_name, ScriptString& func_decl );
@@ -911,6 +952,7 @@ public:
         static uint          Global_GetTick() { return Timer::FastTick(); }
         static void          Global_GetTime( ushort& year, ushort& month, ushort& day, ushort& day_of_week, ushort& hour, ushort& minute, ushort& second, ushort& milliseconds );
         static bool          Global_SetParameterGetBehaviour( uint index, ScriptString& func_name );
+        static bool          Global_SetParameterGetDepends( uint index, ScriptArray& depends );
         static bool          Global_SetParameterChangeBehaviour( uint index, ScriptString& func_name );
         static bool          Global_SetParameterDialogGetBehaviour( uint index, ScriptString& func_name );
         static void          Global_AllowSlot( uchar index, ScriptString& ini_option );
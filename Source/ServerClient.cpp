@@ -14,15 +14,26 @@
 #include "Server.h"
 #include "SinglePlayer.h"
 #include "Text.h"
+#include "Tracer.h"
 
-void FOServer::ProcessCritter( Critter* cr )
+// Milliseconds left to deadline, zero if already passed
+static inline uint GetTimeLeft( uint tick, uint deadline )
 {
+    return deadline > tick ? deadline - tick : 0;
+}
+
+// Returns time in milliseconds until critter needs next processing
+uint FOServer::ProcessCritter( Critter* cr )
+{
+    TRACE_SCOPE( TRACE_PROCESS_CRITTER );
+
     if( cr->IsNotValid )
-        return;
+        return 0;
     if( Timer::IsGamePaused() )
-        return;
+        return 0;
 
     uint tick = Timer::GameTick();
+    uint wait = GetTimeLeft( tick, cr->GlobalIdleNextTick );
 
     // Idle global function
     if( tick >= cr->GlobalIdleNextTick )
@@ -33,6 +44,7 @@ void FOServer::ProcessCritter( Critter* cr )
             Script::RunPrepared();
         }
         cr->GlobalIdleNextTick = tick + GameOpt.CritterIdleTick;
+        wait = GameOpt.CritterIdleTick;
     }
 
     // Ap regeneration
@@ -53,6 +65,11 @@ void FOServer::ProcessCritter( Critter* cr )
                 // if(cr->IsPlayer()) WriteLog("ap<%u.%u>\n",cr->Data.St[ST_CURRENT_AP]/AP_DIVIDER,cr->Data.St[ST_CURRENT_AP]%AP_DIVIDER);
             }
         }
+        wait = MIN( wait, GetTimeLeft( tick, cr->ApRegenerationTick + 500 ) );
+    }
+    else if( cr->GetRealAp() < max_ap && !cr->IsTurnBased() )
+    {
+        wait = MIN( wait, GetTimeLeft( tick, cr->GetBreakEndTick() ) );
     }
     if( cr->Data.Params[ST_CURRENT_AP] > max_ap )
         cr->Data.Params[ST_CURRENT_AP] = max_ap;
@@ -79,10 +96,21 @@ void FOServer::ProcessCritter( Critter* cr )
                 cr->AddCrTimeEvent( me.FuncNum, me.Rate, time, me.Identifier );
         }
     }
+    if( !cr->CrTimeEvents.empty() )
+    {
+        uint next_time = cr->CrTimeEvents[0].NextTime;
+        if( !next_time || GameOpt.FullSecond >= next_time )
+            wait = 0;
+        else if( GameOpt.TimeMultiplier )
+            wait = MIN( wait, (next_time - GameOpt.FullSecond) * 1000 / GameOpt.TimeMultiplier );
+    }
 
     // Global map
     if( !cr->GetMap() && cr->GroupMove && cr == cr->GroupMove->Rule )
+    {
         MapMngr.GM_GroupMove( cr->GroupMove );
+        wait = 0;
+    }
 
     // Client
     if( cr->IsPlayer() )
@@ -128,6 +156,9 @@ void FOServer::ProcessCritter( Critter* cr )
             cl->LookCacheValue = cl->GetLook();
             cl->CacheValuesNextTick = tick + 3000;
         }
+
+        // Players are processed every cycle
+        wait = 0;
     }
     // Npc
     else
@@ -141,15 +172,31 @@ void FOServer::ProcessCritter( Critter* cr )
             ProcessAI( npc );
             if( npc->IsNeedRefreshBag() )
                 npc->RefreshBag();
+
+            // Next AI decision
+            if( npc->IsTurnBased() )
+                wait = 0;
+            else if( npc->IsBusy() )
+                wait = MIN( wait, GetTimeLeft( tick, npc->GetBreakEndTick() ) );
+            else if( npc->IsWait() )
+                wait = MIN( wait, GetTimeLeft( tick, npc->GetWaitEndTick() ) );
+            else
+                wait = 0;
+            if( npc->IsNoPlanes() )
+                wait = MIN( wait, GetTimeLeft( tick, npc->NextRefreshBagTick ) );
         }
     }
 
     // Knockout
     if( cr->IsKnockout() )
+    {
         cr->TryUpOnKnockout();
+        wait = 0;
+    }
 
     // Process changed parameters
     cr->ProcessChangedParams();
+    return wait;
 }
 
 void FOServer::SaveHoloInfoFile()
@@ -422,6 +469,7 @@ bool FOServer::Act_Move( Critter* cr, ushort hx, ushort hy, uint move_params )
     cr->Data.HexX = hx;
     cr->Data.HexY = hy;
     map->SetFlagCritter( hx, hy, multihex, is_dead );
+    map->SetCritterHex( cr );
 
     // Set dir
     cr->Data.Dir = dir;
@@ -1319,6 +1367,7 @@ void FOServer::KnockoutCritter( Critter* cr, uint anim2begin, uint anim2idle, ui
         cr->Data.HexX = x2;
         cr->Data.HexY = y2;
         map->SetFlagCritter( x2, y2, multihex, is_dead );
+        map->SetCritterHex( cr );
     }
 
     cr->ToKnockout( anim2begin, anim2idle, anim2end, lost_ap, knock_hx, knock_hy );
@@ -1781,6 +1830,8 @@ void FOServer::Process_UserRegister( Client* cl )
 
 void FOServer::Process_UserLogin( ClientPtr& cl )
 {
+    TRACE_SCOPE( TRACE_USER_LOGIN );
+
     // Engine version
     ushort engine_stage = 0, engine_version = 0;
 
@@ -2604,7 +2655,8 @@ void FOServer::Process_ParseToGame( Client* cl )
 
     // Send current items on map
     cl->VisItemLocker.Lock();
-    UIntSet items = cl->VisItem;
+    UIntVec items;
+    cl->VisItem.GetIds( items );
     cl->VisItemLocker.Unlock();
     for( auto it = items.begin(), end = items.end(); it != end; ++it )
     {
@@ -3852,6 +3904,7 @@ void FOServer::Process_SetUserHoloStr( Client* cl )
         holo_id = ++LastHoloId;
         HolodiskInfo.insert( PAIR( holo_id, new HoloInfo( true, title, text ) ) );
     }
+    WorldJournal::SetSectionDirty( WORLD_SECTION_HOLO );
 
     HolodiskLocker.Unlock();
 
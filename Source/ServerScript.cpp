@@ -1280,6 +1280,18 @@ uint FOServer::SScriptFunc::Item_get_Flags( Item* item )
     return item->Data.Flags;
 }
 
+void FOServer::SScriptFunc::Item_set_RadioChannel( Item* item, ushort value )
+{
+    if( item->IsNotValid )
+        return;
+    ItemMngr.RadioSetChannel( item, value );
+}
+
+ushort FOServer::SScriptFunc::Item_get_RadioChannel( Item* item )
+{
+    return item->Data.RadioChannel;
+}
+
 void FOServer::SScriptFunc::Item_set_TrapValue( Item* item, short value )
 {
     if( item->IsNotValid )
@@ -1595,6 +1607,12 @@ bool FOServer::SScriptFunc::Crit_ChangeCrType( Critter* cr, uint new_type )
         }
 
         cr->Data.BaseType = new_type;
+        if( cr->GetMap() )
+        {
+            Map* map = MapMngr.GetMap( cr->GetMap() );
+            if( map )
+                map->SetCritterHex( cr );
+        }
         cr->Send_ParamOther( OTHER_BASE_TYPE, new_type );
         cr->SendA_ParamOther( OTHER_BASE_TYPE, new_type );
     }
@@ -2944,6 +2962,12 @@ void FOServer::SScriptFunc::Crit_SetMultihex( Critter* cr, int value )
             map->SetFlagCritter( cr->GetHexX(), cr->GetHexY(), new_mh, false );
         }
     }
+    if( old_mh != new_mh && cr->GetMap() )
+    {
+        Map* map = MapMngr.GetMap( cr->GetMap() );
+        if( map )
+            map->SetCritterHex( cr );
+    }
 
     cr->Send_ParamOther( OTHER_MULTIHEX, value );
     cr->SendA_ParamOther( OTHER_MULTIHEX, value );
@@ -3186,6 +3210,8 @@ uint FOServer::SScriptFunc::Crit_EraseTimeEvents( Critter* cr, int identifier )
         else
             ++it;
     }
+    if( result )
+        cr->SetJournalDirty();
     return result;
 }
 
@@ -3209,6 +3235,8 @@ uint FOServer::SScriptFunc::Crit_EraseTimeEventsArr( Critter* cr, ScriptArray& i
                 ++it;
         }
     }
+    if( result )
+        cr->SetJournalDirty();
     return result;
 }
 
@@ -3821,6 +3849,7 @@ bool FOServer::SScriptFunc::Map_SetEvent( Map* map, int event_type, ScriptString
                 map->NeedProcess = true;
             }
         }
+        map->WakeUp();
     }
 
     if( func_name && func_name->length() && map->FuncId[event_type] <= 0 )
@@ -3909,6 +3938,7 @@ void FOServer::SScriptFunc::Map_SetTurnBasedAvailability( Map* map, bool value )
     if( map->IsNotValid )
         SCRIPT_ERROR_R( "This nullptr." );
     map->Data.IsTurnBasedAviable = value;
+    map->SetJournalDirty();
 }
 
 bool FOServer::SScriptFunc::Map_IsTurnBasedAvailability( Map* map )
@@ -4197,6 +4227,22 @@ uint FOServer::SScriptFunc::Map_GetCrittersByPids( Map* map, ushort pid, int fin
     return (uint)cr_vec.size();
 }
 
+uint FOServer::SScriptFunc::Map_GetCrittersByParam( Map* map, uint index, int min_value, int max_value, int find_type, ScriptArray* critters )
+{
+    if( map->IsNotValid )
+        SCRIPT_ERROR_R0( "This nullptr." );
+    if( index >= MAX_PARAMS )
+        SCRIPT_ERROR_R0( "Invalid index arg." );
+
+    CrVec cr_vec;
+    map->GetCritters( cr_vec, true );
+    Critter::FilterByParam( cr_vec, index, min_value, max_value, find_type );
+
+    if( critters )
+        Script::AppendVectorToArrayRef<Critter*>( cr_vec, critters );
+    return (uint)cr_vec.size();
+}
+
 uint FOServer::SScriptFunc::Map_GetCrittersInPath( Map* map, ushort from_hx, ushort from_hy, ushort to_hx, ushort to_hy, float angle, uint dist, int find_type, ScriptArray* critters )
 {
     if( map->IsNotValid )
@@ -4861,6 +4907,46 @@ uint FOServer::SScriptFunc::Location_GetId( Location* loc )
     return loc->GetId();
 }
 
+// Global map zones index is kept in sync with position and radius
+void FOServer::SScriptFunc::Location_set_WorldX( Location* loc, ushort value )
+{
+    if( loc->IsNotValid )
+        return;
+    loc->Data.WX = value;
+    MapMngr.UpdateLocationZones( loc );
+}
+
+ushort FOServer::SScriptFunc::Location_get_WorldX( Location* loc )
+{
+    return loc->Data.WX;
+}
+
+void FOServer::SScriptFunc::Location_set_WorldY( Location* loc, ushort value )
+{
+    if( loc->IsNotValid )
+        return;
+    loc->Data.WY = value;
+    MapMngr.UpdateLocationZones( loc );
+}
+
+ushort FOServer::SScriptFunc::Location_get_WorldY( Location* loc )
+{
+    return loc->Data.WY;
+}
+
+void FOServer::SScriptFunc::Location_set_Radius( Location* loc, ushort value )
+{
+    if( loc->IsNotValid )
+        return;
+    loc->Data.Radius = value;
+    MapMngr.UpdateLocationZones( loc );
+}
+
+ushort FOServer::SScriptFunc::Location_get_Radius( Location* loc )
+{
+    return loc->Data.Radius;
+}
+
 ushort FOServer::SScriptFunc::Location_GetProtoId( Location* loc )
 {
     if( loc->IsNotValid )
@@ -5425,36 +5511,27 @@ Location* FOServer::SScriptFunc::Global_GetLocationByPid( ushort loc_pid, uint s
 uint FOServer::SScriptFunc::Global_GetLocations( ushort wx, ushort wy, uint radius, ScriptArray* locations )
 {
     LocVec locs;
-    MapMngr.GetLocations( locs, false );
-    LocVec locs_;
-    locs_.reserve( locs.size() );
-    for( auto it = locs.begin(), end = locs.end(); it != end; ++it )
-    {
-        Location* loc = *it;
-        if( DistSqrt( wx, wy, loc->Data.WX, loc->Data.WY ) <= radius + loc->GetRadius() )
-            locs_.push_back( loc );
-    }
+    MapMngr.GetRadiusLocations( wx, wy, radius, locs );
 
     if( locations )
     {
-        for( auto it = locs_.begin(), end = locs_.end(); it != end; ++it )
+        for( auto it = locs.begin(), end = locs.end(); it != end; ++it )
             SYNC_LOCK( *it );
-        Script::AppendVectorToArrayRef<Location*>( locs_, locations );
+        Script::AppendVectorToArrayRef<Location*>( locs, locations );
     }
-    return (uint)locs_.size();
+    return (uint)locs.size();
 }
 
 uint FOServer::SScriptFunc::Global_GetVisibleLocations( ushort wx, ushort wy, uint radius, Critter* cr, ScriptArray* locations )
 {
     LocVec locs;
-    MapMngr.GetLocations( locs, false );
+    MapMngr.GetRadiusLocations( wx, wy, radius, locs );
     LocVec locs_;
     locs_.reserve( locs.size() );
     for( auto it = locs.begin(), end = locs.end(); it != end; ++it )
     {
         Location* loc = *it;
-        if( DistSqrt( wx, wy, loc->Data.WX, loc->Data.WY ) <= radius + loc->GetRadius() &&
-            (loc->IsVisible() || (cr && cr->IsPlayer() && ( (Client*)cr )->CheckKnownLocById( loc->GetId() ) ) ) )
+        if( loc->IsVisible() || (cr && cr->IsPlayer() && ( (Client*)cr )->CheckKnownLocById( loc->GetId() ) ) )
             locs_.push_back( loc );
     }
 
@@ -5467,6 +5544,14 @@ uint FOServer::SScriptFunc::Global_GetVisibleLocations( ushort wx, ushort wy, ui
     return (uint)locs_.size();
 }
 
+Location* FOServer::SScriptFunc::Global_GetNearestLocation( ushort wx, ushort wy, uint radius, bool only_visible )
+{
+    Location* loc = MapMngr.GetNearestLocation( wx, wy, radius, only_visible );
+    if( loc )
+        SYNC_LOCK( loc );
+    return loc;
+}
+
 uint FOServer::SScriptFunc::Global_GetZoneLocationIds( ushort zx, ushort zy, uint zone_radius, ScriptArray* locations )
 {
     UIntVec loc_ids;
@@ -5822,6 +5907,18 @@ uint FOServer::SScriptFunc::Global_GetAllNpc( ushort pid, ScriptArray* npc )
     return (uint)npcs_.size();
 }
 
+uint FOServer::SScriptFunc::Global_GetCrittersByParam( uint index, int min_value, int max_value, int find_type, ScriptArray* critters )
+{
+    if( index >= MAX_PARAMS )
+        SCRIPT_ERROR_R0( "Invalid index arg." );
+
+    CrVec cr_vec;
+    CrMngr.GetCrittersByParam( index, min_value, max_value, find_type, cr_vec, true );
+    if( critters )
+        Script::AppendVectorToArrayRef<Critter*>( cr_vec, critters );
+    return (uint)cr_vec.size();
+}
+
 uint FOServer::SScriptFunc::Global_GetAllMaps( ushort pid, ScriptArray* maps )
 {
     MapVec maps_;
@@ -5915,6 +6012,7 @@ bool FOServer::SScriptFunc::Global_SetParameterGetBehaviour( uint index, ScriptS
     if( index >= MAX_PARAMS )
         SCRIPT_ERROR_R0( "Invalid index arg." );
     Critter::ParamsGetScript[index] = 0;
+    Critter::SetParamsGetDepends( index, UIntVec() );
     if( func_name.length() > 0 )
     {
         int bind_id = Script::Bind( func_name.c_str(), "int %s(Critter&,uint)", false );
@@ -5925,6 +6023,25 @@ bool FOServer::SScriptFunc::Global_SetParameterGetBehaviour( uint index, ScriptS
     return true;
 }
 
+bool FOServer::SScriptFunc::Global_SetParameterGetDepends( uint index, ScriptArray& depends )
+{
+    if( index >= MAX_PARAMS )
+        SCRIPT_ERROR_R0( "Invalid index arg." );
+    if( !Critter::ParamsGetScript[index] )
+        SCRIPT_ERROR_R0( "Get behaviour is not set." );
+
+    UIntVec depends_;
+    for( uint i = 0, j = depends.GetSize(); i < j; i++ )
+    {
+        uint depend = *(uint*)depends.At( i );
+        if( depend >= MAX_PARAMS )
+            SCRIPT_ERROR_R0( "Invalid depends arg." );
+        depends_.push_back( depend );
+    }
+    Critter::SetParamsGetDepends( index, depends_ );
+    return true;
+}
+
 bool FOServer::SScriptFunc::Global_SetParameterChangeBehaviour( uint index, ScriptString& func_name )
 {
     if( index >= MAX_PARAMS )
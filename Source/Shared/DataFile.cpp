@@ -5,11 +5,119 @@
 #include "DataFile.h"
 #include "FileSystem.h"
 #include "Log.Shared.h"
+#include "Mutex.h"
 #include "Text.h"
 
 #include "DataFile/Dat.h"
 #include "DataFile/Zip.h"
 
+struct DataFileCacheEntry
+{
+    DataFile* Owner;
+    string    Name;
+    uchar*    Data;
+    uint      Len;
+};
+typedef list<DataFileCacheEntry>                          DataFileCacheList;
+typedef pair<DataFile*, string>                           CacheKey;
+typedef map<CacheKey, DataFileCacheList::iterator>        DataFileCacheMap;
+
+// Front of list is most recently used entry
+static Mutex             CacheLocker;
+static DataFileCacheList CacheEntries;
+static DataFileCacheMap  CacheIndex;
+static uint              CacheLimit = 0;
+static uint              CacheUsed = 0;
+static uint              CacheHits = 0;
+static uint              CacheMisses = 0;
+static uint              CacheEvicted = 0;
+
+static void CacheShrink( uint limit )
+{
+    while( CacheUsed > limit && !CacheEntries.empty() )
+    {
+        DataFileCacheEntry& entry = CacheEntries.back();
+        CacheUsed -= entry.Len;
+        CacheIndex.erase( CacheKey( entry.Owner, entry.Name ) );
+        delete[] entry.Data;
+        CacheEntries.pop_back();
+        CacheEvicted++;
+    }
+}
+
+void DataFile::SetCacheSize( uint bytes )
+{
+    SCOPE_LOCK( CacheLocker );
+
+    CacheLimit = bytes;
+    CacheShrink( CacheLimit );
+}
+
+bool DataFile::IsCacheEnabled()
+{
+    return CacheLimit != 0;
+}
+
+uchar* DataFile::CacheGet( DataFile* owner, const char* fname, uint& len )
+{
+    if( !CacheLimit )
+        return NULL;
+
+    SCOPE_LOCK( CacheLocker );
+
+    auto it = CacheIndex.find( CacheKey( owner, fname ) );
+    if( it == CacheIndex.end() )
+    {
+        CacheMisses++;
+        return NULL;
+    }
+
+    DataFileCacheList::iterator entry = it->second;
+    CacheEntries.splice( CacheEntries.begin(), CacheEntries, entry );
+    CacheHits++;
+
+    // Caller owns result, as with not cached entries
+    uchar* buf = new uchar[entry->Len + 1];
+    memcpy( buf, entry->Data, entry->Len );
+    buf[entry->Len] = 0;
+    len = entry->Len;
+    return buf;
+}
+
+void DataFile::CachePut( DataFile* owner, const char* fname, const uchar* buf, uint len )
+{
+    // Entry larger than quarter of budget would flush most of cache
+    if( !CacheLimit || len > CacheLimit / 4 )
+        return;
+
+    SCOPE_LOCK( CacheLocker );
+
+    CacheKey key( owner, fname );
+    if( CacheIndex.count( key ) )
+        return;
+
+    DataFileCacheEntry entry;
+    entry.Owner = owner;
+    entry.Name = fname;
+    entry.Data = new uchar[len];
+    entry.Len = len;
+    memcpy( entry.Data, buf, len );
+    CacheEntries.push_front( entry );
+    CacheIndex.insert( make_pair( key, CacheEntries.begin() ) );
+    CacheUsed += len;
+
+    CacheShrink( CacheLimit );
+}
+
+string DataFile::GetCacheStatisticsString()
+{
+    SCOPE_LOCK( CacheLocker );
+
+    char str[MAX_FOTEXT];
+    return Str::Format( str, "Data files cache\nEntries %u, used %u of %u bytes, hits %u, misses %u, evicted %u\n",
+                        (uint)CacheEntries.size(), CacheUsed, CacheLimit, CacheHits, CacheMisses, CacheEvicted );
+}
+
 DataFile* DataFile::Open( const char* fname )
 {
     if( !fname || !fname[0] )
@@ -62,3 +170,32 @@ DataFile* DataFile::Open( const char* fname )
 
     return NULL;
 }
+
+DataFile::~DataFile()
+{
+    SCOPE_LOCK( CacheLocker );
+
+    for( auto it = CacheEntries.begin(); it != CacheEntries.end();)
+    {
+        if( it->Owner == this )
+        {
+            CacheUsed -= it->Len;
+            CacheIndex.erase( CacheKey( this, it->Name ) );
+            delete[] it->Data;
+            it = CacheEntries.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+// FNV-1a
+uint DataFile::GetNameHash( const char* name )
+{
+    uint hash = 2166136261U;
+    for( ; *name; name++ )
+        hash = (hash ^ (uchar)*name) * 16777619U;
+    return hash;
+}
@@ -6,6 +6,7 @@
 //  - Arcanum DAT
 //  - Zip
 
+#include "Text.h"
 #include "Types.h"
 
 class DataFile
@@ -13,14 +14,85 @@ class DataFile
 public:
     static DataFile* Open( const char* fname );
 
-    virtual ~DataFile() {}
+    virtual ~DataFile();
 
     virtual const string& GetPackName() = 0;
     virtual uchar*        OpenFile( const char* fname, uint& len ) = 0;
     virtual void          GetFileNames( const char* path, bool include_subdirs, const char* ext, StrVec& result ) = 0;
     virtual void          GetTime( uint64* create, uint64* access, uint64* write ) = 0;
+
+    // Decompressed entries cache, shared by all data files, zero size disables it
+    static void   SetCacheSize( uint bytes );
+    static string GetCacheStatisticsString();
+
+    static uint GetNameHash( const char* name );
+
+protected:
+
+    static uchar* CacheGet( DataFile* owner, const char* fname, uint& len );
+    static void   CachePut( DataFile* owner, const char* fname, const uchar* buf, uint len );
+    static bool   IsCacheEnabled();
 };
 
 typedef vector<DataFile*> DataFileVec;
 
+// Names of archive entries
+// Ordered by name for listing, lookup goes through names hashes
+template<class T>
+class DataFileIndex
+{
+private:
+    typedef map<string, T>                        NameMap;
+    typedef pair<uint, typename NameMap::iterator> HashEntry;
+
+    NameMap           names;
+    vector<HashEntry> hashes;
+
+    static bool HashLess( const HashEntry& a, const HashEntry& b ) { return a.first < b.first; }
+
+public:
+    void Add( const string& name, const T& data ) { names.insert( make_pair( name, data ) ); }
+
+    // Call after all names are added
+    void Build()
+    {
+        hashes.clear();
+        hashes.reserve( names.size() );
+        for( auto it = names.begin(), end = names.end(); it != end; ++it )
+            hashes.push_back( HashEntry( DataFile::GetNameHash( it->first.c_str() ), it ) );
+        sort( hashes.begin(), hashes.end(), HashLess );
+    }
+
+    T* Find( const char* name )
+    {
+        HashEntry key( DataFile::GetNameHash( name ), names.end() );
+        for( auto it = lower_bound( hashes.begin(), hashes.end(), key, HashLess ), end = hashes.end(); it != end && it->first == key.first; ++it )
+            if( it->second->first == name )
+                return &it->second->second;
+        return NULL;
+    }
+
+    void GetNames( const char* path, bool include_subdirs, const char* ext, StrVec& result )
+    {
+        size_t path_len = Str::Length( path );
+        for( auto it = names.begin(), end = names.end(); it != end; ++it )
+        {
+            const string& fname = (*it).first;
+            if( !fname.compare( 0, path_len, path ) && (include_subdirs || (int)fname.find_last_of( '\\' ) < (int)path_len) )
+            {
+                if( ext && *ext )
+                {
+                    size_t pos = fname.find_last_of( '.' );
+                    if( pos != string::npos && Str::CompareCase( &fname.c_str()[pos + 1], ext ) )
+                        result.push_back( fname );
+                }
+                else
+                {
+                    result.push_back( fname );
+                }
+            }
+        }
+    }
+};
+
 #endif // __DATA_FILE__ //
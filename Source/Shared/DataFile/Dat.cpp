@@ -11,6 +11,8 @@ bool DataFileDat::Init( const char* fname )
 {
     datHandle = NULL;
     memTree = NULL;
+    datView = NULL;
+    datSize = 0;
     fileName = fname;
     readBuf.resize( 0x40000 );
 
@@ -28,12 +30,21 @@ bool DataFileDat::Init( const char* fname )
         WriteLogF( _FUNC_, " - Read file tree fail.\n" );
         return false;
     }
+    filesTree.Build();
+
+    // Entries are read from memory if mapping succeeds, file reads are used otherwise
+    datView = (uchar*)FileMap( datHandle, datSize );
 
     return true;
 }
 
 DataFileDat::~DataFileDat()
 {
+    if( datView )
+    {
+        FileUnmap( datView, datSize );
+        datView = NULL;
+    }
     if( datHandle )
     {
         FileClose( datHandle );
@@ -90,7 +101,7 @@ bool DataFileDat::ReadTree()
 
                 if( type == 2 )
                     *(ptr + 4 + fnsz + 7) = 1;                 // Compressed
-                filesTree.insert( make_pair( name, ptr + 4 + fnsz + 7 ) );
+                filesTree.Add( name, ptr + 4 + fnsz + 7 );
             }
 
             if( ptr + fnsz + 24 >= end_ptr )
@@ -151,7 +162,7 @@ bool DataFileDat::ReadTree()
             transform( name.begin(), name.end(), name.begin(), ::tolower );
             replace( name.begin(), name.end(), '/', '\\' );
 
-            filesTree.insert( make_pair( string( name ), ptr + 4 + fnsz ) );
+            filesTree.Add( name, ptr + 4 + fnsz );
         }
 
         if( ptr + fnsz + 17 >= end_ptr )
@@ -162,23 +173,89 @@ bool DataFileDat::ReadTree()
     return true;
 }
 
-uchar* DataFileDat::OpenFile( const char* fname, uint& len )
+bool DataFileDat::GetEntry( const char* fname, uchar& type, uint& real_size, uint& packed_size, uint& offset )
 {
     if( !datHandle )
-        return NULL;
-
-    auto it = filesTree.find( fname );
-    if( it == filesTree.end() )
-        return NULL;
+        return false;
 
-    uchar* ptr = it->second;
-    uchar  type;
-    uint   real_size, packed_size, offset;
+    uchar** entry = filesTree.Find( fname );
+    if( !entry )
+        return false;
 
+    uchar* ptr = *entry;
     memcpy( &type, ptr, sizeof(type) );
     memcpy( &real_size, ptr + 1, sizeof(real_size) );
     memcpy( &packed_size, ptr + 5, sizeof(packed_size) );
     memcpy( &offset, ptr + 9, sizeof(offset) );
+    return true;
+}
+
+uchar* DataFileDat::OpenMappedFile( const char* fname, uchar type, uint real_size, uint packed_size, uint offset, uint& len )
+{
+    uint stored_size = (type ? packed_size : real_size);
+    if( offset > datSize || stored_size > datSize - offset )
+        return NULL;
+
+    if( type )
+    {
+        uchar* buf = CacheGet( this, fname, len );
+        if( buf )
+            return buf;
+    }
+
+    len = real_size;
+    uchar* buf = new uchar[len + 1];
+
+    if( !type )
+    {
+        memcpy( buf, datView + offset, len );
+    }
+    else
+    {
+        // Whole packed data is available, inflate in one pass
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = datView + offset;
+        stream.avail_in = packed_size;
+        if( inflateInit( &stream ) != Z_OK )
+        {
+            delete[] buf;
+            return NULL;
+        }
+
+        stream.next_out = buf;
+        stream.avail_out = real_size;
+        int r = inflate( &stream, Z_FINISH );
+        inflateEnd( &stream );
+        if( r != Z_STREAM_END )
+        {
+            delete[] buf;
+            return NULL;
+        }
+
+        CachePut( this, fname, buf, len );
+    }
+
+    buf[len] = 0;
+    return buf;
+}
+
+uchar* DataFileDat::OpenFile( const char* fname, uint& len )
+{
+    uchar type;
+    uint  real_size, packed_size, offset;
+    if( !GetEntry( fname, type, real_size, packed_size, offset ) )
+        return NULL;
+
+    // Damaged entries are read again by streaming reader
+    if( datView )
+    {
+        uchar* buf = OpenMappedFile( fname, type, real_size, packed_size, offset, len );
+        if( buf )
+            return buf;
+    }
 
     if( !FileSetPointer( datHandle, offset, SEEK_SET ) )
         return NULL;
@@ -245,24 +322,7 @@ uchar* DataFileDat::OpenFile( const char* fname, uint& len )
 
 void DataFileDat::GetFileNames( const char* path, bool include_subdirs, const char* ext, StrVec& result )
 {
-    size_t path_len = Str::Length( path );
-    for( auto it = filesTree.begin(), end = filesTree.end(); it != end; ++it )
-    {
-        const string& fname = (*it).first;
-        if( !fname.compare( 0, path_len, path ) && (include_subdirs || (int)fname.find_last_of( '\\' ) < (int)path_len) )
-        {
-            if( ext && *ext )
-            {
-                size_t pos = fname.find_last_of( '.' );
-                if( pos != string::npos && Str::CompareCase( &fname.c_str()[pos + 1], ext ) )
-                    result.push_back( fname );
-            }
-            else
-            {
-                result.push_back( fname );
-            }
-        }
-    }
+    filesTree.GetNames( path, include_subdirs, ext, result );
 }
 
 void DataFileDat::GetTime( uint64* create, uint64* access, uint64* write )
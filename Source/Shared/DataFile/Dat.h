@@ -7,17 +7,19 @@
 class DataFileDat : public DataFile
 {
 private:
-    typedef map<string, uchar*> IndexMap;
-
-    IndexMap filesTree;
-    string   fileName;
-    uchar*   memTree;
-    void*    datHandle;
-    UCharVec readBuf;
-
-    uint64   timeCreate, timeAccess, timeWrite;
-
-    bool ReadTree();
+    DataFileIndex<uchar*> filesTree;
+    string                fileName;
+    uchar*                memTree;
+    void*                 datHandle;
+    uchar*                datView;     // Whole archive mapped to memory, if mapping is available
+    uint                  datSize;
+    UCharVec              readBuf;
+
+    uint64                timeCreate, timeAccess, timeWrite;
+
+    bool   ReadTree();
+    bool   GetEntry( const char* fname, uchar& type, uint& real_size, uint& packed_size, uint& offset );
+    uchar* OpenMappedFile( const char* fname, uchar type, uint real_size, uint packed_size, uint offset, uint& len );
 
 public:
     bool Init( const char* fname );
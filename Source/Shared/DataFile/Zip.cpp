@@ -91,12 +91,14 @@ bool DataFileZip::ReadTree()
 
             zip_info.Pos = pos;
             zip_info.UncompressedSize = info.uncompressed_size;
-            filesTree.insert( make_pair( name, zip_info ) );
+            zip_info.Compressed = (info.compression_method != 0);
+            filesTree.Add( name, zip_info );
         }
 
         if( i + 1 < gi.number_entry && unzGoToNextFile( zipHandle ) != UNZ_OK )
             return false;
     }
+    filesTree.Build();
 
     return true;
 }
@@ -106,11 +108,17 @@ uchar* DataFileZip::OpenFile( const char* fname, uint& len )
     if( !zipHandle )
         return NULL;
 
-    auto it = filesTree.find( fname );
-    if( it == filesTree.end() )
+    ZipFileInfo* entry = filesTree.Find( fname );
+    if( !entry )
         return NULL;
 
-    ZipFileInfo& info = (*it).second;
+    ZipFileInfo& info = *entry;
+    if( info.Compressed )
+    {
+        uchar* buf = CacheGet( this, fname, len );
+        if( buf )
+            return buf;
+    }
 
     if( unzGoToFilePos( zipHandle, &info.Pos ) != UNZ_OK )
         return NULL;
@@ -134,29 +142,14 @@ uchar* DataFileZip::OpenFile( const char* fname, uint& len )
 
     len = info.UncompressedSize;
     buf[len] = 0;
+    if( info.Compressed )
+        CachePut( this, fname, buf, len );
     return buf;
 }
 
 void DataFileZip::GetFileNames( const char* path, bool include_subdirs, const char* ext, StrVec& result )
 {
-    size_t path_len = Str::Length( path );
-    for( auto it = filesTree.begin(), end = filesTree.end(); it != end; ++it )
-    {
-        const string& fname = (*it).first;
-        if( !fname.compare( 0, path_len, path ) && (include_subdirs || (int)fname.find_last_of( '\\' ) < (int)path_len) )
-        {
-            if( ext && *ext )
-            {
-                size_t pos = fname.find_last_of( '.' );
-                if( pos != string::npos && Str::CompareCase( &fname.c_str()[pos + 1], ext ) )
-                    result.push_back( fname );
-            }
-            else
-            {
-                result.push_back( fname );
-            }
-        }
-    }
+    filesTree.GetNames( path, include_subdirs, ext, result );
 }
 
 void DataFileZip::GetTime( uint64* create, uint64* access, uint64* write )
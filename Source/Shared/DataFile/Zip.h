@@ -13,14 +13,14 @@ private:
     {
         unz_file_pos Pos;
         uLong        UncompressedSize;
+        bool         Compressed;
     };
-    typedef map<string, ZipFileInfo> IndexMap;
 
-    IndexMap filesTree;
-    string   fileName;
-    unzFile  zipHandle;
+    DataFileIndex<ZipFileInfo> filesTree;
+    string                     fileName;
+    unzFile                    zipHandle;
 
-    uint64   timeCreate, timeAccess, timeWrite;
+    uint64                     timeCreate, timeAccess, timeWrite;
 
     bool ReadTree();
 
@@ -315,10 +315,12 @@
 #endif                                                                                                                                           // FOCLASSIC_EXTENSION
 
 #define BINARY_TYPE_CLIENTSAVE                            'C'
+#define BINARY_TYPE_CLIENTSTORE                           'A'
 #define BINARY_TYPE_MAPSAVE                               'M'
 #define BINARY_TYPE_PROFILERSAVE                          'P'
 #define BINARY_TYPE_SCRIPTSAVE                            'S'
 #define BINARY_TYPE_WORLDSAVE                             'W'
+#define BINARY_TYPE_WORLDJOURNAL                          'J'
 #define BINARY_TYPE_CACHE                                 'c'  // reserved
 
 // Chosen actions
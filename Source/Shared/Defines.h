@@ -31,12 +31,16 @@
 // World dump versions
 #define WORLD_SAVE_V1                         (1)                                                    // unreleased
 #define WORLD_SAVE_LAST                       (WORLD_SAVE_V1)
+#define WORLD_JOURNAL_V1                      (1)                                                    // unreleased
+#define WORLD_JOURNAL_LAST                    (WORLD_JOURNAL_V1)
 #define SINGLEPLAYER_SAVE_V1                  (1)                                                    // unreleased
 #define SINGLEPLAYER_SAVE_LAST                (SINGLEPLAYER_SAVE_V1)
 
 // Client save
 #define CLIENT_SAVE_V1                        (1)  // unreleased
 #define CLIENT_SAVE_LAST                      (CLIENT_SAVE_V1)
+#define CLIENT_STORE_V1                       (1)  // unreleased
+#define CLIENT_STORE_LAST                     (CLIENT_STORE_V1)
 
 // Generic
 #define CRAFT_SEND_TIME                       (60000)
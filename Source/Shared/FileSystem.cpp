@@ -48,6 +48,14 @@ void* FileOpenForAppend( const char* fname, bool write_through /* = false */ )
     return file;
 }
 
+void* FileOpenForSharedRead( const char* fname )
+{
+    HANDLE file = CreateFileW( MBtoWC( fname ), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL );
+    if( file == INVALID_HANDLE_VALUE )
+        return NULL;
+    return file;
+}
+
 void FileClose( void* file )
 {
     if( file )
@@ -93,6 +101,25 @@ uint FileGetSize( void* file )
     return GetFileSize( (HANDLE)file, &high );
 }
 
+void* FileMap( void* file, uint& size )
+{
+    size = FileGetSize( file );
+    if( !size )
+        return NULL;
+    HANDLE mapping = CreateFileMappingW( (HANDLE)file, NULL, PAGE_READONLY, 0, 0, NULL );
+    if( !mapping )
+        return NULL;
+    void* view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    CloseHandle( mapping );
+    return view;
+}
+
+void FileUnmap( void* view, uint /* size */ )
+{
+    if( view )
+        UnmapViewOfFile( view );
+}
+
 bool FileDelete( const char* fname )
 {
     return DeleteFileW( MBtoWC( fname ) ) != FALSE;
@@ -180,6 +207,7 @@ bool ResolvePath( char* path )
 
 #else
 
+# include <sys/mman.h>
 # include <sys/stat.h>
 # include <dirent.h>
 # include <unistd.h>
@@ -214,6 +242,11 @@ void* FileOpenForAppend( const char* fname, bool write_through /* = false */ )
     return (void*)fd;
 }
 
+void* FileOpenForSharedRead( const char* fname )
+{
+    return FileOpen( fname, false );
+}
+
 void FileClose( void* file )
 {
     if( file )
@@ -262,6 +295,21 @@ uint FileGetSize( void* file )
     return (uint)st.st_size;
 }
 
+void* FileMap( void* file, uint& size )
+{
+    size = FileGetSize( file );
+    if( !size )
+        return NULL;
+    void* view = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fileno( ( (FileDesc*)file )->f ), 0 );
+    return view != MAP_FAILED ? view : NULL;
+}
+
+void FileUnmap( void* view, uint size )
+{
+    if( view )
+        munmap( view, size );
+}
+
 bool FileDelete( const char* fname )
 {
     return std::remove( fname );
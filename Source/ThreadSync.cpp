@@ -1,16 +1,41 @@
 #include "Core.h"
 
+#include "Text.h"
 #include "Thread.h"
 #include "ThreadSync.h"
+#include "Timer.h"
 #include "Mutex.h"
 
 extern bool  LogicMT;    // ConfigFile.h
 
 static Mutex SyncLocker; // Defense code from simultaneously execution
 
-SyncObject::SyncObject() : curMngr( NULL )
+// Wait list entry, links thread with busy object
+// Entry stays in object waiters list and in manager busy objects until object is locked by waiting thread
+struct SyncWaiter
+{
+    SyncManager* Mngr;
+    SyncObject*  Obj;
+    SyncWaiter*  Next;
+    uint         Index; // Index in manager busy objects
+};
+
+static SyncStatistics SyncStats[SYNC_OBJECT_COUNT];
+
+SyncObject::SyncObject() : curMngr( NULL ), lockIndex( 0 ), waiters( NULL ), objType( SYNC_OBJECT_OTHER )
 {}
 
+void SyncObject::SetType( int type )
+{
+    objType = (type >= 0 && type < SYNC_OBJECT_COUNT ? type : SYNC_OBJECT_OTHER);
+}
+
+void SyncObject::WakeUpWaiters()
+{
+    for( SyncWaiter* waiter = waiters; waiter; waiter = waiter->Next )
+        waiter->Mngr->waitEvent.Allow();
+}
+
 void SyncObject::Lock()
 {
     if( !LogicMT )
@@ -23,77 +48,26 @@ void SyncObject::Lock()
     // Object is free
     if( !curMngr )
     {
-        curMngr = curm;
-        curMngr->lockedObjects.push_back( this );
+        curm->AddLocked( this );
     }
     // Object busy by another thread
     else if( curm != curMngr )
     {
+        SyncStats[objType].Contentions++;
+
         // Another thread in wait state
         if( curMngr->isWaiting && curm->threadPriority >= curMngr->threadPriority )
         {
             // Pick from waiting thread
-            auto it = std::find( curMngr->lockedObjects.begin(), curMngr->lockedObjects.end(), this );
-            curMngr->lockedObjects.erase( it );
-            curMngr->busyObjects.push_back( this );
-
-            curMngr = curm;
-            curMngr->lockedObjects.push_back( this );
+            curm->PickObject( this );
         }
         // Another thread work with object
         else
         {
-            // Go to wait state
-            curm->isWaiting = true;
-            curm->busyObjects.push_back( this );
-
-            SyncLocker.Unlock();
-
-            // Wait and try lock all busy objects
-            while( true )
-            {
-                Thread::Sleep( 0 );
-
-                SyncLocker.Lock();
-
-                for( auto it = curm->busyObjects.begin(); it != curm->busyObjects.end();)
-                {
-                    SyncObject* obj = *it;
-                    if( !obj->curMngr )
-                    {
-                        // Object free
-                        obj->curMngr = curm;
-                        curm->lockedObjects.push_back( obj );
-                        it = curm->busyObjects.erase( it );
-                    }
-                    else if( obj->curMngr->isWaiting && curm->threadPriority >= obj->curMngr->threadPriority )
-                    {
-                        // Pick from waiting thread
-                        auto it_ = std::find( obj->curMngr->lockedObjects.begin(), obj->curMngr->lockedObjects.end(), obj );
-                        obj->curMngr->lockedObjects.erase( it_ );
-                        obj->curMngr->busyObjects.push_back( obj );
-
-                        obj->curMngr = curm;
-                        curm->lockedObjects.push_back( obj );
-                        it = curm->busyObjects.erase( it );
-                    }
-                    else
-                    {
-                        // Object busy
-                        ++it;
-                    }
-                }
-
-                if( curm->busyObjects.empty() )
-                {
-                    curm->isWaiting = false;
-
-                    SyncLocker.Unlock();
-                    return;
-                }
-
-                SyncLocker.Unlock();
-            }
+            // Go to wait state, lock released inside
+            curm->AddBusy( this );
+            curm->WaitBusyObjects( objType );
+            return;
         }
     }
     // else object already locked by current thread
@@ -109,18 +83,14 @@ void SyncObject::Unlock()
     SCOPE_LOCK( SyncLocker );
 
     if( curMngr )
-    {
-        auto it = std::find( curMngr->lockedObjects.begin(), curMngr->lockedObjects.end(), this );
-        curMngr->lockedObjects.erase( it );
-        curMngr = NULL;
-    }
+        curMngr->EraseLocked( this );
 
-    for( auto it = SyncManager::Managers.begin(), end = SyncManager::Managers.end(); it != end; ++it )
+    // Waiting threads don't need object anymore
+    while( waiters )
     {
-        SyncManager* sync_mngr = *it;
-        auto         it_ = std::find( sync_mngr->busyObjects.begin(), sync_mngr->busyObjects.end(), this );
-        if( it_ != sync_mngr->busyObjects.end() )
-            sync_mngr->busyObjects.erase( it_ );
+        SyncManager* mngr = waiters->Mngr;
+        mngr->EraseBusy( waiters );
+        mngr->waitEvent.Allow();
     }
 }
 
@@ -137,6 +107,153 @@ SyncManager::SyncManager() : isWaiting( false ),
 SyncManager::~SyncManager()
 {
     UnlockAll();
+
+    SCOPE_LOCK( SyncLocker );
+
+    // Unlink waiters from objects wait lists
+    while( !busyObjects.empty() )
+        EraseBusy( busyObjects.back() );
+    for( auto it = freeWaiters.begin(), end = freeWaiters.end(); it != end; ++it )
+        delete *it;
+    freeWaiters.clear();
+}
+
+void SyncManager::AddLocked( SyncObject* obj )
+{
+    obj->curMngr = this;
+    obj->lockIndex = (uint)lockedObjects.size();
+    lockedObjects.push_back( obj );
+}
+
+void SyncManager::EraseLocked( SyncObject* obj )
+{
+    SyncObject* last = lockedObjects.back();
+    lockedObjects[obj->lockIndex] = last;
+    last->lockIndex = obj->lockIndex;
+    lockedObjects.pop_back();
+    obj->curMngr = NULL;
+    obj->lockIndex = 0;
+}
+
+void SyncManager::AddBusy( SyncObject* obj )
+{
+    SyncWaiter* waiter;
+    if( !freeWaiters.empty() )
+    {
+        waiter = freeWaiters.back();
+        freeWaiters.pop_back();
+    }
+    else
+    {
+        waiter = new SyncWaiter();
+    }
+
+    waiter->Mngr = this;
+    waiter->Obj = obj;
+    waiter->Next = obj->waiters;
+    waiter->Index = (uint)busyObjects.size();
+    obj->waiters = waiter;
+    busyObjects.push_back( waiter );
+}
+
+void SyncManager::EraseBusy( SyncWaiter* waiter )
+{
+    // Object wait list, usually contains few entries
+    SyncWaiter** prev = &waiter->Obj->waiters;
+    while( *prev != waiter )
+        prev = &(*prev)->Next;
+    *prev = waiter->Next;
+
+    SyncWaiter* last = busyObjects.back();
+    busyObjects[waiter->Index] = last;
+    last->Index = waiter->Index;
+    busyObjects.pop_back();
+
+    waiter->Obj = NULL;
+    waiter->Next = NULL;
+    freeWaiters.push_back( waiter );
+}
+
+void SyncManager::PickObject( SyncObject* obj )
+{
+    // Previous owner relock object after resuming
+    SyncManager* mngr = obj->curMngr;
+    mngr->EraseLocked( obj );
+    mngr->AddBusy( obj );
+    AddLocked( obj );
+    SyncStats[obj->objType].Steals++;
+}
+
+void SyncManager::WakeUpStealers()
+{
+    // Objects of waiting thread can be picked by threads with same or higher priority
+    for( auto it = lockedObjects.begin(), end = lockedObjects.end(); it != end; ++it )
+    {
+        SyncObject* obj = *it;
+        if( obj->waiters )
+            obj->WakeUpWaiters();
+    }
+}
+
+void SyncManager::WaitBusyObjects( int obj_type )
+{
+    // Must be called with locked SyncLocker, unlocks it before return
+    isWaiting = true;
+    WakeUpStealers();
+
+    uint wait_tick = Timer::FastTick();
+    bool parked = false;
+
+    // Wait and try lock all busy objects
+    while( true )
+    {
+        for( uint i = 0; i < (uint)busyObjects.size();)
+        {
+            SyncWaiter* waiter = busyObjects[i];
+            SyncObject* obj = waiter->Obj;
+            if( !obj->curMngr )
+            {
+                // Object free
+                EraseBusy( waiter );
+                AddLocked( obj );
+            }
+            else if( obj->curMngr->isWaiting && threadPriority >= obj->curMngr->threadPriority )
+            {
+                // Pick from waiting thread
+                EraseBusy( waiter );
+                PickObject( obj );
+            }
+            else
+            {
+                // Object busy
+                i++;
+            }
+        }
+
+        if( busyObjects.empty() )
+            break;
+
+        // Sleep until one of busy objects released or its owner goes to wait state
+        waitEvent.Disallow();
+        SyncLocker.Unlock();
+        waitEvent.Wait();
+        SyncLocker.Lock();
+        parked = true;
+    }
+
+    isWaiting = false;
+
+    if( parked )
+    {
+        SyncStatistics& stats = SyncStats[obj_type];
+        uint            wait_time = Timer::FastTick() - wait_tick;
+        stats.Waits++;
+        stats.WaitTime += wait_time;
+        if( wait_time > stats.WaitTimeMax )
+            stats.WaitTimeMax = wait_time;
+    }
+
+    SyncLocker.Unlock();
 }
 
 void SyncManager::PushPriority( int priority )
@@ -173,6 +290,9 @@ void SyncManager::UnlockAll()
     {
         SyncObject* obj = *it;
         obj->curMngr = NULL;
+        obj->lockIndex = 0;
+        if( obj->waiters )
+            obj->WakeUpWaiters();
     }
     lockedObjects.clear();
 }
@@ -185,6 +305,7 @@ void SyncManager::Suspend()
     SCOPE_LOCK( SyncLocker );
 
     isWaiting = true;
+    WakeUpStealers();
 }
 
 void SyncManager::Resume()
@@ -196,23 +317,11 @@ void SyncManager::Resume()
 
     isWaiting = false;
 
+    // Relock objects picked by other threads
     if( !busyObjects.empty() )
-    {
-        SyncObjectVec busy_objs = busyObjects;
-        busyObjects.clear();
-
-        SyncLocker.Unlock();
-
-        for( auto it = busy_objs.begin(), end = busy_objs.end(); it != end; ++it )
-        {
-            SyncObject* obj = *it;
-            obj->Lock();
-        }
-    }
+        WaitBusyObjects( busyObjects[0]->Obj->objType );
     else
-    {
         SyncLocker.Unlock();
-    }
 }
 
 SyncManager* SyncManager::GetForCurThread()
@@ -223,7 +332,33 @@ SyncManager* SyncManager::GetForCurThread()
         sync_mngr = new SyncManager();
         if( !sync_mngr )
             return NULL;
+        SCOPE_LOCK( SyncLocker );
         Managers.push_back( sync_mngr );
     }
     return sync_mngr;
 }
+
+void SyncManager::GetStatistics( SyncStatistics* stats )
+{
+    SCOPE_LOCK( SyncLocker );
+
+    memcpy( stats, SyncStats, sizeof(SyncStats) );
+}
+
+string SyncManager::GetStatisticsString()
+{
+    static const char* type_names[SYNC_OBJECT_COUNT] = { "Other", "Critter", "Map", "Item", "Location", "Var" };
+
+    SyncStatistics stats[SYNC_OBJECT_COUNT];
+    GetStatistics( stats );
+
+    char   str[MAX_FOTEXT];
+    string result = "Synchronization contention\n";
+    result += "Type       Contentions Steals      Waits       WaitTime    WaitMax\n";
+    for( int i = 0; i < SYNC_OBJECT_COUNT; i++ )
+    {
+        SyncStatistics& s = stats[i];
+        result += Str::Format( str, "%-10s %-11u %-11u %-11u %-11u %-11u\n", type_names[i], s.Contentions, s.Steals, s.Waits, s.WaitTime, s.WaitTimeMax );
+    }
+    return result;
+}
@@ -1,23 +1,51 @@
 #ifndef __THREAD_SYNC__
 #define __THREAD_SYNC__
 
+#include "Mutex.h"
 #include "Types.h"
 
-#define SYNC_LOCK( obj )    (obj)->Sync.Lock()
+// Locked objects can be changed by owner thread, they are reported to world journal
+#define SYNC_LOCK( obj )    ( (obj)->Sync.Lock(), (obj)->SetJournalDirty() )
+
+// Synchronization object types, for contention statistics
+#define SYNC_OBJECT_OTHER       (0)
+#define SYNC_OBJECT_CRITTER     (1)
+#define SYNC_OBJECT_MAP         (2)
+#define SYNC_OBJECT_ITEM        (3)
+#define SYNC_OBJECT_LOCATION    (4)
+#define SYNC_OBJECT_VAR         (5)
+#define SYNC_OBJECT_COUNT       (6)
 
 class SyncObject;
 class SyncManager;
+struct SyncWaiter;
 typedef vector<SyncObject*>  SyncObjectVec;
 typedef vector<SyncManager*> SyncManagerVec;
+typedef vector<SyncWaiter*>  SyncWaiterVec;
+
+struct SyncStatistics
+{
+    uint Contentions; // Lock calls on object locked by another thread
+    uint Steals;      // Objects picked from waiting threads
+    uint Waits;       // Threads parked until object release
+    uint WaitTime;    // Total time in parked state, ms
+    uint WaitTimeMax;
+};
 
 class SyncObject
 {
 private:
     friend class SyncManager;
     SyncManager* curMngr;
+    uint         lockIndex; // Index in owner locked objects
+    SyncWaiter*  waiters;   // Threads which wait for object
+    int          objType;
+
+    void WakeUpWaiters();
 
 public:
     SyncObject();
+    void SetType( int type );
     void Lock();
     void Unlock();
 };
@@ -29,8 +57,18 @@ private:
     volatile bool isWaiting;
     volatile int  threadPriority;
     SyncObjectVec lockedObjects;
-    SyncObjectVec busyObjects;
+    SyncWaiterVec busyObjects;
+    SyncWaiterVec freeWaiters;
     IntVec        priorityStack;
+    MutexEvent    waitEvent;
+
+    void AddLocked( SyncObject* obj );
+    void EraseLocked( SyncObject* obj );
+    void AddBusy( SyncObject* obj );
+    void EraseBusy( SyncWaiter* waiter );
+    void PickObject( SyncObject* obj );
+    void WakeUpStealers();
+    void WaitBusyObjects( int obj_type );
 
 public:
     SyncManager();
@@ -43,6 +81,9 @@ public:
 
     static SyncManagerVec Managers;
     static SyncManager* GetForCurThread();
+
+    static void   GetStatistics( SyncStatistics* stats );
+    static string GetStatisticsString();
 };
 
 #endif // __THREAD_SYNC__
@@ -0,0 +1,299 @@
+#include "Core.h"
+
+#include "FileManager.h"
+#include "FileSystem.h"
+#include "Log.h"
+#include "Mutex.h"
+#include "Text.h"
+#include "Thread.h"
+#include "Timer.h"
+#include "Tracer.h"
+
+struct TraceEvent
+{
+    uint64 Start;
+    uint   Duration;
+    uint   Zone;
+};
+
+struct TraceHistogram
+{
+    uint   Count;
+    uint   Max;
+    uint64 Total;
+    uint   Buckets[TRACE_BUCKETS];
+};
+
+// Written only by owner thread, Written counter is published after event
+struct TraceThread
+{
+    uint           ThreadId;
+    char           Name[64];
+    volatile long  Written;
+    TraceEvent     Events[TRACE_RING_SIZE];
+    TraceHistogram Zones[TRACE_ZONE_COUNT];
+};
+typedef vector<TraceThread*> TraceThreadVec;
+
+static Mutex          TraceThreadsLocker;
+static TraceThreadVec TraceThreads;
+static THREAD TraceThread* CurTraceThread = NULL;
+
+static const char* ZoneNames[TRACE_ZONE_COUNT] =
+{
+    "Nop", "Client", "Critter", "Map", "TimeEvents", "GarbageItems", "GarbageCritters", "GarbageLocations", "GarbageScript",
+    "GarbageVars", "DeferredRelease", "GameTime", "Bans", "LoopScript", "ThreadLoop", "ThreadSynchronize", "ThreadFinish",
+    "ProcessCritter", "NetInput", "NetOutput", "UserLogin", "VisibleCritters", "VisibleItems", "FindPath", "GlobalProcess", "SaveWorld"
+};
+
+static uint GetBucket( uint value )
+{
+    if( value < 8 )
+        return value;
+
+    uint msb = 3;
+    while( msb < 31 && value >> (msb + 1) )
+        msb++;
+    return 8 + (msb - 3) * 8 + ( (value >> (msb - 3) ) & 7 );
+}
+
+// Upper bound of bucket values
+static uint GetBucketValue( uint bucket )
+{
+    if( bucket < 8 )
+        return bucket;
+
+    uint shift = (bucket - 8) / 8;
+    uint sub = (bucket - 8) % 8;
+    return ( (8 + sub + 1) << shift ) - 1;
+}
+
+static TraceThread* RegisterThread()
+{
+    TraceThread* t = new TraceThread();
+    if( !t )
+        return NULL;
+
+    memzero( t, sizeof(TraceThread) );
+    t->ThreadId = Thread::GetCurrentId();
+    Str::Copy( t->Name, Thread::GetCurrentName() );
+
+    SCOPE_LOCK( TraceThreadsLocker );
+    TraceThreads.push_back( t );
+    CurTraceThread = t;
+    return t;
+}
+
+uint64 Tracer::Now()
+{
+    return (uint64)(Timer::AccurateTick() * 1000.0);
+}
+
+void Tracer::Add( int zone, uint64 start )
+{
+    if( zone < 0 || zone >= TRACE_ZONE_COUNT )
+        return;
+
+    TraceThread* t = CurTraceThread;
+    if( !t && !(t = RegisterThread() ) )
+        return;
+
+    uint64 now = Now();
+    uint   duration = (now > start ? (uint)MIN( now - start, (uint64)MAX_UINT ) : 0);
+
+    TraceHistogram& h = t->Zones[zone];
+    h.Count++;
+    h.Total += duration;
+    if( duration > h.Max )
+        h.Max = duration;
+    h.Buckets[GetBucket( duration )]++;
+
+    TraceEvent& e = t->Events[(uint)t->Written & (TRACE_RING_SIZE - 1)];
+    e.Start = start;
+    e.Duration = duration;
+    e.Zone = zone;
+    InterlockedIncrement( &t->Written );
+}
+
+const char* Tracer::GetZoneName( int zone )
+{
+    return zone >= 0 && zone < TRACE_ZONE_COUNT ? ZoneNames[zone] : "Unknown";
+}
+
+void Tracer::GetStatistics( TraceZoneStatistics* stats )
+{
+    SCOPE_LOCK( TraceThreadsLocker );
+
+    uint buckets[TRACE_BUCKETS];
+    for( int zone = 0; zone < TRACE_ZONE_COUNT; zone++ )
+    {
+        TraceZoneStatistics& s = stats[zone];
+        memzero( &s, sizeof(s) );
+        memzero( buckets, sizeof(buckets) );
+
+        // Merge threads, counters may be behind by few events
+        for( auto it = TraceThreads.begin(), end = TraceThreads.end(); it != end; ++it )
+        {
+            TraceHistogram& h = (*it)->Zones[zone];
+            s.Count += h.Count;
+            s.Total += h.Total;
+            s.Max = MAX( s.Max, h.Max );
+            for( uint i = 0; i < TRACE_BUCKETS; i++ )
+                buckets[i] += h.Buckets[i];
+        }
+        if( !s.Count )
+            continue;
+
+        uint64 total = 0;
+        for( uint i = 0; i < TRACE_BUCKETS; i++ )
+            total += buckets[i];
+
+        uint64 sum = 0;
+        for( uint i = 0; i < TRACE_BUCKETS && sum * 100 < total * 99; i++ )
+        {
+            sum += buckets[i];
+            if( !s.P50 && sum * 2 >= total )
+                s.P50 = MIN( GetBucketValue( i ), s.Max );
+            if( sum * 100 >= total * 99 )
+                s.P99 = MIN( GetBucketValue( i ), s.Max );
+        }
+    }
+}
+
+string Tracer::GetStatisticsString()
+{
+    if( !LatencyProfiler )
+        return "Latency profiler: disabled\n";
+
+    TraceZoneStatistics stats[TRACE_ZONE_COUNT];
+    GetStatistics( stats );
+
+    char   str[MAX_FOTEXT];
+    string result = "Latency profiler, microseconds\n";
+    result += "Zone              Count       Avg         P50         P99         Max\n";
+    for( int i = 0; i < TRACE_ZONE_COUNT; i++ )
+    {
+        TraceZoneStatistics& s = stats[i];
+        if( s.Count )
+            result += Str::Format( str, "%-17s %-11u %-11u %-11u %-11u %-11u\n", ZoneNames[i], s.Count, (uint)(s.Total / s.Count), s.P50, s.P99, s.Max );
+    }
+    return result;
+}
+
+// Rings are copied by caller, json is formatted and written by export thread in chunks
+struct TraceExportThread
+{
+    uint               ThreadId;
+    char               Name[64];
+    vector<TraceEvent> Events;
+};
+typedef vector<TraceExportThread> TraceExportThreadVec;
+
+#define TRACE_EXPORT_CHUNK    (0x10000)
+
+static Thread               ExportThread;
+static volatile long        ExportActive = 0;
+static string               ExportFileName;
+static TraceExportThreadVec ExportThreads;
+
+static bool ExportWrite( void* f, string& chunk, bool flush )
+{
+    if( chunk.length() < TRACE_EXPORT_CHUNK && !flush )
+        return true;
+
+    bool ok = FileWrite( f, chunk.c_str(), (uint)chunk.length() );
+    chunk.clear();
+    return ok;
+}
+
+static void ExportWork( void* )
+{
+    void* f = FileOpen( ExportFileName.c_str(), true );
+    if( f )
+    {
+        char   str[MAX_FOTEXT];
+        string chunk = "{\"traceEvents\":[\n";
+        chunk.reserve( TRACE_EXPORT_CHUNK + MAX_FOTEXT );
+        bool   ok = true;
+        bool   first = true;
+        for( auto it = ExportThreads.begin(), end = ExportThreads.end(); it != end && ok; ++it )
+        {
+            TraceExportThread& t = *it;
+            chunk += Str::Format( str, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", t.ThreadId, t.Name );
+            first = false;
+
+            for( auto it_ = t.Events.begin(), end_ = t.Events.end(); it_ != end_ && ok; ++it_ )
+            {
+                TraceEvent& e = *it_;
+                chunk += Str::Format( str, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%u}",
+                                      Tracer::GetZoneName( e.Zone ), e.Zone < JOB_COUNT ? "job" : "zone", e.Start, e.Duration, t.ThreadId );
+                ok = ExportWrite( f, chunk, false );
+            }
+        }
+        chunk += "\n]}\n";
+        ok = ok && ExportWrite( f, chunk, true );
+        FileClose( f );
+
+        if( !ok )
+            WriteLogF( _FUNC_, " - Can't write trace file<%s>.\n", ExportFileName.c_str() );
+    }
+    else
+    {
+        WriteLogF( _FUNC_, " - Can't create trace file<%s>.\n", ExportFileName.c_str() );
+    }
+
+    TraceExportThreadVec().swap( ExportThreads );
+    InterlockedExchange( &ExportActive, 0 );
+}
+
+bool Tracer::ExportChromeTrace( string& fname )
+{
+    // Previous export is still written
+    fname.clear();
+    if( InterlockedCompareExchange( &ExportActive, 1, 0 ) != 0 )
+        return false;
+    ExportThread.Wait();
+
+    TraceThreadVec threads;
+    TraceThreadsLocker.Lock();
+    threads = TraceThreads;
+    TraceThreadsLocker.Unlock();
+
+    DateTime dt;
+    Timer::GetCurrentDateTime( dt );
+
+    char path[MAX_FOPATH];
+    FileManager::GetFullPath( NULL, PATH_SERVER_PROFILER, path );
+    FileManager::CreateDirectoryTree( path );
+
+    char str[MAX_FOTEXT];
+    fname = Str::Format( str, "%sFOnlineServer_Trace_%04u.%02u.%02u_%02u-%02u-%02u.json", path, dt.Year, dt.Month, dt.Day, dt.Hour, dt.Minute, dt.Second );
+    ExportFileName = fname;
+
+    ExportThreads.resize( threads.size() );
+    for( uint i = 0; i < (uint)threads.size(); i++ )
+    {
+        TraceThread*       t = threads[i];
+        TraceExportThread& et = ExportThreads[i];
+        et.ThreadId = t->ThreadId;
+        Str::Copy( et.Name, t->Name );
+
+        // Copy ring while owner writes, then drop events which could be overwritten during copy
+        uint written = (uint)t->Written;
+        uint count = MIN( written, (uint)TRACE_RING_SIZE );
+        et.Events.resize( count );
+        for( uint j = 0; j < count; j++ )
+            et.Events[j] = t->Events[(written - count + j) & (TRACE_RING_SIZE - 1)];
+        uint lost = (uint)t->Written - written + 1;
+        uint skip = (count + lost > TRACE_RING_SIZE ? MIN( count + lost - TRACE_RING_SIZE, count ) : 0);
+        et.Events.erase( et.Events.begin(), et.Events.begin() + skip );
+    }
+
+    if( !ExportThread.Start( ExportWork, "TraceExport" ) )
+    {
+        TraceExportThreadVec().swap( ExportThreads );
+        InterlockedExchange( &ExportActive, 0 );
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef __TRACER__
+#define __TRACER__
+
+#include "Jobs.h"
+#include "Types.h"
+
+extern bool LatencyProfiler; // ConfigFile.h
+
+// Trace zones, first zones are job types of logic threads
+#define TRACE_PROCESS_CRITTER     (JOB_COUNT + 0)
+#define TRACE_NET_INPUT           (JOB_COUNT + 1)
+#define TRACE_NET_OUTPUT          (JOB_COUNT + 2)
+#define TRACE_USER_LOGIN          (JOB_COUNT + 3)
+#define TRACE_VISIBLE_CRITTERS    (JOB_COUNT + 4)
+#define TRACE_VISIBLE_ITEMS       (JOB_COUNT + 5)
+#define TRACE_FIND_PATH           (JOB_COUNT + 6)
+#define TRACE_GLOBAL_PROCESS      (JOB_COUNT + 7)
+#define TRACE_SAVE_WORLD          (JOB_COUNT + 8)
+#define TRACE_ZONE_COUNT          (JOB_COUNT + 9)
+
+// Last events of each thread, power of two
+#define TRACE_RING_SIZE           (0x10000)
+
+// Latency histogram, 8 buckets per power of two of microseconds
+#define TRACE_BUCKETS             (240)
+
+struct TraceZoneStatistics
+{
+    uint   Count;
+    uint   Max;
+    uint64 Total;
+    uint   P50;
+    uint   P99;
+};
+
+// Scoped timers of server hot paths
+// Each thread writes own ring buffer of last events and own histograms, without locks
+// Readers merge histograms and copy rings while threads keep writing
+class Tracer
+{
+public:
+    static uint64 Now();
+    static void   Add( int zone, uint64 start );
+
+    static const char* GetZoneName( int zone );
+    static void        GetStatistics( TraceZoneStatistics* stats );
+    static string      GetStatisticsString();
+    static bool        ExportChromeTrace( string& fname ); // Copies rings and starts background writer, empty name if previous export still runs
+};
+
+class TraceScope
+{
+private:
+    int    traceZone;
+    uint64 traceStart;
+
+public:
+    TraceScope( int zone ) : traceZone( zone ), traceStart( LatencyProfiler ? Tracer::Now() : 0 ) {}
+    ~TraceScope()
+    {
+        if( traceStart )
+            Tracer::Add( traceZone, traceStart );
+    }
+};
+
+#define TRACE_SCOPE( zone )       TraceScope trace_scope( zone )
+
+#endif // __TRACER__
@@ -41,7 +41,17 @@ bool VarManager::Init( const char* fpath )
 }
 
 #ifdef FOCLASSIC_SERVER
-void VarManager::SaveVarsDataFile( void (*save_func)( void*, size_t ) )
+static void SaveVarRecord( GameVar* var, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    if( record_func )
+        record_func();
+    save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
+    save_func( &var->MasterId, sizeof(var->MasterId) );
+    save_func( &var->SlaveId, sizeof(var->SlaveId) );
+    save_func( &var->VarValue, sizeof(var->VarValue) );
+}
+
+void VarManager::SaveVarsDataFile( void (*save_func)( void*, size_t ), void (*record_func)() )
 {
     save_func( &varsCount, sizeof(varsCount) );
     for( auto it = tempVars.begin(), end = tempVars.end(); it != end; ++it )
@@ -50,23 +60,45 @@ void VarManager::SaveVarsDataFile( void (*save_func)( void*, size_t ) )
         if( tvar )
         {
             for( auto it_ = tvar->Vars.begin(), end_ = tvar->Vars.end(); it_ != end_; ++it_ )
-            {
-                GameVar* var = (*it_).second;
-                save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
-                save_func( &var->MasterId, sizeof(var->MasterId) );
-                save_func( &var->SlaveId, sizeof(var->SlaveId) );
-                save_func( &var->VarValue, sizeof(var->VarValue) );
-            }
+                SaveVarRecord( (*it_).second, save_func, record_func );
             for( auto it_ = tvar->VarsUnicum.begin(), end_ = tvar->VarsUnicum.end(); it_ != end_; ++it_ )
-            {
-                GameVar* var = (*it_).second;
-                save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
-                save_func( &var->MasterId, sizeof(var->MasterId) );
-                save_func( &var->SlaveId, sizeof(var->SlaveId) );
-                save_func( &var->VarValue, sizeof(var->VarValue) );
-            }
+                SaveVarRecord( (*it_).second, save_func, record_func );
+        }
+    }
+}
+
+void VarManager::SaveVarsRecords( const WorldJournalKeyVec& keys, void (*save_func)( void*, size_t ), void (*record_func)() )
+{
+    // Erased vars are missed, journal writes erase records for them
+    VarsVec vars;
+    vars.reserve( keys.size() );
+    for( auto it = keys.begin(), end = keys.end(); it != end; ++it )
+    {
+        TemplateVar* tvar = GetTemplateVar( it->KeyHi );
+        if( !tvar )
+            continue;
+
+        GameVar* var = NULL;
+        if( tvar->IsNotUnicum() )
+        {
+            auto it_var = tvar->Vars.find( (uint)it->Key );
+            if( it_var != tvar->Vars.end() )
+                var = (*it_var).second;
         }
+        else
+        {
+            auto it_var = tvar->VarsUnicum.find( it->Key );
+            if( it_var != tvar->VarsUnicum.end() )
+                var = (*it_var).second;
+        }
+        if( var && var->GetUid() == it->Key )
+            vars.push_back( var );
     }
+
+    uint count = (uint)vars.size();
+    save_func( &count, sizeof(count) );
+    for( auto it = vars.begin(), end = vars.end(); it != end; ++it )
+        SaveVarRecord( *it, save_func, record_func );
 }
 
 bool VarManager::LoadVarsDataFile( void* f, int version )
@@ -785,6 +817,18 @@ void VarManager::SwapVars( uint id1, uint id2 )
         }
     }
     varsLocker.Unlock();
+
+    // Report new keys, old ones are reported by lock
+    VarsVec swapped_vars;
+    swapped_vars.insert( swapped_vars.end(), swap_vars1.begin(), swap_vars1.end() );
+    swapped_vars.insert( swapped_vars.end(), swap_vars2.begin(), swap_vars2.end() );
+    swapped_vars.insert( swapped_vars.end(), swap_vars_share.begin(), swap_vars_share.end() );
+    for( auto it = swapped_vars.begin(), end = swapped_vars.end(); it != end; ++it )
+    {
+        GameVar* var = *it;
+        var->JournalGen = 0;
+        var->SetJournalDirty();
+    }
 }
 
 uint VarManager::ClearUnusedVars( UIntSet& ids1, UIntSet& ids2, UIntSet& ids_locs, UIntSet& ids_maps, UIntSet& ids_items )
@@ -943,9 +987,10 @@ void SendQuestVar( GameVar* var )
 }
 
 GameVar::GameVar( uint master_id, uint slave_id, TemplateVar* var_template, int val ) : MasterId( master_id ), SlaveId( slave_id ), VarTemplate( var_template ), QuestVarIndex( 0 ),
-    Type( var_template->Type ), VarValue( val ), RefCount( 1 )
+    Type( var_template->Type ), VarValue( val ), RefCount( 1 ), JournalGen( 0 )
 {
     MEMORY_PROCESS( MEMORY_VAR, sizeof(GameVar) );
+    Sync.SetType( SYNC_OBJECT_VAR );
 }
 
 GameVar::~GameVar()
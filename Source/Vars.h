@@ -6,6 +6,10 @@
 #include "ThreadSync.h"
 #include "Types.h"
 
+#ifdef FOCLASSIC_SERVER
+# include "WorldJournal.h"
+#endif
+
 #define VAR_NAME_LEN                  (256)
 #define VAR_DESC_LEN                  (2048)
 #define VAR_FNAME_VARS                "_vars.fos"
@@ -58,6 +62,7 @@ public:
     ushort       Type;
     short        RefCount;
     SyncObject   Sync;
+    uint         JournalGen; // Generation of last change report to world journal
 
     GameVar& operator+=( const int _right );
     GameVar& operator-=( const int _right );
@@ -101,6 +106,15 @@ public:
     uint         GetMasterId()    { return MasterId; }
     uint         GetSlaveId()     { return SlaveId; }
 
+    void SetJournalDirty()
+    {
+        if( JournalGen != WorldJournal::DirtyGeneration )
+        {
+            JournalGen = WorldJournal::DirtyGeneration;
+            WorldJournal::SetDirty( WORLD_SECTION_VARS, VarTemplate->TempId, GetUid() );
+        }
+    }
+
     void AddRef()  { RefCount++; }
     void Release() { if( !--RefCount ) delete this; }
 
@@ -152,7 +166,8 @@ public:
 
     #ifdef FOCLASSIC_SERVER
 public:
-    void     SaveVarsDataFile( void (* save_func)( void*, size_t ) );
+    void     SaveVarsDataFile( void (* save_func)( void*, size_t ), void (* record_func)() = NULL );
+    void     SaveVarsRecords( const WorldJournalKeyVec& keys, void (* save_func)( void*, size_t ), void (* record_func)() = NULL ); // Delta save, only given vars
     bool     LoadVarsDataFile( void* f, int version );
     bool     CheckVar( const char* var_name, uint master_id, uint slave_id, char oper, int val );
     bool     CheckVar( ushort temp_id, uint master_id, uint slave_id, char oper, int val );
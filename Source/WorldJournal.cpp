@@ -0,0 +1,905 @@
+#include "Core.h"
+
+#include "Crypt.h"
+#include "FileSystem.h"
+#include "Log.h"
+#include "Map.h"
+#include "Mutex.h"
+#include "Server.h"
+#include "Text.h"
+#include "Timer.h"
+#include "WorldJournal.h"
+
+#define WORLD_JOURNAL_BLOCK_MAGIC    (0x424A4F46) // FOJB
+
+BINARY_SIGNATURE( WorldJournalSignature, BINARY_TYPE_WORLDJOURNAL, WORLD_JOURNAL_LAST );
+
+// Key and content hash of record from previous save
+struct RecordState: public WorldJournalKey
+{
+    uint Hash;
+};
+typedef vector<RecordState> RecordStateVec;
+
+// Save data is only copied while logic threads are paused, hashing and diff are done after resume
+struct CapturedRecord
+{
+    int    Section;
+    bool   SectionBegin;
+    size_t Offset;
+    uint   Len;
+};
+typedef vector<CapturedRecord> CapturedRecordVec;
+
+static bool                   SaveActive = false;
+static bool                   SaveDelta = false;
+static bool                   StateValid = false;
+static bool                   KeyError = false;
+static int                    CurSection = -1;
+static RecordStateVec         SectionState[WORLD_SECTION_COUNT];
+static uint                   SectionHash[WORLD_SECTION_COUNT];
+static RecordStateVec         NewState;
+static BoolVec                StateFound;
+static bool                   SavePending = false;
+static bool                   RecordOpen = false;
+static UCharVec               Capture;
+static CapturedRecordVec      Captured;
+static UCharVec               Block;
+static WorldJournalStatistics Stats;
+
+// Changes reported between saves, moved to save lists when save begins
+volatile uint                 WorldJournal::DirtyGeneration = 0;
+static MutexSpinlock          DirtyLocker;
+static WorldJournalKeyVec     DirtyKeys[WORLD_SECTION_COUNT];
+static bool                   DirtySections[WORLD_SECTION_COUNT];
+static WorldJournalKeyVec     SaveDirtyKeys[WORLD_SECTION_COUNT];
+static bool                   SaveDirtySections[WORLD_SECTION_COUNT];
+static uint                   SaveDirtyCount = 0;
+static WorldJournalKeyVec     SavedKeys;
+
+static bool IsKeyedSection( int section )
+{
+    return section == WORLD_SECTION_LOCATIONS || section == WORLD_SECTION_CRITTERS ||
+           section == WORLD_SECTION_ITEMS || section == WORLD_SECTION_VARS;
+}
+
+static uint HashData( const uchar* data, uint len )
+{
+    // Murmur3 mixing, processed by words
+    uint h = len;
+    uint words = len / 4;
+    for( uint i = 0; i < words; i++ )
+    {
+        uint k;
+        memcpy( &k, data + i * 4, sizeof(k) );
+        k *= 0xCC9E2D51;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1B873593;
+        h ^= k;
+        h = (h << 13) | (h >> 19);
+        h = h * 5 + 0xE6546B64;
+    }
+
+    uint tail = 0;
+    for( uint i = words * 4; i < len; i++ )
+        tail = (tail << 8) | data[i];
+    h ^= tail * 0xCC9E2D51;
+
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return h;
+}
+
+static bool GetRecordKey( int section, const uchar* data, uint len, RecordState& key )
+{
+    if( section == WORLD_SECTION_VARS )
+    {
+        ushort temp_id;
+        uint   master_id, slave_id;
+        if( len < sizeof(temp_id) + sizeof(master_id) + sizeof(slave_id) )
+            return false;
+        memcpy( &temp_id, data, sizeof(temp_id) );
+        memcpy( &master_id, data + sizeof(temp_id), sizeof(master_id) );
+        memcpy( &slave_id, data + sizeof(temp_id) + sizeof(master_id), sizeof(slave_id) );
+        key.KeyHi = temp_id;
+        key.Key = ( ( (uint64)slave_id ) << 32 ) | ( (uint64)master_id );
+        return true;
+    }
+
+    uint id;
+    if( len < sizeof(id) )
+        return false;
+    memcpy( &id, data, sizeof(id) );
+    key.KeyHi = 0;
+    key.Key = id;
+    return true;
+}
+
+static void EmitRecord( uchar type, int section, const void* data, uint len )
+{
+    size_t pos = Block.size();
+    Block.resize( pos + sizeof(uchar) * 2 + sizeof(uint) + len );
+    uchar* ptr = &Block[pos];
+    *ptr++ = type;
+    *ptr++ = (uchar)section;
+    memcpy( ptr, &len, sizeof(len) );
+    if( len )
+        memcpy( ptr + sizeof(len), data, len );
+}
+
+static void EmitErase( int section, const RecordState& state )
+{
+    uchar key[sizeof(uint) + sizeof(uint64)];
+    memcpy( key, &state.KeyHi, sizeof(uint) );
+    memcpy( key + sizeof(uint), &state.Key, sizeof(uint64) );
+    EmitRecord( WORLD_JOURNAL_ERASE, section, key, sizeof(key) );
+    Stats.Erases++;
+}
+
+static void FinishRecord( const uchar* data, uint len )
+{
+    RecordState cur;
+    if( !GetRecordKey( CurSection, data, len, cur ) )
+    {
+        KeyError = true;
+        return;
+    }
+    cur.Hash = HashData( data, len );
+    Stats.Records++;
+
+    // Compare with state of previous save, sorted by key
+    RecordStateVec& prev = SectionState[CurSection];
+    auto            it = std::lower_bound( prev.begin(), prev.end(), cur );
+    bool            found = (it != prev.end() && *it == cur);
+    bool            changed = (!found || it->Hash != cur.Hash);
+
+    // Delta saves see only reported records, state is updated in place and new records are merged by FinishSection
+    if( SaveDelta )
+    {
+        SavedKeys.push_back( cur );
+        if( found )
+            it->Hash = cur.Hash;
+        else
+            NewState.push_back( cur );
+    }
+    else
+    {
+        if( found )
+            StateFound[it - prev.begin()] = true;
+        NewState.push_back( cur );
+    }
+
+    if( SaveDelta && changed )
+    {
+        EmitRecord( WORLD_JOURNAL_UPSERT, CurSection, data, len );
+        Stats.Upserts++;
+    }
+}
+
+static void BeginSectionState( int section )
+{
+    CurSection = section;
+    NewState.clear();
+    if( SaveDelta )
+    {
+        SavedKeys.clear();
+    }
+    else
+    {
+        StateFound.assign( SectionState[section].size(), false );
+        NewState.reserve( SectionState[section].size() + 100 );
+    }
+}
+
+static void FinishSection( const uchar* data, uint len )
+{
+    if( CurSection < 0 )
+        return;
+
+    if( IsKeyedSection( CurSection ) && SaveDelta )
+    {
+        // Reported records which are not saved are erased
+        RecordStateVec&     prev = SectionState[CurSection];
+        WorldJournalKeyVec& dirty = SaveDirtyKeys[CurSection];
+        uint                erased = 0;
+        std::sort( SavedKeys.begin(), SavedKeys.end() );
+        for( uint i = 1; i < (uint)SavedKeys.size(); i++ )
+            if( SavedKeys[i - 1] == SavedKeys[i] )
+                KeyError = true;
+        for( auto it = dirty.begin(), end = dirty.end(); it != end; ++it )
+        {
+            if( std::binary_search( SavedKeys.begin(), SavedKeys.end(), *it ) )
+                continue;
+
+            RecordState key;
+            key.KeyHi = it->KeyHi;
+            key.Key = it->Key;
+            auto it_prev = std::lower_bound( prev.begin(), prev.end(), key );
+            if( it_prev != prev.end() && *it_prev == key )
+            {
+                EmitErase( CurSection, *it_prev );
+                it_prev->Hash = 0;
+                it_prev->KeyHi = uint( -1 );
+                erased++;
+            }
+        }
+
+        // Erased records are moved to end by sort
+        if( erased || !NewState.empty() )
+        {
+            prev.insert( prev.end(), NewState.begin(), NewState.end() );
+            std::sort( prev.begin(), prev.end() );
+            prev.resize( prev.size() - erased );
+        }
+        NewState.clear();
+        SavedKeys.clear();
+    }
+    else if( IsKeyedSection( CurSection ) )
+    {
+        RecordStateVec& prev = SectionState[CurSection];
+        std::sort( NewState.begin(), NewState.end() );
+        for( uint i = 1; i < (uint)NewState.size(); i++ )
+            if( NewState[i - 1] == NewState[i] )
+                KeyError = true;
+
+        prev.swap( NewState );
+        NewState.clear();
+    }
+    else
+    {
+        uint hash = HashData( data, len );
+        if( SaveDelta && hash != SectionHash[CurSection] )
+        {
+            EmitRecord( WORLD_JOURNAL_SECTION, CurSection, data, len );
+            Stats.Sections++;
+        }
+        SectionHash[CurSection] = hash;
+    }
+
+    CurSection = -1;
+}
+
+void WorldJournal::SetTracking( bool enabled )
+{
+    SCOPE_LOCK( DirtyLocker );
+
+    DirtyGeneration = (enabled ? 1 : 0);
+    for( int i = 0; i < WORLD_SECTION_COUNT; i++ )
+    {
+        DirtyKeys[i].clear();
+        DirtySections[i] = false;
+    }
+}
+
+void WorldJournal::SetDirty( int section, uint key_hi, uint64 key )
+{
+    if( section < 0 || section >= WORLD_SECTION_COUNT )
+        return;
+
+    SCOPE_LOCK( DirtyLocker );
+
+    WorldJournalKey k = { key_hi, key };
+    DirtyKeys[section].push_back( k );
+}
+
+void WorldJournal::SetSectionDirty( int section )
+{
+    if( section >= 0 && section < WORLD_SECTION_COUNT )
+        DirtySections[section] = true;
+}
+
+bool WorldJournal::IsSectionDirty( int section )
+{
+    return section >= 0 && section < WORLD_SECTION_COUNT && SaveDirtySections[section];
+}
+
+void WorldJournal::GetDirtyIds( int section, UIntVec& ids )
+{
+    ids.clear();
+    if( section < 0 || section >= WORLD_SECTION_COUNT )
+        return;
+
+    WorldJournalKeyVec& keys = SaveDirtyKeys[section];
+    ids.reserve( keys.size() );
+    for( auto it = keys.begin(), end = keys.end(); it != end; ++it )
+        ids.push_back( (uint)it->Key );
+}
+
+void WorldJournal::GetDirtyKeys( int section, WorldJournalKeyVec& keys )
+{
+    keys.clear();
+    if( section >= 0 && section < WORLD_SECTION_COUNT )
+        keys = SaveDirtyKeys[section];
+}
+
+void WorldJournal::BeginSave( bool delta )
+{
+    SaveActive = true;
+    SavePending = false;
+    SaveDelta = (delta && StateValid);
+    CurSection = -1;
+    RecordOpen = false;
+
+    // Changes reported until now belong to this save, next reports start new generation
+    {
+        SCOPE_LOCK( DirtyLocker );
+
+        SaveDirtyCount = 0;
+        for( int i = 0; i < WORLD_SECTION_COUNT; i++ )
+        {
+            WorldJournalKeyVec& keys = SaveDirtyKeys[i];
+            keys.clear();
+            keys.swap( DirtyKeys[i] );
+            std::sort( keys.begin(), keys.end() );
+            keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+            SaveDirtyCount += (uint)keys.size();
+            SaveDirtySections[i] = DirtySections[i];
+            DirtySections[i] = false;
+        }
+        if( DirtyGeneration && !++DirtyGeneration )
+            DirtyGeneration = 1;
+    }
+
+    // Keep capacity, buffers are filled in logic threads pause
+    Capture.clear();
+    Captured.clear();
+    Block.clear();
+}
+
+void WorldJournal::BeginSection( int section )
+{
+    if( !SaveActive )
+        return;
+
+    CurSection = -1;
+    RecordOpen = false;
+
+    if( section >= 0 && section < WORLD_SECTION_COUNT )
+    {
+        CurSection = section;
+        CapturedRecord cr = { section, true, Capture.size(), 0 };
+        Captured.push_back( cr );
+    }
+}
+
+void WorldJournal::BeginRecord()
+{
+    if( !SaveActive || CurSection < 0 || !IsKeyedSection( CurSection ) )
+        return;
+
+    CapturedRecord cr = { CurSection, false, Capture.size(), 0 };
+    Captured.push_back( cr );
+    RecordOpen = true;
+}
+
+void WorldJournal::AddData( const void* data, size_t size )
+{
+    if( !SaveActive || CurSection < 0 || !size )
+        return;
+
+    // Skip count of records in keyed sections
+    if( IsKeyedSection( CurSection ) && !RecordOpen )
+        return;
+
+    Capture.insert( Capture.end(), (const uchar*)data, (const uchar*)data + size );
+    Captured.back().Len += (uint)size;
+}
+
+void WorldJournal::EndSection()
+{
+    CurSection = -1;
+    RecordOpen = false;
+}
+
+void WorldJournal::EndSave()
+{
+    if( !SaveActive )
+        return;
+
+    EndSection();
+    SaveActive = false;
+    SavePending = true;
+}
+
+bool WorldJournal::IsPending()
+{
+    return SavePending;
+}
+
+void WorldJournal::ProcessSave()
+{
+    if( !SavePending )
+        return;
+    SavePending = false;
+
+    double tick = Timer::AccurateTick();
+
+    Stats.Upserts = 0;
+    Stats.Erases = 0;
+    Stats.Sections = 0;
+    Stats.BlockSize = 0;
+    Stats.Records = 0;
+    Stats.Dirty = (SaveDelta ? SaveDirtyCount : 0);
+    KeyError = false;
+    CurSection = -1;
+
+    // Non keyed sections are hashed as whole, data is stored in section begin
+    const uchar*          capture = (Capture.empty() ? NULL : &Capture[0]);
+    const CapturedRecord* section = NULL;
+    for( auto it = Captured.begin(), end = Captured.end(); it != end; ++it )
+    {
+        const CapturedRecord& cr = *it;
+        if( cr.SectionBegin )
+        {
+            if( section )
+                FinishSection( capture + section->Offset, section->Len );
+            BeginSectionState( cr.Section );
+            section = &cr;
+        }
+        else
+        {
+            FinishRecord( capture + cr.Offset, cr.Len );
+        }
+    }
+    if( section )
+        FinishSection( capture + section->Offset, section->Len );
+
+    Capture.clear();
+    Captured.clear();
+    Stats.ProcessTime = Timer::AccurateTick() - tick;
+
+    if( KeyError )
+    {
+        WriteLogF( _FUNC_, " - World save records have invalid or duplicate keys, journal state dropped.\n" );
+        Reset();
+        return;
+    }
+
+    StateValid = true;
+    Stats.BlockSize = (uint)Block.size();
+    if( SaveDelta )
+    {
+        Stats.DeltaSaves++;
+        WriteLog( "World journal processed in %g ms, dirty<%u>, records<%u>, erased<%u>, sections<%u>, size<%u>.\n",
+                  Stats.ProcessTime, Stats.Dirty, Stats.Upserts, Stats.Erases, Stats.Sections, Stats.BlockSize );
+    }
+    else
+    {
+        Stats.FullSaves++;
+    }
+}
+
+void WorldJournal::SetPauseTime( double ms )
+{
+    Stats.PauseTime = ms;
+    if( ms > Stats.PauseTimeMax )
+        Stats.PauseTimeMax = ms;
+}
+
+bool WorldJournal::IsActive()
+{
+    return SaveActive;
+}
+
+bool WorldJournal::IsDelta()
+{
+    return SaveDelta;
+}
+
+bool WorldJournal::HasState()
+{
+    return StateValid;
+}
+
+void WorldJournal::Reset()
+{
+    StateValid = false;
+    SavePending = false;
+    Capture.clear();
+    Captured.clear();
+    for( int i = 0; i < WORLD_SECTION_COUNT; i++ )
+    {
+        RecordStateVec().swap( SectionState[i] );
+        SectionHash[i] = 0;
+    }
+    Block.clear();
+}
+
+UCharVec& WorldJournal::GetBlock()
+{
+    return Block;
+}
+
+bool WorldJournal::WriteBlock( const char* journal_fname, const char* world_fname )
+{
+    // Nothing changed
+    if( Block.empty() )
+        return true;
+
+    void* f = FileOpenForAppend( journal_fname );
+    if( !f )
+    {
+        // New journal, bound to size of world dump
+        void* fworld = FileOpen( world_fname, false );
+        if( !fworld )
+        {
+            WriteLogF( _FUNC_, " - World dump file<%s> not found.\n", world_fname );
+            return false;
+        }
+        uint world_size = FileGetSize( fworld );
+        FileClose( fworld );
+
+        f = FileOpen( journal_fname, true );
+        if( !f )
+        {
+            WriteLogF( _FUNC_, " - Can't create journal file<%s>.\n", journal_fname );
+            return false;
+        }
+        FileWrite( f, WorldJournalSignature, sizeof(WorldJournalSignature) );
+        FileWrite( f, &world_size, sizeof(world_size) );
+    }
+
+    uint magic = WORLD_JOURNAL_BLOCK_MAGIC;
+    uint size = (uint)Block.size();
+    uint crc = Crypt.Crc32( &Block[0], size );
+    bool ok = FileWrite( f, &magic, sizeof(magic) ) && FileWrite( f, &size, sizeof(size) ) &&
+              FileWrite( f, &Block[0], size ) && FileWrite( f, &crc, sizeof(crc) );
+    FileClose( f );
+
+    if( !ok )
+        WriteLogF( _FUNC_, " - Can't write journal file<%s>.\n", journal_fname );
+    return ok;
+}
+
+string WorldJournal::GetJournalName( const char* world_fname )
+{
+    return string( world_fname ) + "j";
+}
+
+/************************************************************************/
+/* Loading                                                              */
+/************************************************************************/
+
+// Readers must follow format of Save*File functions
+class SectionReader
+{
+public:
+    void*     F;
+    UCharVec& Data;
+    bool      Ok;
+
+    SectionReader( void* f, UCharVec& data ) : F( f ), Data( data ), Ok( true ) {}
+
+    bool Read( void* buf, uint size )
+    {
+        if( !Ok || !size )
+            return Ok;
+
+        size_t pos = Data.size();
+        Data.resize( pos + size );
+        Ok = FileRead( F, &Data[pos], size );
+        if( Ok && buf )
+            memcpy( buf, &Data[pos], size );
+        return Ok;
+    }
+
+    template<typename T>
+    bool Read( T& value ) { return Read( &value, sizeof(value) ); }
+    bool Skip( uint size ) { return Read( NULL, size ); }
+};
+
+static bool ReadRecord( void* f, int section, UCharVec& data )
+{
+    SectionReader r( f, data );
+    switch( section )
+    {
+        case WORLD_SECTION_LOCATIONS:
+        {
+            uint map_count = 0;
+            r.Skip( sizeof(Location::LocData) );
+            r.Read( map_count );
+            r.Skip( map_count * sizeof(Map::MapData) );
+        }
+        break;
+        case WORLD_SECTION_CRITTERS:
+        {
+            CritData cr_data;
+            uint     te_count = 0;
+            r.Read( cr_data );
+            if( cr_data.IsDataExt )
+                r.Skip( sizeof(CritDataExt) );
+            r.Read( te_count );
+            r.Skip( te_count * sizeof(Critter::CrTimeEvent) );
+        }
+        break;
+        case WORLD_SECTION_ITEMS:
+        {
+            uchar lex_len = 0;
+            r.Skip( sizeof(uint) + sizeof(ushort) + sizeof(uchar) + sizeof(Item().AccBuffer) + sizeof(Item::ItemData) );
+            r.Read( lex_len );
+            r.Skip( lex_len );
+        }
+        break;
+        case WORLD_SECTION_VARS:
+            r.Skip( sizeof(ushort) + sizeof(uint) + sizeof(uint) + sizeof(int) );
+            break;
+        default:
+            return false;
+    }
+    return r.Ok;
+}
+
+static bool ReadBlobSection( void* f, int section, UCharVec& data )
+{
+    SectionReader r( f, data );
+    uint          count = 0;
+    switch( section )
+    {
+        case WORLD_SECTION_GAME_INFO:
+        {
+            uint sp = 0;
+            r.Read( sp );
+            if( sp )
+            {
+                uint te_count = 0, pic_size = 0;
+                r.Skip( sizeof(FOServer::ClientSaveData().Name) + sizeof(CritData) + sizeof(CritDataExt) );
+                r.Read( te_count );
+                r.Skip( te_count * sizeof(Critter::CrTimeEvent) );
+                r.Read( pic_size );
+                r.Skip( pic_size );
+            }
+            r.Skip( sizeof(GameOpt.YearStart) + sizeof(GameOpt.Year) + sizeof(GameOpt.Month) + sizeof(GameOpt.Day) +
+                    sizeof(GameOpt.Hour) + sizeof(GameOpt.Minute) + sizeof(GameOpt.Second) + sizeof(GameOpt.TimeMultiplier) );
+            r.Skip( sizeof(FOServer::BestScores) );
+        }
+        break;
+        case WORLD_SECTION_HOLO:
+            r.Read( count );
+            for( uint i = 0; i < count && r.Ok; i++ )
+            {
+                ushort title_len = 0, text_len = 0;
+                r.Skip( sizeof(uint) + sizeof(bool) );
+                r.Read( title_len );
+                r.Skip( title_len );
+                r.Read( text_len );
+                r.Skip( text_len );
+            }
+            break;
+        case WORLD_SECTION_ANY_DATA:
+            r.Read( count );
+            for( uint i = 0; i < count && r.Ok; i++ )
+            {
+                uint name_len = 0, data_len = 0;
+                r.Read( name_len );
+                r.Skip( name_len );
+                r.Read( data_len );
+                r.Skip( data_len );
+            }
+            break;
+        case WORLD_SECTION_TIME_EVENTS:
+            r.Read( count );
+            for( uint i = 0; i < count && r.Ok; i++ )
+            {
+                ushort name_len = 0;
+                uint   values_size = 0;
+                r.Skip( sizeof(uint) );
+                r.Read( name_len );
+                r.Skip( name_len + sizeof(uint) + sizeof(uint) );
+                r.Read( values_size );
+                r.Skip( values_size * sizeof(uint) );
+            }
+            break;
+        case WORLD_SECTION_SCRIPT_FUNCTIONS:
+            r.Read( count );
+            for( uint i = 0; i < count && r.Ok; i++ )
+            {
+                uint len = 0;
+                r.Read( len );
+                r.Skip( len );
+            }
+            break;
+        default:
+            return false;
+    }
+    return r.Ok;
+}
+
+typedef map<RecordState, UCharVec> RecordMap;
+
+bool WorldJournal::Apply( const char* world_fname, const char* journal_fname, const char* out_fname )
+{
+    void* fj = FileOpen( journal_fname, false );
+    if( !fj )
+        return false;
+
+    WriteLog( "Apply world journal<%s>...\n", journal_fname );
+
+    // Header
+    uchar signature[sizeof(WorldJournalSignature)];
+    uint  world_size = 0;
+    if( !FileRead( fj, signature, sizeof(signature) ) || memcmp( signature, WorldJournalSignature, sizeof(signature) ) ||
+        !FileRead( fj, &world_size, sizeof(world_size) ) )
+    {
+        WriteLog( "Invalid world journal<%s>, ignored.\n", journal_fname );
+        FileClose( fj );
+        return false;
+    }
+
+    void* fw = FileOpen( world_fname, false );
+    if( !fw )
+    {
+        FileClose( fj );
+        return false;
+    }
+    if( FileGetSize( fw ) != world_size )
+    {
+        WriteLog( "World journal<%s> does not match world dump file, ignored.\n", journal_fname );
+        FileClose( fj );
+        FileClose( fw );
+        return false;
+    }
+
+    // Blocks, last block can be incomplete
+    vector<UCharVec> blocks;
+    while( true )
+    {
+        uint magic = 0, size = 0, crc = 0;
+        if( !FileRead( fj, &magic, sizeof(magic) ) )
+            break;
+        if( magic != WORLD_JOURNAL_BLOCK_MAGIC || !FileRead( fj, &size, sizeof(size) ) )
+        {
+            WriteLog( "World journal block<%u> damaged, rest of journal skipped.\n", (uint)blocks.size() );
+            break;
+        }
+
+        UCharVec block( size );
+        if( !size || !FileRead( fj, &block[0], size ) || !FileRead( fj, &crc, sizeof(crc) ) || Crypt.Crc32( &block[0], size ) != crc )
+        {
+            WriteLog( "World journal block<%u> incomplete, rest of journal skipped.\n", (uint)blocks.size() );
+            break;
+        }
+        blocks.push_back( UCharVec() );
+        blocks.back().swap( block );
+    }
+    FileClose( fj );
+
+    if( blocks.empty() )
+    {
+        FileClose( fw );
+        return false;
+    }
+
+    // Read world dump by records
+    uchar     world_signature[6];
+    ushort    version = 0;
+    RecordMap records[WORLD_SECTION_COUNT];
+    UCharVec  blobs[WORLD_SECTION_COUNT];
+    bool      ok = FileRead( fw, world_signature, sizeof(world_signature) );
+    for( int s = 0; s < WORLD_SECTION_COUNT && ok; s++ )
+    {
+        if( IsKeyedSection( s ) )
+        {
+            uint count = 0;
+            ok = FileRead( fw, &count, sizeof(count) );
+            for( uint i = 0; i < count && ok; i++ )
+            {
+                UCharVec    data;
+                RecordState key;
+                ok = ReadRecord( fw, s, data ) && GetRecordKey( s, &data[0], (uint)data.size(), key );
+                if( ok )
+                    records[s][key].swap( data );
+            }
+        }
+        else
+        {
+            ok = ReadBlobSection( fw, s, blobs[s] );
+        }
+    }
+    ok = ok && FileRead( fw, &version, sizeof(version) );
+    FileClose( fw );
+    if( !ok )
+    {
+        WriteLog( "Can't read world dump file<%s> for journal applying.\n", world_fname );
+        return false;
+    }
+
+    // Apply changes
+    uint changes = 0;
+    for( size_t b = 0; b < blocks.size(); b++ )
+    {
+        UCharVec& block = blocks[b];
+        uint      pos = 0;
+        while( pos + sizeof(uchar) * 2 + sizeof(uint) <= block.size() )
+        {
+            uchar type = block[pos];
+            int   section = block[pos + 1];
+            uint  len;
+            memcpy( &len, &block[pos + 2], sizeof(len) );
+            pos += sizeof(uchar) * 2 + sizeof(uint);
+            if( pos + len > block.size() || section >= WORLD_SECTION_COUNT )
+            {
+                WriteLog( "World journal block<%u> contains invalid record.\n", (uint)b );
+                return false;
+            }
+
+            const uchar* data = (len ? &block[pos] : NULL);
+            RecordState  key;
+            if( type == WORLD_JOURNAL_UPSERT && IsKeyedSection( section ) && GetRecordKey( section, data, len, key ) )
+            {
+                records[section][key].assign( data, data + len );
+            }
+            else if( type == WORLD_JOURNAL_ERASE && IsKeyedSection( section ) && len == sizeof(uint) + sizeof(uint64) )
+            {
+                memcpy( &key.KeyHi, data, sizeof(uint) );
+                memcpy( &key.Key, data + sizeof(uint), sizeof(uint64) );
+                key.Hash = 0;
+                records[section].erase( key );
+            }
+            else if( type == WORLD_JOURNAL_SECTION && !IsKeyedSection( section ) )
+            {
+                blobs[section].assign( data, data + len );
+            }
+            else
+            {
+                WriteLog( "World journal block<%u> contains unknown record<%u>.\n", (uint)b, type );
+                return false;
+            }
+
+            pos += len;
+            changes++;
+        }
+    }
+
+    // Write merged world dump
+    void* fout = FileOpen( out_fname, true );
+    if( !fout )
+    {
+        WriteLog( "Can't create world dump file<%s>.\n", out_fname );
+        return false;
+    }
+
+    ok = FileWrite( fout, world_signature, sizeof(world_signature) );
+    for( int s = 0; s < WORLD_SECTION_COUNT && ok; s++ )
+    {
+        if( IsKeyedSection( s ) )
+        {
+            uint count = (uint)records[s].size();
+            ok = FileWrite( fout, &count, sizeof(count) );
+            for( auto it = records[s].begin(), end = records[s].end(); it != end && ok; ++it )
+                ok = FileWrite( fout, &it->second[0], (uint)it->second.size() );
+        }
+        else if( !blobs[s].empty() )
+        {
+            ok = FileWrite( fout, &blobs[s][0], (uint)blobs[s].size() );
+        }
+    }
+    ok = ok && FileWrite( fout, &version, sizeof(version) );
+    FileClose( fout );
+
+    if( !ok )
+    {
+        WriteLog( "Can't write world dump file<%s>.\n", out_fname );
+        FileDelete( out_fname );
+        return false;
+    }
+
+    WriteLog( "Apply world journal<%s>... blocks<%u>, changes<%u>, saved to<%s>.\n", journal_fname, (uint)blocks.size(), changes, out_fname );
+    return true;
+}
+
+void WorldJournal::GetStatistics( WorldJournalStatistics& stats )
+{
+    stats = Stats;
+}
+
+string WorldJournal::GetStatisticsString()
+{
+    char str[MAX_FOTEXT];
+    return Str::Format( str, "World journal: full saves %u, delta saves %u; last save: dirty %u, records %u, upserts %u, erases %u, sections %u, block %u bytes, "
+                             "pause %g ms (max %g ms), processing %g ms\n",
+                        Stats.FullSaves, Stats.DeltaSaves, Stats.Dirty, Stats.Records, Stats.Upserts, Stats.Erases, Stats.Sections, Stats.BlockSize,
+                        Stats.PauseTime, Stats.PauseTimeMax, Stats.ProcessTime );
+}
@@ -0,0 +1,91 @@
+#ifndef __WORLD_JOURNAL__
+#define __WORLD_JOURNAL__
+
+#include "Types.h"
+
+// World save sections, in order of worldXXXX.fo
+#define WORLD_SECTION_GAME_INFO           (0)
+#define WORLD_SECTION_LOCATIONS           (1)
+#define WORLD_SECTION_CRITTERS            (2)
+#define WORLD_SECTION_ITEMS               (3)
+#define WORLD_SECTION_VARS                (4)
+#define WORLD_SECTION_HOLO                (5)
+#define WORLD_SECTION_ANY_DATA            (6)
+#define WORLD_SECTION_TIME_EVENTS         (7)
+#define WORLD_SECTION_SCRIPT_FUNCTIONS    (8)
+#define WORLD_SECTION_COUNT               (9)
+
+// Journal records
+#define WORLD_JOURNAL_UPSERT              (1)
+#define WORLD_JOURNAL_ERASE               (2)
+#define WORLD_JOURNAL_SECTION             (3)
+
+// Key of record in keyed section, locations, critters, items: id, vars: template id and uid of var
+struct WorldJournalKey
+{
+    uint   KeyHi;
+    uint64 Key;
+
+    bool operator<( const WorldJournalKey& r ) const  { return KeyHi < r.KeyHi || (KeyHi == r.KeyHi && Key < r.Key); }
+    bool operator==( const WorldJournalKey& r ) const { return KeyHi == r.KeyHi && Key == r.Key; }
+};
+typedef vector<WorldJournalKey> WorldJournalKeyVec;
+
+struct WorldJournalStatistics
+{
+    uint   DeltaSaves;
+    uint   FullSaves;
+    uint   Upserts;      // Records written by last delta save
+    uint   Erases;
+    uint   Sections;
+    uint   BlockSize;
+    uint   Records;      // Records checked by last save
+    uint   Dirty;        // Records reported as changed before last delta save
+    double PauseTime;    // Logic threads pause of last autosave, ms
+    double PauseTimeMax;
+    double ProcessTime;  // Hashing and diff of last save, done after pause, ms
+};
+
+// Incremental world saving
+// Objects report changes between saves, delta saves serialize only reported records and sections
+// Records are only copied during save, ProcessSave hashes them after logic threads are resumed
+// Delta saves store only changed records in worldXXXX.foj, full saves rebuild state and start new journal
+class WorldJournal
+{
+public:
+    // Changes tracking, objects keep generation of last report to skip repeated reports until next save
+    // Zero generation means disabled tracking
+    static volatile uint DirtyGeneration;
+    static void          SetTracking( bool enabled );
+    static void          SetDirty( int section, uint key_hi, uint64 key );
+    static void          SetSectionDirty( int section );
+    static bool          IsSectionDirty( int section );
+    static void          GetDirtyIds( int section, UIntVec& ids );
+    static void          GetDirtyKeys( int section, WorldJournalKeyVec& keys );
+
+    // Saving
+    static void      BeginSave( bool delta );
+    static void      BeginSection( int section );
+    static void      BeginRecord();
+    static void      AddData( const void* data, size_t size );
+    static void      EndSection();
+    static void      EndSave();
+    static bool      IsPending();
+    static void      ProcessSave();
+    static void      SetPauseTime( double ms );
+    static bool      IsActive();
+    static bool      IsDelta();
+    static bool      HasState();
+    static void      Reset();
+    static UCharVec& GetBlock();
+    static bool      WriteBlock( const char* journal_fname, const char* world_fname );
+
+    // Loading
+    static string GetJournalName( const char* world_fname );
+    static bool   Apply( const char* world_fname, const char* journal_fname, const char* out_fname );
+
+    static void   GetStatistics( WorldJournalStatistics& stats );
+    static string GetStatisticsString();
+};
+
+#endif // __WORLD_JOURNAL__